@@ -0,0 +1,90 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+// 测试程序共用的工具：客户端WebSocket帧编码、计时
+
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace bench {
+
+// 进程内单调时间（毫秒，带小数）
+inline double nowMs() {
+    static const auto origin = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+}
+
+// 编码客户端到服务器的帧（客户端帧必须带掩码）
+inline void appendMaskedFrame(std::string& out, uint8_t opcode, const char* payload, size_t length, uint32_t maskKey) {
+    out.push_back(static_cast<char>(0x80 | opcode));
+    if (length < 126) {
+        out.push_back(static_cast<char>(0x80 | length));
+    } else if (length <= 0xFFFF) {
+        out.push_back(static_cast<char>(0x80 | 126));
+        out.push_back(static_cast<char>((length >> 8) & 0xFF));
+        out.push_back(static_cast<char>(length & 0xFF));
+    } else {
+        out.push_back(static_cast<char>(0x80 | 127));
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            out.push_back(static_cast<char>((static_cast<uint64_t>(length) >> shift) & 0xFF));
+        }
+    }
+
+    uint8_t mask[4] = {
+        static_cast<uint8_t>(maskKey >> 24), static_cast<uint8_t>(maskKey >> 16),
+        static_cast<uint8_t>(maskKey >> 8), static_cast<uint8_t>(maskKey)
+    };
+    out.append(reinterpret_cast<const char*>(mask), 4);
+
+    size_t start = out.size();
+    out.append(payload, length);
+    for (size_t i = 0; i < length; ++i) {
+        out[start + i] = static_cast<char>(out[start + i] ^ mask[i & 3]);
+    }
+}
+
+inline void appendMaskedFrame(std::string& out, uint8_t opcode, const std::string& payload, uint32_t maskKey) {
+    appendMaskedFrame(out, opcode, payload.data(), payload.size(), maskKey);
+}
+
+// 解析服务器到客户端的帧（不带掩码），数据不完整时返回false
+// 成功时返回操作码、载荷位置和帧总长度
+inline bool parseServerFrame(const std::string& data, size_t offset, uint8_t& opcode,
+                             size_t& payloadOffset, size_t& payloadLength, size_t& frameLength) {
+    if (data.size() - offset < 2) {
+        return false;
+    }
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data.data()) + offset;
+    size_t available = data.size() - offset;
+    opcode = bytes[0] & 0x0F;
+    uint64_t length = bytes[1] & 0x7F;
+    size_t header = 2;
+    if (length == 126) {
+        if (available < 4) return false;
+        length = (static_cast<uint64_t>(bytes[2]) << 8) | bytes[3];
+        header = 4;
+    } else if (length == 127) {
+        if (available < 10) return false;
+        length = 0;
+        for (int i = 0; i < 8; ++i) {
+            length = (length << 8) | bytes[2 + i];
+        }
+        header = 10;
+    }
+    if (bytes[1] & 0x80) {
+        header += 4;   // 服务器不应发送掩码帧，这里只跳过
+    }
+    if (available < header + length) {
+        return false;
+    }
+    payloadOffset = offset + header;
+    payloadLength = static_cast<size_t>(length);
+    frameLength = header + static_cast<size_t>(length);
+    return true;
+}
+
+} // namespace bench
+
+#endif // BENCHUTIL_H
@@ -0,0 +1,658 @@
+// WebSocket 负载生成器：模拟大量客户端连接游戏服务器，测量往返延迟和服务器吞吐量
+// 用法: loadgen [选项]
+//   --host <地址>        服务器地址（默认 127.0.0.1）
+//   --port <端口>        WebSocket端口（默认 8081）
+//   --clients <N>        模拟客户端数（默认 1000）
+//   --threads <N>        I/O线程数（默认 2）
+//   --duration <秒>      全部连接建立后的测量时长（默认 30）
+//   --ramp <N>           每秒新建的连接数（默认 500）
+//   --ping-rate <Hz>     每个客户端每秒发送的 ping 数（默认 1）
+//   --move-rate <Hz>     每个客户端每秒发送的移动输入数（默认 10）
+//   --binary             使用二进制协议（认证时协商），否则使用JSON
+// 每秒输出一行进度，结束时输出连接、往返延迟（ping -> pong）p50/p99/p999 和吞吐量汇总
+#include "BenchUtil.h"
+#include "EventPoller.h"
+#include "Metrics.h"
+#include "BinaryProtocol.h"
+
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8081;
+    int clients = 1000;
+    int threads = 2;
+    double durationSeconds = 30.0;
+    double rampPerSecond = 500.0;
+    double pingRate = 1.0;
+    double moveRate = 10.0;
+    bool binary = false;
+};
+
+enum class ClientState {
+    IDLE,            // 尚未发起连接
+    CONNECTING,      // 非阻塞connect进行中
+    HANDSHAKING,     // 已发送升级请求
+    AUTHENTICATING,  // 已发送auth
+    RUNNING,
+    CLOSED
+};
+
+struct Client {
+    int socket = -1;
+    int id = 0;
+    ClientState state = ClientState::IDLE;
+    std::string input;
+    std::string output;
+    size_t outputOffset = 0;
+    bool writeRegistered = false;
+    double connectStartMs = 0.0;
+    double nextPingMs = 0.0;
+    double nextMoveMs = 0.0;
+    uint32_t inputSequence = 0;
+};
+
+// 全部线程共享的统计
+struct Stats {
+    MetricHistogram rtt;           // ping -> pong
+    MetricHistogram connectTime;   // connect -> auth_success
+    MetricCounter sentMessages;
+    MetricCounter sentBytes;
+    MetricCounter receivedMessages;
+    MetricCounter receivedBytes;
+    MetricCounter snapshots;
+    std::atomic<int> running{0};
+    std::atomic<int> failed{0};
+    std::atomic<int> closed{0};
+};
+
+std::atomic<bool> g_stop{false};
+
+void HandleSignal(int) {
+    g_stop = true;
+}
+
+const char* HANDSHAKE_KEY = "dGhlIHNhbXBsZSBub25jZQ==";
+
+const char* const DIRECTIONS[] = {"forward", "backward", "left", "right"};
+
+class LoadWorker {
+public:
+    LoadWorker(const Options& options, Stats& stats, sockaddr_in address, int firstId, int count)
+        : options(options), stats(stats), address(address), clients(count), rng(firstId * 7919 + 17) {
+        for (int i = 0; i < count; ++i) {
+            clients[i].id = firstId + i;
+        }
+    }
+
+    ~LoadWorker() {
+        for (Client& client : clients) {
+            if (client.socket >= 0) {
+                ::close(client.socket);
+            }
+        }
+    }
+
+    bool isValid() const { return poller.isValid(); }
+
+    void run(double startMs) {
+        std::vector<EventPoller::Event> events;
+        events.reserve(1024);
+        size_t nextToOpen = 0;
+        double rampPerThread = options.rampPerSecond / options.threads;
+
+        while (!g_stop) {
+            double now = bench::nowMs();
+
+            // 按速率逐步建立连接，避免瞬间打满服务器的监听队列
+            size_t allowed = rampPerThread > 0
+                ? static_cast<size_t>((now - startMs) / 1000.0 * rampPerThread) + 1
+                : clients.size();
+            while (nextToOpen < clients.size() && nextToOpen < allowed) {
+                openConnection(clients[nextToOpen++], now);
+            }
+
+            int count = poller.wait(events, 2);
+            if (count < 0) {
+                break;
+            }
+            for (int i = 0; i < count; ++i) {
+                Client& client = clients[static_cast<size_t>(events[i].token)];
+                if (events[i].events & EventPoller::EVENT_WRITE) {
+                    onWritable(client);
+                }
+                if (events[i].events & (EventPoller::EVENT_READ | EventPoller::EVENT_ERROR)) {
+                    onReadable(client);
+                }
+            }
+
+            now = bench::nowMs();
+            for (Client& client : clients) {
+                if (client.state == ClientState::RUNNING) {
+                    sendScheduled(client, now);
+                }
+            }
+        }
+    }
+
+private:
+    void openConnection(Client& client, double now) {
+        client.socket = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (client.socket < 0) {
+            fail(client);
+            return;
+        }
+        fcntl(client.socket, F_SETFL, fcntl(client.socket, F_GETFL, 0) | O_NONBLOCK);
+        int noDelay = 1;
+        setsockopt(client.socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+        int noSigPipe = 1;
+        setsockopt(client.socket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+        client.connectStartMs = now;
+        int result = ::connect(client.socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        if (result < 0 && errno != EINPROGRESS) {
+            fail(client);
+            return;
+        }
+
+        size_t token = static_cast<size_t>(&client - clients.data());
+        if (!poller.add(client.socket, EventPoller::EVENT_READ | EventPoller::EVENT_WRITE, token)) {
+            fail(client);
+            return;
+        }
+        client.writeRegistered = true;
+        client.state = ClientState::CONNECTING;
+        if (result == 0) {
+            onWritable(client);
+        }
+    }
+
+    void onWritable(Client& client) {
+        if (client.state == ClientState::CONNECTING) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (getsockopt(client.socket, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) {
+                fail(client);
+                return;
+            }
+            client.state = ClientState::HANDSHAKING;
+            client.output += "GET / HTTP/1.1\r\nHost: " + options.host + ":" + std::to_string(options.port) +
+                "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: " + HANDSHAKE_KEY +
+                "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+        }
+        flush(client);
+    }
+
+    void onReadable(Client& client) {
+        char buffer[16384];
+        while (client.state != ClientState::CLOSED && client.state != ClientState::IDLE) {
+            ssize_t received = ::recv(client.socket, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                stats.receivedBytes.add(static_cast<uint64_t>(received));
+                client.input.append(buffer, static_cast<size_t>(received));
+                continue;
+            }
+            if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                close(client);
+                return;
+            }
+            break;
+        }
+        processInput(client);
+    }
+
+    void processInput(Client& client) {
+        if (client.state == ClientState::HANDSHAKING) {
+            size_t headerEnd = client.input.find("\r\n\r\n");
+            if (headerEnd == std::string::npos) {
+                return;
+            }
+            if (client.input.compare(0, 12, "HTTP/1.1 101") != 0) {
+                fail(client);
+                return;
+            }
+            client.input.erase(0, headerEnd + 4);
+            client.state = ClientState::AUTHENTICATING;
+
+            std::string auth = "{\"type\":\"auth\",\"playerName\":\"loadgen_" + std::to_string(client.id) + "\"" +
+                (options.binary ? ",\"binaryProtocol\":" + std::to_string(BINARY_PROTOCOL_VERSION) : std::string()) + "}";
+            sendText(client, auth);
+        }
+
+        size_t offset = 0;
+        uint8_t opcode = 0;
+        size_t payloadOffset = 0, payloadLength = 0, frameLength = 0;
+        while (client.state != ClientState::CLOSED &&
+               bench::parseServerFrame(client.input, offset, opcode, payloadOffset, payloadLength, frameLength)) {
+            stats.receivedMessages.add();
+            handleFrame(client, opcode, client.input.data() + payloadOffset, payloadLength);
+            offset += frameLength;
+        }
+        if (client.state != ClientState::CLOSED) {
+            client.input.erase(0, offset);
+        }
+    }
+
+    void handleFrame(Client& client, uint8_t opcode, const char* payload, size_t length) {
+        double now = bench::nowMs();
+        if (opcode == 0x8) {
+            close(client);
+            return;
+        }
+
+        if (opcode == 0x1) {
+            std::string text(payload, length);
+            if (client.state == ClientState::AUTHENTICATING) {
+                if (text.find("\"type\":\"auth_success\"") != std::string::npos) {
+                    startRunning(client, now);
+                } else if (text.find("\"type\":\"auth_failed\"") != std::string::npos) {
+                    fail(client);
+                }
+                return;
+            }
+            if (text.find("\"type\":\"pong\"") != std::string::npos) {
+                size_t pos = text.find("\"timestamp\":");
+                if (pos != std::string::npos) {
+                    recordRoundTrip(now - std::atof(text.c_str() + pos + 12));
+                }
+            } else if (text.find("\"type\":\"snapshot\"") != std::string::npos) {
+                stats.snapshots.add();
+                size_t pos = text.find("\"tick\":");
+                if (pos != std::string::npos) {
+                    sendText(client, "{\"type\":\"snapshot_ack\",\"data\":{\"tick\":" +
+                                     std::to_string(std::strtoul(text.c_str() + pos + 7, nullptr, 10)) + "}}");
+                }
+            }
+            return;
+        }
+
+        if (opcode == 0x2 && length >= BINARY_HEADER_SIZE) {
+            uint8_t type = static_cast<uint8_t>(payload[1]);
+            if (type == static_cast<uint8_t>(BinaryOpcode::PONG) && length >= BINARY_HEADER_SIZE + 8) {
+                double timestamp;
+                std::memcpy(&timestamp, payload + BINARY_HEADER_SIZE, 8);
+                recordRoundTrip(now - timestamp);
+            } else if (type == static_cast<uint8_t>(BinaryOpcode::SNAPSHOT) && length >= BINARY_HEADER_SIZE + 4) {
+                stats.snapshots.add();
+                char ack[BINARY_HEADER_SIZE + 4] = {
+                    static_cast<char>(BINARY_PROTOCOL_VERSION), static_cast<char>(BinaryOpcode::SNAPSHOT_ACK)
+                };
+                std::memcpy(ack + BINARY_HEADER_SIZE, payload + BINARY_HEADER_SIZE, 4);
+                sendBinary(client, ack, sizeof(ack));
+            }
+        }
+    }
+
+    void startRunning(Client& client, double now) {
+        client.state = ClientState::RUNNING;
+        stats.running++;
+        stats.connectTime.record(static_cast<uint64_t>((now - client.connectStartMs) * 1e6));
+
+        // 随机相位，避免所有客户端在同一时刻发送
+        std::uniform_real_distribution<double> phase(0.0, 1.0);
+        client.nextPingMs = options.pingRate > 0 ? now + phase(rng) * 1000.0 / options.pingRate : 0.0;
+        client.nextMoveMs = options.moveRate > 0 ? now + phase(rng) * 1000.0 / options.moveRate : 0.0;
+    }
+
+    void recordRoundTrip(double milliseconds) {
+        if (milliseconds >= 0) {
+            stats.rtt.record(static_cast<uint64_t>(milliseconds * 1e6));
+        }
+    }
+
+    void sendScheduled(Client& client, double now) {
+        if (options.pingRate > 0 && now >= client.nextPingMs) {
+            sendPing(client, now);
+            client.nextPingMs = std::max(client.nextPingMs + 1000.0 / options.pingRate, now - 1000.0);
+        }
+        if (client.state == ClientState::RUNNING && options.moveRate > 0 && now >= client.nextMoveMs) {
+            sendMove(client);
+            client.nextMoveMs = std::max(client.nextMoveMs + 1000.0 / options.moveRate, now - 1000.0);
+        }
+    }
+
+    void sendPing(Client& client, double now) {
+        if (options.binary) {
+            char ping[BINARY_HEADER_SIZE + 8] = {
+                static_cast<char>(BINARY_PROTOCOL_VERSION), static_cast<char>(BinaryOpcode::PING)
+            };
+            std::memcpy(ping + BINARY_HEADER_SIZE, &now, 8);
+            sendBinary(client, ping, sizeof(ping));
+        } else {
+            char text[96];
+            std::snprintf(text, sizeof(text), "{\"type\":\"ping\",\"data\":{\"timestamp\":%.4f}}", now);
+            sendText(client, text);
+        }
+    }
+
+    void sendMove(Client& client) {
+        int direction = static_cast<int>(rng() % 4);
+        float rotation = static_cast<float>(rng() % 6283) / 1000.0f;
+        if (options.binary) {
+            char input[BINARY_HEADER_SIZE + 9] = {
+                static_cast<char>(BINARY_PROTOCOL_VERSION), static_cast<char>(BinaryOpcode::INPUT)
+            };
+            uint32_t sequence = ++client.inputSequence;
+            uint8_t bits = static_cast<uint8_t>(1u << direction);
+            std::memcpy(input + BINARY_HEADER_SIZE, &sequence, 4);
+            std::memcpy(input + BINARY_HEADER_SIZE + 4, &bits, 1);
+            std::memcpy(input + BINARY_HEADER_SIZE + 5, &rotation, 4);
+            sendBinary(client, input, sizeof(input));
+        } else {
+            char text[128];
+            std::snprintf(text, sizeof(text), "{\"type\":\"move\",\"data\":{\"directions\":[\"%s\"],\"rotation\":%.3f}}",
+                          DIRECTIONS[direction], rotation);
+            sendText(client, text);
+        }
+    }
+
+    void sendText(Client& client, const std::string& text) {
+        bench::appendMaskedFrame(client.output, 0x1, text, static_cast<uint32_t>(rng()));
+        stats.sentMessages.add();
+        flush(client);
+    }
+
+    void sendBinary(Client& client, const char* data, size_t length) {
+        bench::appendMaskedFrame(client.output, 0x2, data, length, static_cast<uint32_t>(rng()));
+        stats.sentMessages.add();
+        flush(client);
+    }
+
+    void flush(Client& client) {
+        while (client.outputOffset < client.output.size()) {
+            ssize_t sent = ::send(client.socket, client.output.data() + client.outputOffset,
+                                  client.output.size() - client.outputOffset, MSG_NOSIGNAL);
+            if (sent > 0) {
+                stats.sentBytes.add(static_cast<uint64_t>(sent));
+                client.outputOffset += static_cast<size_t>(sent);
+                continue;
+            }
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+                break;
+            }
+            close(client);
+            return;
+        }
+
+        if (client.outputOffset == client.output.size()) {
+            client.output.clear();
+            client.outputOffset = 0;
+        }
+
+        // 只在有待发数据时关注可写事件（兼容水平触发的轮询后端）
+        bool wantWrite = !client.output.empty() || client.state == ClientState::CONNECTING;
+        if (wantWrite != client.writeRegistered) {
+            size_t token = static_cast<size_t>(&client - clients.data());
+            poller.modify(client.socket, EventPoller::EVENT_READ | (wantWrite ? static_cast<uint32_t>(EventPoller::EVENT_WRITE) : 0u), token);
+            client.writeRegistered = wantWrite;
+        }
+    }
+
+    void fail(Client& client) {
+        if (client.state != ClientState::RUNNING && client.state != ClientState::CLOSED) {
+            stats.failed++;
+        }
+        close(client);
+    }
+
+    void close(Client& client) {
+        if (client.state == ClientState::CLOSED) {
+            return;
+        }
+        if (client.state == ClientState::RUNNING) {
+            stats.running--;
+            stats.closed++;
+        }
+        if (client.socket >= 0) {
+            poller.remove(client.socket);
+            ::close(client.socket);
+            client.socket = -1;
+        }
+        client.state = ClientState::CLOSED;
+        client.output.clear();
+        client.input.clear();
+    }
+
+    const Options& options;
+    Stats& stats;
+    sockaddr_in address;
+    EventPoller poller;
+    std::vector<Client> clients;
+    std::mt19937 rng;
+};
+
+// 两次快照之间新增的样本
+HistogramSnapshot Difference(const HistogramSnapshot& current, const HistogramSnapshot& previous) {
+    HistogramSnapshot delta = current;
+    if (previous.buckets.size() != current.buckets.size()) {
+        return delta;
+    }
+    delta.count = 0;
+    for (size_t i = 0; i < delta.buckets.size(); ++i) {
+        delta.buckets[i] -= std::min(delta.buckets[i], previous.buckets[i]);
+        delta.count += delta.buckets[i];
+        if (delta.buckets[i] > 0) {
+            delta.max = MetricHistogram::bucketUpper(i);
+        }
+    }
+    delta.max = std::min(delta.max, current.max);
+    delta.sum = current.sum - std::min(current.sum, previous.sum);
+    return delta;
+}
+
+double Ms(double ns) {
+    return ns / 1e6;
+}
+
+void PrintUsage() {
+    std::printf("usage: loadgen [--host H] [--port P] [--clients N] [--threads N] [--duration S]\n"
+                "               [--ramp N/s] [--ping-rate HZ] [--move-rate HZ] [--binary]\n");
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](const char* name) -> const char* {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", name);
+                return nullptr;
+            }
+            return argv[++i];
+        };
+        const char* value = nullptr;
+        if (arg == "--binary") {
+            options.binary = true;
+        } else if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if (arg == "--host") {
+            if (!(value = next("--host"))) return false;
+            options.host = value;
+        } else if (arg == "--port") {
+            if (!(value = next("--port"))) return false;
+            options.port = std::atoi(value);
+        } else if (arg == "--clients") {
+            if (!(value = next("--clients"))) return false;
+            options.clients = std::atoi(value);
+        } else if (arg == "--threads") {
+            if (!(value = next("--threads"))) return false;
+            options.threads = std::atoi(value);
+        } else if (arg == "--duration") {
+            if (!(value = next("--duration"))) return false;
+            options.durationSeconds = std::atof(value);
+        } else if (arg == "--ramp") {
+            if (!(value = next("--ramp"))) return false;
+            options.rampPerSecond = std::atof(value);
+        } else if (arg == "--ping-rate") {
+            if (!(value = next("--ping-rate"))) return false;
+            options.pingRate = std::atof(value);
+        } else if (arg == "--move-rate") {
+            if (!(value = next("--move-rate"))) return false;
+            options.moveRate = std::atof(value);
+        } else {
+            std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+    options.clients = std::max(1, options.clients);
+    options.threads = std::max(1, std::min(options.threads, options.clients));
+    return true;
+}
+
+// 每个客户端需要一个文件描述符
+void RaiseFileLimit(int clients) {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < static_cast<rlim_t>(clients) + 64) {
+        limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, static_cast<rlim_t>(clients) + 64);
+        setrlimit(RLIMIT_NOFILE, &limit);
+        if (limit.rlim_cur < static_cast<rlim_t>(clients) + 64) {
+            std::fprintf(stderr, "warning: open file limit %llu is below the client count\n",
+                         static_cast<unsigned long long>(limit.rlim_cur));
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(options.port));
+    if (inet_pton(AF_INET, options.host.c_str(), &address.sin_addr) != 1) {
+        std::fprintf(stderr, "invalid IPv4 address: %s\n", options.host.c_str());
+        return 1;
+    }
+
+    RaiseFileLimit(options.clients);
+    std::signal(SIGINT, HandleSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    Stats stats;
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    int perWorker = options.clients / options.threads;
+    int extra = options.clients % options.threads;
+    int nextId = 1;
+    for (int i = 0; i < options.threads; ++i) {
+        int count = perWorker + (i < extra ? 1 : 0);
+        workers.push_back(std::make_unique<LoadWorker>(options, stats, address, nextId, count));
+        if (!workers.back()->isValid()) {
+            std::fprintf(stderr, "failed to create event poller\n");
+            return 1;
+        }
+        nextId += count;
+    }
+
+    std::printf("loadgen: %d clients, %d threads, ping %.1f Hz, move %.1f Hz, %s protocol -> %s:%d\n",
+                options.clients, options.threads, options.pingRate, options.moveRate,
+                options.binary ? "binary" : "JSON", options.host.c_str(), options.port);
+
+    double startMs = bench::nowMs();
+    std::vector<std::thread> threads;
+    for (auto& worker : workers) {
+        threads.emplace_back([&worker, startMs] { worker->run(startMs); });
+    }
+
+    // 连接全部建立（或失败）后开始计时
+    std::printf("%6s %8s %7s %10s %10s %10s %9s %9s %9s\n",
+                "time", "running", "failed", "sent/s", "recv/s", "recv MB/s", "rtt p50", "rtt p99", "rtt max");
+    double measureStartMs = 0.0;
+    HistogramSnapshot previousRtt = stats.rtt.snapshot();
+    uint64_t previousSent = 0, previousReceived = 0, previousBytes = 0;
+    uint64_t measureSent = 0, measureReceived = 0, measureBytes = 0;
+    HistogramSnapshot measureRtt;
+    double lastMs = startMs;
+
+    while (!g_stop) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        double now = bench::nowMs();
+        double seconds = (now - lastMs) / 1000.0;
+        lastMs = now;
+
+        uint64_t sent = stats.sentMessages.value();
+        uint64_t received = stats.receivedMessages.value();
+        uint64_t bytes = stats.receivedBytes.value();
+        HistogramSnapshot rtt = stats.rtt.snapshot();
+        HistogramSnapshot interval = Difference(rtt, previousRtt);
+
+        std::printf("%5.0fs %8d %7d %10.0f %10.0f %10.2f %8.2fms %8.2fms %8.2fms\n",
+                    (now - startMs) / 1000.0, stats.running.load(), stats.failed.load(),
+                    (sent - previousSent) / seconds, (received - previousReceived) / seconds,
+                    (bytes - previousBytes) / seconds / 1e6,
+                    Ms(interval.percentile(0.5)), Ms(interval.percentile(0.99)), Ms(static_cast<double>(interval.max)));
+        std::fflush(stdout);
+        previousSent = sent;
+        previousReceived = received;
+        previousBytes = bytes;
+        previousRtt = rtt;
+
+        bool allStarted = stats.running + stats.failed + stats.closed >= options.clients;
+        if (measureStartMs == 0.0 && allStarted) {
+            measureStartMs = now;
+            measureSent = sent;
+            measureReceived = received;
+            measureBytes = bytes;
+            measureRtt = rtt;
+        }
+        if (measureStartMs > 0.0 && now - measureStartMs >= options.durationSeconds * 1000.0) {
+            break;
+        }
+    }
+
+    g_stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double now = bench::nowMs();
+    if (measureStartMs == 0.0) {
+        measureStartMs = startMs;
+    }
+    double seconds = std::max((now - measureStartMs) / 1000.0, 1e-3);
+    HistogramSnapshot rtt = Difference(stats.rtt.snapshot(), measureRtt);
+    HistogramSnapshot connect = stats.connectTime.snapshot();
+
+    std::printf("\n== summary (%.1fs measured after ramp-up) ==\n", seconds);
+    std::printf("clients:     %d running, %d failed, %d closed by server\n",
+                stats.running.load(), stats.failed.load(), stats.closed.load());
+    std::printf("connect:     p50 %.2fms  p99 %.2fms  max %.2fms  (connect -> auth_success)\n",
+                Ms(connect.percentile(0.5)), Ms(connect.percentile(0.99)), Ms(static_cast<double>(connect.max)));
+    std::printf("round trip:  p50 %.3fms  p99 %.3fms  p999 %.3fms  max %.3fms  (%llu samples)\n",
+                Ms(rtt.percentile(0.5)), Ms(rtt.percentile(0.99)), Ms(rtt.percentile(0.999)),
+                Ms(static_cast<double>(rtt.max)), static_cast<unsigned long long>(rtt.count));
+    std::printf("client->srv: %.0f msg/s\n", (stats.sentMessages.value() - measureSent) / seconds);
+    std::printf("srv->client: %.0f msg/s, %.2f MB/s, %llu snapshots\n",
+                (stats.receivedMessages.value() - measureReceived) / seconds,
+                (stats.receivedBytes.value() - measureBytes) / seconds / 1e6,
+                static_cast<unsigned long long>(stats.snapshots.value()));
+    return stats.running > 0 ? 0 : 1;
+}
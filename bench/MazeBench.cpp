@@ -0,0 +1,59 @@
+// 迷宫生成吞吐量测试
+// 用法: maze_bench [线程数] [种子]
+// 对每个尺寸分别以单线程和多线程生成，输出耗时、每秒生成的单元格数，并校验两者结果一致
+#include "MazeGenerator.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace {
+
+struct BenchSize {
+    int width, height, layers;
+    int repeats;
+};
+
+double GenerateMs(MazeGenerator& generator, uint64_t seed, int threads, int repeats) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        generator.generateMaze(seed + i, threads);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count() / repeats;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int threads = argc > 1 ? std::atoi(argv[1]) : 0;
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 12345;
+
+    const BenchSize sizes[] = {
+        {50, 50, 7, 50},
+        {128, 128, 8, 10},
+        {256, 256, 16, 3},
+        {512, 512, 32, 1},
+    };
+
+    std::printf("%-14s %12s %12s %14s %8s\n", "size", "1 thread ms", "N thread ms", "Mcells/s (N)", "same");
+    for (const BenchSize& size : sizes) {
+        MazeGenerator serial(size.width, size.height, size.layers);
+        MazeGenerator parallel(size.width, size.height, size.layers);
+
+        double serialMs = GenerateMs(serial, seed, 1, size.repeats);
+        double parallelMs = GenerateMs(parallel, seed, threads, size.repeats);
+        bool same = serial.getGrid() == parallel.getGrid();
+
+        double cells = static_cast<double>(size.width) * size.height * size.layers;
+        char label[32];
+        std::snprintf(label, sizeof(label), "%dx%dx%d", size.width, size.height, size.layers);
+        std::printf("%-14s %12.2f %12.2f %14.1f %8s\n", label, serialMs, parallelMs,
+                    cells / (parallelMs * 1000.0), same ? "yes" : "NO");
+    }
+    std::printf("threads: %d, seed: %llu\n", threads, static_cast<unsigned long long>(seed));
+    return 0;
+}
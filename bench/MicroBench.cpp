@@ -0,0 +1,431 @@
+// 服务器热路径的微基准
+// 用法: bench [名称过滤]（-h 显示用法）
+// 每项先校准迭代次数，再运行约200ms，输出每次操作的平均耗时；给出过滤串时只运行名称包含该串的项
+#include "BenchUtil.h"
+#include "WebSocketFrame.h"
+#include "BinaryProtocol.h"
+#include "MazeGenerator.h"
+#include "MazeChunks.h"
+#include "GameLogic.h"
+#include "InterestManager.h"
+#include "DataManager.h"
+#include "PlayerManager.h"
+#include "Logger.h"
+#include "Metrics.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 防止编译器把结果优化掉
+volatile uint64_t g_sink = 0;
+
+std::string g_filter;
+
+// 运行 body(iterations)，返回每次迭代的纳秒数
+double TimeIterations(const std::function<void(size_t)>& body, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    body(iterations);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+// body(n) 执行 n 次被测操作；bytesPerOp 为每次操作处理的字节数（用于输出吞吐量）
+// 返回该项是否运行（被过滤掉时为false），依赖 body 结果的检查只在运行后进行
+bool Run(const std::string& name, const std::function<void(size_t)>& body, double bytesPerOp = 0.0) {
+    if (!g_filter.empty() && name.find(g_filter) == std::string::npos) {
+        return false;
+    }
+
+    // 校准：迭代次数翻倍直到单轮超过20ms，再按比例放大到约200ms
+    size_t iterations = 1;
+    double nsPerOp = 0.0;
+    while (true) {
+        nsPerOp = TimeIterations(body, iterations);
+        if (nsPerOp * iterations >= 20e6 || iterations >= (1u << 30)) {
+            break;
+        }
+        iterations *= 2;
+    }
+    iterations = std::max<size_t>(1, static_cast<size_t>(200e6 / std::max(nsPerOp, 1.0)));
+    nsPerOp = TimeIterations(body, iterations);
+
+    if (bytesPerOp > 0.0) {
+        std::printf("%-36s %14.1f ns/op %12zu ops %10.1f MB/s\n", name.c_str(), nsPerOp, iterations,
+                    bytesPerOp / nsPerOp * 1e3);
+    } else {
+        std::printf("%-36s %14.1f ns/op %12zu ops\n", name.c_str(), nsPerOp, iterations);
+    }
+    std::fflush(stdout);
+    return true;
+}
+
+std::string Payload(size_t length) {
+    std::string payload(length, 'x');
+    for (size_t i = 0; i < length; ++i) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+    return payload;
+}
+
+void BenchFrames() {
+    for (size_t length : {16, 128, 1024, 16384}) {
+        std::string payload = Payload(length);
+        Run("frame/encode_text/" + std::to_string(length), [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                SharedFrame frame = PreparedFrame::text(payload);
+                g_sink += frame->size();
+            }
+        }, static_cast<double>(length));
+    }
+
+    // 一批客户端帧写入缓冲区后一次解析（模拟一次recv读到多帧）
+    for (size_t length : {16, 128, 1024, 16384}) {
+        std::string payload = Payload(length);
+        std::string wire;
+        const size_t framesPerBatch = 32;
+        for (size_t i = 0; i < framesPerBatch; ++i) {
+            bench::appendMaskedFrame(wire, 0x1, payload, 0x12345678u + static_cast<uint32_t>(i));
+        }
+        WebSocketFrameParser parser;
+        WebSocketMessageBatch messages;
+        Run("frame/parse_masked/" + std::to_string(length), [&](size_t n) {
+            for (size_t i = 0; i < n; i += framesPerBatch) {
+                parser.buffer().append(reinterpret_cast<const uint8_t*>(wire.data()), wire.size());
+                messages.clear();
+                parser.parse(messages);
+                g_sink += messages.size();
+            }
+        }, static_cast<double>(length));
+    }
+
+    std::vector<uint8_t> data(16384);
+    const uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    Run("frame/unmask/16384", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            unmaskWebSocketPayload(data.data(), data.size(), mask);
+        }
+        g_sink += data[0];
+    }, static_cast<double>(data.size()));
+}
+
+void BenchMaze() {
+    MazeGenerator generator(50, 50, 7);
+    uint64_t seed = 1;
+    Run("maze/generate/50x50x7/1thread", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            generator.generateMaze(seed++, 1);
+        }
+        g_sink += generator.getCoinCount();
+    });
+    Run("maze/generate/50x50x7/Nthreads", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            generator.generateMaze(seed++, 0);
+        }
+        g_sink += generator.getCoinCount();
+    });
+
+    // 迷宫分块：房间创建时编码一次，客户端每层解码一次
+    generator.generateMaze(42, 1);
+    const MazeGrid& grid = generator.getGrid();
+    MazeChunkSet chunks;
+    bool encoded = Run("maze/encode_chunks/50x50x7", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            encodeMazeChunks(grid, chunks);
+        }
+        g_sink += chunks.totalBytes();
+    }, static_cast<double>(grid.getCellCount()));
+
+    // 解码项使用编码项的结果，过滤掉编码项时先编码一次
+    if (!encoded) {
+        encodeMazeChunks(grid, chunks);
+    }
+    MazeGrid decoded(grid.getWidth(), grid.getHeight(), grid.getLayers());
+    bool decodedRan = Run("maze/decode_chunks/50x50x7", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            for (const std::string& chunk : chunks.chunks) {
+                g_sink += decodeMazeChunk(reinterpret_cast<const uint8_t*>(chunk.data()), chunk.size(), decoded);
+            }
+        }
+    }, static_cast<double>(grid.getCellCount()));
+    if (decodedRan && !(decoded == grid)) {
+        std::printf("maze/decode_chunks: decoded maze differs from encoded maze\n");
+    }
+    if (encoded || decodedRan) {
+        std::printf("maze/chunks: %d layers, %zu bytes (%d cells)\n",
+                    chunks.layers, chunks.totalBytes(), static_cast<int>(grid.getCellCount()));
+    }
+}
+
+void BenchGameLogic() {
+    MazeGenerator generator(50, 50, 7);
+    generator.generateMaze(42, 1);
+
+    for (int playerCount : {10, 100, 1000}) {
+        GameLogic logic;
+        logic.Initialize(generator.getGrid());
+        for (int id = 1; id <= playerCount; ++id) {
+            logic.AddPlayer(id, logic.GetStartPosition());
+        }
+
+        // 每个tick所有玩家各有一条输入，方向轮换
+        uint8_t directions[] = {INPUT_FORWARD, INPUT_LEFT, INPUT_BACKWARD, INPUT_RIGHT};
+        size_t tick = 0;
+        Run("game/update/" + std::to_string(playerCount) + "players", [&](size_t n) {
+            for (size_t i = 0; i < n; ++i, ++tick) {
+                for (int id = 1; id <= playerCount; ++id) {
+                    float rotation = static_cast<float>((tick + id) % 628) / 100.0f;
+                    logic.QueueInput(id, directions[(tick / 8 + id) & 3], &rotation);
+                }
+                logic.Update();
+            }
+        });
+
+        // 每帧的快照写入复用的对象（与房间线程的做法相同）
+        if (playerCount == 1000) {
+            WorldSnapshot snapshot;
+            uint32_t snapshotTick = 0;
+            Run("game/capture_snapshot/" + std::to_string(playerCount) + "players", [&](size_t n) {
+                for (size_t i = 0; i < n; ++i) {
+                    logic.CaptureSnapshot(snapshotTick++, snapshot);
+                    g_sink += snapshot.players.size();
+                }
+            });
+        }
+    }
+
+    // CheckCollision 是私有的，通过 IsValidPosition 测量（两者只差一次取反）
+    GameLogic logic;
+    logic.Initialize(generator.getGrid());
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> horizontal(0.0f, 50.0f);
+    std::uniform_real_distribution<float> vertical(0.0f, 7.0f);
+    std::vector<float> points(3 * 4096);
+    for (size_t i = 0; i < points.size(); i += 3) {
+        points[i] = horizontal(rng);
+        points[i + 1] = vertical(rng);
+        points[i + 2] = horizontal(rng);
+    }
+    Run("game/collision_check", [&](size_t n) {
+        uint64_t valid = 0;
+        for (size_t i = 0; i < n; ++i) {
+            size_t p = (i & 4095) * 3;
+            valid += logic.IsValidPosition(points[p], points[p + 1], points[p + 2]);
+        }
+        g_sink += valid;
+    });
+
+    // 兴趣管理：玩家随机分布在各层，每次操作为所有观察者计算一遍相关集合（即每帧的开销）
+    const int viewerCount = 200;
+    const MazeGrid& grid = generator.getGrid();
+    for (int id = 1; id <= viewerCount; ++id) {
+        logic.AddPlayer(id, logic.GetStartPosition());
+        int x, y, layer;
+        do {
+            x = static_cast<int>(rng() % 50);
+            y = static_cast<int>(rng() % 50);
+            layer = static_cast<int>(rng() % 7);
+        } while (grid.isWall(x, y, layer));
+        logic.TeleportPlayer(id, static_cast<float>(x), static_cast<float>(layer), static_cast<float>(y));
+    }
+    InterestManager interest(logic);
+    std::vector<int> noPrevious;
+    std::vector<InterestManager::Entry> relevant;
+    Run("game/interest_set/" + std::to_string(viewerCount) + "viewers", [&](size_t n) {
+        uint64_t total = 0;
+        for (size_t i = 0; i < n; ++i) {
+            for (int id = 1; id <= viewerCount; ++id) {
+                PlayerView view = logic.GetPlayerView(id);
+                interest.ComputeRelevantSet(id, view.x(), view.y(), view.z(), noPrevious, relevant);
+                total += relevant.size();
+            }
+        }
+        g_sink += total;
+    });
+
+    // 一波重生：所有玩家各抽取一次重生点
+    Run("game/respawn_wave/" + std::to_string(viewerCount) + "players", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            for (int id = 1; id <= viewerCount; ++id) {
+                logic.RespawnPlayer(id);
+            }
+        }
+    });
+}
+
+void BenchDataManager() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "netlab_bench_data";
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+
+    DataManager dataManager;
+    if (!dataManager.Initialize(directory.string())) {
+        std::printf("data/*: skipped (cannot create %s)\n", directory.string().c_str());
+        return;
+    }
+
+    MazeGenerator generator(50, 50, 7);
+    generator.generateMaze(42, 1);
+    const MazeGrid& grid = generator.getGrid();
+    MazeGrid loaded;
+
+    // 加载项读取保存项写出的文件，过滤掉保存项时先写一次
+    if (!Run("data/save_maze/50x50x7", [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                g_sink += dataManager.SaveMazeData(grid, 42);
+            }
+        })) {
+        dataManager.SaveMazeData(grid, 42);
+    }
+    bool loadedRan = Run("data/load_maze/50x50x7", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t seed = 0;
+            g_sink += dataManager.LoadMazeData(loaded, &seed);
+        }
+    });
+    if (loadedRan && !(loaded == grid)) {
+        std::printf("data/load_maze: loaded maze differs from saved maze\n");
+    }
+
+    std::filesystem::remove_all(directory, error);
+}
+
+void BenchPlayers() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "netlab_bench_players";
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+
+    {
+        PlayerManager players;
+        if (!players.Initialize(directory.string())) {
+            std::printf("player/*: skipped (cannot create %s)\n", directory.string().c_str());
+            return;
+        }
+
+        // 10000个已注册玩家，其中1000个在线
+        auto mac = [](uint32_t id) {
+            char buffer[18];
+            std::snprintf(buffer, sizeof(buffer), "02:00:%02X:%02X:%02X:%02X",
+                          (id >> 24) & 0xFF, (id >> 16) & 0xFF, (id >> 8) & 0xFF, id & 0xFF);
+            return std::string(buffer);
+        };
+        std::vector<std::string> ids;
+        for (uint32_t i = 0; i < 10000; ++i) {
+            ids.push_back(players.RegisterPlayer(mac(i)));
+            if (i < 1000) {
+                players.LoginPlayer(ids.back());
+            }
+        }
+
+        // 重复认证：按MAC找到已有玩家，登录后登出
+        size_t next = 1000;
+        Run("player/reauth/10000players", [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                std::string id = players.RegisterPlayer(mac(static_cast<uint32_t>(next)));
+                g_sink += players.IsValidPlayerId(id) && players.LoginPlayer(id);
+                players.LogoutPlayer(id);
+                next = next + 1 < ids.size() ? next + 1 : 1000;
+            }
+        });
+        Run("player/online_snapshot/1000online", [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                g_sink += players.GetOnlineSnapshot()->size();
+            }
+        });
+    }
+
+    std::filesystem::remove_all(directory, error);
+}
+
+void BenchLogger(bool fileLogging) {
+    if (!fileLogging) {
+        std::printf("log/*: skipped (no log directory)\n");
+        return;
+    }
+    Logger& logger = Logger::getInstance();
+
+    // 低于日志级别的消息在调用方就被过滤
+    logger.setLogLevel(LogLevel::INFO);
+    Run("log/filtered_debug", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            LOG_DEBUG(LogCategory::SYSTEM, "filtered message");
+        }
+    });
+
+    // 入队到后台线程写文件；队列满时丢弃，这里测的是调用方的开销
+    std::string message = "player moved to (12, 3, 40) after input #12345";
+    Run("log/info_enqueue", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            logger.log(LogLevel::INFO, LogCategory::GAME, message);
+        }
+    });
+    logger.flush();
+    if (logger.getDroppedCount() > 0) {
+        std::printf("log/info_enqueue: %llu records dropped (queue full)\n",
+                    static_cast<unsigned long long>(logger.getDroppedCount()));
+    }
+}
+
+void BenchMetrics() {
+    MetricHistogram histogram;
+    std::mt19937_64 rng(3);
+    std::vector<uint64_t> values(4096);
+    for (uint64_t& value : values) {
+        value = rng() % 10000000;
+    }
+    Run("metrics/histogram_record", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            histogram.record(values[i & 4095]);
+        }
+    });
+
+    MetricCounter counter;
+    Run("metrics/counter_add", [&](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            counter.add();
+        }
+        g_sink += counter.value();
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        std::string arg = argv[1];
+        if (arg == "-h" || arg == "--help") {
+            std::printf("Usage: %s [name-filter]\n", argv[0]);
+            return 0;
+        }
+        if (argc > 2 || arg[0] == '-') {
+            std::fprintf(stderr, "Usage: %s [name-filter]\n", argv[0]);
+            return 1;
+        }
+        g_filter = arg;
+    }
+
+    // 被测模块会写日志：写到临时目录，不在当前目录下创建 Data/，也不输出到控制台
+    std::filesystem::path logDirectory = std::filesystem::temp_directory_path() / "netlab_bench_logs";
+    Logger& logger = Logger::getInstance();
+    logger.setConsoleOutput(false);
+    bool fileLogging = logger.initialize(logDirectory.string());
+    if (!fileLogging) {
+        logger.setFileOutput(false);
+    }
+
+    BenchFrames();
+    BenchMaze();
+    BenchGameLogic();
+    BenchDataManager();
+    BenchPlayers();
+    BenchLogger(fileLogging);
+    BenchMetrics();
+    return 0;
+}
@@ -0,0 +1,144 @@
+#ifndef BINARYPROTOCOL_H
+#define BINARYPROTOCOL_H
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <cstdint>
+#include <cstddef>
+
+// 高频消息（输入、心跳、快照）的二进制线格式，承载在WebSocket二进制帧中
+// 每条消息以2字节头开始：[u8 版本][u8 操作码]，之后是固定布局的小端字段
+// 认证时协商：客户端在auth中携带 binaryProtocol 版本号，服务器在auth_success中返回实际使用的协议
+// JSON文本帧始终可用，便于调试
+
+const uint8_t BINARY_PROTOCOL_VERSION = 1;
+const size_t BINARY_HEADER_SIZE = 2;
+
+// 客户端与服务器之间使用的消息格式
+enum class WireFormat {
+    JSON,
+    BINARY
+};
+
+// 操作码：0x01-0x7F 客户端到服务器，0x81-0xFF 服务器到客户端
+enum class BinaryOpcode : uint8_t {
+    INPUT = 0x01,          // u32 序号, u8 方向位, f32 朝向
+    PING = 0x02,           // f64 客户端时间戳(ms)
+    SNAPSHOT_ACK = 0x03,   // u32 tick
+
+    PONG = 0x81,           // f64 回显的时间戳
+    SNAPSHOT = 0x82,       // 快照增量，布局见 encodeSnapshotDelta
+    MAZE_CHUNK = 0x83      // 一层迷宫分块，布局见 MazeChunks.h
+};
+
+// 输入方向位，第i位对应 MoveDirection 的第i个值
+enum InputDirectionBits : uint8_t {
+    INPUT_FORWARD  = 1u << 0,
+    INPUT_BACKWARD = 1u << 1,
+    INPUT_LEFT     = 1u << 2,
+    INPUT_RIGHT    = 1u << 3,
+    INPUT_UP       = 1u << 4,
+    INPUT_DOWN     = 1u << 5
+};
+
+// 玩家增量中携带的字段
+enum PlayerDeltaFields : uint8_t {
+    DELTA_X      = 1u << 0,
+    DELTA_Y      = 1u << 1,
+    DELTA_Z      = 1u << 2,
+    DELTA_ROT    = 1u << 3,
+    DELTA_ALIVE  = 1u << 4,
+    DELTA_COINS  = 1u << 5,
+    DELTA_ALL    = 0x3F
+};
+
+// 输入消息
+struct InputMessage {
+    uint32_t sequence = 0;
+    uint8_t directions = 0;   // InputDirectionBits 组合
+    float rotation = 0.0f;
+};
+
+// 心跳消息
+struct PingMessage {
+    double timestamp = 0.0;
+};
+
+// 快照确认消息
+struct SnapshotAckMessage {
+    uint32_t tick = 0;
+};
+
+// 单个玩家相对基线的变化；坐标和朝向为1/1000量化后的整数
+struct PlayerDelta {
+    int32_t playerId = 0;
+    uint8_t fields = 0;       // PlayerDeltaFields 组合
+    int32_t x = 0, y = 0, z = 0;
+    int32_t rotation = 0;
+    bool isAlive = true;
+    int32_t coins = 0;
+};
+
+// 快照增量；baseline为0表示完整快照
+struct SnapshotDelta {
+    uint32_t tick = 0;
+    uint32_t baseline = 0;
+    std::vector<PlayerDelta> players;
+    std::vector<int32_t> removedPlayers;
+    std::vector<uint16_t> coinsCollected;
+    std::vector<uint16_t> coinsRestored;
+    std::vector<std::tuple<int, int, int>> wallsBroken;
+    std::vector<std::tuple<int, int, int>> wallsRepaired;
+
+    bool empty() const {
+        return players.empty() && removedPlayers.empty() && coinsCollected.empty() &&
+               coinsRestored.empty() && wallsBroken.empty() && wallsRepaired.empty();
+    }
+
+    // 清空内容，保留各数组的容量
+    void clear() {
+        tick = 0;
+        baseline = 0;
+        players.clear();
+        removedPlayers.clear();
+        coinsCollected.clear();
+        coinsRestored.clear();
+        wallsBroken.clear();
+        wallsRepaired.clear();
+    }
+};
+
+// 坐标量化
+inline int32_t quantizeCoordinate(float value) {
+    double scaled = static_cast<double>(value) * 1000.0;
+    return static_cast<int32_t>(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+}
+
+inline double dequantizeCoordinate(int32_t value) {
+    return static_cast<double>(value) / 1000.0;
+}
+
+// 读取消息头，版本不匹配或长度不足时返回false
+bool readBinaryHeader(const std::string& payload, BinaryOpcode& opcode);
+
+// 解码客户端消息（包含消息头），长度不符时返回false
+// 按消息结构重载，供 MessageRouter::onBinary<T> 使用
+bool decodeBinaryMessage(const std::string& payload, InputMessage& message);
+bool decodeBinaryMessage(const std::string& payload, PingMessage& message);
+bool decodeBinaryMessage(const std::string& payload, SnapshotAckMessage& message);
+
+// 编码服务器消息（包含消息头）
+std::string encodePongMessage(double timestamp);
+std::string encodeMazeChunkMessage(const std::string& chunk);
+
+// 快照布局：u32 tick, u32 baseline,
+//   u16 玩家数 × { i32 id, u8 字段位, [i32 x][i32 y][i32 z][i32 朝向][u8 存活][i32 金币] },
+//   u16 移除数 × i32 id, u16 × u16 已收集金币, u16 × u16 恢复的金币,
+//   u16 × (i16 x, i16 y, i16 z) 被破坏的墙, u16 × (i16 x, i16 y, i16 z) 已修复的墙
+std::string encodeSnapshotDelta(const SnapshotDelta& delta);
+
+// 编码到out（先清空），复用out的容量
+void encodeSnapshotDelta(const SnapshotDelta& delta, std::string& out);
+
+#endif // BINARYPROTOCOL_H
@@ -0,0 +1,55 @@
+#ifndef CELLSET_H
+#define CELLSET_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 单元格编号的集合（编号与 MazeGrid::indexOf 一致，或任意 [0, capacity) 内的编号）
+// 成员保存在稠密数组中，每个编号记录自己在数组中的位置：插入、删除（与最后一个交换）和均匀随机抽取都是O(1)
+// 用于出生点、金币和楼梯的选址，代替在整个网格上反复随机试探
+class CellSet {
+public:
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    CellSet() = default;
+
+    // 清空并设置编号范围
+    void reset(size_t capacity);
+    void clear();
+
+    // 返回集合是否变化；越界的编号被忽略
+    bool insert(size_t cell);
+    bool erase(size_t cell);
+    bool contains(size_t cell) const {
+        return cell < slots.size() && slots[cell] != NOT_MEMBER;
+    }
+
+    size_t size() const { return cells.size(); }
+    bool empty() const { return cells.empty(); }
+    size_t capacity() const { return slots.size(); }
+
+    // 均匀随机抽取一个成员，集合为空时返回NPOS；取模而不是分布对象，相同种子在各平台上结果相同
+    template <typename Rng>
+    size_t sample(Rng& rng) const {
+        return cells.empty() ? NPOS : cells[static_cast<size_t>(rng() % cells.size())];
+    }
+
+    // 抽取并移除一个成员
+    template <typename Rng>
+    size_t take(Rng& rng) {
+        size_t cell = sample(rng);
+        if (cell != NPOS) {
+            erase(cell);
+        }
+        return cell;
+    }
+
+private:
+    static constexpr uint32_t NOT_MEMBER = UINT32_MAX;
+
+    std::vector<uint32_t> cells;   // 成员（顺序不固定）
+    std::vector<uint32_t> slots;   // 编号 -> 在 cells 中的位置
+};
+
+#endif // CELLSET_H
@@ -0,0 +1,98 @@
+#ifndef CHATLOG_H
+#define CHATLOG_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <ctime>
+#include <cstdint>
+#include <cstddef>
+
+// 聊天记录：内存环形缓冲保存最近的消息，磁盘上按大小分段保存全部消息
+//
+//   chat_log.txt       当前段，后台线程批量追加
+//   chat_log.1.txt     上一段，chat_log.2.txt 更早，超过 maxSegments 的段被删除
+//
+// 每行格式 "[YYYY-MM-DD HH:MM:SS] [玩家名]: 消息"
+// append() 只格式化并放入缓冲，后台线程每 commitInterval 合并写入一次（组提交）
+// recent(n) 在 n 不超过环形缓冲容量时只复制内存中的行；更早的行从各段文件末尾反向读取，
+// 读取量只和 n 有关，与文件总大小无关
+class ChatLog {
+public:
+    ChatLog();
+    ~ChatLog();
+
+    ChatLog(const ChatLog&) = delete;
+    ChatLog& operator=(const ChatLog&) = delete;
+
+    // 打开 directory 下的聊天记录，从文件末尾恢复最近 historyCapacity 行到内存，然后启动后台线程
+    bool open(const std::string& directory, size_t historyCapacity,
+              uint64_t segmentBytes = 4 * 1024 * 1024, int maxSegments = 8);
+
+    // 写出缓冲中剩余的行并停止后台线程
+    void close();
+
+    bool isOpen() const { return running; }
+
+    // 追加一条消息（不等待I/O）
+    bool append(const std::string& playerName, const std::string& message);
+
+    // 最近的 maxLines 行，按时间顺序
+    std::vector<std::string> recent(size_t maxLines);
+
+    // 删除全部聊天记录
+    bool clear();
+
+    // 阻塞直到此前追加的行全部写入文件
+    void flush();
+
+    size_t getHistoryCapacity() const { return history.size(); }
+
+private:
+    void run();
+
+    // 把 pending 中的行写入当前段，需要时轮转（调用时持有 fileMutex）
+    bool commit(const std::string& text, uint64_t textGeneration);
+    void rotateSegments();
+
+    std::string segmentPath(int index) const;
+
+    // 从文件末尾反向读取最后 count 行，按时间顺序插入到 lines 前面
+    static size_t readTailLines(const std::string& path, size_t count, std::vector<std::string>& lines);
+
+    std::string directory;
+    uint64_t segmentBytes = 0;
+    int maxSegments = 0;
+    std::chrono::milliseconds commitInterval{200};
+
+    // 内存中的最近消息（环形缓冲）和待写入的文本
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable committed;
+    std::vector<std::string> history;
+    size_t historyHead = 0;     // 下一次写入的位置
+    size_t historyCount = 0;
+    std::string pending;
+    uint64_t appendedCount = 0;     // 已追加的行数
+    uint64_t committedCount = 0;    // 已写入文件的行数
+    uint64_t generation = 0;        // clear() 时递增，丢弃清空前取出但尚未写入的文本
+    bool flushRequested = false;
+    bool stopRequested = false;
+    bool running = false;
+    std::thread worker;
+
+    // 时间前缀缓存（同一秒内复用）
+    std::time_t cachedSecond = -1;
+    std::string cachedTimePrefix;
+
+    // 当前段文件，只有后台线程和持有 fileMutex 的调用者访问
+    std::mutex fileMutex;
+    std::ofstream segment;
+    uint64_t segmentSize = 0;
+};
+
+#endif // CHATLOG_H
@@ -8,6 +8,7 @@
 #include <memory>
 #include "GameLogic.h"
 #include "PlayerManager.h"
+#include "RoomManager.h"
 #include "Logger.h"
 
 // 命令执行结果
@@ -40,14 +41,39 @@ struct CommandInfo {
         : name(n), description(desc), usage(use), requiredLevel(level) {}
 };
 
+// 命令目标：接受玩家ID的命令（give、tp、kick、kill、coin）也接受选择器
+//   <playerId>    单个在线玩家
+//   @a            所有在线玩家
+//   @room:<id>    指定房间中的所有玩家
+//   @layer:<n>    当前位于第n层的所有玩家
+struct TargetSelector {
+    enum class Kind { PLAYER, ALL, ROOM, LAYER };
+    
+    Kind kind = Kind::PLAYER;
+    std::string playerId;   // PLAYER
+    int value = 0;          // ROOM 的房间编号或 LAYER 的层号
+    std::string text;       // 原始写法，用于结果消息
+};
+
+// 控制台命令
+// 修改游戏状态的命令编译为房间任务：同一房间的所有目标在一个任务中修改（在两帧之间一起生效），
+// 不同房间的任务并行执行；ExecuteCommand 只在控制台线程上调用
 class CommandSystem {
 public:
-    CommandSystem(GameLogic& gameLogic, PlayerManager& playerManager);
+    // 命令历史保留的条数
+    static const size_t MAX_HISTORY = 1000;
+    
+    CommandSystem(RoomManager& roomManager, PlayerManager& playerManager);
     ~CommandSystem();
 
     // 执行命令
     CommandResult ExecuteCommand(const std::string& command, const std::string& executorId = "");
     
+    // 执行脚本文件：每行一条命令，空行和 # 开头的行忽略
+    // 先检查所有行（命令存在、有权限、参数有效），全部通过后才执行：give/tp/kick/kill/coin 编译为房间操作，
+    // 整个脚本的操作在每个房间一个任务中按行顺序执行（在两帧之间一起生效）；其余命令随后按行顺序执行
+    CommandResult ExecuteScript(const std::string& path, const std::string& executorId = "");
+    
     // 检查权限
     bool CheckPermission(const std::string& playerId, AdminLevel requiredLevel) const;
     
@@ -60,11 +86,11 @@ public:
     // 获取管理员级别
     AdminLevel GetAdminLevel(const std::string& playerId) const;
     
-    // 获取命令历史
-    const std::vector<std::string>& GetCommandHistory() const { return commandHistory_; }
+    // 获取命令历史（从旧到新）
+    std::vector<std::string> GetCommandHistory() const;
     
     // 清除命令历史
-    void ClearCommandHistory() { commandHistory_.clear(); }
+    void ClearCommandHistory();
     
     // 获取所有命令信息（用于帮助系统）
     const std::vector<CommandInfo>& GetAllCommandsInfo() const { return commandsInfo_; }
@@ -73,6 +99,26 @@ private:
     // 命令处理函数类型
     using CommandHandler = std::function<CommandResult(const std::vector<std::string>&, const std::string&)>;
     
+    // 对单个玩家的游戏操作（在玩家所在房间的模拟线程上执行），返回是否成功
+    using PlayerAction = std::function<bool(GameLogic&, int clientId)>;
+    
+    // 编译后的玩家命令：在控制台线程上解析参数并确定目标，action 在目标所在房间的模拟线程上执行，
+    // finish 根据成功的玩家ID完成持久化等收尾工作并生成结果
+    struct CompiledCommand {
+        TargetSelector target;
+        PlayerAction action;
+        std::function<CommandResult(const std::vector<std::string>& affected)> finish;
+    };
+    
+    // 编译命令参数，参数无效时返回失败的结果
+    using CommandCompiler = std::function<CommandResult(const std::vector<std::string>&, CompiledCommand&)>;
+    
+    struct RegisteredCommand {
+        CommandHandler handler;
+        AdminLevel requiredLevel;
+        CommandCompiler compiler;   // 只有作用于玩家的命令有，脚本用它合并房间任务
+    };
+    
     // 注册所有命令
     void RegisterCommands();
     
@@ -81,43 +127,73 @@ private:
                         const std::string& description, const std::string& usage, 
                         AdminLevel requiredLevel = AdminLevel::NONE);
     
+    // 注册作用于玩家的命令（单独执行时编译后立即执行）
+    void RegisterPlayerCommand(const std::string& name, CommandCompiler compiler,
+                              const std::string& description, const std::string& usage,
+                              AdminLevel requiredLevel);
+    
     // 解析命令字符串
     std::vector<std::string> ParseCommand(const std::string& command);
     
+    // 查找命令并检查权限，失败时 error 为错误消息
+    const RegisteredCommand* ResolveCommand(const std::vector<std::string>& args, const std::string& executorId,
+                                            std::string& error) const;
+    
+    // 执行已解析的命令并记录日志
+    CommandResult Dispatch(const std::vector<std::string>& args, const std::string& command,
+                           const std::string& executorId);
+    
+    // 记录命令历史
+    void RecordHistory(const std::string& entry);
+    
     // 命令实现
-    CommandResult HandleGive(const std::vector<std::string>& args, const std::string& executorId);
-    CommandResult HandleTeleport(const std::vector<std::string>& args, const std::string& executorId);
-    CommandResult HandleKick(const std::vector<std::string>& args, const std::string& executorId);
-    CommandResult HandleKill(const std::vector<std::string>& args, const std::string& executorId);
+    CommandResult CompileGive(const std::vector<std::string>& args, CompiledCommand& out);
+    CommandResult CompileTeleport(const std::vector<std::string>& args, CompiledCommand& out);
+    CommandResult CompileKick(const std::vector<std::string>& args, CompiledCommand& out);
+    CommandResult CompileKill(const std::vector<std::string>& args, CompiledCommand& out);
     CommandResult HandleClear(const std::vector<std::string>& args, const std::string& executorId);
-    CommandResult HandleCoin(const std::vector<std::string>& args, const std::string& executorId);
+    CommandResult CompileCoin(const std::vector<std::string>& args, CompiledCommand& out);
     CommandResult HandleSystem(const std::vector<std::string>& args, const std::string& executorId);
     CommandResult HandleHelp(const std::vector<std::string>& args, const std::string& executorId);
     CommandResult HandleAdmin(const std::vector<std::string>& args, const std::string& executorId);
     CommandResult HandleListPlayers(const std::vector<std::string>& args, const std::string& executorId);
     CommandResult HandleRestart(const std::vector<std::string>& args, const std::string& executorId);
     CommandResult HandleWhoami(const std::vector<std::string>& args, const std::string& executorId);
+    CommandResult HandleScript(const std::vector<std::string>& args, const std::string& executorId);
     
     // 工具函数
     ItemType ParseItemType(const std::string& itemStr);
     std::string ItemTypeToString(ItemType item);
     bool ParsePosition(const std::vector<std::string>& args, int startIndex, float& x, float& y, float& z);
     bool IsValidPlayer(const std::string& playerId);
-    int ConvertPlayerIdToInt(const std::string& playerId);
+    
+    // 解析玩家ID或选择器；选择器格式错误或玩家不在线时返回false，error 为错误消息
+    bool ParseTarget(const std::string& text, TargetSelector& selector, std::string& error);
+    
+    // 列出选择器匹配的已认证玩家（LAYER 在房间线程上按位置过滤）
+    std::vector<RoomPlayer> SelectPlayers(const TargetSelector& selector) const;
+    
+    // 在目标所在的房间上执行已编译的命令并等待完成：所有命令在每个房间合并为一个任务按顺序执行，各房间并行执行；
+    // 返回每条命令操作成功的玩家ID
+    std::vector<std::vector<std::string>> ExecuteCompiled(const std::vector<const CompiledCommand*>& commands);
+    
+    // 结果消息中的目标描述："player <id>" 或 "N player(s) matching @a"
+    static std::string DescribeTargets(const TargetSelector& selector, size_t affected);
     std::string AdminLevelToString(AdminLevel level) const;
 
 private:
-    GameLogic& gameLogic_;
+    RoomManager& roomManager_;
     PlayerManager& playerManager_;
     
     // 命令映射
-    std::map<std::string, CommandHandler> commandHandlers_;
+    std::map<std::string, RegisteredCommand> commandHandlers_;
     
     // 命令信息
     std::vector<CommandInfo> commandsInfo_;
     
-    // 命令历史
+    // 命令历史（环形缓冲区，写满后覆盖最旧的条目）
     std::vector<std::string> commandHistory_;
+    size_t historyNext_ = 0;
     
     // 管理员列表
     std::map<std::string, AdminLevel> admins_;
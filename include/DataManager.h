@@ -7,12 +7,16 @@
 #include <memory>
 #include <fstream>
 #include <chrono>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 
+#include "ChatLog.h"
+
 // 前向声明
 struct PlayerData;
 class GameLogic;
 class MazeGenerator;
+class MazeGrid;
 
 using json = nlohmann::json;
 
@@ -31,20 +35,16 @@ public:
     bool LoadAllPlayersData(std::map<std::string, PlayerData>& players);
     
     // 迷宫数据管理
-    bool SaveMazeData(const std::vector<std::vector<std::vector<bool>>>& mazeLayout,
-                     const std::vector<std::tuple<int, int, int>>& coinPositions,
-                     const std::tuple<int, int, int>& startPos,
-                     const std::tuple<int, int, int>& endPos);
-    bool LoadMazeData(std::vector<std::vector<std::vector<bool>>>& mazeLayout,
-                     std::vector<std::tuple<int, int, int>>& coinPositions,
-                     std::tuple<int, int, int>& startPos,
-                     std::tuple<int, int, int>& endPos);
+    // 保存为二进制迷宫文件 maze_data.bin（格式见 MazeFile.h），起点、终点和金币以单元格类型保存在网格中
+    // 只有旧版 maze_data.json 时读取它并转换为二进制文件
+    bool SaveMazeData(const MazeGrid& maze, uint64_t seed = 0);
+    bool LoadMazeData(MazeGrid& maze, uint64_t* seed = nullptr);
     
     // 配置管理
     bool SaveConfig(const json& config);
     bool LoadConfig(json& config);
     
-    // 聊天日志管理
+    // 聊天日志管理（最近 max_chat_history 条保存在内存中，写入由后台线程批量完成）
     bool AppendChatLog(const std::string& playerName, const std::string& message);
     std::vector<std::string> GetChatLog(int maxLines = 100);
     bool ClearChatLog();
@@ -63,15 +63,8 @@ private:
     json PlayerDataToJson(const PlayerData& data);
     bool JsonToPlayerData(const json& j, PlayerData& data);
     
-    json MazeDataToJson(const std::vector<std::vector<std::vector<bool>>>& mazeLayout,
-                       const std::vector<std::tuple<int, int, int>>& coinPositions,
-                       const std::tuple<int, int, int>& startPos,
-                       const std::tuple<int, int, int>& endPos);
-    bool JsonToMazeData(const json& j, 
-                       std::vector<std::vector<std::vector<bool>>>& mazeLayout,
-                       std::vector<std::tuple<int, int, int>>& coinPositions,
-                       std::tuple<int, int, int>& startPos,
-                       std::tuple<int, int, int>& endPos);
+    // 旧版JSON迷宫数据，只用于迁移
+    bool JsonToMazeData(const json& j, MazeGrid& maze);
     
     // 文件操作
     bool WriteJsonToFile(const json& j, const std::string& filename);
@@ -82,7 +75,7 @@ private:
 
 private:
     std::string dataPath_;
-    std::ofstream chatLogStream_;
+    ChatLog chatLog_;
     
     // 默认配置
     json defaultConfig_ = {
@@ -0,0 +1,56 @@
+#ifndef EVENTPOLLER_H
+#define EVENTPOLLER_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+// 跨平台socket就绪事件轮询器
+// Linux: epoll（边缘触发） | BSD/macOS: kqueue（EV_CLEAR） | 其他平台: poll/WSAPoll（水平触发）
+// 调用方需要在收到事件后一直读/写到 EWOULDBLOCK，以同时兼容边缘触发和水平触发
+class EventPoller {
+public:
+    // 事件标志
+    enum : uint32_t {
+        EVENT_READ  = 1u << 0,
+        EVENT_WRITE = 1u << 1,
+        EVENT_ERROR = 1u << 2   // 对端挂断或socket错误（只在返回的事件中出现）
+    };
+
+    struct Event {
+        uint64_t token;   // 注册时传入的用户数据
+        uint32_t events;  // EVENT_* 组合
+    };
+
+    EventPoller();
+    ~EventPoller();
+
+    // 后端是否创建成功
+    bool isValid() const;
+
+    // 注册/修改/移除socket（socket句柄统一用intptr_t承载，兼容Windows的SOCKET类型）
+    bool add(intptr_t socket, uint32_t events, uint64_t token);
+    bool modify(intptr_t socket, uint32_t events, uint64_t token);
+    void remove(intptr_t socket);
+
+    // 等待事件，timeoutMs < 0 表示无限等待；返回事件数量，出错返回 -1
+    // 被 wakeup() 唤醒时可能返回 0
+    int wait(std::vector<Event>& events, int timeoutMs);
+
+    // 从任意线程唤醒正在 wait 的线程
+    void wakeup();
+
+    // 后端名称（用于日志）
+    const char* backendName() const;
+
+private:
+    // 禁止拷贝
+    EventPoller(const EventPoller&) = delete;
+    EventPoller& operator=(const EventPoller&) = delete;
+
+    // 内部实现
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+#endif // EVENTPOLLER_H
@@ -6,31 +6,55 @@
 #include <string>
 #include <chrono>
 #include <memory>
+#include <tuple>
+#include <cstdint>
+#include <random>
 
-// 道具类型枚举
-enum class ItemType {
-    SPEED_POTION = 0,  // 加速药水
-    COMPASS,           // 指南针
-    HAMMER,            // 锤子
-    KILL_SWORD,        // 秒人剑
-    SLOW_TRAP,         // 减速带
-    SWAP_ITEM,         // 大局逆转
-    COIN               // 金币（特殊道具）
-};
+#include "MazeGrid.h"
+#include "NavigationField.h"
+#include "SpatialIndex.h"
+#include "TimerWheel.h"
+#include "PlayerStore.h"
+#include "CellSet.h"
 
-// 玩家状态结构
+// 玩家状态结构（GetPlayerState 返回的副本，只读访问请用 GetPlayerView）
 struct PlayerState {
+    int playerId = 0;
+    float x = 0, y = 0, z = 0;  // 位置坐标
+    float rotation = 0;          // 旋转角度
+    bool isAlive = false;
+    bool hasCompass = false;
+    bool hasSpeedBoost = false;
+    std::chrono::steady_clock::time_point speedBoostEndTime;
+    int coins = 0;
+    Inventory inventory{};       // 道具库存，按 ItemType 下标
+    bool reachedGoal = false;
+    int finishRank = 0;          // 到达终点名次
+};
+
+// 玩家快照（只包含需要同步给客户端的字段）
+struct PlayerSnapshot {
     int playerId;
-    float x, y, z;      // 位置坐标
-    float rotation;      // 旋转角度
+    float x, y, z;
+    float rotation;
     bool isAlive;
-    bool hasCompass;
-    bool hasSpeedBoost;
-    std::chrono::steady_clock::time_point speedBoostEndTime;
     int coins;
-    std::map<ItemType, int> inventory;  // 道具库存
-    bool reachedGoal;
-    int finishRank;      // 到达终点名次
+};
+
+// 世界状态快照，每帧生成一份用于增量同步
+struct WorldSnapshot {
+    uint32_t tick = 0;
+    std::vector<PlayerSnapshot> players;                 // 按playerId升序
+    std::vector<bool> coinCollected;                     // 按金币ID索引
+    std::vector<std::tuple<int, int, int>> brokenWalls;  // 当前被破坏的墙壁，升序
+};
+
+// 指南针提示：朝终点前进一步的世界坐标方向（x、层、z 各为 -1/0/1）和剩余步数
+struct CompassHint {
+    int dx = 0;
+    int dy = 0;
+    int dz = 0;
+    int distance = -1;  // 已到达终点时为0
 };
 
 // 游戏配置
@@ -58,14 +82,23 @@ public:
     ~GameLogic();
 
     // 初始化游戏
-    bool Initialize(const std::vector<std::vector<std::vector<bool>>>& mazeLayout,
-                   const std::vector<std::tuple<int, int, int>>& coinPositions,
-                   const std::tuple<int, int, int>& startPos,
-                   const std::tuple<int, int, int>& endPos);
+    // 起点、终点和金币位置取自网格中的 START / END / COIN 单元格
+    bool Initialize(const MazeGrid& maze);
 
-    // 玩家移动
+    // 玩家移动（立即执行一步）
     bool MovePlayer(int playerId, MoveDirection direction);
     
+    // 把一次移动输入加入本帧队列，在下一次 Update 中按玩家批量结算
+    // directionBits 的第i位对应 MoveDirection(i)；rotation 为空时保持当前朝向
+    bool QueueInput(int playerId, uint8_t directionBits, const float* rotation = nullptr);
+    
+    // 每个玩家每帧最多结算的输入数量，多余的输入被丢弃
+    static constexpr int MAX_INPUTS_PER_TICK = 8;
+    // 玩家碰撞盒的半边长（格子边长为1）
+    static constexpr float PLAYER_HALF_EXTENT = 0.2f;
+    // 重生点抽到孤立区域时的最大重试次数
+    static constexpr int MAX_SPAWN_ATTEMPTS = 16;
+    
     // 购买道具
     bool PurchaseItem(int playerId, ItemType itemType);
     
@@ -79,9 +112,24 @@ public:
     // 检查玩家是否到达终点
     bool CheckPlayerReachedGoal(int playerId);
     
-    // 获取玩家状态
+    // 获取玩家状态（复制）
     PlayerState GetPlayerState(int playerId) const;
     
+    // 玩家的只读视图，不存在时返回无效视图
+    PlayerView GetPlayerView(int playerId) const;
+    
+    // 所有玩家的结构数组存储（只读，按稠密索引遍历）
+    const PlayerStore& GetPlayers() const { return players_; }
+    
+    // 设置玩家朝向（弧度）
+    bool SetPlayerRotation(int playerId, float rotation);
+    
+    // 生成当前帧的世界快照
+    WorldSnapshot CaptureSnapshot(uint32_t tick) const;
+    
+    // 写入已有的快照对象，复用其中各数组的容量
+    void CaptureSnapshot(uint32_t tick, WorldSnapshot& snapshot) const;
+    
     // 添加/移除玩家
     bool AddPlayer(int playerId, const std::tuple<int, int, int>& startPos);
     bool RemovePlayer(int playerId);
@@ -97,12 +145,30 @@ public:
     // 更新游戏逻辑（每帧调用）
     void Update();
     
-    // 获取迷宫布局
-    const std::vector<std::vector<std::vector<bool>>>& GetMazeLayout() const { return mazeLayout_; }
+    // 获取迷宫网格（墙壁位包含当前被破坏的墙壁）
+    const MazeGrid& GetMaze() const { return maze_; }
     
     // 获取金币位置
     const std::vector<std::tuple<int, int, int>>& GetCoinPositions() const { return coinPositions_; }
     
+    // 获取指南针提示（需要玩家已使用指南针），查询为O(1)
+    bool GetCompassHint(int playerId, CompassHint& hint) const;
+    
+    // 世界坐标到终点的最短步数，不可达时返回-1
+    int GetDistanceToGoal(float x, float y, float z) const;
+    
+    // 世界坐标 pos 同层周围 radius 格内的玩家（按编号升序）
+    std::vector<int> GetPlayersNear(const std::tuple<int, int, int>& pos, int radius) const;
+    
+    // 距离 pos 最近的存活玩家，范围内没有时返回-1
+    int FindNearestPlayer(const std::tuple<int, int, int>& pos, int radius, int excludePlayerId = -1) const;
+    
+    // 获取玩家/金币的空间索引（单元格坐标：列=x，行=z，层=y）
+    const SpatialIndex& GetSpatialIndex() const { return spatial_; }
+    
+    // 获取到终点的距离场（所有玩家共享）
+    const NavigationField& GetGoalField() const { return goalField_; }
+    
     // 获取起点和终点
     std::tuple<int, int, int> GetStartPosition() const { return startPosition_; }
     std::tuple<int, int, int> GetEndPosition() const { return endPosition_; }
@@ -134,6 +200,30 @@ private:
     // 碰撞检测
     bool CheckCollision(float x, float y, float z) const;
     
+    // 结算队列中的移动输入
+    void ProcessInputQueue();
+    
+    // 按方向位累加一步位移（使用缓存的朝向正余弦）
+    void AccumulateMove(size_t index, uint8_t directionBits, float& dx, float& dy, float& dz) const;
+    
+    // 扫掠碰撞：沿x、z轴依次移动碰撞盒，逐格检查经过的单元格，撞墙时停在墙前；返回是否移动
+    bool ResolveMove(size_t index, float dx, float dy, float dz);
+    
+    // 碰撞盒在 (x, z) 处是否与该层的墙壁重叠
+    bool BoxHitsWall(float x, float z, int layer) const;
+    
+    // 沿单轴扫掠，返回该轴的新坐标
+    float SweepAxis(float position, float delta, float across, int layer, bool alongX) const;
+    
+    // 玩家（稠密索引）位置变化后更新空间索引，进入新格子时自动拾取金币
+    void UpdatePlayerCell(size_t index);
+    
+    // 按收集状态把金币登记到空间索引
+    void PlaceCoinsInIndex();
+    
+    // 设置世界坐标 (x, 层, z) 处的墙壁位
+    bool SetWall(const std::tuple<int, int, int>& pos, bool wall);
+    
     // 道具效果实现
     void ApplySpeedPotion(int playerId);
     void ApplyCompass(int playerId);
@@ -145,16 +235,36 @@ private:
     // 计算金币奖励
     int CalculateCoinReward(int rank) const;
     
-    // 检查速度提升是否过期
-    void CheckSpeedBoostExpiry(int playerId);
+    // 在delay之后的模拟帧中执行callback
+    TimerWheel::TimerId ScheduleAfter(std::chrono::milliseconds delay, TimerWheel::Callback callback);
+    
+    // 取消并清除玩家身上的定时事件
+    void CancelPlayerTimers(int playerId);
     
-    // 寻找随机重生点
-    std::tuple<int, int, int> FindRandomSpawnPoint() const;
+    // 寻找随机重生点：从非墙格子中抽取，最多尝试 MAX_SPAWN_ATTEMPTS 次，失败时回到起点
+    std::tuple<int, int, int> FindRandomSpawnPoint();
 
 private:
     GameConfig config_;
-    std::map<int, PlayerState> players_;
-    std::vector<std::vector<std::vector<bool>>> mazeLayout_;
+    PlayerStore players_;
+    
+    // 本帧排队的移动输入
+    struct QueuedInput {
+        PlayerStore::Handle handle;
+        uint8_t directionBits;
+        bool hasRotation;
+        float rotation;
+    };
+    std::vector<QueuedInput> inputQueue_;
+    
+    // 批量结算时的每玩家累加位移（按稠密索引，复用内存）
+    std::vector<float> pendingDx_, pendingDy_, pendingDz_;
+    std::vector<uint8_t> pendingCount_;
+    MazeGrid maze_;
+    NavigationField goalField_;  // 到终点的距离场，墙壁变化时增量更新
+    CellSet walkable_;           // 非墙格子（MazeGrid编号），重生点的候选
+    std::mt19937_64 rng_;
+    SpatialIndex spatial_;       // 玩家、金币和减速带的格子索引
     std::vector<std::tuple<int, int, int>> coinPositions_;
     std::vector<bool> coinCollected_;
     std::tuple<int, int, int> startPosition_;
@@ -165,8 +275,19 @@ private:
     int finishedPlayersCount_ = 0;
     int nextFinishRank_ = 1;
     
-    // 减速带位置和效果
-    std::vector<std::tuple<int, int, int, std::chrono::steady_clock::time_point>> slowTraps_;
+    // 定时事件：加速结束、减速带消失、墙壁恢复、延迟重生，在 Update 中触发
+    TimerWheel timers_;
+    
+    // 玩家身上待触发的定时事件，玩家离开或重置时取消
+    struct PlayerTimers {
+        TimerWheel::TimerId speedBoost = TimerWheel::INVALID_TIMER;
+        TimerWheel::TimerId respawn = TimerWheel::INVALID_TIMER;
+    };
+    std::map<int, PlayerTimers> playerTimers_;
+    
+    // 减速带位置，按放置编号索引，消失时由定时事件删除
+    std::map<int, std::tuple<int, int, int>> slowTraps_;
+    int nextTrapId_ = 0;
     
     // 被破坏的墙壁（临时）
     std::vector<std::tuple<int, int, int>> brokenWalls_;
@@ -0,0 +1,124 @@
+#ifndef GAMEMESSAGEHANDLERS_H
+#define GAMEMESSAGEHANDLERS_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <nlohmann/json.hpp>
+
+#include "GameLogic.h"
+#include "BinaryProtocol.h"
+#include "MazeChunks.h"
+#include "WebSocketFrame.h"
+
+class PlayerManager;
+class DataManager;
+class NetworkManager;
+class SnapshotReplicator;
+class TickScheduler;
+class MessageRouter;
+
+// 客户端协议处理：把网络消息桥接到 GameLogic / PlayerManager
+// 所有处理函数都在模拟线程上执行；GameLogic中的玩家编号直接使用clientId
+// 每个房间一个实例，广播只发给本实例的会话（同一房间的玩家）
+class GameMessageHandlers {
+public:
+    // 会话加入（认证成功）或离开时的通知：clientId, playerId, joined
+    typedef std::function<void(int clientId, const std::string& playerId, bool joined)> SessionListener;
+
+    GameMessageHandlers(GameLogic& gameLogic, PlayerManager& playerManager, DataManager& dataManager,
+                        NetworkManager& networkManager, SnapshotReplicator& snapshotReplicator,
+                        TickScheduler& tickScheduler);
+
+    // 向路由器注册所有消息处理函数
+    void RegisterRoutes(MessageRouter& router);
+
+    // 每帧调用：向持有指南针的玩家推送方向或剩余步数的变化
+    void SendCompassUpdates();
+
+    // 已认证的会话数量
+    size_t GetSessionCount() const { return sessions_.size(); }
+    
+    // 所属房间编号，随 auth_success 发给客户端
+    void SetRoomId(int roomId) { roomId_ = roomId; }
+    
+    // 迷宫分块：清单随 auth_success 发送，二进制协议的客户端认证后直接推送出生层及相邻层
+    void SetMazeChunks(std::shared_ptr<const MazeChunkSet> chunks);
+    
+    // 设置会话通知（在模拟线程上调用）
+    void SetSessionListener(SessionListener listener) { sessionListener_ = std::move(listener); }
+
+private:
+    // 已认证的客户端会话
+    struct ClientSession {
+        std::string playerId;
+        std::string playerName;
+        WireFormat wireFormat = WireFormat::JSON;
+        CompassHint lastCompass;   // 最近一次发送的指南针提示，distance为-1表示尚未发送
+    };
+
+    // 连接事件
+    void HandleConnection(int clientId, bool connected);
+
+    // JSON消息
+    void HandleAuth(int clientId, const nlohmann::json& message);
+    void HandleMove(int clientId, const nlohmann::json& data);
+    void HandleSnapshotAck(int clientId, const nlohmann::json& data);
+    void HandlePing(int clientId, const nlohmann::json& data);
+    void HandlePurchaseItem(int clientId, const nlohmann::json& data);
+    void HandleUseItem(int clientId, const nlohmann::json& data);
+    void HandleCollectCoin(int clientId, const nlohmann::json& data);
+    void HandleChatMessage(int clientId, const nlohmann::json& data);
+    void HandleChatHistory(int clientId, const nlohmann::json& data);
+
+    // 二进制消息
+    void HandleInput(int clientId, const InputMessage& input);
+    void HandleBinaryPing(int clientId, const PingMessage& ping);
+    void HandleBinarySnapshotAck(int clientId, const SnapshotAckMessage& ack);
+
+    // 应用移动输入：directionBits第i位对应MoveDirection的第i个值
+    void ApplyPlayerInput(int clientId, uint8_t directionBits, const float* rotation);
+
+    // 发送给本实例的所有会话，excludeClientId为0表示不排除任何客户端；消息只编码一次
+    void BroadcastToSessions(const std::string& message, int excludeClientId = 0);
+
+    // 发送错误码（客户端按code显示提示）
+    void SendError(int clientId, const std::string& code, const std::string& message = "");
+
+    // 发送金币和道具库存
+    void SendGameState(int clientId);
+
+    // 迷宫分块清单，pushedLayers为随后通过WebSocket推送的层
+    nlohmann::json MazeManifestToJson(const std::vector<int>& pushedLayers) const;
+
+    // 查找会话，未认证时返回nullptr
+    const ClientSession* FindSession(int clientId) const;
+
+    // 按playerId查找clientId，不存在时返回-1
+    int FindClientByPlayerId(const std::string& playerId) const;
+
+    // 道具库存转为客户端使用的键名
+    nlohmann::json InventoryToJson(const PlayerView& player) const;
+
+
+    // 解析道具类型（网络协议名称），无效时返回false
+    static bool ParseItemType(const std::string& name, ItemType& itemType);
+
+private:
+    GameLogic& gameLogic_;
+    PlayerManager& playerManager_;
+    DataManager& dataManager_;
+    NetworkManager& networkManager_;
+    SnapshotReplicator& snapshotReplicator_;
+    TickScheduler& tickScheduler_;
+
+    std::map<int, ClientSession> sessions_;
+    int roomId_ = 0;
+    SessionListener sessionListener_;
+    std::shared_ptr<const MazeChunkSet> mazeChunks_;
+    std::vector<SharedFrame> mazeChunkFrames_;   // 按层预先编码的 MAZE_CHUNK 帧，所有会话共享
+};
+
+#endif // GAMEMESSAGEHANDLERS_H
@@ -0,0 +1,56 @@
+#ifndef INTERESTMANAGER_H
+#define INTERESTMANAGER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "GameLogic.h"
+
+// 兴趣范围配置（单位：格，切比雪夫距离）
+struct InterestConfig {
+    bool enabled = true;
+    int nearRadius = 6;         // 同层该范围内：全速同步
+    int sightRadius = 16;       // 同层该范围内且视线不被墙壁遮挡：全速同步
+    int farRadius = 12;         // 同层该范围内（被遮挡）或相邻层 nearRadius 内：降频同步
+    int reducedInterval = 4;    // 降频同步的玩家每隔多少帧更新一次
+    int hysteresis = 2;         // 已可见的玩家半径放宽的格数，避免在边界上反复出现/消失
+};
+
+// 观察者对一个玩家的关注程度
+enum class Interest : uint8_t {
+    NONE = 0,      // 不同步（客户端收到 removed）
+    REDUCED,       // 每 reducedInterval 帧更新一次
+    FULL           // 每帧更新
+};
+
+// 兴趣管理：根据空间索引和迷宫墙壁计算每个客户端需要同步的玩家集合
+// 只在房间线程上使用，查询读取 GameLogic 当前帧的状态（与本帧快照一致）
+class InterestManager {
+public:
+    struct Entry {
+        int playerId;
+        Interest interest;
+    };
+
+    InterestManager(const GameLogic& gameLogic, const InterestConfig& config = InterestConfig());
+
+    bool IsEnabled() const { return config_.enabled; }
+    const InterestConfig& GetConfig() const { return config_; }
+
+    // 计算观察者（世界坐标 x, y, z）的相关玩家，结果按 playerId 升序，不包含 NONE
+    // wasVisible 为上一次发送给该观察者的玩家（升序），用于边界滞后
+    void ComputeRelevantSet(int viewerId, float x, float y, float z,
+                            const std::vector<int>& wasVisible, std::vector<Entry>& result) const;
+
+    // 降频同步的玩家本帧是否更新（按玩家错开，避免所有降频玩家集中在同一帧）
+    bool IsReducedTick(int playerId, uint32_t tick) const;
+
+    // 同层两格之间的视线是否被墙壁遮挡（格子连线经过的所有格子都不是墙）
+    bool HasLineOfSight(int x0, int y0, int x1, int y1, int layer) const;
+
+private:
+    const GameLogic& gameLogic_;
+    InterestConfig config_;
+};
+
+#endif // INTERESTMANAGER_H
@@ -11,6 +11,11 @@
 #include <map>
 #include <vector>
 #include <filesystem>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <condition_variable>
+#include <cstdint>
 
 // 日志级别枚举
 enum class LogLevel {
@@ -31,6 +36,23 @@ enum class LogCategory {
     WEB
 };
 
+// 日志宏：级别被过滤时不计算消息参数（字符串拼接、to_string 等）
+#define LOG_AT(level, category, message) \
+    do { \
+        Logger& logger_ = Logger::getInstance(); \
+        if (logger_.isEnabled(level)) { \
+            logger_.log(level, category, message); \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(category, message) LOG_AT(LogLevel::DEBUG, category, message)
+#define LOG_INFO(category, message) LOG_AT(LogLevel::INFO, category, message)
+#define LOG_WARNING(category, message) LOG_AT(LogLevel::WARNING, category, message)
+#define LOG_ERROR(category, message) LOG_AT(LogLevel::ERROR, category, message)
+
+// 异步日志：调用线程只把记录写入无锁环形队列（多生产者单消费者），不做格式化和I/O
+// 后台写线程批量取出记录，使用缓存的时间和日期格式化后一次性写入文件和控制台
+// 队列满时丢弃新记录并计数，不阻塞调用线程
 class Logger {
 public:
     static Logger& getInstance();
@@ -47,9 +69,27 @@ public:
     // 设置是否输出到文件
     void setFileOutput(bool enabled);
     
+    // 指定级别的日志是否会被记录
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= currentLevel_.load(std::memory_order_relaxed);
+    }
+    
     // 记录日志
     void log(LogLevel level, LogCategory category, const std::string& message);
     
+    // 等待此前提交的日志全部写出
+    void flush();
+    
+    // 因队列满被丢弃的日志条数
+    uint64_t getDroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+    
+    // 已提交但写线程尚未写出的日志条数
+    size_t getQueueDepth() const {
+        size_t written = writtenPos_.load(std::memory_order_acquire);
+        size_t enqueued = enqueuePos_.load(std::memory_order_relaxed);
+        return enqueued > written ? enqueued - written : 0;
+    }
+    
     // 便捷日志方法
     void debug(LogCategory category, const std::string& message);
     void info(LogCategory category, const std::string& message);
@@ -82,11 +122,30 @@ private:
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
     
-    // 输出到控制台（带颜色）
-    void outputToConsole(LogLevel level, const std::string& message);
+    // 队列中的一条记录；sequence 用于生产者和写线程之间的交接
+    struct Record {
+        std::atomic<size_t> sequence{0};
+        LogLevel level = LogLevel::INFO;
+        LogCategory category = LogCategory::SYSTEM;
+        int64_t timeMs = 0;
+        std::string message;
+    };
     
-    // 获取当前时间字符串
-    std::string getCurrentTimeString() const;
+    static constexpr size_t QUEUE_CAPACITY = 16384;   // 2的幂
+    
+    bool tryPush(LogLevel level, LogCategory category, int64_t timeMs, const std::string& message);
+    
+    // 后台写线程
+    void writerLoop();
+    
+    // 取出并写出队列中的一批记录，返回条数
+    size_t drainBatch();
+    
+    // 格式化一条日志（不含换行），时间前缀按秒缓存
+    void formatRecord(const Record& record, std::string& out);
+    
+    // 输出到控制台（带颜色），由写线程调用，批末统一 flush
+    void outputToConsole(LogLevel level, const std::string& message);
     
     // 获取当前日期字符串（用于日志文件命名）
     std::string getCurrentDateString() const;
@@ -100,21 +159,45 @@ private:
     // 确保日志目录存在
     bool ensureLogDirectory() const;
     
-    // 轮转日志文件（按日期）
-    void rotateLogFileIfNeeded();
+    // 轮转日志文件（按日期），dateString 为 YYYYMMDD，调用时需持有 mutex_
+    void rotateLogFileIfNeeded(const std::string& dateString);
     
-    // 写入日志到文件
-    void writeToFile(const std::string& logMessage);
+    // 写入日志到文件（调用时需持有 mutex_）
+    void writeToFile(const std::string& text);
 
 private:
     std::ofstream logFile_;
-    std::mutex mutex_;
+    mutable std::mutex mutex_;      // 保护日志文件和目录，只有写线程和配置函数使用
     
-    LogLevel currentLevel_;
-    bool consoleOutput_;
-    bool fileOutput_;
+    std::atomic<int> currentLevel_;
+    std::atomic<bool> consoleOutput_;
+    std::atomic<bool> fileOutput_;
     std::string logDirectory_;
     std::string currentLogFile_;
+    std::string currentLogDate_;
+    
+    // 无锁环形队列
+    std::unique_ptr<Record[]> queue_;
+    alignas(64) std::atomic<size_t> enqueuePos_{0};
+    alignas(64) size_t dequeuePos_ = 0;              // 只有写线程访问
+    std::atomic<size_t> writtenPos_{0};              // 已写出的记录数
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t reportedDropped_ = 0;
+    
+    // 写线程的唤醒和 flush() 的等待
+    std::mutex wakeMutex_;
+    std::condition_variable wakeup_;
+    std::condition_variable drained_;
+    std::atomic<bool> writerIdle_{false};
+    std::atomic<bool> stopping_{false};
+    std::thread writer_;
+    
+    // 写线程缓存的时间前缀（同一秒内复用）
+    int64_t cachedSecond_ = -1;
+    std::string cachedTimePrefix_;   // "YYYY-MM-DD HH:MM:SS"
+    std::string cachedDate_;         // "YYYYMMDD"
+    std::string fileBuffer_;
+    std::string lineBuffer_;
     
     // 日志级别到颜色的映射（控制台输出）
     std::map<LogLevel, std::string> levelColors_;
@@ -0,0 +1,61 @@
+#ifndef MAZECHUNKS_H
+#define MAZECHUNKS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "MazeGrid.h"
+
+// 下发给客户端的迷宫分块：每层一个二进制块，迷宫生成后编码一次，按内容哈希寻址，可被HTTP缓存长期保存
+// 单个块的布局（小端）：
+//
+//   [MazeChunkHeader 32字节]
+//   [墙壁位图 ceil(width*height/8) 字节]      第i位为层内单元格 i = y*width + x，1表示墙（按类型平面，不含被锤子破坏的墙）
+//   [特殊格表 specialCount 个 {u32 层内单元格编号, u8 CellType}]   非 WALL/PATH 的格子（楼梯、金币、起点、终点），升序
+//
+// 被破坏和修复的墙壁不修改分块，由快照增量的 wallsBroken / wallsRepaired 下发
+
+constexpr uint32_t MAZE_CHUNK_MAGIC = 0x434D4C4E;   // "NLMC"
+constexpr uint16_t MAZE_CHUNK_VERSION = 1;
+
+#pragma pack(push, 1)
+struct MazeChunkHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint64_t mazeHash;       // 整个迷宫（所有层）的内容哈希，同一迷宫的各层相同
+    uint16_t width;
+    uint16_t height;
+    uint16_t layers;
+    uint16_t layer;
+    uint32_t specialCount;
+    uint32_t reserved;       // 保留，写入0
+};
+#pragma pack(pop)
+
+static_assert(sizeof(MazeChunkHeader) == 32, "MazeChunkHeader must be 32 bytes");
+
+// 一个迷宫的全部分块
+struct MazeChunkSet {
+    uint64_t mazeHash = 0;
+    int width = 0;
+    int height = 0;
+    int layers = 0;
+    std::vector<std::string> chunks;   // 按层编号
+
+    bool empty() const { return chunks.empty(); }
+
+    // 第layer层的URL路径："/maze/<16位十六进制哈希>/<layer>.bin"
+    std::string chunkPath(int layer) const;
+    size_t totalBytes() const;
+};
+
+// 按类型平面编码所有层；迷宫为空或尺寸超出 uint16 时返回false
+bool encodeMazeChunks(const MazeGrid& maze, MazeChunkSet& chunks);
+
+// 解码一个块到maze的对应层（maze需已是相同尺寸），校验头部和长度；失败时maze保持不变
+bool decodeMazeChunk(const uint8_t* data, size_t size, MazeGrid& maze);
+
+#endif // MAZECHUNKS_H
@@ -0,0 +1,61 @@
+#ifndef MAZEFILE_H
+#define MAZEFILE_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "MazeGrid.h"
+
+// 二进制迷宫文件（maze_data.bin），小端字节序
+//
+//   [MazeFileHeader 72字节]
+//   [墙壁位平面 wallWords 个 uint64]                 与 MazeGrid 的墙壁位平面逐字相同
+//   [楼梯表 stairCount 个 uint32]                    下层 STAIR_DOWN 的单元格编号，上层 STAIR_UP 为 +layerStride
+//   [金币表 coinCount 个 uint32]                     COIN 单元格编号，升序
+//
+// 类型字节平面不保存：非墙壁格为 PATH，再按楼梯表、金币表和头部的起点终点恢复
+// checksum 为载荷（头部之后的全部字节）的 FNV-1a 64 位哈希
+
+constexpr uint32_t MAZE_FILE_MAGIC = 0x5A4D4C4E;   // "NLMZ"
+constexpr uint16_t MAZE_FILE_VERSION = 1;
+
+#pragma pack(push, 1)
+struct MazeFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    int32_t width;
+    int32_t height;
+    int32_t layers;
+    uint32_t stairCount;
+    uint32_t coinCount;
+    int32_t start[3];      // 网格坐标 (x, y, layer)，没有起点时为 -1
+    int32_t end[3];
+    uint32_t reserved;     // 保留，写入0
+    uint64_t seed;
+    uint64_t checksum;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(MazeFileHeader) == 72, "MazeFileHeader must be 72 bytes");
+
+// 文件附带的信息
+struct MazeFileInfo {
+    uint64_t seed = 0;
+    uint16_t version = 0;
+    size_t fileSize = 0;
+};
+
+// 写入迷宫文件（先写临时文件再重命名，不会留下半个文件）
+bool saveMazeFile(const std::string& path, const MazeGrid& maze, uint64_t seed = 0);
+
+// 内存映射读取迷宫文件，校验头部、尺寸和校验和后直接填充网格；失败时maze保持不变
+bool loadMazeFile(const std::string& path, MazeGrid& maze, MazeFileInfo* info = nullptr);
+
+// 从内存中的完整文件内容解析（loadMazeFile 映射文件后调用）
+bool parseMazeFile(const uint8_t* data, size_t size, MazeGrid& maze, MazeFileInfo* info = nullptr);
+
+uint64_t mazeFileChecksum(const uint8_t* data, size_t size);
+
+#endif // MAZEFILE_H
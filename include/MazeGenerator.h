@@ -4,43 +4,25 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <random>
 
-enum class CellType {
-    WALL = 0,
-    PATH = 1,
-    STAIR_UP = 2,
-    STAIR_DOWN = 3,
-    COIN = 4,
-    START = 5,
-    END = 6
-};
-
-enum class Direction {
-    NORTH = 0,
-    EAST = 1,
-    SOUTH = 2,
-    WEST = 3,
-    UP = 4,
-    DOWN = 5
-};
-
-struct Position {
-    int x, y, z;
-    Position(int x = 0, int y = 0, int z = 0) : x(x), y(y), z(z) {}
-    bool operator==(const Position& other) const {
-        return x == other.x && y == other.y && z == other.z;
-    }
-};
+#include "MazeGrid.h"
+#include "CellSet.h"
 
 class MazeGenerator {
 public:
     MazeGenerator(int width = 50, int height = 50, int layers = 7);
     ~MazeGenerator();
 
-    // 生成迷宫
+    // 生成迷宫（随机种子）
     void generateMaze();
     
-    // 序列化/反序列化
+    // 按种子生成：尺寸和种子相同时结果总是相同，与线程数无关
+    // 每层使用由种子派生的独立随机数流并行生成；threadCount为0时使用硬件线程数
+    void generateMaze(uint64_t seed, int threadCount = 0);
+    uint64_t getSeed() const { return seed; }
+    
+    // 序列化/反序列化（二进制迷宫文件，格式见 MazeFile.h）
     bool saveToFile(const std::string& filename);
     bool loadFromFile(const std::string& filename);
     
@@ -56,25 +38,36 @@ public:
     int getWidth() const { return width; }
     int getHeight() const { return height; }
     int getLayers() const { return layers; }
+    
+    // 获取迷宫网格
+    const MazeGrid& getGrid() const { return maze; }
 
 private:
     int width, height, layers;
-    std::vector<std::vector<std::vector<CellType>>> maze;
+    MazeGrid maze;
     Position startPosition;
     Position endPosition;
     int coinCount;
+    uint64_t seed;
+    std::mt19937_64 rng;    // 楼梯、起点和金币使用的随机数流
     
-    // 迷宫生成算法
-    void initializeMaze();
-    void recursiveDivision(int minX, int maxX, int minY, int maxY, int layer, bool horizontal);
+    // 由种子和流编号派生互不相关的随机数流
+    static std::mt19937_64 makeStream(uint64_t seed, uint64_t stream);
+    
+    // 迷宫生成算法：单层在 width*height 的字节缓冲区中生成，不访问共享状态
+    void generateLayer(std::vector<uint8_t>& cells, std::mt19937_64& layerRng) const;
+    void recursiveDivision(std::vector<uint8_t>& cells, std::mt19937_64& layerRng,
+                           int minX, int maxX, int minY, int maxY, bool horizontal) const;
     void addStairs();
     void placeStartAndEnd();
     void distributeCoins();
     
+    // 把 [firstLayer, lastLayer) 层中不在边界上的通路格子（MazeGrid 编号）放入集合
+    void addPathCells(CellSet& cells, int firstLayer, int lastLayer) const;
+    
     // 工具函数
     bool isValidPosition(int x, int y, int z) const;
     bool isBorder(int x, int y, int z) const;
-    int calculateDistance(const Position& a, const Position& b) const;
     Position findFarthestPosition(const Position& from) const;
 };
 
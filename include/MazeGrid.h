@@ -0,0 +1,142 @@
+#ifndef MAZEGRID_H
+#define MAZEGRID_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+enum class CellType {
+    WALL = 0,
+    PATH = 1,
+    STAIR_UP = 2,
+    STAIR_DOWN = 3,
+    COIN = 4,
+    START = 5,
+    END = 6
+};
+
+enum class Direction {
+    NORTH = 0,
+    EAST = 1,
+    SOUTH = 2,
+    WEST = 3,
+    UP = 4,
+    DOWN = 5
+};
+
+struct Position {
+    int x, y, z;
+    Position(int x = 0, int y = 0, int z = 0) : x(x), y(y), z(z) {}
+    bool operator==(const Position& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+// 扁平存储的三维迷宫网格，由 MazeGenerator、GameLogic 和 DataManager 共用
+// 坐标为 (x, y, layer)：x为列、y为行、layer为层；单元格编号 = (layer * height + y) * width + x
+// 一块连续内存中存放两个平面：
+//   墙壁位平面（每格1位）：碰撞检测的唯一依据，一次读取即可判断
+//   类型字节平面（每格1字节）：CellType，供生成、寻路和持久化使用
+// setCell 同步更新两个平面；setWall 只修改墙壁位（锤子临时破坏墙壁时类型保持不变）
+class MazeGrid {
+public:
+    MazeGrid();
+    MazeGrid(int width, int height, int layers, CellType fill = CellType::WALL);
+
+    // 重新分配并用fill填充所有单元格
+    void reset(int width, int height, int layers, CellType fill = CellType::WALL);
+    void fill(CellType type);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getLayers() const { return layers; }
+    size_t getCellCount() const { return cellCount; }
+    bool empty() const { return cellCount == 0; }
+
+    // 步长：相邻行、相邻层之间的单元格编号差
+    size_t getRowStride() const { return static_cast<size_t>(width); }
+    size_t getLayerStride() const { return layerStride; }
+
+    bool inBounds(int x, int y, int layer) const {
+        return static_cast<unsigned>(x) < static_cast<unsigned>(width) &&
+               static_cast<unsigned>(y) < static_cast<unsigned>(height) &&
+               static_cast<unsigned>(layer) < static_cast<unsigned>(layers);
+    }
+
+    size_t indexOf(int x, int y, int layer) const {
+        return static_cast<size_t>(layer) * layerStride + static_cast<size_t>(y) * width + x;
+    }
+
+    Position positionOf(size_t index) const {
+        return Position(static_cast<int>(index % width),
+                        static_cast<int>((index / width) % height),
+                        static_cast<int>(index / layerStride));
+    }
+
+    // 不检查边界的访问（调用者保证index有效）
+    bool wallAt(size_t index) const {
+        return (storage[index >> 6] >> (index & 63)) & 1u;
+    }
+    CellType cellAt(size_t index) const {
+        return static_cast<CellType>(cellBytes()[index]);
+    }
+    void setCellAt(size_t index, CellType type);
+    void setWallAt(size_t index, bool wall);
+
+    // 检查边界的访问：越界视为墙壁，写入越界时忽略并返回false
+    bool isWall(int x, int y, int layer) const {
+        return !inBounds(x, y, layer) || wallAt(indexOf(x, y, layer));
+    }
+    CellType getCell(int x, int y, int layer) const {
+        return inBounds(x, y, layer) ? cellAt(indexOf(x, y, layer)) : CellType::WALL;
+    }
+    bool setCell(int x, int y, int layer, CellType type);
+    bool setWall(int x, int y, int layer, bool wall);
+
+    // 按尺寸重新分配，并从 wallWords 个字的墙壁位平面恢复：墙壁位为1的格为 WALL，其余为 PATH
+    // words 不要求对齐（可以直接指向映射的文件内容）
+    void assignWalls(int width, int height, int layers, const void* words);
+
+    // 用 width*height 个 CellType 字节整体覆盖一层，墙壁位按类型重建；层号越界时返回false
+    bool assignLayer(int layer, const uint8_t* cells);
+
+    // layer 与 layer+1 之间在 (x, y) 处是否有楼梯相连
+    // 与 MazeGenerator::addStairs 一致：下层为 STAIR_DOWN，上层为 STAIR_UP，且两格都未被墙壁位阻挡
+    bool hasStairLink(int x, int y, int layer) const {
+        if (!inBounds(x, y, layer) || !inBounds(x, y, layer + 1)) {
+            return false;
+        }
+        size_t lower = indexOf(x, y, layer);
+        size_t upper = lower + layerStride;
+        return cellAt(lower) == CellType::STAIR_DOWN && cellAt(upper) == CellType::STAIR_UP &&
+               !wallAt(lower) && !wallAt(upper);
+    }
+
+    // 按单元格编号顺序查找指定类型的所有单元格
+    std::vector<Position> findCells(CellType type) const;
+
+    // 墙壁位为1的单元格数量
+    size_t countWalls() const;
+
+    // 原始平面，用于序列化
+    const uint8_t* cellData() const { return cellBytes(); }
+    const uint64_t* wallData() const { return storage.data(); }
+    size_t getWallWordCount() const { return wallWords; }
+
+    bool operator==(const MazeGrid& other) const;
+    bool operator!=(const MazeGrid& other) const { return !(*this == other); }
+
+private:
+    const uint8_t* cellBytes() const { return reinterpret_cast<const uint8_t*>(storage.data() + wallWords); }
+    uint8_t* cellBytes() { return reinterpret_cast<uint8_t*>(storage.data() + wallWords); }
+
+    int width, height, layers;
+    size_t cellCount;
+    size_t layerStride;
+    size_t wallWords;
+
+    // [墙壁位平面 wallWords 个64位字][类型字节平面 cellCount 字节，按8字节补齐]
+    std::vector<uint64_t> storage;
+};
+
+#endif // MAZEGRID_H
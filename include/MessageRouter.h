@@ -0,0 +1,67 @@
+#ifndef MESSAGEROUTER_H
+#define MESSAGEROUTER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "BinaryProtocol.h"
+
+// 表驱动的消息分发器
+// JSON消息按 type 字段的哈希（注册时预先计算）查表，二进制消息按操作码直接索引，分发代价与路由数量无关
+// 所有分发都在调用 dispatch* 的线程（模拟线程）上执行
+// 每条路由的消息数、错误数和处理耗时记入 MetricsRegistry（netlab_router_*），随 /api/metrics 和 system stats 导出
+class MessageRouter {
+public:
+    // data 为消息的 data 字段（客户端 sendMessage 格式），没有时为整个消息
+    typedef std::function<void(int clientId, const nlohmann::json& data)> JsonHandler;
+    typedef std::function<void(int clientId, bool connected)> ConnectionHandler;
+
+    MessageRouter();
+    ~MessageRouter();
+
+    // 注册JSON消息处理函数，type重复或哈希冲突时返回false
+    bool onJson(const std::string& type, JsonHandler handler);
+
+    // 注册二进制消息处理函数，T为固定布局的消息结构，需要有对应的 decodeBinaryMessage 重载
+    // 处理函数收到的是直接从载荷解码的结构，不经过中间拷贝
+    template <typename T>
+    bool onBinary(BinaryOpcode opcode, const std::string& name, std::function<void(int, const T&)> handler) {
+        return registerBinary(opcode, name, [handler](int clientId, const std::string& payload) {
+            T message;
+            if (!decodeBinaryMessage(payload, message)) {
+                return false;
+            }
+            handler(clientId, message);
+            return true;
+        });
+    }
+
+    // 连接建立/断开（NetworkManager投递的 CONNECT / DISCONNECT）
+    void onConnection(ConnectionHandler handler);
+
+    // 分发文本消息和二进制消息
+    void dispatchText(int clientId, const std::string& message);
+    void dispatchBinary(int clientId, const std::string& payload);
+
+    // 消息类型哈希（FNV-1a）
+    static uint32_t hashType(const char* data, size_t length);
+
+private:
+    // 返回false表示载荷解码失败
+    typedef std::function<bool(int clientId, const std::string& payload)> BinaryHandler;
+
+    bool registerBinary(BinaryOpcode opcode, const std::string& name, BinaryHandler handler);
+
+    // 禁止拷贝
+    MessageRouter(const MessageRouter&) = delete;
+    MessageRouter& operator=(const MessageRouter&) = delete;
+
+    // 内部实现
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+#endif // MESSAGEROUTER_H
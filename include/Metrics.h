@@ -0,0 +1,186 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// 运行时指标：计数器、仪表和延迟直方图
+// 热路径上的更新只是一次 relaxed 原子加法，写入按线程分片，避免多个I/O线程争用同一缓存行；
+// 读取（导出）时再把各分片合并
+
+// 分片数量；线程按首次使用的顺序轮流分配到分片上
+constexpr size_t METRIC_SHARD_COUNT = 8;
+
+// 当前线程使用的分片
+size_t metricShardIndex();
+
+// 单调递增的计数器
+class MetricCounter {
+public:
+    void add(uint64_t value = 1) {
+        slots[metricShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> value{0};
+    };
+    Slot slots[METRIC_SHARD_COUNT];
+};
+
+// 可增可减的瞬时值
+class MetricGauge {
+public:
+    void set(int64_t newValue) { current.store(newValue, std::memory_order_relaxed); }
+    void add(int64_t delta) { current.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return current.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> current{0};
+};
+
+// 直方图的合并结果
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    std::vector<uint64_t> buckets;
+
+    // 分位数（q 取 0~1），返回所在桶的中点，不超过最大值
+    double percentile(double q) const;
+    double mean() const { return count > 0 ? static_cast<double>(sum) / count : 0.0; }
+};
+
+// HDR风格的对数线性直方图，记录纳秒
+// 每个2的幂区间再均分为8个子桶，相对误差不超过12.5%；覆盖 0 ~ 2^41 ns（约36分钟），更大的值计入最后一桶
+class MetricHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr size_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr int MAX_MAGNITUDE = 40;
+    static constexpr size_t BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    MetricHistogram();
+
+    void record(uint64_t valueNs);
+
+    template <typename Duration>
+    void recordDuration(Duration duration) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+    }
+
+    HistogramSnapshot snapshot() const;
+
+    // 桶下标与桶的取值范围 [lower, upper)
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketLower(size_t index);
+    static uint64_t bucketUpper(size_t index);
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+        std::atomic<uint64_t> buckets[BUCKET_COUNT];
+    };
+    std::unique_ptr<Shard[]> shards;
+};
+
+// 作用域计时：析构时把经过的时间记入直方图
+class MetricTimer {
+public:
+    explicit MetricTimer(MetricHistogram& target)
+        : histogram(target), start(std::chrono::steady_clock::now()) {}
+    ~MetricTimer() { histogram.recordDuration(std::chrono::steady_clock::now() - start); }
+
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    MetricHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+// 指标注册表
+// 指标按名称注册一次，返回的引用在进程生命周期内有效，热路径上应缓存引用：
+//     static MetricCounter& sent = MetricsRegistry::getInstance().counter("netlab_ws_frames_sent_total", "...");
+// 名称可以带 Prometheus 标签，如 "netlab_http_requests_total{server=\"web\"}"
+class MetricsRegistry {
+public:
+    static MetricsRegistry& getInstance();
+
+    // 同名指标重复注册时返回已有的实例
+    MetricCounter& counter(const std::string& name, const std::string& help);
+    MetricGauge& gauge(const std::string& name, const std::string& help);
+    MetricHistogram& histogram(const std::string& name, const std::string& help);
+
+    // 导出时调用回调取值的仪表（用于已有的统计，如连接数、队列长度）；回调可能在任意线程上执行
+    void gaugeCallback(const std::string& name, const std::string& help, std::function<double()> callback);
+
+    // 导出时调用回调取值的计数器（已有的单调递增统计，如丢弃的日志记录数）；名称应以 _total 结尾
+    void counterCallback(const std::string& name, const std::string& help, std::function<uint64_t()> callback);
+
+    // Prometheus 文本格式（0.0.4）；直方图导出为 summary，单位为秒
+    std::string renderPrometheus();
+
+    // 便于在控制台阅读的摘要，计数器附带距上次调用的速率
+    std::string renderSummary();
+
+    // 进程启动以来的秒数
+    double getUptimeSeconds() const;
+
+private:
+    MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    enum class MetricType { COUNTER, GAUGE, HISTOGRAM, CALLBACK, COUNTER_CALLBACK };
+
+    struct Metric {
+        MetricType type;
+        std::string help;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::unique_ptr<MetricHistogram> histogram;
+        std::function<double()> callback;
+        std::function<uint64_t()> counterCallback;
+    };
+
+    // 导出时使用的副本：回调在注册表锁之外执行
+    struct MetricView {
+        std::string name;
+        MetricType type;
+        std::string help;
+        const MetricCounter* counter;
+        const MetricGauge* gauge;
+        const MetricHistogram* histogram;
+        std::function<double()> callback;
+        std::function<uint64_t()> counterCallback;
+    };
+
+    Metric& findOrCreate(const std::string& name, const std::string& help, MetricType type);
+    std::vector<MetricView> collect();
+
+    std::mutex mutex;
+    std::map<std::string, Metric> metrics;
+    std::chrono::steady_clock::time_point startTime;
+
+    // renderSummary 上次调用时的计数器值
+    std::mutex summaryMutex;
+    std::map<std::string, uint64_t> lastSummaryValues;
+    std::chrono::steady_clock::time_point lastSummaryTime;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,57 @@
+#ifndef NAVIGATIONFIELD_H
+#define NAVIGATIONFIELD_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "MazeGrid.h"
+
+// 多层迷宫的BFS距离场：记录每个单元格到目标单元格的最短步数
+// 邻接关系：同层上下左右四个未被墙壁位阻挡的格子，以及 MazeGrid::hasStairLink 连接的上下层
+// 一张距离场由所有玩家共享，查询下一步方向为O(1)；墙壁被破坏或恢复时增量更新，只重算受影响的区域
+class NavigationField {
+public:
+    static constexpr uint32_t UNREACHABLE = 0xFFFFFFFFu;
+
+    NavigationField();
+
+    // 以target为目标完整计算距离场
+    void build(const MazeGrid& maze, const Position& target);
+
+    // 单元格变为可通行（锤子破坏墙壁）后调用，maze为修改后的网格
+    void onCellOpened(const MazeGrid& maze, const Position& cell);
+
+    // 单元格变为不可通行（墙壁恢复）后调用，maze为修改后的网格
+    void onCellBlocked(const MazeGrid& maze, const Position& cell);
+
+    bool isBuilt() const { return !distances.empty(); }
+    const Position& getTarget() const { return target; }
+
+    // 到目标的步数，越界或不可达时返回UNREACHABLE
+    uint32_t distanceAt(int x, int y, int layer) const;
+
+    // 朝目标前进一步的方向，已在目标处或不可达时返回false
+    bool nextStep(const MazeGrid& maze, int x, int y, int layer, Direction& direction) const;
+
+    // 距离最远的可达单元格（只考虑指定类型，layer为-1时不限定层），没有可达单元格时返回false
+    bool findFarthest(const MazeGrid& maze, CellType type, int layer, Position& result) const;
+
+    // 最近一次更新重新计算的单元格数量（用于观察增量更新的代价）
+    size_t getLastUpdateCount() const { return lastUpdateCount; }
+
+    // 方向对应的坐标偏移
+    static void directionOffset(Direction direction, int& dx, int& dy, int& dlayer);
+
+private:
+    // 遍历index的可通行邻居，回调参数为邻居的单元格编号
+    template <typename Visitor>
+    void forEachNeighbor(const MazeGrid& maze, size_t index, Visitor visit) const;
+
+    Position target;
+    int width, height, layers;
+    std::vector<uint32_t> distances;
+    size_t lastUpdateCount;
+};
+
+#endif // NAVIGATIONFIELD_H
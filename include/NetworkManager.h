@@ -10,12 +10,28 @@
 #include <mutex>
 #include <vector>
 
+#include "WebSocketFrame.h"
+
+// 慢消费者策略：发送队列超过上限时的处理方式
+enum class SlowConsumerPolicy {
+    DROP_OLDEST,   // 丢弃最旧的可丢弃帧（状态更新），仍超限时断开
+    DISCONNECT     // 直接断开该客户端
+};
+
+// 所有连接发送队列的汇总
+struct SendQueueStats {
+    size_t totalBytes = 0;          // 排队的总字节数
+    size_t totalFrames = 0;         // 排队的总帧数
+    size_t maxBytes = 0;            // 单个连接的最大排队字节数
+    int blockedConnections = 0;     // 正在等待可写事件的连接数
+};
+
 class NetworkManager {
 public:
     static NetworkManager& getInstance();
     
-    // 初始化网络管理器
-    bool initialize(int port);
+    // 初始化网络管理器，ioThreads为I/O工作线程数（0表示按CPU核心数自动选择）
+    bool initialize(int port, int ioThreads = 0);
     
     // 启动服务器
     bool startServer();
@@ -26,20 +42,55 @@ public:
     // 发送消息给指定客户端
     void sendToClient(int clientId, const std::string& message);
     
-    // 广播消息给所有客户端
-    void broadcast(const std::string& message);
+    // 广播消息给所有客户端；droppable表示该消息可在队列拥塞时被丢弃（如状态更新）
+    void broadcast(const std::string& message, bool droppable = false);
     
     // 广播消息给除指定客户端外的所有客户端
-    void broadcastExcept(int excludeClientId, const std::string& message);
+    void broadcastExcept(int excludeClientId, const std::string& message, bool droppable = false);
+    
+    // 发送预先编码的帧（不拷贝，帧由所有发送队列共享），客户端不存在或帧被拒绝时返回false
+    bool sendPrepared(int clientId, const SharedFrame& frame);
+    
+    // 广播预先编码的帧，excludeClientId为0表示不排除任何客户端；返回入队的客户端数
+    int broadcastPrepared(const SharedFrame& frame, int excludeClientId = 0);
+    
+    // 设置每个客户端发送队列的上限（字节数和帧数）
+    void setSendQueueLimits(size_t maxBytes, size_t maxFrames);
+    
+    // 设置慢消费者策略
+    void setSlowConsumerPolicy(SlowConsumerPolicy policy);
     
     // 获取连接客户端数量
     int getConnectedClientsCount() const;
     
+    // 汇总所有连接的发送队列（逐个连接加锁遍历，用于监控）
+    SendQueueStats getSendQueueStats() const;
+    
+    // 等待模拟线程处理的入站消息数
+    size_t getIncomingQueueSize() const;
+    
+    // 获取I/O工作线程数量
+    int getIoThreadCount() const;
+    
     // 断开指定客户端
     void disconnectClient(int clientId);
     
-    // 设置消息回调函数
+    // 设置消息回调函数（回调只在调用processIncomingMessages的线程上执行）
     void setMessageCallback(std::function<void(int, const std::string&)> callback);
+    
+    // 设置二进制消息回调（BINARY_FRAME的载荷；未设置时丢弃二进制消息）
+    void setBinaryMessageCallback(std::function<void(int, const std::string&)> callback);
+    
+    // 设置入站消息处理函数：设置后入站消息（包括"DISCONNECT"通知）在I/O线程上直接交给handler，
+    // 不再进入processIncomingMessages的队列；handler需要线程安全且不能阻塞。必须在startServer之前设置
+    // handler 取走 payload 后可以把一个空的字符串（保留已分配的容量）留在 payload 中，I/O线程用它接收下一条消息
+    void setIncomingMessageHandler(std::function<void(int clientId, std::string&& payload, bool binary)> handler);
+    
+    // 等待入站消息，超时返回false
+    bool waitForIncomingMessages(int timeoutMs);
+    
+    // 在模拟线程上分发所有排队的入站消息，返回处理的消息数
+    int processIncomingMessages();
 
 private:
     NetworkManager();
@@ -0,0 +1,102 @@
+#ifndef PLAYERJOURNAL_H
+#define PLAYERJOURNAL_H
+
+#include <string>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+// 玩家数据持久化结构
+struct PlayerData {
+    std::string playerId;
+    std::string macAddress;
+    std::string cookie;
+    int totalCoins;
+    int gamesPlayed;
+    int gamesWon;
+    std::chrono::system_clock::time_point lastLogin;
+    bool isOnline;
+};
+
+// 玩家数据的预写日志（WAL）持久化
+//
+//   players.json  快照 {"version":1,"seq":N,"players":[...]}，写入临时文件后重命名替换
+//   players.wal   追加日志，每行一条记录 "<校验和> {"seq":N,"player":{...}}"
+//
+// 日志记录是某个玩家修改后的完整数据，重放是幂等的；序号不大于快照 seq 的记录已在快照中
+// record() 只把数据放进待写表（同一玩家多次修改只保留最后一次），不做任何I/O
+// 后台线程定期把待写表追加到日志并 fsync，日志记录数超过阈值时在线程内压缩为新快照并清空日志
+// 启动时先读快照再重放日志，写了一半或校验失败的记录及其之后的内容被丢弃
+class PlayerJournal {
+public:
+    PlayerJournal();
+    ~PlayerJournal();
+
+    PlayerJournal(const PlayerJournal&) = delete;
+    PlayerJournal& operator=(const PlayerJournal&) = delete;
+
+    // 从 directory 中的快照和日志恢复全部玩家数据，然后启动后台线程
+    bool open(const std::string& directory, std::map<std::string, PlayerData>& players);
+
+    // 写出剩余记录、压缩为快照并停止后台线程
+    void close();
+
+    bool isOpen() const { return running; }
+
+    // 记录一个玩家的最新数据（只在锁内复制，不等待I/O），可以在任意线程调用
+    void record(const PlayerData& data);
+
+    // 阻塞直到此前的所有记录写入磁盘；compactSnapshot 为 true 时同时压缩为快照
+    bool flush(bool compactSnapshot = false);
+
+    void setFlushInterval(std::chrono::milliseconds interval) { flushInterval = interval; }
+    void setCompactThreshold(size_t records) { compactThreshold = records; }
+
+    size_t getJournalRecords() const { return journalRecords.load(); }
+    uint64_t getLastSequence() const { return sequence.load(); }
+
+private:
+    void run();
+
+    // 以下函数只在后台线程（或线程启动前、停止后）调用
+    bool appendRecords(const std::map<std::string, PlayerData>& batch);
+    bool compact();
+    bool readSnapshot(uint64_t& snapshotSequence);
+    void replayJournal(uint64_t snapshotSequence);
+    bool reopenJournal(bool truncate);
+
+    std::string snapshotPath;
+    std::string journalPath;
+    std::FILE* journal = nullptr;
+    uint64_t journalBytes = 0;    // 日志中完整记录的字节数，写入失败时截断回这里
+
+    // 已写入日志的完整玩家数据，压缩时写成快照
+    std::map<std::string, PlayerData> committed;
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<size_t> journalRecords{0};
+    bool snapshotStale = false;   // 快照需要重写（旧格式或日志有损坏）
+
+    std::chrono::milliseconds flushInterval{500};
+    size_t compactThreshold = 1024;
+
+    // 与调用线程共享的状态
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable flushed;
+    std::map<std::string, PlayerData> pending;
+    uint64_t flushRequested = 0;
+    uint64_t flushCompleted = 0;
+    bool compactRequested = false;
+    bool lastFlushOk = true;
+    std::atomic<bool> running{false};
+    bool stopRequested = false;
+    std::thread worker;
+};
+
+#endif // PLAYERJOURNAL_H
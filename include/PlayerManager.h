@@ -2,25 +2,27 @@
 #define PLAYERMANAGER_H
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <unordered_map>
+#include <deque>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <random>
 #include "GameLogic.h"
+#include "PlayerJournal.h"
 
-// 玩家数据持久化结构
-struct PlayerData {
-    std::string playerId;
-    std::string macAddress;
-    std::string cookie;
-    int totalCoins;
-    int gamesPlayed;
-    int gamesWon;
-    std::chrono::system_clock::time_point lastLogin;
-    bool isOnline;
-};
-
+// 所有公开方法都是线程安全的（各房间的模拟线程、I/O线程与控制台线程会同时调用）
+// 查询持有读锁，互不阻塞；只有注册、登录/登出和数据修改持有写锁，且都是O(1)的哈希表操作
+// 玩家计数是原子变量，在线玩家列表通过不可变快照读取，管理查询不会与认证相互阻塞
 class PlayerManager {
 public:
+    // 在线玩家的不可变快照：在线集合或在线玩家数据变化后的第一次读取时重建，之后的读取共享同一份
+    typedef std::shared_ptr<const std::vector<PlayerData>> OnlineSnapshot;
+
     PlayerManager();
     ~PlayerManager();
 
@@ -30,6 +32,16 @@ public:
     // 玩家身份识别和注册
     std::string RegisterPlayer(const std::string& macAddress, const std::string& cookie = "");
     
+    // 为没有MAC地址的客户端（浏览器）注册新玩家：标识为随机生成且不与已有玩家重复的MAC格式值，
+    // 同时生成随机令牌作为cookie写入token，客户端保存后在下次认证时用它找回玩家
+    std::string RegisterAnonymousPlayer(std::string& token);
+    
+    // 通过 RegisterAnonymousPlayer 下发的令牌查找玩家，其他格式的值（如旧版本以玩家名作为的cookie）不匹配
+    std::string FindPlayerByToken(const std::string& token) const;
+    
+    // 是否为下发的令牌格式："tk_" + 32位十六进制
+    static bool IsIssuedToken(const std::string& token);
+    
     // 玩家登录
     bool LoginPlayer(const std::string& playerId);
     
@@ -60,21 +72,46 @@ public:
     // 获取所有在线玩家
     std::vector<std::string> GetOnlinePlayers() const;
     
+    // 获取在线玩家及其数据（顺序不固定）
+    OnlineSnapshot GetOnlineSnapshot() const;
+    
     // 获取玩家总数
-    int GetPlayerCount() const { return players_.size(); }
+    int GetPlayerCount() const;
     
     // 获取在线玩家数量
-    int GetOnlinePlayerCount() const { return onlinePlayers_.size(); }
+    int GetOnlinePlayerCount() const;
     
-    // 保存所有玩家数据到文件
+    // 等待所有修改写入磁盘并压缩为快照（平时修改由后台线程增量写入日志）
     bool SaveAllPlayerData();
     
-    // 加载玩家数据从文件
+    // 从快照和日志重新加载玩家数据
     bool LoadAllPlayerData();
 
 private:
-    // 生成唯一玩家ID
-    std::string GeneratePlayerId() const;
+    // 玩家记录：在 players_ 中的下标即玩家句柄，记录只增不删，地址在整个生命周期内不变
+    struct PlayerEntry {
+        PlayerData data;
+        size_t onlineSlot;   // 在 onlinePlayers_ 中的位置，NOT_ONLINE 表示不在线
+    };
+    
+    static constexpr size_t NOT_ONLINE = static_cast<size_t>(-1);
+    static constexpr uint32_t NOT_FOUND = static_cast<uint32_t>(-1);
+    
+    // 以下函数的调用方需持有 mutex_（读锁或写锁）
+    uint32_t FindHandle(const std::string& playerId) const;
+    uint32_t FindPlayerLocked(const std::string& macAddress, const std::string& cookie) const;
+    
+    // 以下函数的调用方需持有写锁
+    uint32_t AddEntry(PlayerData data);
+    void IndexIdentifiers(uint32_t handle);
+    void SetOnline(uint32_t handle, bool online);
+    
+    // 生成未被使用的玩家ID（调用方需持有写锁）
+    std::string GeneratePlayerId();
+    
+    // 生成未被使用的匿名标识（本地管理的MAC地址格式）和令牌（调用方需持有写锁）
+    std::string GenerateAnonymousMac();
+    std::string GenerateToken();
     
     // 生成默认玩家数据
     PlayerData CreateDefaultPlayerData(const std::string& playerId, 
@@ -84,21 +121,40 @@ private:
     // 验证MAC地址格式
     bool ValidateMacAddress(const std::string& macAddress) const;
     
-    // 数据文件路径
-    std::string GetPlayerDataFilePath() const;
+    // 把玩家的当前数据交给日志线程（不阻塞，调用方需持有写锁）
+    void MarkDirty(uint32_t handle);
 
 private:
-    std::map<std::string, PlayerData> players_;
+    std::deque<PlayerEntry> players_;
     std::string dataPath_;
     
-    // MAC地址到玩家ID的映射
-    std::map<std::string, std::string> macToPlayerId_;
+    // 玩家ID到句柄的映射，键指向记录中的 playerId（记录地址不变，ID不会修改）
+    std::unordered_map<std::string_view, uint32_t> playerIndex_;
+    
+    // MAC地址、Cookie到句柄的映射
+    std::unordered_map<std::string, uint32_t> macIndex_;
+    std::unordered_map<std::string, uint32_t> cookieIndex_;
+    
+    // 在线玩家集合：记录保存自己在数组中的位置，加入和移除（与最后一个交换）都是O(1)
+    std::vector<uint32_t> onlinePlayers_;
+    
+    std::mt19937_64 idGenerator_;
+    
+    // 保护以上所有成员
+    mutable std::shared_mutex mutex_;
+    
+    // 无锁读取的计数
+    std::atomic<int> playerCount_{0};
+    std::atomic<int> onlineCount_{0};
     
-    // Cookie到玩家ID的映射
-    std::map<std::string, std::string> cookieToPlayerId_;
+    // 在线快照：onlineVersion_ 在写锁内随在线集合或在线玩家数据的变化递增
+    std::atomic<uint64_t> onlineVersion_{1};
+    mutable std::mutex snapshotMutex_;
+    mutable OnlineSnapshot onlineSnapshot_;
+    mutable uint64_t snapshotVersion_ = 0;
     
-    // 在线玩家列表
-    std::vector<std::string> onlinePlayers_;
+    // 增量持久化
+    PlayerJournal journal_;
 };
 
 #endif // PLAYERMANAGER_H
\ No newline at end of file
@@ -0,0 +1,160 @@
+#ifndef PLAYERSTORE_H
+#define PLAYERSTORE_H
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// 道具类型枚举
+enum class ItemType {
+    SPEED_POTION = 0,  // 加速药水
+    COMPASS,           // 指南针
+    HAMMER,            // 锤子
+    KILL_SWORD,        // 秒人剑
+    SLOW_TRAP,         // 减速带
+    SWAP_ITEM,         // 大局逆转
+    COIN               // 金币（特殊道具）
+};
+
+constexpr size_t ITEM_TYPE_COUNT = static_cast<size_t>(ItemType::COIN) + 1;
+
+// 道具库存，按 ItemType 下标
+typedef std::array<uint16_t, ITEM_TYPE_COUNT> Inventory;
+
+// 玩家状态位
+enum PlayerFlag : uint8_t {
+    PLAYER_ALIVE = 1 << 0,
+    PLAYER_HAS_COMPASS = 1 << 1,
+    PLAYER_SPEED_BOOST = 1 << 2,
+    PLAYER_REACHED_GOAL = 1 << 3
+};
+
+// 玩家数据的结构数组（SoA）存储：每个字段一个连续数组，下标为稠密索引 [0, size())
+// 删除时用末尾元素填补空位，所以稠密索引在增删之后会变化；需要长期持有时使用句柄
+// 句柄 = (代数 << 32) | 槽位，玩家删除后旧句柄失效
+class PlayerStore {
+public:
+    typedef uint64_t Handle;
+    static constexpr Handle INVALID_HANDLE = 0;
+    static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+    PlayerStore() = default;
+
+    // 添加玩家，已存在时返回 INVALID_HANDLE；新玩家的所有字段为零
+    Handle insert(int playerId);
+    bool erase(int playerId);
+    void clear();
+
+    size_t size() const { return ids.size(); }
+    bool empty() const { return ids.empty(); }
+
+    // playerId 或句柄对应的稠密索引，不存在时返回 NPOS
+    size_t indexOf(int playerId) const;
+    size_t indexOf(Handle handle) const;
+    Handle handleOf(int playerId) const;
+
+    // ========== 按稠密索引访问字段 ==========
+
+    int playerId(size_t i) const { return ids[i]; }
+
+    float& x(size_t i) { return xs[i]; }
+    float& y(size_t i) { return ys[i]; }
+    float& z(size_t i) { return zs[i]; }
+    int& coins(size_t i) { return coinCounts[i]; }
+    int& finishRank(size_t i) { return finishRanks[i]; }
+    Inventory& inventory(size_t i) { return inventories[i]; }
+    std::chrono::steady_clock::time_point& speedBoostEnd(size_t i) { return speedBoostEnds[i]; }
+
+    float x(size_t i) const { return xs[i]; }
+    float y(size_t i) const { return ys[i]; }
+    float z(size_t i) const { return zs[i]; }
+    float rotation(size_t i) const { return rotations[i]; }
+    float rotationSin(size_t i) const { return rotationSins[i]; }
+    float rotationCos(size_t i) const { return rotationCoses[i]; }
+    int coins(size_t i) const { return coinCounts[i]; }
+    int finishRank(size_t i) const { return finishRanks[i]; }
+    const Inventory& inventory(size_t i) const { return inventories[i]; }
+    std::chrono::steady_clock::time_point speedBoostEnd(size_t i) const { return speedBoostEnds[i]; }
+
+    // 设置朝向并缓存其正弦和余弦，移动时不必每次重新计算
+    void setRotation(size_t i, float rotation);
+
+    bool hasFlag(size_t i, PlayerFlag flag) const { return (flags[i] & flag) != 0; }
+    void setFlag(size_t i, PlayerFlag flag, bool value) {
+        flags[i] = value ? static_cast<uint8_t>(flags[i] | flag) : static_cast<uint8_t>(flags[i] & ~flag);
+    }
+
+    uint16_t itemCount(size_t i, ItemType itemType) const {
+        return inventories[i][static_cast<size_t>(itemType)];
+    }
+    uint16_t& itemCount(size_t i, ItemType itemType) {
+        return inventories[i][static_cast<size_t>(itemType)];
+    }
+
+    // ========== 整列只读访问（按稠密索引顺序，便于线性遍历） ==========
+
+    const std::vector<int>& getIds() const { return ids; }
+    const std::vector<float>& getX() const { return xs; }
+    const std::vector<float>& getY() const { return ys; }
+    const std::vector<float>& getZ() const { return zs; }
+    const std::vector<uint8_t>& getFlags() const { return flags; }
+
+private:
+    struct Slot {
+        uint32_t dense = 0;
+        uint32_t generation = 1;
+        bool used = false;
+    };
+
+    static Handle makeHandle(uint32_t slot, uint32_t generation) {
+        return (static_cast<Handle>(generation) << 32) | slot;
+    }
+
+    // 稠密数组（同一下标为同一玩家）
+    std::vector<int> ids;
+    std::vector<float> xs, ys, zs, rotations;
+    std::vector<float> rotationSins, rotationCoses;
+    std::vector<uint8_t> flags;
+    std::vector<int> coinCounts;
+    std::vector<int> finishRanks;
+    std::vector<Inventory> inventories;
+    std::vector<std::chrono::steady_clock::time_point> speedBoostEnds;
+    std::vector<uint32_t> slotOfDense;
+
+    // 槽位表和 playerId 索引
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<int, uint32_t> slotById;
+};
+
+// 单个玩家的只读视图，不复制数据；在下一次添加或删除玩家之前有效
+// 默认构造的视图无效，所有字段返回零值
+class PlayerView {
+public:
+    PlayerView() = default;
+    PlayerView(const PlayerStore* store, size_t index) : store(store), index(index) {}
+
+    bool valid() const { return store != nullptr; }
+
+    int playerId() const { return store ? store->playerId(index) : 0; }
+    float x() const { return store ? store->x(index) : 0.0f; }
+    float y() const { return store ? store->y(index) : 0.0f; }
+    float z() const { return store ? store->z(index) : 0.0f; }
+    float rotation() const { return store ? store->rotation(index) : 0.0f; }
+    int coins() const { return store ? store->coins(index) : 0; }
+    int finishRank() const { return store ? store->finishRank(index) : 0; }
+    bool isAlive() const { return store && store->hasFlag(index, PLAYER_ALIVE); }
+    bool hasCompass() const { return store && store->hasFlag(index, PLAYER_HAS_COMPASS); }
+    bool hasSpeedBoost() const { return store && store->hasFlag(index, PLAYER_SPEED_BOOST); }
+    bool reachedGoal() const { return store && store->hasFlag(index, PLAYER_REACHED_GOAL); }
+    int itemCount(ItemType itemType) const { return store ? store->itemCount(index, itemType) : 0; }
+
+private:
+    const PlayerStore* store = nullptr;
+    size_t index = 0;
+};
+
+#endif // PLAYERSTORE_H
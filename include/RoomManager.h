@@ -0,0 +1,315 @@
+#ifndef ROOMMANAGER_H
+#define ROOMMANAGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "MazeGrid.h"
+#include "GameLogic.h"
+#include "InterestManager.h"
+#include "TickScheduler.h"
+#include "SnapshotReplicator.h"
+#include "MessageRouter.h"
+#include "GameMessageHandlers.h"
+
+class PlayerManager;
+class DataManager;
+class NetworkManager;
+class RoomManager;
+
+// 房间与模拟线程池配置
+struct RoomConfig {
+    int simulationThreads = 0;            // 模拟线程数，0表示按可用CPU核心数
+    bool pinThreads = true;               // 把模拟线程绑定到CPU核心（仅Linux）
+    int roomCapacity = GameConfig().maxPlayers;
+    int maxRooms = 256;
+    int tickRate = 20;
+    int mazeWidth = 50;
+    int mazeHeight = 50;
+    int mazeLayers = 7;
+    bool hasMazeSeed = false;
+    uint64_t mazeSeed = 0;                // 新房间的迷宫种子为 mazeSeed + 房间编号（未指定时随机）
+    std::chrono::seconds idleTimeout{60}; // 没有连接的房间（默认房间除外）保留的时间
+    InterestConfig interest;              // 快照同步的兴趣范围
+};
+
+// 已认证玩家所在的房间
+struct RoomPlayer {
+    std::string playerId;
+    int roomId = 0;
+    int clientId = 0;
+};
+
+// 单个房间的统计
+struct RoomInfo {
+    int roomId = 0;
+    int members = 0;         // 已分配到房间的连接数
+    int sessions = 0;        // 已认证的玩家数
+    uint64_t mazeSeed = 0;
+    int tickRate = 0;
+    TickMetrics tick;
+};
+
+// 所有房间的汇总
+struct RoomManagerStats {
+    int rooms = 0;
+    int members = 0;
+    int sessions = 0;
+    size_t queuedMessages = 0;   // 等待模拟线程处理的入站消息
+    double avgTickMs = 0.0;      // 各房间平均帧耗时的平均值
+    double maxTickMs = 0.0;
+    uint64_t overruns = 0;
+    uint64_t skippedTicks = 0;
+    uint64_t runs = 0;           // 房间被调度运行的次数
+    uint64_t steals = 0;         // 其中从其他线程的队列窃取的次数
+};
+
+// 一局独立的游戏：迷宫、GameLogic、帧调度、快照同步和协议处理
+// 除入站队列外，房间状态只在运行它的模拟线程上访问；RoomManager 保证同一时刻最多一个线程在运行某个房间
+class Room {
+public:
+    typedef std::function<void(Room&)> Task;
+
+    Room(int roomId, uint64_t mazeSeed, const RoomConfig& config,
+         PlayerManager& playerManager, DataManager& dataManager, NetworkManager& networkManager);
+    ~Room();
+
+    // 加载迷宫并注册协议处理函数
+    bool Initialize(const MazeGrid& maze);
+
+    int GetRoomId() const { return roomId_; }
+    uint64_t GetMazeSeed() const { return mazeSeed_; }
+    int GetCapacity() const { return capacity_; }
+
+    // 迷宫分块（Initialize 后不再改变，可从任意线程读取）
+    const std::shared_ptr<const MazeChunkSet>& GetMazeChunks() const { return mazeChunks_; }
+
+    // 以下访问器只能在房间线程上使用（Task 内）
+    GameLogic& GetGameLogic() { return gameLogic_; }
+    TickScheduler& GetTickScheduler() { return tickScheduler_; }
+
+    // 可从任意线程读取
+    int GetMemberCount() const { return members_.load(std::memory_order_relaxed); }
+    int GetSessionCount() const { return sessionCount_.load(std::memory_order_relaxed); }
+    TickMetrics GetTickMetrics() const { return tickScheduler_.getMetrics(); }
+    int GetTickRate() const { return tickScheduler_.getTickRate(); }
+    size_t GetQueuedMessageCount() const { return queuedMessages_.load(std::memory_order_relaxed); }
+
+private:
+    friend class RoomManager;
+
+    // 调度状态：保证房间只在一个队列中、只被一个线程运行，运行中收到的新消息不会丢失
+    enum RunState : int {
+        IDLE = 0,        // 不在任何队列中
+        QUEUED,          // 在某个工作线程的就绪队列中
+        RUNNING,         // 正在运行
+        RUNNING_DIRTY    // 正在运行，期间又有新消息或任务，运行结束后需要再次入队
+    };
+
+    struct Message {
+        int clientId;
+        bool binary;
+        std::string payload;
+    };
+
+    // 已处理消息的载荷缓冲区最多回收的数量和容量，超出的直接释放
+    static constexpr size_t MAX_SPARE_BUFFERS = 256;
+    static constexpr size_t MAX_SPARE_CAPACITY = 4096;
+
+    // 入队（任意线程）；有回收的缓冲区时换给调用方，用于接收下一条消息
+    void PushMessage(int clientId, std::string&& payload, bool binary);
+    void PushTask(Task task);
+
+    // 处理所有排队的消息和任务，到期时推进一帧；返回本次是否执行了帧，nextTick为下一帧的计划时间
+    bool Run(TickScheduler::Clock::time_point& nextTick);
+
+    // 执行剩余的任务（房间关闭或线程池停止后在调用线程上执行，保证等待任务的调用方不会一直阻塞）
+    void DrainTasks();
+
+    void Tick(uint32_t tick);
+
+    const int roomId_;
+    const uint64_t mazeSeed_;
+    const int capacity_;
+    NetworkManager& networkManager_;
+
+    GameLogic gameLogic_;
+    InterestManager interestManager_;
+    TickScheduler tickScheduler_;
+    SnapshotReplicator snapshotReplicator_;
+    MessageRouter messageRouter_;
+    GameMessageHandlers handlers_;
+    std::shared_ptr<const MazeChunkSet> mazeChunks_;
+    bool ticked_ = false;
+
+    // 入站队列
+    std::mutex inboxMutex_;
+    std::vector<Message> inbox_;
+    std::vector<Task> tasks_;
+    std::vector<Message> processing_;   // 与 inbox_ 交换，复用容量
+    std::vector<Task> runningTasks_;    // 与 tasks_ 交换，复用容量
+    std::vector<std::string> spareBuffers_;   // 回收的空载荷（保留容量），由 inboxMutex_ 保护
+    std::vector<std::string> recycled_;       // 本次运行处理完的载荷，下次交换队列时放回 spareBuffers_
+
+    std::atomic<int> runState_{IDLE};
+    std::atomic<int> homeWorker_{0};     // 最近运行该房间的线程，新消息投递到它的队列
+    std::atomic<int> members_{0};        // 由 RoomManager 在分配/断开时修改（持有其写锁）
+    std::atomic<int> sessionCount_{0};
+    std::atomic<size_t> queuedMessages_{0};
+    std::atomic<bool> closed_{false};
+
+    // 以下只由运行房间的线程访问
+    TickScheduler::Clock::time_point armedDeadline_;   // 已登记到定时器的下一帧时间
+    TickScheduler::Clock::time_point idleSince_;       // 变为没有连接的时刻
+    bool wasEmpty_ = true;
+};
+
+// 多房间调度
+// 每个房间有自己的迷宫、GameLogic和帧率；房间分布在固定数量的模拟线程上，每个线程有一个就绪队列（双端队列），
+// 空闲线程从其他线程队列的尾部窃取房间，房间随之迁移到窃取它的线程；每个线程用最小堆记录自己房间的下一帧时间
+// 连接在认证（auth）时分配到房间：auth可以指定 roomId，否则加入第一个未满的房间，全部满时创建新房间
+class RoomManager {
+public:
+    static constexpr int DEFAULT_ROOM_ID = 1;
+
+    // 房间创建（opened为true，在房间接收消息之前）或关闭时的通知，可能在I/O线程或模拟线程上调用
+    typedef std::function<void(const Room& room, bool opened)> RoomListener;
+
+    RoomManager(const RoomConfig& config, PlayerManager& playerManager, DataManager& dataManager,
+                NetworkManager& networkManager);
+    ~RoomManager();
+
+    // 设置房间通知（在 Initialize 之前调用，默认房间也会通知）
+    void SetRoomListener(RoomListener listener) { roomListener_ = std::move(listener); }
+
+    // 用已有迷宫（持久化的迷宫）创建默认房间
+    bool Initialize(const MazeGrid& defaultMaze, uint64_t defaultSeed);
+
+    // 启动/停止模拟线程；Stop 后仍在排队的任务在调用线程上执行
+    bool Start();
+    void Stop();
+
+    // 入站消息路由（作为 NetworkManager 的入站消息处理函数，在I/O线程上调用）
+    void RouteMessage(int clientId, std::string&& payload, bool binary);
+
+    // 在房间线程上执行任务，房间不存在时返回false
+    bool Post(int roomId, Room::Task task);
+
+    // 在房间线程上执行任务并等待完成（供控制台命令使用，不能在模拟线程上调用）
+    bool Execute(int roomId, const Room::Task& task);
+
+    // 同时向多个房间投递任务并等待全部完成，返回执行的房间数；各房间的任务并行执行，每个任务在该房间的两帧之间执行
+    int ExecuteMany(const std::vector<std::pair<int, Room::Task>>& tasks);
+    
+    // 在每个房间上执行任务并等待完成，返回执行的房间数
+    int ExecuteAll(const Room::Task& task);
+
+    // 查找已认证玩家所在的房间和clientId
+    bool FindPlayer(const std::string& playerId, int& roomId, int& clientId) const;
+    
+    // 所有已认证玩家及其所在房间
+    std::vector<RoomPlayer> GetPlayers() const;
+
+    // 统计（任意线程）
+    std::vector<RoomInfo> GetRoomInfo() const;
+    RoomManagerStats GetStats() const;
+    int GetRoomCount() const;
+    int GetThreadCount() const { return static_cast<int>(workers_.size()); }
+    const RoomConfig& GetConfig() const { return config_; }
+
+private:
+    typedef TickScheduler::Clock Clock;
+    typedef std::shared_ptr<Room> RoomPtr;
+
+    struct TimerEntry {
+        Clock::time_point deadline;
+        RoomPtr room;
+        bool operator>(const TimerEntry& other) const { return deadline > other.deadline; }
+    };
+
+    struct Worker {
+        int index = 0;
+        int cpu = -1;   // 绑定的CPU，-1表示不绑定
+
+        // 就绪队列：所属线程从头部取，其他线程从尾部窃取
+        std::mutex readyMutex;
+        std::deque<RoomPtr> ready;
+
+        // 所属线程的定时器（只由所属线程访问）
+        std::priority_queue<TimerEntry, std::vector<TimerEntry>, std::greater<TimerEntry>> timers;
+
+        std::thread thread;
+    };
+
+    // 创建房间（生成迷宫，不加锁）
+    RoomPtr CreateRoom(int roomId, const MazeGrid* maze, uint64_t seed);
+
+    // 认证消息分配房间；没有可用房间时返回nullptr
+    RoomPtr AssignRoom(int clientId, const std::string& payload);
+
+    // 有新消息或任务时调用（任意线程）：房间空闲时放入其所属线程的就绪队列，运行中时标记为需要再次运行
+    void Schedule(const RoomPtr& room);
+
+    // 放入指定线程的就绪队列，必要时唤醒空闲线程
+    void Enqueue(const RoomPtr& room, int workerIndex);
+
+    void WorkerLoop(Worker& worker);
+    RoomPtr PopReady(Worker& worker);
+    RoomPtr Steal(Worker& thief);
+    bool HasReadyWork();
+    void RunRoom(Worker& worker, const RoomPtr& room);
+
+    // 没有连接且空闲超时的房间（默认房间除外）关闭，返回是否已关闭
+    bool TryCloseRoom(const RoomPtr& room, Clock::time_point now);
+
+    // 会话通知：维护 playerId -> 房间 的索引
+    void OnSessionChanged(Room& room, int clientId, const std::string& playerId, bool joined);
+
+    RoomConfig config_;
+    PlayerManager& playerManager_;
+    DataManager& dataManager_;
+    NetworkManager& networkManager_;
+    RoomListener roomListener_;
+
+    // 房间表与连接分配（I/O线程读多写少）
+    mutable std::shared_mutex mutex_;
+    std::map<int, RoomPtr> rooms_;
+    std::unordered_map<int, RoomPtr> clientRooms_;
+    std::atomic<int> nextRoomId_{DEFAULT_ROOM_ID + 1};
+
+    // playerId -> (房间编号, clientId)
+    struct PlayerLocation {
+        int roomId;
+        int clientId;
+    };
+    mutable std::mutex playersMutex_;
+    std::unordered_map<std::string, PlayerLocation> playerLocations_;
+
+    // 线程池
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<bool> running_{false};
+
+    // 空闲线程的等待与唤醒
+    std::mutex idleMutex_;
+    std::condition_variable idleCondition_;
+    uint64_t wakeEpoch_ = 0;
+    std::atomic<int> idleWorkers_{0};
+
+    std::atomic<uint64_t> runs_{0};
+    std::atomic<uint64_t> steals_{0};
+};
+
+#endif // ROOMMANAGER_H
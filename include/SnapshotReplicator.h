@@ -0,0 +1,133 @@
+#ifndef SNAPSHOTREPLICATOR_H
+#define SNAPSHOTREPLICATOR_H
+
+#include "GameLogic.h"
+#include "BinaryProtocol.h"
+#include "InterestManager.h"
+#include "WebSocketFrame.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class NetworkManager;
+
+// 世界状态增量同步
+// 保存最近若干帧快照，每个客户端以其最后确认（snapshot_ack）的快照为基线，
+// 只发送与基线不同的字段；没有基线的客户端收到完整快照
+// 启用兴趣管理时每个客户端只收到相关玩家，基线为该客户端实际收到的视图
+class SnapshotReplicator {
+public:
+    explicit SnapshotReplicator(size_t historySize = 64);
+    ~SnapshotReplicator();
+
+    // 记录本帧快照
+    void PushSnapshot(WorldSnapshot snapshot);
+    void PushSnapshot(std::shared_ptr<WorldSnapshot> snapshot);
+
+    // 取得一个可写入本帧内容的快照对象：优先复用已移出历史且没有客户端引用的旧快照
+    std::shared_ptr<WorldSnapshot> AcquireSnapshot();
+
+    // 客户端加入/离开同步，format为认证时协商的消息格式
+    void AddClient(int clientId, WireFormat format = WireFormat::JSON);
+    void RemoveClient(int clientId);
+
+    // 客户端确认已收到tick帧；tick不在历史中或早于当前基线时忽略
+    void Acknowledge(int clientId, uint32_t tick);
+
+    // 向所有客户端发送最新快照相对其基线的增量，返回发送的帧数
+    // interest 为空或未启用时所有客户端同步全部玩家，基线和格式相同的客户端共用同一份编码结果；
+    // 否则按客户端（clientId 即其 playerId）的相关集合过滤玩家，离开范围的玩家以 removed 通知；
+    // 本帧内容相同的视图共用一个对象，基线视图、当前视图和格式都相同的客户端共用编码结果
+    int Broadcast(NetworkManager& networkManager, const InterestManager* interest = nullptr);
+
+    // 计算current相对baseline的增量（baseline为空时生成完整快照），没有任何变化时返回false
+    static bool ComputeDelta(const WorldSnapshot* baseline, const WorldSnapshot& current, SnapshotDelta& delta);
+
+    // 把增量编码为JSON文本（调试用格式）
+    static std::string EncodeJson(const SnapshotDelta& delta);
+
+    // 统计
+    size_t GetClientCount() const { return clients_.size(); }
+    uint64_t GetBytesSent() const { return bytesSent_; }
+    uint64_t GetPlayersFiltered() const { return playersFiltered_; }
+
+private:
+    typedef std::shared_ptr<const WorldSnapshot> SnapshotPtr;
+
+    // 按兴趣过滤后发送给某个客户端的视图：玩家为过滤结果，金币和墙壁仍使用完整快照
+    struct ClientView {
+        uint32_t tick = 0;
+        SnapshotPtr world;
+        std::vector<PlayerSnapshot> players;   // 按playerId升序
+    };
+    typedef std::shared_ptr<const ClientView> ViewPtr;
+
+    // 本帧计算的一份增量及其编码结果（空帧表示尚未编码）
+    struct EncodedDelta {
+        bool changed = false;
+        SnapshotDelta delta;
+        SharedFrame frames[2];
+    };
+
+    struct ClientState {
+        SnapshotPtr baseline;  // 客户端已确认的快照
+        WireFormat format = WireFormat::JSON;
+
+        // 兴趣管理模式：已发送但未确认的视图（按tick升序，通常只有几个）和已确认的视图
+        std::vector<ViewPtr> sentViews;
+        ViewPtr baselineView;
+    };
+
+    // BroadcastFiltered 中一个客户端本帧的发送计划
+    struct PendingView {
+        int clientId;
+        ClientState* client;
+        std::shared_ptr<const ClientView> view;
+        uint64_t playersHash;    // 视图中玩家ID的哈希，只对可共用的视图有效
+        bool shareable;
+        EncodedDelta* delta;
+    };
+
+    int BroadcastShared(NetworkManager& networkManager, const WorldSnapshot& current);
+    int BroadcastFiltered(NetworkManager& networkManager, const InterestManager& interest);
+
+    // 按兴趣过滤出 clientId 本帧的视图，prev 为上一次发送的视图
+    // 返回视图是否只包含本帧的状态（没有沿用 prev 中降频玩家的旧状态），只有这样的视图可以在客户端间共用
+    bool BuildView(int clientId, const InterestManager& interest, const ClientView* prev, ClientView& view);
+
+    // 本帧的增量从池中取出，下一帧重新使用：各数组保留容量，稳定状态下不再分配
+    EncodedDelta& AcquireDelta();
+
+    // 视图池：只被池引用的视图即空闲（客户端已不再把它作为基线或待确认视图），每帧开始时收集
+    void CollectFreeViews();
+    std::shared_ptr<ClientView> AcquireView();
+
+    // 最多保留的空闲快照数
+    static constexpr size_t MAX_SPARE_SNAPSHOTS = 4;
+
+    size_t historySize_;
+    std::vector<SnapshotPtr> history_;  // 按tick升序
+    std::map<int, ClientState> clients_;
+    uint64_t bytesSent_ = 0;
+    uint64_t playersFiltered_ = 0;
+
+    // 帧间复用的对象
+    std::vector<std::shared_ptr<WorldSnapshot>> spareSnapshots_;
+    std::deque<EncodedDelta> deltaPool_;   // deque 保证已取出的引用在扩容时不失效
+    size_t deltasUsed_ = 0;
+    std::vector<std::pair<const WorldSnapshot*, EncodedDelta*>> sharedDeltas_;   // BroadcastShared：基线 -> 增量
+    std::string encodeBuffer_;
+    std::vector<std::shared_ptr<ClientView>> viewPool_;
+    std::vector<size_t> freeViews_;            // viewPool_ 中空闲视图的下标
+    std::vector<PendingView> pending_;         // BroadcastFiltered：按 clientId 升序
+    std::vector<size_t> order_;                // pending_ 的下标，排序后用于合并相同的视图和增量
+
+    // BuildView 复用的缓冲区
+    std::vector<InterestManager::Entry> relevant_;
+    std::vector<int> wasVisible_;
+};
+
+#endif // SNAPSHOTREPLICATOR_H
@@ -0,0 +1,89 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// 按网格单元格（列, 行, 层）索引的占用表，与 MazeGrid 使用相同的单元格编号
+// 每个单元格保存：该格内玩家的双向链表头、金币编号（每格最多一枚）、减速带数量
+// 插入、移动、删除都是O(1)；半径查询只访问 (2r+1)^2 个单元格，与玩家总数无关
+class SpatialIndex {
+public:
+    static constexpr int NONE = -1;
+
+    SpatialIndex();
+
+    // 按迷宫尺寸重新分配并清空
+    void reset(int width, int height, int layers);
+    void clear();
+
+    bool inBounds(int x, int y, int layer) const {
+        return static_cast<unsigned>(x) < static_cast<unsigned>(width) &&
+               static_cast<unsigned>(y) < static_cast<unsigned>(height) &&
+               static_cast<unsigned>(layer) < static_cast<unsigned>(layers);
+    }
+
+    // ========== 玩家 ==========
+
+    // 设置玩家所在单元格（不存在时插入），越界时玩家不属于任何单元格；返回单元格是否变化
+    bool updatePlayer(int playerId, int x, int y, int layer);
+    void removePlayer(int playerId);
+    size_t getPlayerCount() const { return players.size(); }
+
+    // 遍历 (x, y, layer) 同层周围 radius 格（切比雪夫距离）内的玩家
+    template <typename Visitor>
+    void forEachPlayerNear(int x, int y, int layer, int radius, Visitor visit) const {
+        if (layer < 0 || layer >= layers || radius < 0) {
+            return;
+        }
+        for (int cy = y - radius; cy <= y + radius; ++cy) {
+            for (int cx = x - radius; cx <= x + radius; ++cx) {
+                if (!inBounds(cx, cy, layer)) {
+                    continue;
+                }
+                for (int id = playerHeads[indexOf(cx, cy, layer)]; id != NONE; id = players.at(id).next) {
+                    visit(id);
+                }
+            }
+        }
+    }
+
+    std::vector<int> queryPlayers(int x, int y, int layer, int radius) const;
+
+    // ========== 金币 ==========
+
+    void setCoin(int x, int y, int layer, int coinId);
+    void clearCoin(int x, int y, int layer);
+    // 该格的金币编号，没有时返回NONE
+    int coinAt(int x, int y, int layer) const;
+
+    // ========== 减速带 ==========
+
+    void addTrap(int x, int y, int layer);
+    void removeTrap(int x, int y, int layer);
+    bool hasTrap(int x, int y, int layer) const;
+
+private:
+    size_t indexOf(int x, int y, int layer) const {
+        return (static_cast<size_t>(layer) * height + y) * width + x;
+    }
+
+    // 从单元格链表中摘除（不删除玩家记录）
+    void unlink(int playerId);
+
+    struct PlayerEntry {
+        int64_t cell = NONE;   // 所在单元格编号，NONE表示不在网格内
+        int prev = NONE;
+        int next = NONE;
+    };
+
+    int width, height, layers;
+    std::vector<int> playerHeads;       // 每格玩家链表头
+    std::vector<int32_t> coins;         // 每格金币编号
+    std::vector<uint16_t> trapCounts;   // 每格减速带数量
+    std::unordered_map<int, PlayerEntry> players;
+};
+
+#endif // SPATIALINDEX_H
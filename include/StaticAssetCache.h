@@ -0,0 +1,79 @@
+#ifndef STATICASSETCACHE_H
+#define STATICASSETCACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// 响应体编码
+enum class ContentEncoding {
+    IDENTITY = 0,
+    GZIP,
+    BROTLI
+};
+
+// 一个静态文件；加载后不再修改，可在多个线程间共享
+struct StaticAsset {
+    std::string filePath;       // 磁盘路径
+    std::string contentType;
+    std::string etag;           // 强校验值（带引号），压缩版本追加 -gz / -br 后缀
+    std::string cacheControl;   // 为空时使用 no-cache（每次用ETag验证）
+    uint64_t size = 0;
+
+    // 响应体；超过缓存上限的文件为空，发送时直接从磁盘读取（sendfile）
+    std::shared_ptr<const std::string> body;
+    std::shared_ptr<const std::string> gzipBody;
+    std::shared_ptr<const std::string> brotliBody;
+
+    bool isCompressible() const { return gzipBody || brotliBody; }
+
+    // 按编码取响应体和对应的ETag，没有该编码版本时返回 nullptr
+    const std::shared_ptr<const std::string>* variant(ContentEncoding encoding) const;
+    std::string variantETag(ContentEncoding encoding) const;
+};
+
+// 静态资源缓存：启动时把网站根目录下的全部文件读入内存，文本类文件预先压缩一次
+// 查找无锁（整张表是不可变的，重新加载时整体替换）
+class StaticAssetCache {
+public:
+    // 单个文件超过此大小时不读入内存，发送时使用 sendfile
+    static constexpr uint64_t MAX_CACHED_FILE_SIZE = 8 * 1024 * 1024;
+
+    // 小于此大小的文件不压缩
+    static constexpr uint64_t MIN_COMPRESS_SIZE = 256;
+
+    StaticAssetCache() = default;
+
+    // 加载 rootPath 下的全部文件，替换现有内容；mimeTypes 为扩展名到Content-Type的映射
+    bool load(const std::string& rootPath, const std::unordered_map<std::string, std::string>& mimeTypes);
+
+    // 按URL路径（如 "/js/main.js"）查找，不存在时返回 nullptr
+    std::shared_ptr<const StaticAsset> find(const std::string& urlPath) const;
+
+    size_t getAssetCount() const;
+    uint64_t getTotalBytes() const;       // 内存中原始内容的字节数
+    uint64_t getCompressedBytes() const;  // 内存中压缩版本的字节数
+
+    // 编译时是否支持该编码
+    static bool isEncodingSupported(ContentEncoding encoding);
+
+    // 用内存中生成的内容创建资源（计算ETag；compress为true且足够大时预生成压缩版本）
+    static std::shared_ptr<const StaticAsset> makeAsset(std::string content, const std::string& contentType,
+                                                        const std::string& cacheControl = "", bool compress = false);
+
+private:
+    struct AssetTable {
+        std::unordered_map<std::string, std::shared_ptr<const StaticAsset>> assets;
+        uint64_t totalBytes = 0;
+        uint64_t compressedBytes = 0;
+    };
+
+    std::shared_ptr<const AssetTable> table() const;
+
+    // 使用 std::atomic_load / std::atomic_store 访问
+    std::shared_ptr<const AssetTable> current;
+};
+
+#endif // STATICASSETCACHE_H
@@ -0,0 +1,68 @@
+#ifndef TICKSCHEDULER_H
+#define TICKSCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+// 帧耗时统计
+struct TickMetrics {
+    uint32_t tickCount = 0;      // 已执行的帧数
+    double lastTickMs = 0.0;     // 最近一帧耗时
+    double avgTickMs = 0.0;      // 平均帧耗时（指数滑动平均）
+    double maxTickMs = 0.0;      // 最大帧耗时
+    uint64_t overruns = 0;       // 耗时超过帧周期的帧数
+    uint64_t skippedTicks = 0;   // 落后过多而放弃追赶的帧数
+};
+
+// 固定频率的帧调度器
+// 按绝对时间表推进（next += interval），单帧的抖动不会累积成漂移；
+// 短暂落后时连续补帧，落后超过 MAX_CATCHUP_TICKS 帧时放弃追赶并重新对齐
+class TickScheduler {
+public:
+    // tick: 帧序号（从1开始）；deltaSeconds: 固定的帧间隔
+    typedef std::function<void(uint32_t tick, double deltaSeconds)> TickCallback;
+    // 两帧之间的空闲回调，timeoutMs 为距下一帧的剩余时间，可以阻塞等待
+    typedef std::function<void(int timeoutMs)> IdleCallback;
+    typedef std::function<bool()> StopPredicate;
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr int MIN_TICK_RATE = 1;
+    static constexpr int MAX_TICK_RATE = 240;
+    static constexpr int MAX_CATCHUP_TICKS = 5;
+
+    explicit TickScheduler(int tickRate = 20);
+
+    // 设置帧率（Hz），可以在运行中从其他线程调用
+    void setTickRate(int tickRate);
+    int getTickRate() const { return tickRate_.load(); }
+
+    // 运行调度循环，直到 shouldStop 返回 true
+    void run(const TickCallback& onTick, const IdleCallback& onIdle, const StopPredicate& shouldStop);
+
+    // 非阻塞推进：到期时执行一帧，返回下一帧的计划时间（仍落后时不晚于当前时刻）
+    // 供外部调度器（如 RoomManager 的工作线程）在多个调度器之间轮流推进；同一实例只能由一个线程调用
+    Clock::time_point runDue(const TickCallback& onTick);
+
+    // 获取统计信息（线程安全）
+    TickMetrics getMetrics() const;
+
+private:
+    void recordTick(double tickMs, double intervalMs);
+
+    std::atomic<int> tickRate_;
+    uint32_t nextTick_ = 1;
+
+    // 时间表，首次调用 runDue 时初始化
+    bool started_ = false;
+    int currentRate_ = 0;
+    Clock::duration interval_{};
+    Clock::time_point nextTime_;
+
+    mutable std::mutex metricsMutex_;
+    TickMetrics metrics_;
+};
+
+#endif // TICKSCHEDULER_H
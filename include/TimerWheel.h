@@ -0,0 +1,78 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <array>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// 分层时间轮：4层 × 64槽，第0层每槽一个时间刻度（resolutionMs），上层每槽覆盖下层一整圈
+// 插入和取消都是O(1)（槽内为双向链表）；advance 的代价与到期的定时器数量成正比，
+// 上层的槽在转到时整体下放一次
+// 非线程安全，由拥有者在自己的线程上调用（GameLogic 在模拟线程中推进）
+class TimerWheel {
+public:
+    typedef uint64_t TimerId;
+    typedef std::function<void()> Callback;
+
+    static constexpr TimerId INVALID_TIMER = 0;
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+
+    explicit TimerWheel(uint32_t resolutionMs = 10);
+
+    // 把当前时间设为nowMs并清空所有定时器
+    void reset(uint64_t nowMs);
+    void clear();
+
+    // 在绝对时间expiryMs（不早于下一个刻度）时触发
+    TimerId scheduleAt(uint64_t expiryMs, Callback callback);
+
+    // 取消定时器，已触发或不存在时返回false
+    bool cancel(TimerId id);
+
+    // 推进到nowMs并依次触发到期的定时器，返回触发数量
+    // 回调中可以安全地添加或取消定时器
+    size_t advance(uint64_t nowMs);
+
+    size_t size() const { return activeCount; }
+    bool empty() const { return activeCount == 0; }
+    uint64_t getCurrentTime() const { return currentTick * resolution; }
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Node {
+        uint64_t expiryTick = 0;
+        uint32_t generation = 1;
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        int16_t level = -1;      // -1 表示空闲
+        uint8_t slot = 0;
+        Callback callback;
+    };
+
+    // 按与当前刻度的距离放入合适的层和槽
+    void insert(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+
+    // 把某层当前槽内的定时器重新分配到下层
+    void cascade(int level);
+
+    uint32_t resolution;
+    uint64_t currentTick;
+    size_t activeCount;
+
+    std::array<std::array<uint32_t, SLOTS>, LEVELS> slots;
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeNodes;
+
+    // 禁止拷贝（回调通常捕获了拥有者的this）
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+};
+
+#endif // TIMERWHEEL_H
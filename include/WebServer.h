@@ -8,87 +8,161 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
-#include <fstream>
-#include <sstream>
+#include <vector>
+#include <cstdint>
 
+#include "StaticAssetCache.h"
+
+// 定义在WebServer.cpp中
+struct HttpWorker;
+struct HttpConnection;
+struct HttpRequest;
+
+// HTTP/1.1 服务器
+// 监听线程只负责accept，连接按轮转分配给多个I/O工作线程，每个工作线程用EventPoller运行自己的事件循环
+// 支持keep-alive和流水线请求；静态文件启动时预加载到StaticAssetCache，支持ETag/If-None-Match和gzip/br
 class WebServer {
 public:
     static WebServer& getInstance();
-    
-    // 初始化Web服务器
+
+    // 初始化Web服务器（预加载网站根目录下的静态文件）
     bool initialize(const std::string& webRootPath, int httpPort = 8080);
-    
+
     // 启动HTTP服务器
     bool startServer();
-    
+
     // 停止HTTP服务器
     void stopServer();
-    
+
     // 获取HTTP端口
     int getHttpPort() const { return httpPort_; }
-    
-    // 设置Web根目录
+
+    // 设置Web根目录（需要调用reloadAssets重新加载）
     void setWebRootPath(const std::string& path) { webRootPath_ = path; }
-    
-    // 添加自定义路由
-    void addRoute(const std::string& path, 
-                  std::function<std::string(const std::string&)> handler);
-    
+
+    // 重新加载静态文件缓存
+    bool reloadAssets();
+
+    // 设置I/O工作线程数量（startServer之前调用，0表示按CPU核心数）
+    void setWorkerCount(int count) { workerCount_ = count; }
+
+    // 添加自定义路由；contentType为空时 /api/ 下的路由按JSON返回，其余按HTML返回
+    void addRoute(const std::string& path,
+                  std::function<std::string(const std::string&)> handler,
+                  const std::string& contentType = "");
+
+    // 发布/撤销内存中生成的资源（如迷宫分块），按URL路径精确匹配，优先于静态文件；可在任意线程调用
+    void publishAsset(const std::string& urlPath, std::shared_ptr<const StaticAsset> asset);
+    void unpublishAsset(const std::string& urlPath);
+
     // 检查服务器是否运行中
     bool isRunning() const { return serverRunning_; }
 
+    // 统计
+    uint64_t getRequestsServed() const { return requestsServed_.load(); }
+    int getOpenConnections() const { return openConnections_.load(); }
+    const StaticAssetCache& getAssetCache() const { return assetCache_; }
+
 private:
     WebServer();
     ~WebServer();
-    
+
     // 禁止拷贝
     WebServer(const WebServer&) = delete;
     WebServer& operator=(const WebServer&) = delete;
-    
-    // 服务器主循环
+
+    // 监听线程：accept并把连接交给工作线程
     void serverLoop();
-    
-    // 处理HTTP请求
-    std::string handleRequest(const std::string& request);
-    
-    // 解析HTTP请求
-    bool parseHttpRequest(const std::string& request, 
-                         std::string& method, 
-                         std::string& path, 
+
+    // I/O工作线程的事件循环
+    void workerLoop(HttpWorker* worker);
+
+    // 读取、解析并响应连接上已到达的请求，返回false表示需要关闭连接
+    bool serviceConnection(HttpWorker& worker, HttpConnection& connection, bool readable);
+
+    // 从接收缓冲区中依次解析请求（流水线）
+    void processRequests(HttpConnection& connection);
+
+    // 发送待发送的响应，返回false表示连接出错
+    bool flushConnection(HttpWorker& worker, HttpConnection& connection);
+
+    // 处理一个HTTP请求，把响应追加到连接的发送队列
+    void handleRequest(const HttpRequest& request, HttpConnection& connection);
+
+    // 发送缓存中的静态文件（处理条件请求和压缩协商）
+    void serveAsset(const HttpRequest& request, const StaticAsset& asset, HttpConnection& connection);
+
+    // 追加一个完整的小响应
+    void queueResponse(HttpConnection& connection, const HttpRequest& request,
+                       int statusCode, const std::string& statusText,
+                       const std::string& content, const std::string& contentType,
+                       const std::string& extraHeaders = "");
+
+    // 解析HTTP请求头（header名称转为小写）
+    bool parseHttpRequest(const std::string& request,
+                         std::string& method,
+                         std::string& path,
+                         std::string& version,
                          std::unordered_map<std::string, std::string>& headers);
-    
+
     // 构建HTTP响应
-    std::string buildHttpResponse(int statusCode, 
+    std::string buildHttpResponse(int statusCode,
                                  const std::string& statusText,
-                                 const std::string& content, 
+                                 const std::string& content,
                                  const std::string& contentType,
-                                 bool isHeadRequest = false);
-    
+                                 bool isHeadRequest = false,
+                                 bool keepAlive = false,
+                                 const std::string& extraHeaders = "");
+
+    // 构建响应头（以空行结尾），内容长度由调用方给出（内容体另行发送，如缓存的资源或sendfile）
+    std::string buildHttpHead(int statusCode,
+                             const std::string& statusText,
+                             const std::string& contentType,
+                             uint64_t contentLength,
+                             bool keepAlive = false,
+                             const std::string& extraHeaders = "");
+
     // 获取MIME类型
     std::string getMimeType(const std::string& filePath) const;
-    
+
     // 读取文件内容
     bool readFile(const std::string& filePath, std::string& content) const;
-    
+
     // URL解码
     std::string urlDecode(const std::string& str) const;
-    
+
     // 检查路径安全性
     bool isSafePath(const std::string& path) const;
 
 private:
     std::string webRootPath_;
     int httpPort_;
+    int workerCount_;
     std::atomic<bool> serverRunning_;
     std::unique_ptr<std::thread> serverThread_;
-    
-    // 自定义路由处理
-    std::unordered_map<std::string, std::function<std::string(const std::string&)>> customRoutes_;
-    
+    std::vector<std::unique_ptr<HttpWorker>> workers_;
+
+    // 静态文件缓存
+    StaticAssetCache assetCache_;
+
+    // 发布的资源
+    std::unordered_map<std::string, std::shared_ptr<const StaticAsset>> publishedAssets_;
+    mutable std::mutex publishedMutex_;
+
+    // 自定义路由处理（处理函数串行执行）
+    struct CustomRoute {
+        std::function<std::string(const std::string&)> handler;
+        std::string contentType;
+    };
+    std::unordered_map<std::string, CustomRoute> customRoutes_;
+
     // MIME类型映射
     std::unordered_map<std::string, std::string> mimeTypes_;
-    
+
+    std::atomic<uint64_t> requestsServed_;
+    std::atomic<int> openConnections_;
+
     mutable std::mutex mutex_;
 };
 
-#endif // WEBSERVER_H
\ No newline at end of file
+#endif // WEBSERVER_H
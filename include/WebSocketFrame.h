@@ -0,0 +1,170 @@
+#ifndef WEBSOCKETFRAME_H
+#define WEBSOCKETFRAME_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// WebSocket帧类型
+enum WebSocketOpcode {
+    CONTINUATION_FRAME = 0x0,
+    TEXT_FRAME = 0x1,
+    BINARY_FRAME = 0x2,
+    CLOSE_FRAME = 0x8,
+    PING_FRAME = 0x9,
+    PONG_FRAME = 0xA
+};
+
+// WebSocket关闭状态码
+enum WebSocketCloseCode : uint16_t {
+    CLOSE_NORMAL = 1000,
+    CLOSE_PROTOCOL_ERROR = 1002,
+    CLOSE_MESSAGE_TOO_BIG = 1009
+};
+
+// 字节环形缓冲区：容量为2的幂，空间不足时自动扩容
+// recv可以直接写入 writableRegion() 返回的连续区域，避免中间拷贝
+class ByteRingBuffer {
+public:
+    ByteRingBuffer() = default;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return buffer_.size(); }
+
+    // 保证至少有minFree字节空闲，返回尾部连续可写区域及其长度
+    uint8_t* writableRegion(size_t minFree, size_t& available);
+
+    // 确认已写入writableRegion的字节数
+    void commitWrite(size_t length);
+
+    // 追加数据
+    void append(const uint8_t* data, size_t length);
+
+    // 读取offset处的字节（不消费）
+    uint8_t peek(size_t offset) const {
+        return buffer_[(head_ + offset) & (buffer_.size() - 1)];
+    }
+
+    // 从offset处拷贝length字节到dest（不消费）
+    void copyOut(size_t offset, uint8_t* dest, size_t length) const;
+
+    // 丢弃头部length字节
+    void consume(size_t length);
+
+    void clear() { head_ = 0; size_ = 0; }
+
+private:
+    // 扩容并把数据整理到缓冲区开头
+    void grow(size_t minCapacity);
+
+    std::vector<uint8_t> buffer_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+// 已解析的完整消息（分片已重组）或控制帧
+struct WebSocketMessage {
+    uint8_t opcode;
+    std::string payload;
+};
+
+// 复用内存的消息列表：clear() 只重置数量，每个位置的载荷保留上次分配的容量，稳定状态下解析不再分配内存
+class WebSocketMessageBatch {
+public:
+    // 超过该容量的载荷在复用时释放，避免偶尔的大消息让连接长期占用内存
+    static constexpr size_t MAX_RETAINED_CAPACITY = 64 * 1024;
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    void clear() { count_ = 0; }
+
+    WebSocketMessage& operator[](size_t index) { return messages_[index]; }
+    WebSocketMessage* begin() { return messages_.data(); }
+    WebSocketMessage* end() { return messages_.data() + count_; }
+
+    // 追加一条消息，返回的载荷为空
+    WebSocketMessage& append(uint8_t opcode);
+
+private:
+    std::vector<WebSocketMessage> messages_;
+    size_t count_ = 0;
+};
+
+// 增量WebSocket帧解析器（服务器端，要求客户端帧带掩码）
+// 每个连接一个实例：收到的字节写入buffer()，再调用parse()取出所有完整帧
+class WebSocketFrameParser {
+public:
+    enum class Result {
+        OK,               // 已取出所有完整帧，剩余字节等待后续数据
+        PROTOCOL_ERROR,   // 帧格式错误，需要以1002关闭连接
+        MESSAGE_TOO_BIG   // 消息超过上限，需要以1009关闭连接
+    };
+
+    explicit WebSocketFrameParser(size_t maxMessageSize = 256 * 1024);
+
+    ByteRingBuffer& buffer() { return buffer_; }
+
+    // 解析缓冲区中所有完整的帧，完整的数据消息和控制帧按顺序追加到messages
+    // 载荷直接解掩码到 messages 中复用的字符串
+    Result parse(WebSocketMessageBatch& messages);
+
+private:
+    ByteRingBuffer buffer_;
+    size_t maxMessageSize_;
+
+    // 分片重组状态
+    bool inFragment_ = false;
+    uint8_t fragmentOpcode_ = 0;
+    std::string fragmentPayload_;
+};
+
+// 按掩码异或数据，offset为data首字节在整个载荷中的位置
+// 批量按64位字处理，剩余字节逐个处理
+void unmaskWebSocketPayload(uint8_t* data, size_t length, const uint8_t mask[4], size_t offset = 0);
+
+// 计算服务器帧头长度（不带掩码）
+size_t webSocketFrameHeaderSize(size_t payloadLength);
+
+// 写入服务器帧头（FIN=1，不带掩码），返回写入的字节数；header至少需要10字节
+size_t writeWebSocketFrameHeader(uint8_t* header, uint8_t opcode, size_t payloadLength);
+
+class PreparedFrame;
+
+// 共享的已编码帧：所有接收者的发送队列引用同一份字节，不再拷贝
+typedef std::shared_ptr<const PreparedFrame> SharedFrame;
+
+// 预先编码好的服务器帧，帧头与载荷位于同一块连续内存
+class PreparedFrame {
+public:
+    // 编码文本帧；droppable表示发送队列拥塞时可被丢弃（如状态更新）
+    static SharedFrame text(const std::string& payload, bool droppable = false);
+
+    // 编码二进制帧
+    static SharedFrame binary(const uint8_t* payload, size_t length, bool droppable = false);
+
+    // 编码关闭帧
+    static SharedFrame close(uint16_t code);
+
+    // 编码任意操作码的帧
+    static SharedFrame create(uint8_t opcode, const uint8_t* payload, size_t length, bool droppable = false);
+
+    // 整个帧（帧头+载荷）
+    const uint8_t* data() const { return bytes_.data(); }
+    size_t size() const { return bytes_.size(); }
+
+    uint8_t opcode() const { return bytes_[0] & 0x0F; }
+    size_t payloadSize() const { return bytes_.size() - headerSize_; }
+    bool droppable() const { return droppable_; }
+
+    PreparedFrame(uint8_t opcode, const uint8_t* payload, size_t length, bool droppable);
+
+private:
+    std::vector<uint8_t> bytes_;
+    size_t headerSize_;
+    bool droppable_;
+};
+
+#endif // WEBSOCKETFRAME_H
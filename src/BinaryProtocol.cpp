@@ -0,0 +1,207 @@
+#include "BinaryProtocol.h"
+
+#include <cstring>
+
+namespace {
+
+// 小端写入器，与主机字节序无关
+class BinaryWriter {
+public:
+    explicit BinaryWriter(std::string& out) : out_(out) {}
+
+    void u8(uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+    void u16(uint16_t value) {
+        u8(static_cast<uint8_t>(value & 0xFF));
+        u8(static_cast<uint8_t>(value >> 8));
+    }
+
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            u8(static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    void u64(uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            u8(static_cast<uint8_t>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    void i16(int16_t value) { u16(static_cast<uint16_t>(value)); }
+    void i32(int32_t value) { u32(static_cast<uint32_t>(value)); }
+
+    void f64(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        u64(bits);
+    }
+
+    void header(BinaryOpcode opcode) {
+        u8(BINARY_PROTOCOL_VERSION);
+        u8(static_cast<uint8_t>(opcode));
+    }
+
+private:
+    std::string& out_;
+};
+
+// 小端读取器，越界时置失败标志并返回0
+class BinaryReader {
+public:
+    BinaryReader(const std::string& data, size_t offset)
+        : data_(reinterpret_cast<const uint8_t*>(data.data())), size_(data.size()), offset_(offset) {}
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return offset_ == size_; }
+
+    uint8_t u8() {
+        if (offset_ + 1 > size_) { ok_ = false; return 0; }
+        return data_[offset_++];
+    }
+
+    uint32_t u32() {
+        if (offset_ + 4 > size_) { ok_ = false; return 0; }
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(data_[offset_ + i]) << (8 * i);
+        }
+        offset_ += 4;
+        return value;
+    }
+
+    uint64_t u64() {
+        if (offset_ + 8 > size_) { ok_ = false; return 0; }
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) {
+            value |= static_cast<uint64_t>(data_[offset_ + i]) << (8 * i);
+        }
+        offset_ += 8;
+        return value;
+    }
+
+    float f32() {
+        uint32_t bits = u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    double f64() {
+        uint64_t bits = u64();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_;
+    bool ok_ = true;
+};
+
+void writeWall(BinaryWriter& writer, const std::tuple<int, int, int>& wall) {
+    writer.i16(static_cast<int16_t>(std::get<0>(wall)));
+    writer.i16(static_cast<int16_t>(std::get<1>(wall)));
+    writer.i16(static_cast<int16_t>(std::get<2>(wall)));
+}
+
+} // namespace
+
+bool readBinaryHeader(const std::string& payload, BinaryOpcode& opcode) {
+    if (payload.size() < BINARY_HEADER_SIZE ||
+        static_cast<uint8_t>(payload[0]) != BINARY_PROTOCOL_VERSION) {
+        return false;
+    }
+    opcode = static_cast<BinaryOpcode>(static_cast<uint8_t>(payload[1]));
+    return true;
+}
+
+bool decodeBinaryMessage(const std::string& payload, InputMessage& message) {
+    BinaryReader reader(payload, BINARY_HEADER_SIZE);
+    message.sequence = reader.u32();
+    message.directions = reader.u8();
+    message.rotation = reader.f32();
+    return reader.ok() && reader.atEnd();
+}
+
+bool decodeBinaryMessage(const std::string& payload, PingMessage& message) {
+    BinaryReader reader(payload, BINARY_HEADER_SIZE);
+    message.timestamp = reader.f64();
+    return reader.ok() && reader.atEnd();
+}
+
+bool decodeBinaryMessage(const std::string& payload, SnapshotAckMessage& message) {
+    BinaryReader reader(payload, BINARY_HEADER_SIZE);
+    message.tick = reader.u32();
+    return reader.ok() && reader.atEnd();
+}
+
+std::string encodePongMessage(double timestamp) {
+    std::string out;
+    out.reserve(BINARY_HEADER_SIZE + 8);
+    BinaryWriter writer(out);
+    writer.header(BinaryOpcode::PONG);
+    writer.f64(timestamp);
+    return out;
+}
+
+std::string encodeMazeChunkMessage(const std::string& chunk) {
+    std::string out;
+    out.reserve(BINARY_HEADER_SIZE + chunk.size());
+    BinaryWriter writer(out);
+    writer.header(BinaryOpcode::MAZE_CHUNK);
+    out += chunk;
+    return out;
+}
+
+std::string encodeSnapshotDelta(const SnapshotDelta& delta) {
+    std::string out;
+    encodeSnapshotDelta(delta, out);
+    return out;
+}
+
+void encodeSnapshotDelta(const SnapshotDelta& delta, std::string& out) {
+    out.clear();
+    out.reserve(BINARY_HEADER_SIZE + 20 + delta.players.size() * 26);
+    BinaryWriter writer(out);
+    writer.header(BinaryOpcode::SNAPSHOT);
+    writer.u32(delta.tick);
+    writer.u32(delta.baseline);
+
+    writer.u16(static_cast<uint16_t>(delta.players.size()));
+    for (const PlayerDelta& player : delta.players) {
+        writer.i32(player.playerId);
+        writer.u8(player.fields);
+        if (player.fields & DELTA_X) writer.i32(player.x);
+        if (player.fields & DELTA_Y) writer.i32(player.y);
+        if (player.fields & DELTA_Z) writer.i32(player.z);
+        if (player.fields & DELTA_ROT) writer.i32(player.rotation);
+        if (player.fields & DELTA_ALIVE) writer.u8(player.isAlive ? 1 : 0);
+        if (player.fields & DELTA_COINS) writer.i32(player.coins);
+    }
+
+    writer.u16(static_cast<uint16_t>(delta.removedPlayers.size()));
+    for (int32_t playerId : delta.removedPlayers) {
+        writer.i32(playerId);
+    }
+
+    writer.u16(static_cast<uint16_t>(delta.coinsCollected.size()));
+    for (uint16_t coinId : delta.coinsCollected) {
+        writer.u16(coinId);
+    }
+    writer.u16(static_cast<uint16_t>(delta.coinsRestored.size()));
+    for (uint16_t coinId : delta.coinsRestored) {
+        writer.u16(coinId);
+    }
+
+    writer.u16(static_cast<uint16_t>(delta.wallsBroken.size()));
+    for (const auto& wall : delta.wallsBroken) {
+        writeWall(writer, wall);
+    }
+    writer.u16(static_cast<uint16_t>(delta.wallsRepaired.size()));
+    for (const auto& wall : delta.wallsRepaired) {
+        writeWall(writer, wall);
+    }
+}
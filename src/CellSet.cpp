@@ -0,0 +1,35 @@
+#include "CellSet.h"
+
+void CellSet::reset(size_t capacity) {
+    cells.clear();
+    slots.assign(capacity, NOT_MEMBER);
+}
+
+void CellSet::clear() {
+    for (uint32_t cell : cells) {
+        slots[cell] = NOT_MEMBER;
+    }
+    cells.clear();
+}
+
+bool CellSet::insert(size_t cell) {
+    if (cell >= slots.size() || slots[cell] != NOT_MEMBER) {
+        return false;
+    }
+    slots[cell] = static_cast<uint32_t>(cells.size());
+    cells.push_back(static_cast<uint32_t>(cell));
+    return true;
+}
+
+bool CellSet::erase(size_t cell) {
+    if (!contains(cell)) {
+        return false;
+    }
+    uint32_t slot = slots[cell];
+    uint32_t last = cells.back();
+    cells[slot] = last;
+    slots[last] = slot;
+    cells.pop_back();
+    slots[cell] = NOT_MEMBER;
+    return true;
+}
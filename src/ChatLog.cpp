@@ -0,0 +1,331 @@
+#include "ChatLog.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+namespace {
+
+// 待写文本超过这个大小时立即唤醒后台线程，不等到下一个提交周期
+constexpr size_t COMMIT_BYTES = 64 * 1024;
+
+// 反向读取文件时每次读取的块大小
+constexpr size_t TAIL_CHUNK_BYTES = 64 * 1024;
+
+} // namespace
+
+ChatLog::ChatLog() {
+}
+
+ChatLog::~ChatLog() {
+    close();
+}
+
+bool ChatLog::open(const std::string& dir, size_t historyCapacity, uint64_t maxSegmentBytes, int segmentCount) {
+    close();
+
+    directory = dir;
+    segmentBytes = maxSegmentBytes;
+    maxSegments = std::max(segmentCount, 0);
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+
+    // 从各段末尾恢复最近的消息
+    std::vector<std::string> lines;
+    for (int i = 0; i <= maxSegments && lines.size() < historyCapacity; ++i) {
+        readTailLines(segmentPath(i), historyCapacity - lines.size(), lines);
+    }
+
+    history.assign(historyCapacity, std::string());
+    historyHead = 0;
+    historyCount = 0;
+    for (std::string& line : lines) {
+        history[historyHead] = std::move(line);
+        historyHead = (historyHead + 1) % std::max<size_t>(historyCapacity, 1);
+        ++historyCount;
+    }
+
+    segment.open(segmentPath(0), std::ios::app | std::ios::binary);
+    if (!segment.is_open()) {
+        return false;
+    }
+    uintmax_t size = std::filesystem::file_size(segmentPath(0), ec);
+    segmentSize = ec ? 0 : size;
+
+    pending.clear();
+    appendedCount = 0;
+    committedCount = 0;
+    flushRequested = false;
+    stopRequested = false;
+    running = true;
+    worker = std::thread(&ChatLog::run, this);
+    return true;
+}
+
+void ChatLog::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        stopRequested = true;
+    }
+    wakeup.notify_one();
+    worker.join();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    committed.notify_all();
+    segment.close();
+}
+
+bool ChatLog::append(const std::string& playerName, const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+        return false;
+    }
+
+    std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    if (now != cachedSecond) {
+        cachedSecond = now;
+        std::tm tm;
+#ifdef _WIN32
+        localtime_s(&tm, &now);
+#else
+        localtime_r(&now, &tm);
+#endif
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "[%Y-%m-%d %H:%M:%S]", &tm);
+        cachedTimePrefix = buffer;
+    }
+
+    std::string line = cachedTimePrefix + " [" + playerName + "]: " + message;
+    // 每条消息占一行
+    std::replace(line.begin(), line.end(), '\n', ' ');
+    std::replace(line.begin(), line.end(), '\r', ' ');
+
+    pending += line;
+    pending += '\n';
+    ++appendedCount;
+
+    if (!history.empty()) {
+        history[historyHead] = std::move(line);
+        historyHead = (historyHead + 1) % history.size();
+        historyCount = std::min(historyCount + 1, history.size());
+    }
+
+    if (pending.size() >= COMMIT_BYTES) {
+        wakeup.notify_one();
+    }
+    return true;
+}
+
+std::vector<std::string> ChatLog::recent(size_t maxLines) {
+    std::vector<std::string> lines;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t count = std::min(maxLines, historyCount);
+        lines.reserve(count);
+        size_t start = (historyHead + history.size() - count) % std::max<size_t>(history.size(), 1);
+        for (size_t i = 0; i < count; ++i) {
+            lines.push_back(history[(start + i) % history.size()]);
+        }
+
+        // 环形缓冲没有满说明已经是全部记录
+        if (count == maxLines || historyCount < history.size()) {
+            return lines;
+        }
+    }
+
+    // 超出内存容量：写出缓冲后从文件末尾反向读取
+    flush();
+    lines.clear();
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+    for (int i = 0; i <= maxSegments && lines.size() < maxLines; ++i) {
+        readTailLines(segmentPath(i), maxLines - lines.size(), lines);
+    }
+    return lines;
+}
+
+bool ChatLog::clear() {
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::fill(history.begin(), history.end(), std::string());
+    historyHead = 0;
+    historyCount = 0;
+    pending.clear();
+    committedCount = appendedCount;
+    ++generation;
+
+    std::error_code ec;
+    for (int i = 1; i <= maxSegments; ++i) {
+        std::filesystem::remove(segmentPath(i), ec);
+    }
+    segment.close();
+    segment.open(segmentPath(0), std::ios::trunc | std::ios::binary);
+    segmentSize = 0;
+    committed.notify_all();
+    return segment.is_open();
+}
+
+void ChatLog::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!running) {
+        return;
+    }
+    uint64_t target = appendedCount;
+    flushRequested = true;
+    wakeup.notify_one();
+    committed.wait(lock, [this, target] { return committedCount >= target || !running; });
+}
+
+void ChatLog::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeup.wait_for(lock, commitInterval, [this] {
+            return stopRequested || flushRequested || pending.size() >= COMMIT_BYTES;
+        });
+
+        bool stopping = stopRequested;
+        flushRequested = false;
+        std::string text;
+        text.swap(pending);
+        uint64_t count = appendedCount;
+        uint64_t textGeneration = generation;
+        lock.unlock();
+
+        // 一批消息一次写入、一次 flush
+        if (!text.empty()) {
+            std::lock_guard<std::mutex> fileLock(fileMutex);
+            commit(text, textGeneration);
+        }
+
+        lock.lock();
+        committedCount = std::max(committedCount, count);
+        committed.notify_all();
+
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+bool ChatLog::commit(const std::string& text, uint64_t textGeneration) {
+    // clear() 发生在取出之后，这批文本已被清空
+    if (textGeneration != generation) {
+        return true;
+    }
+    if (!segment.is_open()) {
+        return false;
+    }
+
+    static MetricHistogram& commitDuration = MetricsRegistry::getInstance().histogram(
+        "netlab_chat_commit_seconds", "Chat log group commit duration");
+    static MetricCounter& committedBytes = MetricsRegistry::getInstance().counter(
+        "netlab_chat_written_bytes_total", "Bytes appended to the chat log");
+    MetricTimer timer(commitDuration);
+    committedBytes.add(text.size());
+
+    segment.write(text.data(), static_cast<std::streamsize>(text.size()));
+    segment.flush();
+    segmentSize += text.size();
+
+    if (segmentBytes > 0 && segmentSize >= segmentBytes) {
+        rotateSegments();
+    }
+    return segment.good();
+}
+
+void ChatLog::rotateSegments() {
+    segment.close();
+
+    std::error_code ec;
+    if (maxSegments > 0) {
+        std::filesystem::remove(segmentPath(maxSegments), ec);
+        for (int i = maxSegments - 1; i >= 0; --i) {
+            if (std::filesystem::exists(segmentPath(i), ec)) {
+                std::filesystem::rename(segmentPath(i), segmentPath(i + 1), ec);
+            }
+        }
+    }
+
+    segment.open(segmentPath(0), std::ios::trunc | std::ios::binary);
+    segmentSize = 0;
+}
+
+std::string ChatLog::segmentPath(int index) const {
+    if (index == 0) {
+        return directory + "/chat_log.txt";
+    }
+    return directory + "/chat_log." + std::to_string(index) + ".txt";
+}
+
+size_t ChatLog::readTailLines(const std::string& path, size_t count, std::vector<std::string>& lines) {
+    if (count == 0) {
+        return 0;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    file.seekg(0, std::ios::end);
+    std::streamoff position = file.tellg();
+    if (position <= 0) {
+        return 0;
+    }
+
+    // 从末尾按块向前读，直到读到的换行符足够分出 count 行
+    std::vector<std::string> chunks;
+    size_t newlines = 0;
+    bool trailingNewline = false;
+    bool first = true;
+    while (position > 0 && newlines <= count) {
+        std::streamoff chunkSize = std::min<std::streamoff>(position, TAIL_CHUNK_BYTES);
+        position -= chunkSize;
+        std::string chunk(static_cast<size_t>(chunkSize), '\0');
+        file.seekg(position);
+        file.read(&chunk[0], chunkSize);
+        if (first) {
+            trailingNewline = !chunk.empty() && chunk.back() == '\n';
+            first = false;
+        }
+        newlines += static_cast<size_t>(std::count(chunk.begin(), chunk.end(), '\n'));
+        chunks.push_back(std::move(chunk));
+    }
+
+    std::string tail;
+    for (auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
+        tail += *it;
+    }
+    if (trailingNewline) {
+        tail.pop_back();
+    }
+
+    // 拆分为行，只保留最后 count 行（没有读到文件开头时第一行可能不完整，总会被舍弃）
+    std::vector<std::string> found;
+    size_t end = tail.size();
+    while (found.size() < count) {
+        size_t newline = tail.rfind('\n', end == 0 ? 0 : end - 1);
+        if (end == 0) {
+            break;
+        }
+        if (newline == std::string::npos) {
+            if (position == 0) {
+                found.push_back(tail.substr(0, end));
+            }
+            break;
+        }
+        found.push_back(tail.substr(newline + 1, end - newline - 1));
+        end = newline;
+    }
+
+    std::reverse(found.begin(), found.end());
+    lines.insert(lines.begin(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+    return found.size();
+}
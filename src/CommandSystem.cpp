@@ -1,8 +1,11 @@
 #include "CommandSystem.h"
+#include "Metrics.h"
 #include <sstream>
+#include <fstream>
 #include <algorithm>
 #include <iostream>
 #include <cctype>
+#include <cmath>
 
 // 默认管理员列表（可在配置中修改）
 const std::vector<std::pair<std::string, AdminLevel>> CommandSystem::DEFAULT_ADMINS = {
@@ -10,8 +13,8 @@ const std::vector<std::pair<std::string, AdminLevel>> CommandSystem::DEFAULT_ADM
     {"root", AdminLevel::ROOT}  // root 拥有最高权限
 };
 
-CommandSystem::CommandSystem(GameLogic& gameLogic, PlayerManager& playerManager)
-    : gameLogic_(gameLogic), playerManager_(playerManager) {
+CommandSystem::CommandSystem(RoomManager& roomManager, PlayerManager& playerManager)
+    : roomManager_(roomManager), playerManager_(playerManager) {
     RegisterCommands();
     
     // 添加默认管理员
@@ -26,28 +29,28 @@ CommandSystem::~CommandSystem() {
 
 void CommandSystem::RegisterCommands() {
     // 注册所有可用命令
-    RegisterCommand("give", 
-        [this](const auto& args, const auto& executor) { return HandleGive(args, executor); },
+    RegisterPlayerCommand("give", 
+        [this](const auto& args, auto& compiled) { return CompileGive(args, compiled); },
         "Give item to player", 
-        "give <player> <item> [count]",
+        "give <player|@selector> <item> [count]",
         AdminLevel::ADMIN);
         
-    RegisterCommand("tp", 
-        [this](const auto& args, const auto& executor) { return HandleTeleport(args, executor); },
+    RegisterPlayerCommand("tp", 
+        [this](const auto& args, auto& compiled) { return CompileTeleport(args, compiled); },
         "Teleport player", 
-        "tp <player> <x> <y> <z>",
+        "tp <player|@selector> <x> <y> <z>",
         AdminLevel::ADMIN);
         
-    RegisterCommand("kick", 
-        [this](const auto& args, const auto& executor) { return HandleKick(args, executor); },
+    RegisterPlayerCommand("kick", 
+        [this](const auto& args, auto& compiled) { return CompileKick(args, compiled); },
         "Kick player from game", 
-        "kick <player> [reason]",
+        "kick <player|@selector> [reason]",
         AdminLevel::MODERATOR);
         
-    RegisterCommand("kill", 
-        [this](const auto& args, const auto& executor) { return HandleKill(args, executor); },
+    RegisterPlayerCommand("kill", 
+        [this](const auto& args, auto& compiled) { return CompileKill(args, compiled); },
         "Kill player", 
-        "kill <player>",
+        "kill <player|@selector>",
         AdminLevel::MODERATOR);
         
     RegisterCommand("clear", 
@@ -56,16 +59,16 @@ void CommandSystem::RegisterCommands() {
         "clear",
         AdminLevel::SUPER_ADMIN);
         
-    RegisterCommand("coin", 
-        [this](const auto& args, const auto& executor) { return HandleCoin(args, executor); },
+    RegisterPlayerCommand("coin", 
+        [this](const auto& args, auto& compiled) { return CompileCoin(args, compiled); },
         "Set player coins", 
-        "coin <player> <amount>",
+        "coin <player|@selector> <amount>",
         AdminLevel::ADMIN);
         
     RegisterCommand("system", 
         [this](const auto& args, const auto& executor) { return HandleSystem(args, executor); },
-        "Send system message", 
-        "system <message>",
+        "Send system message or show server statistics", 
+        "system <message> | system stats",
         AdminLevel::MODERATOR);
         
     RegisterCommand("help", 
@@ -95,23 +98,40 @@ void CommandSystem::RegisterCommands() {
         [this](const auto& args, const auto& executor) { return HandleWhoami(args, executor); },
         "Show current user info and permissions", 
         "whoami");
+        
+    RegisterCommand("script", 
+        [this](const auto& args, const auto& executor) { return HandleScript(args, executor); },
+        "Run commands from a file (all lines checked first; give/tp/kick/kill/coin applied together in one task per room)", 
+        "script <file>",
+        AdminLevel::MODERATOR);
 }
 
 void CommandSystem::RegisterCommand(const std::string& name, CommandHandler handler, 
                                   const std::string& description, const std::string& usage, 
                                   AdminLevel requiredLevel) {
-    commandHandlers_[name] = handler;
+    commandHandlers_[name] = RegisteredCommand{handler, requiredLevel, nullptr};
+    commandsInfo_.emplace_back(name, description, usage, requiredLevel);
+}
+
+void CommandSystem::RegisterPlayerCommand(const std::string& name, CommandCompiler compiler,
+                                        const std::string& description, const std::string& usage,
+                                        AdminLevel requiredLevel) {
+    // 单独执行时：编译后立即在目标所在的房间上执行
+    CommandHandler handler = [this, compiler](const std::vector<std::string>& args, const std::string&) {
+        CompiledCommand compiled;
+        CommandResult result = compiler(args, compiled);
+        if (!result.success) {
+            return result;
+        }
+        return compiled.finish(ExecuteCompiled({&compiled})[0]);
+    };
+    commandHandlers_[name] = RegisteredCommand{handler, requiredLevel, compiler};
     commandsInfo_.emplace_back(name, description, usage, requiredLevel);
 }
 
 CommandResult CommandSystem::ExecuteCommand(const std::string& command, const std::string& executorId) {
     // 记录命令历史
-    commandHistory_.push_back("[" + executorId + "] " + command);
-    
-    // 限制历史记录大小
-    if (commandHistory_.size() > 1000) {
-        commandHistory_.erase(commandHistory_.begin());
-    }
+    RecordHistory("[" + executorId + "] " + command);
     
     // 解析命令
     std::vector<std::string> args = ParseCommand(command);
@@ -119,31 +139,134 @@ CommandResult CommandSystem::ExecuteCommand(const std::string& command, const st
         return CommandResult(false, "Empty command");
     }
     
+    return Dispatch(args, command, executorId);
+}
+
+CommandResult CommandSystem::ExecuteScript(const std::string& path, const std::string& executorId) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return CommandResult(false, "Cannot open script: " + path);
+    }
+    
+    struct ScriptLine {
+        int number;
+        std::string text;
+        std::vector<std::string> args;
+        bool compiled;
+        CompiledCommand command;
+    };
+    
+    // 第一遍：解析并检查所有行，作用于玩家的命令编译为房间操作；有任何错误时不执行
+    const RegisteredCommand* scriptCommand = &commandHandlers_.at("script");
+    std::vector<ScriptLine> lines;
+    std::string errors;
+    std::string line;
+    int number = 0;
+    while (std::getline(file, line)) {
+        number++;
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') {
+            continue;
+        }
+        size_t end = line.find_last_not_of(" \t\r");
+        std::string text = line.substr(begin, end - begin + 1);
+        
+        ScriptLine scriptLine{number, text, ParseCommand(text), false, CompiledCommand()};
+        std::string error;
+        const RegisteredCommand* resolved = ResolveCommand(scriptLine.args, executorId, error);
+        if (resolved == scriptCommand) {
+            error = "Nested scripts are not allowed";
+        } else if (resolved && resolved->compiler) {
+            try {
+                CommandResult result = resolved->compiler(scriptLine.args, scriptLine.command);
+                if (!result.success) {
+                    error = result.message;
+                }
+            } catch (const std::exception& e) {
+                error = "Invalid arguments: " + std::string(e.what());
+            }
+            scriptLine.compiled = true;
+        }
+        if (!error.empty()) {
+            errors += "\n  line " + std::to_string(number) + ": " + error;
+            continue;
+        }
+        lines.push_back(std::move(scriptLine));
+    }
+    if (!errors.empty()) {
+        return CommandResult(false, "Script " + path + " not executed:" + errors);
+    }
+    
+    // 第二遍：所有房间操作一次提交，每个房间一个任务按脚本顺序执行（在两帧之间一起生效）
+    std::vector<const CompiledCommand*> compiled;
+    for (const ScriptLine& scriptLine : lines) {
+        if (scriptLine.compiled) {
+            compiled.push_back(&scriptLine.command);
+        }
+    }
+    std::vector<std::vector<std::string>> affected = ExecuteCompiled(compiled);
+    
+    // 第三遍：按行生成结果，其余命令（system、admin、clear等）在房间操作之后依次执行；失败的命令不影响后续命令
+    size_t succeeded = 0;
+    size_t compiledIndex = 0;
+    std::string failures;
+    for (const ScriptLine& scriptLine : lines) {
+        CommandResult result;
+        if (scriptLine.compiled) {
+            result = scriptLine.command.finish(affected[compiledIndex++]);
+            Logger::getInstance().logCommand(executorId, scriptLine.text, "", result.success);
+        } else {
+            result = Dispatch(scriptLine.args, scriptLine.text, executorId);
+        }
+        if (result.success) {
+            succeeded++;
+        } else {
+            failures += "\n  line " + std::to_string(scriptLine.number) + ": " + result.message;
+        }
+    }
+    
+    return CommandResult(failures.empty(), "Script " + path + ": " + std::to_string(succeeded) + "/" +
+                         std::to_string(lines.size()) + " commands succeeded" + failures);
+}
+
+const CommandSystem::RegisteredCommand* CommandSystem::ResolveCommand(const std::vector<std::string>& args,
+                                                                      const std::string& executorId,
+                                                                      std::string& error) const {
+    if (args.empty()) {
+        error = "Empty command";
+        return nullptr;
+    }
+    
     std::string commandName = args[0];
     std::transform(commandName.begin(), commandName.end(), commandName.begin(), ::tolower);
     
     // 查找命令处理器
     auto it = commandHandlers_.find(commandName);
     if (it == commandHandlers_.end()) {
-        return CommandResult(false, "Unknown command: " + commandName);
+        error = "Unknown command: " + commandName;
+        return nullptr;
     }
     
     // 检查权限
-    AdminLevel requiredLevel = AdminLevel::NONE;
-    for (const auto& cmdInfo : commandsInfo_) {
-        if (cmdInfo.name == commandName) {
-            requiredLevel = cmdInfo.requiredLevel;
-            break;
-        }
+    if (!CheckPermission(executorId, it->second.requiredLevel)) {
+        error = "Insufficient permissions for " + commandName + " command";
+        return nullptr;
     }
     
-    if (!CheckPermission(executorId, requiredLevel)) {
-        return CommandResult(false, "Insufficient permissions for " + commandName + " command");
+    return &it->second;
+}
+
+CommandResult CommandSystem::Dispatch(const std::vector<std::string>& args, const std::string& command,
+                                      const std::string& executorId) {
+    std::string error;
+    const RegisteredCommand* registered = ResolveCommand(args, executorId, error);
+    if (!registered) {
+        return CommandResult(false, error);
     }
     
     // 执行命令
     try {
-        CommandResult result = it->second(args, executorId);
+        CommandResult result = registered->handler(args, executorId);
         
         // 记录命令执行结果
         Logger::getInstance().logCommand(executorId, command, "", result.success);
@@ -156,6 +279,33 @@ CommandResult CommandSystem::ExecuteCommand(const std::string& command, const st
     }
 }
 
+void CommandSystem::RecordHistory(const std::string& entry) {
+    if (commandHistory_.size() < MAX_HISTORY) {
+        commandHistory_.push_back(entry);
+    } else {
+        commandHistory_[historyNext_] = entry;
+    }
+    historyNext_ = (historyNext_ + 1) % MAX_HISTORY;
+}
+
+std::vector<std::string> CommandSystem::GetCommandHistory() const {
+    if (commandHistory_.size() < MAX_HISTORY) {
+        return commandHistory_;
+    }
+    
+    // 写满后 historyNext_ 指向最旧的条目
+    std::vector<std::string> history;
+    history.reserve(commandHistory_.size());
+    history.insert(history.end(), commandHistory_.begin() + historyNext_, commandHistory_.end());
+    history.insert(history.end(), commandHistory_.begin(), commandHistory_.begin() + historyNext_);
+    return history;
+}
+
+void CommandSystem::ClearCommandHistory() {
+    commandHistory_.clear();
+    historyNext_ = 0;
+}
+
 bool CommandSystem::CheckPermission(const std::string& playerId, AdminLevel requiredLevel) const {
     // 不需要权限的命令任何人都可以执行
     if (requiredLevel == AdminLevel::NONE) {
@@ -204,48 +354,59 @@ std::vector<std::string> CommandSystem::ParseCommand(const std::string& command)
 
 // ==================== 命令实现 ====================
 
-CommandResult CommandSystem::HandleGive(const std::vector<std::string>& args, const std::string& executorId) {
+CommandResult CommandSystem::CompileGive(const std::vector<std::string>& args, CompiledCommand& out) {
     if (args.size() < 3) {
-        return CommandResult(false, "Usage: give <player> <item> [count]");
+        return CommandResult(false, "Usage: give <player|@selector> <item> [count]");
     }
     
-    std::string playerId = args[1];
-    if (!IsValidPlayer(playerId)) {
-        return CommandResult(false, "Invalid player: " + playerId);
+    std::string error;
+    if (!ParseTarget(args[1], out.target, error)) {
+        return CommandResult(false, error);
     }
     
     ItemType item = ParseItemType(args[2]);
     int count = (args.size() > 3) ? std::stoi(args[3]) : 1;
+    TargetSelector target = out.target;
     
     if (item == ItemType::COIN) {
-        // 特殊处理金币
-        PlayerData data = playerManager_.GetPlayerData(playerId);
-        data.totalCoins += count;
-        playerManager_.UpdatePlayerData(playerId, data);
-        return CommandResult(true, "Gave " + std::to_string(count) + " coins to player " + playerId);
+        // 特殊处理金币：只修改持久化数据，房间任务只用于确定目标
+        out.action = [](GameLogic&, int) { return true; };
+        out.finish = [this, target, count](const std::vector<std::string>& targets) {
+            for (const std::string& playerId : targets) {
+                PlayerData data = playerManager_.GetPlayerData(playerId);
+                data.totalCoins += count;
+                playerManager_.UpdatePlayerData(playerId, data);
+            }
+            if (targets.empty()) {
+                return CommandResult(false, "Failed to give coins to " + DescribeTargets(target, 0));
+            }
+            return CommandResult(true, "Gave " + std::to_string(count) + " coins to " + DescribeTargets(target, targets.size()));
+        };
     } else {
         // 使用扩展的GameLogic功能给予道具
-        int playerIdInt = ConvertPlayerIdToInt(playerId);
-        if (playerIdInt == -1) {
-            return CommandResult(false, "Invalid player ID format: " + playerId);
-        }
-        if (gameLogic_.GiveItem(playerIdInt, item, count)) {
-            return CommandResult(true, "Gave " + std::to_string(count) + " " + 
-                                ItemTypeToString(item) + " to player " + playerId);
-        } else {
-            return CommandResult(false, "Failed to give item to player " + playerId);
-        }
+        out.action = [item, count](GameLogic& gameLogic, int clientId) {
+            return gameLogic.GiveItem(clientId, item, count);
+        };
+        out.finish = [this, target, item, count](const std::vector<std::string>& given) {
+            if (!given.empty()) {
+                return CommandResult(true, "Gave " + std::to_string(count) + " " + 
+                                    ItemTypeToString(item) + " to " + DescribeTargets(target, given.size()));
+            } else {
+                return CommandResult(false, "Failed to give item to " + DescribeTargets(target, 0));
+            }
+        };
     }
+    return CommandResult(true);
 }
 
-CommandResult CommandSystem::HandleTeleport(const std::vector<std::string>& args, const std::string& executorId) {
+CommandResult CommandSystem::CompileTeleport(const std::vector<std::string>& args, CompiledCommand& out) {
     if (args.size() < 5) {
-        return CommandResult(false, "Usage: tp <player> <x> <y> <z>");
+        return CommandResult(false, "Usage: tp <player|@selector> <x> <y> <z>");
     }
     
-    std::string playerId = args[1];
-    if (!IsValidPlayer(playerId)) {
-        return CommandResult(false, "Invalid player: " + playerId);
+    std::string error;
+    if (!ParseTarget(args[1], out.target, error)) {
+        return CommandResult(false, error);
     }
     
     float x, y, z;
@@ -254,97 +415,119 @@ CommandResult CommandSystem::HandleTeleport(const std::vector<std::string>& args
     }
     
     // 使用扩展的GameLogic功能传送玩家
-    int playerIdInt = ConvertPlayerIdToInt(playerId);
-    if (playerIdInt == -1) {
-        return CommandResult(false, "Invalid player ID format: " + playerId);
-    }
-    if (gameLogic_.TeleportPlayer(playerIdInt, x, y, z)) {
-        return CommandResult(true, "Teleported player " + playerId + " to (" + 
-                            std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ")");
-    } else {
-        return CommandResult(false, "Failed to teleport player " + playerId + " - invalid position");
-    }
+    out.action = [x, y, z](GameLogic& gameLogic, int clientId) {
+        return gameLogic.TeleportPlayer(clientId, x, y, z);
+    };
+    out.finish = [target = out.target, x, y, z](const std::vector<std::string>& teleported) {
+        if (!teleported.empty()) {
+            return CommandResult(true, "Teleported " + DescribeTargets(target, teleported.size()) + " to (" + 
+                                std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(z) + ")");
+        } else {
+            return CommandResult(false, "Failed to teleport " + DescribeTargets(target, 0) + " - invalid position");
+        }
+    };
+    return CommandResult(true);
 }
 
-CommandResult CommandSystem::HandleKick(const std::vector<std::string>& args, const std::string& executorId) {
+CommandResult CommandSystem::CompileKick(const std::vector<std::string>& args, CompiledCommand& out) {
     if (args.size() < 2) {
-        return CommandResult(false, "Usage: kick <player> [reason]");
+        return CommandResult(false, "Usage: kick <player|@selector> [reason]");
     }
     
-    std::string playerId = args[1];
-    if (!IsValidPlayer(playerId)) {
-        return CommandResult(false, "Invalid player: " + playerId);
+    std::string error;
+    if (!ParseTarget(args[1], out.target, error)) {
+        return CommandResult(false, error);
     }
     
     std::string reason = (args.size() > 2) ? args[2] : "No reason specified";
     
-    // 踢出玩家逻辑
-    playerManager_.LogoutPlayer(playerId);
-    
-    return CommandResult(true, "Kicked player " + playerId + ": " + reason);
+    // 踢出玩家逻辑：房间任务只用于确定目标，单个玩家即使不在房间中也踢出
+    out.action = [](GameLogic&, int) { return true; };
+    out.finish = [this, target = out.target, reason](const std::vector<std::string>& selected) {
+        std::vector<std::string> kicked = selected;
+        if (target.kind == TargetSelector::Kind::PLAYER) {
+            kicked.assign(1, target.playerId);
+        }
+        for (const std::string& playerId : kicked) {
+            playerManager_.LogoutPlayer(playerId);
+        }
+        return CommandResult(true, "Kicked " + DescribeTargets(target, kicked.size()) + ": " + reason);
+    };
+    return CommandResult(true);
 }
 
-CommandResult CommandSystem::HandleKill(const std::vector<std::string>& args, const std::string& executorId) {
+CommandResult CommandSystem::CompileKill(const std::vector<std::string>& args, CompiledCommand& out) {
     if (args.size() < 2) {
-        return CommandResult(false, "Usage: kill <player>");
+        return CommandResult(false, "Usage: kill <player|@selector>");
     }
     
-    std::string playerId = args[1];
-    if (!IsValidPlayer(playerId)) {
-        return CommandResult(false, "Invalid player: " + playerId);
+    std::string error;
+    if (!ParseTarget(args[1], out.target, error)) {
+        return CommandResult(false, error);
     }
     
     // 使用扩展的GameLogic功能杀死玩家
-    int playerIdInt = ConvertPlayerIdToInt(playerId);
-    if (playerIdInt == -1) {
-        return CommandResult(false, "Invalid player ID format: " + playerId);
-    }
-    if (gameLogic_.KillPlayer(playerIdInt)) {
-        return CommandResult(true, "Killed player " + playerId);
-    } else {
-        return CommandResult(false, "Failed to kill player " + playerId);
-    }
+    out.action = [](GameLogic& gameLogic, int clientId) {
+        return gameLogic.KillPlayer(clientId);
+    };
+    out.finish = [target = out.target](const std::vector<std::string>& killed) {
+        if (!killed.empty()) {
+            return CommandResult(true, "Killed " + DescribeTargets(target, killed.size()));
+        } else {
+            return CommandResult(false, "Failed to kill " + DescribeTargets(target, 0));
+        }
+    };
+    return CommandResult(true);
 }
 
 CommandResult CommandSystem::HandleClear(const std::vector<std::string>& args, const std::string& executorId) {
-    // 重置游戏状态
-    gameLogic_.ResetGameState();
+    // 重置所有房间的游戏状态
+    int rooms = roomManager_.ExecuteAll([](Room& room) { room.GetGameLogic().ResetGameState(); });
     
-    return CommandResult(true, "Game state cleared and reset");
+    return CommandResult(true, "Game state cleared and reset in " + std::to_string(rooms) + " room(s)");
 }
 
-CommandResult CommandSystem::HandleCoin(const std::vector<std::string>& args, const std::string& executorId) {
+CommandResult CommandSystem::CompileCoin(const std::vector<std::string>& args, CompiledCommand& out) {
     if (args.size() < 3) {
-        return CommandResult(false, "Usage: coin <player> <amount>");
+        return CommandResult(false, "Usage: coin <player|@selector> <amount>");
     }
     
-    std::string playerId = args[1];
-    if (!IsValidPlayer(playerId)) {
-        return CommandResult(false, "Invalid player: " + playerId);
+    std::string error;
+    if (!ParseTarget(args[1], out.target, error)) {
+        return CommandResult(false, error);
     }
     
     int amount = std::stoi(args[2]);
     
     // 使用扩展的GameLogic功能设置金币
-    int playerIdInt = ConvertPlayerIdToInt(playerId);
-    if (playerIdInt == -1) {
-        return CommandResult(false, "Invalid player ID format: " + playerId);
-    }
-    if (gameLogic_.SetPlayerCoins(playerIdInt, amount)) {
-        // 同时更新持久化数据
-        PlayerData data = playerManager_.GetPlayerData(playerId);
-        data.totalCoins = amount;
-        playerManager_.UpdatePlayerData(playerId, data);
-        
-        return CommandResult(true, "Set coins to " + std::to_string(amount) + " for player " + playerId);
-    } else {
-        return CommandResult(false, "Failed to set coins for player " + playerId);
-    }
+    out.action = [amount](GameLogic& gameLogic, int clientId) {
+        return gameLogic.SetPlayerCoins(clientId, amount);
+    };
+    out.finish = [this, target = out.target, amount](const std::vector<std::string>& updated) {
+        if (!updated.empty()) {
+            // 同时更新持久化数据
+            for (const std::string& playerId : updated) {
+                PlayerData data = playerManager_.GetPlayerData(playerId);
+                data.totalCoins = amount;
+                playerManager_.UpdatePlayerData(playerId, data);
+            }
+            
+            return CommandResult(true, "Set coins to " + std::to_string(amount) + " for " + DescribeTargets(target, updated.size()));
+        } else {
+            return CommandResult(false, "Failed to set coins for " + DescribeTargets(target, 0));
+        }
+    };
+    return CommandResult(true);
 }
 
 CommandResult CommandSystem::HandleSystem(const std::vector<std::string>& args, const std::string& executorId) {
     if (args.size() < 2) {
-        return CommandResult(false, "Usage: system <message>");
+        return CommandResult(false, "Usage: system <message> | system stats");
+    }
+    
+    // system stats：输出运行指标摘要
+    if (args.size() == 2 && args[1] == "stats") {
+        return CommandResult(true, MetricsRegistry::getInstance().renderSummary());
     }
     
     // 组合消息（支持空格）
@@ -414,14 +597,15 @@ CommandResult CommandSystem::HandleAdmin(const std::vector<std::string>& args, c
 }
 
 CommandResult CommandSystem::HandleListPlayers(const std::vector<std::string>& args, const std::string& executorId) {
-    auto onlinePlayers = playerManager_.GetOnlinePlayers();
-    if (onlinePlayers.empty()) {
+    // 一次取得在线玩家及其数据的快照，不逐个查询
+    PlayerManager::OnlineSnapshot onlinePlayers = playerManager_.GetOnlineSnapshot();
+    if (onlinePlayers->empty()) {
         return CommandResult(true, "No players online");
     }
     
-    std::string result = "Online players (" + std::to_string(onlinePlayers.size()) + "):\n";
-    for (const auto& playerId : onlinePlayers) {
-        PlayerData data = playerManager_.GetPlayerData(playerId);
+    std::string result = "Online players (" + std::to_string(onlinePlayers->size()) + "):\n";
+    for (const PlayerData& data : *onlinePlayers) {
+        const std::string& playerId = data.playerId;
         result += "  " + playerId + " - Coins: " + std::to_string(data.totalCoins) + 
                  ", Games: " + std::to_string(data.gamesPlayed);
         
@@ -437,8 +621,8 @@ CommandResult CommandSystem::HandleListPlayers(const std::vector<std::string>& a
 }
 
 CommandResult CommandSystem::HandleRestart(const std::vector<std::string>& args, const std::string& executorId) {
-    // 重置游戏状态
-    gameLogic_.ResetGameState();
+    // 重置所有房间的游戏状态
+    roomManager_.ExecuteAll([](Room& room) { room.GetGameLogic().ResetGameState(); });
     
     // TODO : 添加更复杂的重启逻辑，比如重新生成迷宫等
     // 目前只是重置玩家状态和游戏进度
@@ -465,6 +649,13 @@ CommandResult CommandSystem::HandleWhoami(const std::vector<std::string>& args,
     return CommandResult(true, result);
 }
 
+CommandResult CommandSystem::HandleScript(const std::vector<std::string>& args, const std::string& executorId) {
+    if (args.size() < 2) {
+        return CommandResult(false, "Usage: script <file>");
+    }
+    return ExecuteScript(args[1], executorId);
+}
+
 // ==================== 工具函数 ====================
 
 ItemType CommandSystem::ParseItemType(const std::string& itemStr) {
@@ -514,12 +705,117 @@ bool CommandSystem::IsValidPlayer(const std::string& playerId) {
     return playerManager_.IsSessionValid(playerId);
 }
 
-int CommandSystem::ConvertPlayerIdToInt(const std::string& playerId) {
-    try {
-        return std::stoi(playerId);
-    } catch (const std::exception&) {
-        return -1; // 无效的玩家ID
+bool CommandSystem::ParseTarget(const std::string& text, TargetSelector& selector, std::string& error) {
+    selector = TargetSelector();
+    selector.text = text;
+    
+    if (text.empty() || text[0] != '@') {
+        if (!IsValidPlayer(text)) {
+            error = "Invalid player: " + text;
+            return false;
+        }
+        selector.kind = TargetSelector::Kind::PLAYER;
+        selector.playerId = text;
+        return true;
+    }
+    
+    if (text == "@a") {
+        selector.kind = TargetSelector::Kind::ALL;
+        return true;
+    }
+    
+    // @room:<id> / @layer:<n>
+    size_t colon = text.find(':');
+    std::string name = text.substr(1, colon == std::string::npos ? std::string::npos : colon - 1);
+    if (colon != std::string::npos && (name == "room" || name == "layer")) {
+        try {
+            size_t parsed = 0;
+            selector.value = std::stoi(text.substr(colon + 1), &parsed);
+            if (parsed == text.size() - colon - 1) {
+                selector.kind = name == "room" ? TargetSelector::Kind::ROOM : TargetSelector::Kind::LAYER;
+                return true;
+            }
+        } catch (const std::exception&) {
+        }
+    }
+    
+    error = "Invalid selector: " + text + " (use @a, @room:<id> or @layer:<n>)";
+    return false;
+}
+
+std::vector<RoomPlayer> CommandSystem::SelectPlayers(const TargetSelector& selector) const {
+    std::vector<RoomPlayer> players;
+    if (selector.kind == TargetSelector::Kind::PLAYER) {
+        RoomPlayer player;
+        player.playerId = selector.playerId;
+        if (roomManager_.FindPlayer(selector.playerId, player.roomId, player.clientId)) {
+            players.push_back(std::move(player));
+        }
+        return players;
+    }
+    
+    players = roomManager_.GetPlayers();
+    if (selector.kind == TargetSelector::Kind::ROOM) {
+        players.erase(std::remove_if(players.begin(), players.end(),
+                                     [&selector](const RoomPlayer& player) { return player.roomId != selector.value; }),
+                      players.end());
+    }
+    return players;
+}
+
+std::vector<std::vector<std::string>> CommandSystem::ExecuteCompiled(const std::vector<const CompiledCommand*>& commands) {
+    // 按房间分组，每个房间一个任务；房间内按命令顺序排列
+    std::map<int, std::vector<std::pair<size_t, RoomPlayer>>> playersByRoom;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        for (RoomPlayer& player : SelectPlayers(commands[i]->target)) {
+            playersByRoom[player.roomId].emplace_back(i, std::move(player));
+        }
+    }
+    
+    // 每个房间单独记录结果，并行的任务不写同一个vector
+    std::vector<std::vector<std::vector<std::string>>> affectedByRoom(
+        playersByRoom.size(), std::vector<std::vector<std::string>>(commands.size()));
+    std::vector<std::pair<int, Room::Task>> tasks;
+    tasks.reserve(playersByRoom.size());
+    size_t index = 0;
+    for (const auto& pair : playersByRoom) {
+        const std::vector<std::pair<size_t, RoomPlayer>>& players = pair.second;
+        std::vector<std::vector<std::string>>& result = affectedByRoom[index++];
+        tasks.emplace_back(pair.first, [&commands, &players, &result](Room& room) {
+            GameLogic& gameLogic = room.GetGameLogic();
+            for (const auto& [command, player] : players) {
+                const TargetSelector& selector = commands[command]->target;
+                if (selector.kind == TargetSelector::Kind::LAYER) {
+                    // 层号与世界坐标y一致；按执行时的位置过滤，能看到同一脚本中之前的传送
+                    PlayerView view = gameLogic.GetPlayerView(player.clientId);
+                    if (!view.valid() || static_cast<int>(std::round(view.y())) != selector.value) {
+                        continue;
+                    }
+                }
+                if (commands[command]->action(gameLogic, player.clientId)) {
+                    result[command].push_back(player.playerId);
+                }
+            }
+        });
+    }
+    if (!tasks.empty()) {
+        roomManager_.ExecuteMany(tasks);
+    }
+    
+    std::vector<std::vector<std::string>> playerIds(commands.size());
+    for (std::vector<std::vector<std::string>>& roomResult : affectedByRoom) {
+        for (size_t i = 0; i < commands.size(); ++i) {
+            playerIds[i].insert(playerIds[i].end(), roomResult[i].begin(), roomResult[i].end());
+        }
+    }
+    return playerIds;
+}
+
+std::string CommandSystem::DescribeTargets(const TargetSelector& selector, size_t affected) {
+    if (selector.kind == TargetSelector::Kind::PLAYER) {
+        return "player " + selector.playerId;
     }
+    return std::to_string(affected) + " player(s) matching " + selector.text;
 }
 
 std::string CommandSystem::AdminLevelToString(AdminLevel level) const {
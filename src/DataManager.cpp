@@ -1,11 +1,14 @@
 #include "DataManager.h"
 #include "PlayerManager.h"
 #include "GameLogic.h"
-#include "MazeGenerator.h"
+#include "MazeGrid.h"
+#include "MazeFile.h"
+#include "Metrics.h"
 #include <iostream>
 #include <filesystem>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 // nlohmann/json头文件包含
 // 如果使用系统包管理器安装，通常直接包含
@@ -54,9 +57,7 @@ DataManager::DataManager() : dataPath_("./Data/") {
 }
 
 DataManager::~DataManager() {
-    if (chatLogStream_.is_open()) {
-        chatLogStream_.close();
-    }
+    chatLog_.close();
 }
 
 bool DataManager::Initialize(const std::string& dataPath) {
@@ -68,14 +69,6 @@ bool DataManager::Initialize(const std::string& dataPath) {
         return false;
     }
     
-    // 打开聊天日志文件（追加模式）
-    std::string chatLogPath = BuildFilePath("chat_log.txt");
-    chatLogStream_.open(chatLogPath, std::ios::app);
-    if (!chatLogStream_.is_open()) {
-        std::cerr << "Failed to open chat log file: " << chatLogPath << std::endl;
-        return false;
-    }
-    
     // 如果配置文件不存在，创建默认配置
     std::string configPath = BuildFilePath("config.json");
     if (!std::filesystem::exists(configPath)) {
@@ -85,6 +78,17 @@ bool DataManager::Initialize(const std::string& dataPath) {
         }
     }
     
+    // 打开聊天日志，内存中保留的条数来自配置
+    json config;
+    int maxChatHistory = defaultConfig_["game"]["max_chat_history"];
+    if (LoadConfig(config) && config.contains("game") && config["game"].is_object()) {
+        maxChatHistory = config["game"].value("max_chat_history", maxChatHistory);
+    }
+    if (!chatLog_.open(dataPath_, static_cast<size_t>(std::max(maxChatHistory, 0)))) {
+        std::cerr << "Failed to open chat log file: " << BuildFilePath("chat_log.txt") << std::endl;
+        return false;
+    }
+    
     std::cout << "DataManager initialized successfully. Data path: " << dataPath_ << std::endl;
     return true;
 }
@@ -175,31 +179,44 @@ bool DataManager::LoadAllPlayersData(std::map<std::string, PlayerData>& players)
     return true;
 }
 
-bool DataManager::SaveMazeData(const std::vector<std::vector<std::vector<bool>>>& mazeLayout,
-                              const std::vector<std::tuple<int, int, int>>& coinPositions,
-                              const std::tuple<int, int, int>& startPos,
-                              const std::tuple<int, int, int>& endPos) {
-    json j = MazeDataToJson(mazeLayout, coinPositions, startPos, endPos);
-    std::string mazePath = BuildFilePath("maze_data.json");
-    return WriteJsonToFile(j, mazePath);
+bool DataManager::SaveMazeData(const MazeGrid& maze, uint64_t seed) {
+    std::string mazePath = BuildFilePath("maze_data.bin");
+    if (!saveMazeFile(mazePath, maze, seed)) {
+        std::cerr << "Failed to write maze file: " << mazePath << std::endl;
+        return false;
+    }
+    return true;
 }
 
-bool DataManager::LoadMazeData(std::vector<std::vector<std::vector<bool>>>& mazeLayout,
-                              std::vector<std::tuple<int, int, int>>& coinPositions,
-                              std::tuple<int, int, int>& startPos,
-                              std::tuple<int, int, int>& endPos) {
-    std::string mazePath = BuildFilePath("maze_data.json");
+bool DataManager::LoadMazeData(MazeGrid& maze, uint64_t* seed) {
+    std::string mazePath = BuildFilePath("maze_data.bin");
+    if (std::filesystem::exists(mazePath)) {
+        MazeFileInfo info;
+        if (!loadMazeFile(mazePath, maze, &info)) {
+            std::cerr << "Invalid or corrupted maze file: " << mazePath << std::endl;
+            return false;
+        }
+        if (seed) {
+            *seed = info.seed;
+        }
+        return true;
+    }
     
-    if (!std::filesystem::exists(mazePath)) {
+    // 旧版JSON数据：读取后转换为二进制文件
+    std::string legacyPath = BuildFilePath("maze_data.json");
+    if (!std::filesystem::exists(legacyPath)) {
         return false;
     }
     
     json j;
-    if (!ReadJsonFromFile(j, mazePath)) {
+    if (!ReadJsonFromFile(j, legacyPath) || !JsonToMazeData(j, maze)) {
         return false;
     }
-    
-    return JsonToMazeData(j, mazeLayout, coinPositions, startPos, endPos);
+    if (seed) {
+        *seed = 0;
+    }
+    SaveMazeData(maze);
+    return true;
 }
 
 bool DataManager::SaveConfig(const json& config) {
@@ -219,61 +236,18 @@ bool DataManager::LoadConfig(json& config) {
 }
 
 bool DataManager::AppendChatLog(const std::string& playerName, const std::string& message) {
-    if (!chatLogStream_.is_open()) {
-        return false;
-    }
-    
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "[%Y-%m-%d %H:%M:%S]");
-    ss << " [" << playerName << "]: " << message << "\n";
-    
-    chatLogStream_ << ss.str();
-    chatLogStream_.flush();
-    
-    return chatLogStream_.good();
+    return chatLog_.append(playerName, message);
 }
 
 std::vector<std::string> DataManager::GetChatLog(int maxLines) {
-    std::vector<std::string> chatLines;
-    std::string chatPath = BuildFilePath("chat_log.txt");
-    
-    if (!std::filesystem::exists(chatPath)) {
-        return chatLines;
+    if (maxLines <= 0) {
+        return std::vector<std::string>();
     }
-    
-    std::ifstream file(chatPath);
-    if (!file.is_open()) {
-        return chatLines;
-    }
-    
-    std::string line;
-    std::vector<std::string> allLines;
-    
-    while (std::getline(file, line)) {
-        allLines.push_back(line);
-    }
-    
-    // 返回最新的maxLines行
-    int startIndex = std::max(0, static_cast<int>(allLines.size()) - maxLines);
-    for (int i = startIndex; i < allLines.size(); ++i) {
-        chatLines.push_back(allLines[i]);
-    }
-    
-    return chatLines;
+    return chatLog_.recent(static_cast<size_t>(maxLines));
 }
 
 bool DataManager::ClearChatLog() {
-    if (chatLogStream_.is_open()) {
-        chatLogStream_.close();
-    }
-    
-    std::string chatPath = BuildFilePath("chat_log.txt");
-    chatLogStream_.open(chatPath, std::ios::trunc);
-    
-    return chatLogStream_.is_open();
+    return chatLog_.clear();
 }
 
 bool DataManager::CreateBackup() {
@@ -303,8 +277,8 @@ bool DataManager::CreateBackup() {
     }
     
     // 备份迷宫数据
-    std::string mazePath = BuildFilePath("maze_data.json");
-    std::string backupMazePath = backupDir + backupName.str() + "_maze.json";
+    std::string mazePath = BuildFilePath("maze_data.bin");
+    std::string backupMazePath = backupDir + backupName.str() + "_maze.bin";
     if (std::filesystem::exists(mazePath)) {
         std::filesystem::copy_file(mazePath, backupMazePath);
     }
@@ -349,69 +323,52 @@ bool DataManager::JsonToPlayerData(const json& j, PlayerData& data) {
     }
 }
 
-json DataManager::MazeDataToJson(const std::vector<std::vector<std::vector<bool>>>& mazeLayout,
-                                const std::vector<std::tuple<int, int, int>>& coinPositions,
-                                const std::tuple<int, int, int>& startPos,
-                                const std::tuple<int, int, int>& endPos) {
-    json j;
-    
-    // 序列化迷宫布局
-    j["maze_layout"] = json::array();
-    for (const auto& layer : mazeLayout) {
-        json layerJson = json::array();
-        for (const auto& row : layer) {
-            json rowJson = json::array();
-            for (bool cell : row) {
-                rowJson.push_back(cell);
-            }
-            layerJson.push_back(rowJson);
-        }
-        j["maze_layout"].push_back(layerJson);
-    }
-    
-    // 序列化金币位置
-    j["coin_positions"] = json::array();
-    for (const auto& coin : coinPositions) {
-        json coinJson = json::array({std::get<0>(coin), std::get<1>(coin), std::get<2>(coin)});
-        j["coin_positions"].push_back(coinJson);
-    }
-    
-    // 序列化起点和终点
-    j["start_position"] = json::array({std::get<0>(startPos), std::get<1>(startPos), std::get<2>(startPos)});
-    j["end_position"] = json::array({std::get<0>(endPos), std::get<1>(endPos), std::get<2>(endPos)});
-    
-    return j;
-}
-
-bool DataManager::JsonToMazeData(const json& j, 
-                                std::vector<std::vector<std::vector<bool>>>& mazeLayout,
-                                std::vector<std::tuple<int, int, int>>& coinPositions,
-                                std::tuple<int, int, int>& startPos,
-                                std::tuple<int, int, int>& endPos) {
+bool DataManager::JsonToMazeData(const json& j, MazeGrid& maze) {
     try {
-        // 反序列化迷宫布局
-        mazeLayout.clear();
-        for (const auto& layerJson : j["maze_layout"]) {
-            std::vector<std::vector<bool>> layer;
-            for (const auto& rowJson : layerJson) {
-                std::vector<bool> row;
-                for (bool cell : rowJson) {
-                    row.push_back(cell);
+        if (j.contains("maze_cells")) {
+            int width = j["maze_size"][0];
+            int height = j["maze_size"][1];
+            int layers = j["maze_size"][2];
+            const std::string& cells = j["maze_cells"].get_ref<const std::string&>();
+            
+            maze.reset(width, height, layers);
+            if (maze.empty() || cells.size() != maze.getCellCount()) {
+                std::cerr << "Error converting JSON to MazeData: invalid maze size" << std::endl;
+                return false;
+            }
+            for (size_t i = 0; i < cells.size(); ++i) {
+                int type = cells[i] - '0';
+                if (type < static_cast<int>(CellType::WALL) || type > static_cast<int>(CellType::END)) {
+                    std::cerr << "Error converting JSON to MazeData: invalid cell type" << std::endl;
+                    return false;
                 }
-                layer.push_back(row);
+                maze.setCellAt(i, static_cast<CellType>(type));
             }
-            mazeLayout.push_back(layer);
+            return true;
         }
         
-        // 反序列化金币位置
-        coinPositions.clear();
-        for (const auto& coinJson : j["coin_positions"]) {
-            coinPositions.emplace_back(coinJson[0], coinJson[1], coinJson[2]);
+        // 旧格式：maze_layout[层][行][列] 为是否是墙壁，起点终点单独保存
+        const json& layout = j["maze_layout"];
+        int layers = static_cast<int>(layout.size());
+        int height = layers > 0 ? static_cast<int>(layout[0].size()) : 0;
+        int width = height > 0 ? static_cast<int>(layout[0][0].size()) : 0;
+        
+        maze.reset(width, height, layers);
+        if (maze.empty()) {
+            return false;
+        }
+        for (int z = 0; z < layers; ++z) {
+            for (int y = 0; y < height && y < static_cast<int>(layout[z].size()); ++y) {
+                for (int x = 0; x < width && x < static_cast<int>(layout[z][y].size()); ++x) {
+                    maze.setCell(x, y, z, layout[z][y][x].get<bool>() ? CellType::WALL : CellType::PATH);
+                }
+            }
         }
         
-        // 反序列化起点和终点
-        startPos = {j["start_position"][0], j["start_position"][1], j["start_position"][2]};
-        endPos = {j["end_position"][0], j["end_position"][1], j["end_position"][2]};
+        const json& start = j["start_position"];
+        const json& end = j["end_position"];
+        maze.setCell(start[0], start[1], start[2], CellType::START);
+        maze.setCell(end[0], end[1], end[2], CellType::END);
         
         return true;
     } catch (const json::exception& e) {
@@ -421,19 +378,55 @@ bool DataManager::JsonToMazeData(const json& j,
 }
 
 bool DataManager::WriteJsonToFile(const json& j, const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file for writing: " << filename << std::endl;
-        return false;
+    static MetricHistogram& writeDuration = MetricsRegistry::getInstance().histogram(
+        "netlab_data_write_seconds", "DataManager JSON file write duration (serialize, write, rename)");
+    static MetricCounter& writtenBytes = MetricsRegistry::getInstance().counter(
+        "netlab_data_written_bytes_total", "Bytes written by DataManager JSON file writes");
+    static MetricCounter& writeErrors = MetricsRegistry::getInstance().counter(
+        "netlab_data_write_errors_total", "Failed DataManager JSON file writes");
+    MetricTimer timer(writeDuration);
+    
+    // 先写临时文件再重命名，写入中途崩溃不会破坏原文件
+    std::string tempPath = filename + ".tmp";
+    std::string text;
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file for writing: " << filename << std::endl;
+            writeErrors.add();
+            return false;
+        }
+        
+        try {
+            text = j.dump(4); // 使用4空格缩进
+            file << text;
+        } catch (const json::exception& e) {
+            std::cerr << "Error writing JSON to file: " << e.what() << std::endl;
+            file.close();
+            std::filesystem::remove(tempPath);
+            writeErrors.add();
+            return false;
+        }
+        
+        if (!file.good()) {
+            std::cerr << "Error writing JSON to file: " << filename << std::endl;
+            file.close();
+            std::filesystem::remove(tempPath);
+            writeErrors.add();
+            return false;
+        }
     }
     
-    try {
-        file << j.dump(4); // 使用4空格缩进
-        return true;
-    } catch (const json::exception& e) {
-        std::cerr << "Error writing JSON to file: " << e.what() << std::endl;
+    std::error_code ec;
+    std::filesystem::rename(tempPath, filename, ec);
+    if (ec) {
+        std::cerr << "Failed to replace file: " << filename << std::endl;
+        std::filesystem::remove(tempPath, ec);
+        writeErrors.add();
         return false;
     }
+    writtenBytes.add(text.size());
+    return true;
 }
 
 bool DataManager::ReadJsonFromFile(json& j, const std::string& filename) {
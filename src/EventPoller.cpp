@@ -0,0 +1,420 @@
+#include "EventPoller.h"
+
+#include <limits>
+
+#if defined(__linux__)
+    #define EVENT_POLLER_EPOLL
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <unistd.h>
+    #include <cerrno>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__DragonFly__)
+    #define EVENT_POLLER_KQUEUE
+    #include <sys/types.h>
+    #include <sys/event.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <cerrno>
+#else
+    #define EVENT_POLLER_POLL
+    #include <mutex>
+    #include <atomic>
+    #include <unordered_map>
+    #ifdef _WIN32
+        #include <winsock2.h>
+    #else
+        #include <poll.h>
+        #include <unistd.h>
+        #include <fcntl.h>
+        #include <cerrno>
+    #endif
+#endif
+
+// 唤醒句柄使用的内部token，不会返回给调用方
+static const uint64_t WAKEUP_TOKEN = std::numeric_limits<uint64_t>::max();
+
+// 单次wait最多取回的事件数
+static const int MAX_EVENTS_PER_WAIT = 256;
+
+#if defined(EVENT_POLLER_EPOLL)
+
+// ==================== epoll 实现 ====================
+
+class EventPoller::Impl {
+public:
+    int epollFd = -1;
+    int wakeFd = -1;
+    epoll_event readyEvents[MAX_EVENTS_PER_WAIT];
+
+    Impl() {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd >= 0 && wakeFd >= 0) {
+            epoll_event ev{};
+            ev.events = EPOLLIN;
+            ev.data.u64 = WAKEUP_TOKEN;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+        }
+    }
+
+    ~Impl() {
+        if (wakeFd >= 0) close(wakeFd);
+        if (epollFd >= 0) close(epollFd);
+    }
+
+    static uint32_t toEpollEvents(uint32_t events) {
+        uint32_t result = EPOLLET | EPOLLRDHUP;
+        if (events & EVENT_READ) result |= EPOLLIN;
+        if (events & EVENT_WRITE) result |= EPOLLOUT;
+        return result;
+    }
+
+    bool control(int op, intptr_t socket, uint32_t events, uint64_t token) {
+        epoll_event ev{};
+        ev.events = toEpollEvents(events);
+        ev.data.u64 = token;
+        return epoll_ctl(epollFd, op, static_cast<int>(socket), &ev) == 0;
+    }
+};
+
+bool EventPoller::isValid() const {
+    return m_impl->epollFd >= 0 && m_impl->wakeFd >= 0;
+}
+
+bool EventPoller::add(intptr_t socket, uint32_t events, uint64_t token) {
+    return m_impl->control(EPOLL_CTL_ADD, socket, events, token);
+}
+
+bool EventPoller::modify(intptr_t socket, uint32_t events, uint64_t token) {
+    return m_impl->control(EPOLL_CTL_MOD, socket, events, token);
+}
+
+void EventPoller::remove(intptr_t socket) {
+    epoll_event ev{};
+    epoll_ctl(m_impl->epollFd, EPOLL_CTL_DEL, static_cast<int>(socket), &ev);
+}
+
+int EventPoller::wait(std::vector<Event>& events, int timeoutMs) {
+    events.clear();
+    int count = epoll_wait(m_impl->epollFd, m_impl->readyEvents, MAX_EVENTS_PER_WAIT, timeoutMs);
+    if (count < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const epoll_event& ev = m_impl->readyEvents[i];
+        if (ev.data.u64 == WAKEUP_TOKEN) {
+            uint64_t value;
+            while (read(m_impl->wakeFd, &value, sizeof(value)) > 0) {}
+            continue;
+        }
+
+        uint32_t flags = 0;
+        if (ev.events & (EPOLLIN | EPOLLRDHUP)) flags |= EVENT_READ;
+        if (ev.events & EPOLLOUT) flags |= EVENT_WRITE;
+        if (ev.events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) flags |= EVENT_ERROR;
+        events.push_back({ev.data.u64, flags});
+    }
+    return static_cast<int>(events.size());
+}
+
+void EventPoller::wakeup() {
+    uint64_t one = 1;
+    ssize_t ignored = write(m_impl->wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+const char* EventPoller::backendName() const {
+    return "epoll";
+}
+
+#elif defined(EVENT_POLLER_KQUEUE)
+
+// ==================== kqueue 实现 ====================
+
+class EventPoller::Impl {
+public:
+    int kqueueFd = -1;
+    int wakePipe[2] = {-1, -1};
+    struct kevent readyEvents[MAX_EVENTS_PER_WAIT];
+
+    Impl() {
+        kqueueFd = kqueue();
+        if (kqueueFd >= 0 && pipe(wakePipe) == 0) {
+            for (int fd : wakePipe) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+            struct kevent ev;
+            EV_SET(&ev, wakePipe[0], EVFILT_READ, EV_ADD, 0, 0,
+                   reinterpret_cast<void*>(static_cast<uintptr_t>(WAKEUP_TOKEN)));
+            kevent(kqueueFd, &ev, 1, nullptr, 0, nullptr);
+        }
+    }
+
+    ~Impl() {
+        for (int fd : wakePipe) {
+            if (fd >= 0) close(fd);
+        }
+        if (kqueueFd >= 0) close(kqueueFd);
+    }
+
+    bool apply(intptr_t socket, uint32_t events, uint64_t token) {
+        // kqueue按过滤器注册，读写分别启用或禁用
+        struct kevent changes[2];
+        void* udata = reinterpret_cast<void*>(static_cast<uintptr_t>(token));
+        EV_SET(&changes[0], socket, EVFILT_READ,
+               (events & EVENT_READ) ? (EV_ADD | EV_CLEAR) : (EV_ADD | EV_DISABLE), 0, 0, udata);
+        EV_SET(&changes[1], socket, EVFILT_WRITE,
+               (events & EVENT_WRITE) ? (EV_ADD | EV_CLEAR) : (EV_ADD | EV_DISABLE), 0, 0, udata);
+        return kevent(kqueueFd, changes, 2, nullptr, 0, nullptr) == 0;
+    }
+};
+
+bool EventPoller::isValid() const {
+    return m_impl->kqueueFd >= 0 && m_impl->wakePipe[0] >= 0;
+}
+
+bool EventPoller::add(intptr_t socket, uint32_t events, uint64_t token) {
+    return m_impl->apply(socket, events, token);
+}
+
+bool EventPoller::modify(intptr_t socket, uint32_t events, uint64_t token) {
+    return m_impl->apply(socket, events, token);
+}
+
+void EventPoller::remove(intptr_t socket) {
+    struct kevent changes[2];
+    EV_SET(&changes[0], socket, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+    EV_SET(&changes[1], socket, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+    kevent(m_impl->kqueueFd, changes, 2, nullptr, 0, nullptr);
+}
+
+int EventPoller::wait(std::vector<Event>& events, int timeoutMs) {
+    events.clear();
+
+    timespec timeout;
+    timespec* timeoutPtr = nullptr;
+    if (timeoutMs >= 0) {
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+        timeoutPtr = &timeout;
+    }
+
+    int count = kevent(m_impl->kqueueFd, nullptr, 0, m_impl->readyEvents, MAX_EVENTS_PER_WAIT, timeoutPtr);
+    if (count < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const struct kevent& ev = m_impl->readyEvents[i];
+        uint64_t token = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ev.udata));
+        if (token == WAKEUP_TOKEN) {
+            char drain[64];
+            while (read(m_impl->wakePipe[0], drain, sizeof(drain)) > 0) {}
+            continue;
+        }
+
+        uint32_t flags = (ev.filter == EVFILT_WRITE) ? EVENT_WRITE : EVENT_READ;
+        if (ev.flags & (EV_EOF | EV_ERROR)) flags |= EVENT_ERROR;
+        events.push_back({token, flags});
+    }
+    return static_cast<int>(events.size());
+}
+
+void EventPoller::wakeup() {
+    char one = 1;
+    ssize_t ignored = write(m_impl->wakePipe[1], &one, 1);
+    (void)ignored;
+}
+
+const char* EventPoller::backendName() const {
+    return "kqueue";
+}
+
+#else
+
+// ==================== poll / WSAPoll 实现 ====================
+// 水平触发；每次wait复制一份pollfd数组，允许其他线程并发注册
+
+#ifdef _WIN32
+    typedef WSAPOLLFD PollFd;
+    #define EVENT_POLLER_POLL_FN WSAPoll
+    // Windows下没有可用于WSAPoll的自唤醒句柄，以短超时代替
+    static const int WAKEUP_POLL_INTERVAL_MS = 20;
+#else
+    typedef pollfd PollFd;
+    #define EVENT_POLLER_POLL_FN poll
+#endif
+
+class EventPoller::Impl {
+public:
+    std::mutex mutex;
+    std::vector<PollFd> fds;
+    std::vector<uint64_t> tokens;
+    std::unordered_map<intptr_t, size_t> indexBySocket;
+    std::atomic<bool> wakeRequested{false};
+#ifndef _WIN32
+    int wakePipe[2] = {-1, -1};
+#endif
+
+    Impl() {
+#ifndef _WIN32
+        if (pipe(wakePipe) == 0) {
+            for (int fd : wakePipe) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+            }
+            PollFd wakeFd{};
+            wakeFd.fd = wakePipe[0];
+            wakeFd.events = POLLIN;
+            fds.push_back(wakeFd);
+            tokens.push_back(WAKEUP_TOKEN);
+        }
+#endif
+    }
+
+    ~Impl() {
+#ifndef _WIN32
+        for (int fd : wakePipe) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    static short toPollEvents(uint32_t events) {
+        short result = 0;
+        if (events & EVENT_READ) result |= POLLIN;
+        if (events & EVENT_WRITE) result |= POLLOUT;
+        return result;
+    }
+};
+
+bool EventPoller::isValid() const {
+#ifdef _WIN32
+    return true;
+#else
+    return m_impl->wakePipe[0] >= 0;
+#endif
+}
+
+bool EventPoller::add(intptr_t socket, uint32_t events, uint64_t token) {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    if (m_impl->indexBySocket.count(socket)) {
+        return false;
+    }
+    PollFd entry{};
+    entry.fd = socket;
+    entry.events = Impl::toPollEvents(events);
+    m_impl->indexBySocket[socket] = m_impl->fds.size();
+    m_impl->fds.push_back(entry);
+    m_impl->tokens.push_back(token);
+    return true;
+}
+
+bool EventPoller::modify(intptr_t socket, uint32_t events, uint64_t token) {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    auto it = m_impl->indexBySocket.find(socket);
+    if (it == m_impl->indexBySocket.end()) {
+        return false;
+    }
+    m_impl->fds[it->second].events = Impl::toPollEvents(events);
+    m_impl->tokens[it->second] = token;
+    return true;
+}
+
+void EventPoller::remove(intptr_t socket) {
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    auto it = m_impl->indexBySocket.find(socket);
+    if (it == m_impl->indexBySocket.end()) {
+        return;
+    }
+    // 与末尾元素交换后删除，保持O(1)
+    size_t index = it->second;
+    size_t last = m_impl->fds.size() - 1;
+    if (index != last) {
+        m_impl->fds[index] = m_impl->fds[last];
+        m_impl->tokens[index] = m_impl->tokens[last];
+        m_impl->indexBySocket[static_cast<intptr_t>(m_impl->fds[index].fd)] = index;
+    }
+    m_impl->fds.pop_back();
+    m_impl->tokens.pop_back();
+    m_impl->indexBySocket.erase(it);
+}
+
+int EventPoller::wait(std::vector<Event>& events, int timeoutMs) {
+    events.clear();
+
+    std::vector<PollFd> snapshot;
+    std::vector<uint64_t> tokens;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+        snapshot = m_impl->fds;
+        tokens = m_impl->tokens;
+    }
+
+#ifdef _WIN32
+    if (timeoutMs < 0 || timeoutMs > WAKEUP_POLL_INTERVAL_MS) {
+        timeoutMs = WAKEUP_POLL_INTERVAL_MS;
+    }
+    if (snapshot.empty()) {
+        Sleep(timeoutMs);
+        m_impl->wakeRequested = false;
+        return 0;
+    }
+#endif
+
+    int count = EVENT_POLLER_POLL_FN(snapshot.data(), static_cast<unsigned long>(snapshot.size()), timeoutMs);
+    if (count < 0) {
+#ifndef _WIN32
+        if (errno == EINTR) return 0;
+#endif
+        return -1;
+    }
+    m_impl->wakeRequested = false;
+
+    for (size_t i = 0; i < snapshot.size() && events.size() < static_cast<size_t>(count); ++i) {
+        const PollFd& entry = snapshot[i];
+        if (entry.revents == 0) continue;
+
+        if (tokens[i] == WAKEUP_TOKEN) {
+#ifndef _WIN32
+            char drain[64];
+            while (read(m_impl->wakePipe[0], drain, sizeof(drain)) > 0) {}
+#endif
+            continue;
+        }
+
+        uint32_t flags = 0;
+        if (entry.revents & POLLIN) flags |= EVENT_READ;
+        if (entry.revents & POLLOUT) flags |= EVENT_WRITE;
+        if (entry.revents & (POLLERR | POLLHUP | POLLNVAL)) flags |= EVENT_ERROR | EVENT_READ;
+        events.push_back({tokens[i], flags});
+    }
+    return static_cast<int>(events.size());
+}
+
+void EventPoller::wakeup() {
+    if (m_impl->wakeRequested.exchange(true)) {
+        return;  // 已有未处理的唤醒请求
+    }
+#ifndef _WIN32
+    char one = 1;
+    ssize_t ignored = write(m_impl->wakePipe[1], &one, 1);
+    (void)ignored;
+#endif
+}
+
+const char* EventPoller::backendName() const {
+#ifdef _WIN32
+    return "WSAPoll";
+#else
+    return "poll";
+#endif
+}
+
+#endif
+
+EventPoller::EventPoller() : m_impl(std::make_unique<Impl>()) {}
+
+EventPoller::~EventPoller() = default;
@@ -1,106 +1,295 @@
 #include "GameLogic.h"
+#include "Metrics.h"
 #include <cmath>
 #include <random>
 #include <algorithm>
 
-GameLogic::GameLogic() {
-    // 初始化随机数生成器
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));
+namespace {
+
+// 世界坐标 (x, 层, z) 与网格坐标 (列, 行, 层) 的转换
+std::tuple<int, int, int> ToWorld(const Position& cell) {
+    return std::make_tuple(cell.x, cell.z, cell.y);
+}
+
+Position ToGrid(const std::tuple<int, int, int>& world) {
+    return Position(std::get<0>(world), std::get<2>(world), std::get<1>(world));
+}
+
+Position ToGrid(float x, float y, float z) {
+    return Position(static_cast<int>(std::round(x)), static_cast<int>(std::round(z)),
+                    static_cast<int>(std::round(y)));
+}
+
+// 热路径上使用的指标
+MetricHistogram& UpdateDurationMetric() {
+    static MetricHistogram& histogram = MetricsRegistry::getInstance().histogram(
+        "netlab_game_update_seconds", "GameLogic::Update duration (input queue and timers)");
+    return histogram;
+}
+
+MetricCounter& MovesAppliedMetric() {
+    static MetricCounter& counter = MetricsRegistry::getInstance().counter(
+        "netlab_game_moves_total{result=\"applied\"}", "Player movement resolutions");
+    return counter;
+}
+
+MetricCounter& MovesBlockedMetric() {
+    static MetricCounter& counter = MetricsRegistry::getInstance().counter(
+        "netlab_game_moves_total{result=\"blocked\"}", "Player movement resolutions");
+    return counter;
+}
+
+// 定时事件使用的单调时间（毫秒）
+uint64_t NowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+constexpr std::chrono::milliseconds SPEED_BOOST_DURATION(10000);
+constexpr std::chrono::milliseconds SLOW_TRAP_DURATION(30000);
+constexpr std::chrono::milliseconds WALL_REPAIR_DELAY(60000);
+constexpr std::chrono::milliseconds RESPAWN_DELAY(3000);
+
+} // namespace
+
+GameLogic::GameLogic() : rng_(std::random_device{}()) {
 }
 
 GameLogic::~GameLogic() {
     // TODO:清理资源
 }
 
-bool GameLogic::Initialize(const std::vector<std::vector<std::vector<bool>>>& mazeLayout,
-                          const std::vector<std::tuple<int, int, int>>& coinPositions,
-                          const std::tuple<int, int, int>& startPos,
-                          const std::tuple<int, int, int>& endPos) {
-    mazeLayout_ = mazeLayout;
-    coinPositions_ = coinPositions;
-    startPosition_ = startPos;
-    endPosition_ = endPos;
+bool GameLogic::Initialize(const MazeGrid& maze) {
+    if (maze.empty()) {
+        return false;
+    }
+    
+    maze_ = maze;
+    config_.mazeWidth = maze.getWidth();
+    config_.mazeHeight = maze.getHeight();
+    config_.mazeLayers = maze.getLayers();
+    
+    // 所有非墙格子，重生点从中抽取；墙壁破坏和修复时由 SetWall 维护
+    walkable_.reset(maze_.getCellCount());
+    for (size_t cell = 0; cell < maze_.getCellCount(); ++cell) {
+        if (!maze_.wallAt(cell)) {
+            walkable_.insert(cell);
+        }
+    }
+    
+    // 起点、终点和金币来自网格中的单元格类型，转换为世界坐标 (x, 层, 行)
+    std::vector<Position> starts = maze.findCells(CellType::START);
+    std::vector<Position> ends = maze.findCells(CellType::END);
+    startPosition_ = starts.empty() ? FindRandomSpawnPoint() : ToWorld(starts.front());
+    endPosition_ = ends.empty() ? startPosition_ : ToWorld(ends.front());
+    
+    coinPositions_.clear();
+    for (const Position& cell : maze.findCells(CellType::COIN)) {
+        coinPositions_.push_back(ToWorld(cell));
+    }
+    
+    // 到终点的距离场，指南针和重生点共用
+    goalField_.build(maze_, ToGrid(endPosition_));
     
     // 初始化金币收集状态
-    coinCollected_.resize(coinPositions.size(), false);
-    remainingCoins_ = static_cast<int>(coinPositions.size());
+    coinCollected_.assign(coinPositions_.size(), false);
+    remainingCoins_ = static_cast<int>(coinPositions_.size());
+    
+    // 空间索引：已在线的玩家重新登记，金币按格子登记
+    spatial_.reset(maze.getWidth(), maze.getHeight(), maze.getLayers());
+    PlaceCoinsInIndex();
+    for (size_t i = 0; i < players_.size(); ++i) {
+        UpdatePlayerCell(i);
+    }
+    
+    // 旧迷宫上的定时事件不再有效
+    timers_.reset(NowMs());
+    playerTimers_.clear();
+    slowTraps_.clear();
+    brokenWalls_.clear();
+    wallRepairTimes_.clear();
     
     gameRunning_ = true;
     return true;
 }
 
 bool GameLogic::MovePlayer(int playerId, MoveDirection direction) {
-    auto it = players_.find(playerId);
-    if (it == players_.end() || !it->second.isAlive) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS || !players_.hasFlag(index, PLAYER_ALIVE)) {
         return false;
     }
     
-    PlayerState& player = it->second;
-    
-    // 计算移动向量
-    float moveSpeed = player.hasSpeedBoost ? 0.2f : 0.1f;  // 加速时速度翻倍
     float dx = 0, dy = 0, dz = 0;
+    AccumulateMove(index, static_cast<uint8_t>(1u << static_cast<int>(direction)), dx, dy, dz);
+    return ResolveMove(index, dx, dy, dz);
+}
+
+bool GameLogic::QueueInput(int playerId, uint8_t directionBits, const float* rotation) {
+    PlayerStore::Handle handle = players_.handleOf(playerId);
+    if (handle == PlayerStore::INVALID_HANDLE) {
+        return false;
+    }
     
-    switch (direction) {
-        case MoveDirection::FORWARD:
-            dx = -sin(player.rotation) * moveSpeed;
-            dz = -cos(player.rotation) * moveSpeed;
-            break;
-        case MoveDirection::BACKWARD:
-            dx = sin(player.rotation) * moveSpeed;
-            dz = cos(player.rotation) * moveSpeed;
-            break;
-        case MoveDirection::LEFT:
-            dx = -cos(player.rotation) * moveSpeed;
-            dz = sin(player.rotation) * moveSpeed;
-            break;
-        case MoveDirection::RIGHT:
-            dx = cos(player.rotation) * moveSpeed;
-            dz = -sin(player.rotation) * moveSpeed;
-            break;
-        case MoveDirection::UP:
-            if (player.y < config_.mazeLayers - 1) dy = moveSpeed;
-            break;
-        case MoveDirection::DOWN:
-            if (player.y > 0) dy = -moveSpeed;
-            break;
+    QueuedInput input;
+    input.handle = handle;
+    input.directionBits = directionBits;
+    input.hasRotation = rotation != nullptr;
+    input.rotation = rotation ? *rotation : 0.0f;
+    inputQueue_.push_back(input);
+    return true;
+}
+
+void GameLogic::ProcessInputQueue() {
+    if (inputQueue_.empty()) {
+        return;
     }
     
-    // 计算新位置
-    float newX = player.x + dx;
-    float newY = player.y + dy;
-    float newZ = player.z + dz;
+    size_t count = players_.size();
+    pendingDx_.assign(count, 0.0f);
+    pendingDy_.assign(count, 0.0f);
+    pendingDz_.assign(count, 0.0f);
+    pendingCount_.assign(count, 0);
     
-    // 检查碰撞
-    if (!CheckCollision(newX, newY, newZ)) {
-        player.x = newX;
-        player.y = newY;
-        player.z = newZ;
-        
-        // 检查是否到达终点
-        int endX = std::get<0>(endPosition_);
-        int endY = std::get<1>(endPosition_);
-        int endZ = std::get<2>(endPosition_);
-        
-        if (static_cast<int>(player.x) == endX && 
-            static_cast<int>(player.y) == endY && 
-            static_cast<int>(player.z) == endZ) {
-            CheckPlayerReachedGoal(playerId);
+    // 按到达顺序应用朝向并累加位移，每个玩家的输入数量有上限
+    for (const QueuedInput& input : inputQueue_) {
+        size_t index = players_.indexOf(input.handle);
+        if (index == PlayerStore::NPOS || pendingCount_[index] >= MAX_INPUTS_PER_TICK) {
+            continue;
         }
+        ++pendingCount_[index];
         
-        return true;
+        if (input.hasRotation && std::isfinite(input.rotation) && input.rotation != players_.rotation(index)) {
+            players_.setRotation(index, input.rotation);
+        }
+        if (input.directionBits != 0 && players_.hasFlag(index, PLAYER_ALIVE)) {
+            AccumulateMove(index, input.directionBits, pendingDx_[index], pendingDy_[index], pendingDz_[index]);
+        }
+    }
+    inputQueue_.clear();
+    
+    // 每个玩家只做一次扫掠碰撞和格子更新
+    for (size_t i = 0; i < count && i < players_.size(); ++i) {
+        if (pendingDx_[i] != 0.0f || pendingDy_[i] != 0.0f || pendingDz_[i] != 0.0f) {
+            ResolveMove(i, pendingDx_[i], pendingDy_[i], pendingDz_[i]);
+        }
+    }
+}
+
+void GameLogic::AccumulateMove(size_t index, uint8_t directionBits, float& dx, float& dy, float& dz) const {
+    // 加速时速度翻倍，减速带上速度减半（按本帧起点所在格子判断）
+    float moveSpeed = players_.hasFlag(index, PLAYER_SPEED_BOOST) ? 0.2f : 0.1f;
+    Position cell = ToGrid(players_.x(index), players_.y(index), players_.z(index));
+    if (spatial_.hasTrap(cell.x, cell.y, cell.z)) {
+        moveSpeed *= 0.5f;
+    }
+    
+    float sinR = players_.rotationSin(index) * moveSpeed;
+    float cosR = players_.rotationCos(index) * moveSpeed;
+    auto has = [directionBits](MoveDirection direction) {
+        return (directionBits & (1u << static_cast<int>(direction))) != 0;
+    };
+    
+    if (has(MoveDirection::FORWARD))  { dx -= sinR; dz -= cosR; }
+    if (has(MoveDirection::BACKWARD)) { dx += sinR; dz += cosR; }
+    if (has(MoveDirection::LEFT))     { dx -= cosR; dz += sinR; }
+    if (has(MoveDirection::RIGHT))    { dx += cosR; dz -= sinR; }
+    if (has(MoveDirection::UP))       { dy += moveSpeed; }
+    if (has(MoveDirection::DOWN))     { dy -= moveSpeed; }
+}
+
+bool GameLogic::ResolveMove(size_t index, float dx, float dy, float dz) {
+    float x = players_.x(index);
+    float y = players_.y(index);
+    float z = players_.z(index);
+    int layer = static_cast<int>(std::round(y));
+    
+    // 先水平两轴，再处理层间移动
+    float newX = SweepAxis(x, dx, z, layer, true);
+    float newZ = SweepAxis(z, dz, newX, layer, false);
+    float newY = y;
+    if (dy != 0.0f) {
+        // 换层时整个碰撞盒都必须落在目标层的空地上
+        float targetY = std::max(0.0f, std::min(y + dy, static_cast<float>(config_.mazeLayers - 1)));
+        int targetLayer = static_cast<int>(std::round(targetY));
+        if (targetLayer == layer || !BoxHitsWall(newX, newZ, targetLayer)) {
+            newY = targetY;
+        }
     }
     
+    if (newX == x && newY == y && newZ == z) {
+        MovesBlockedMetric().add();
+        return false;
+    }
+    MovesAppliedMetric().add();
+    
+    players_.x(index) = newX;
+    players_.y(index) = newY;
+    players_.z(index) = newZ;
+    UpdatePlayerCell(index);
+    
+    // 检查是否到达终点
+    Position cell = ToGrid(newX, newY, newZ);
+    Position goal = ToGrid(endPosition_);
+    if (cell.x == goal.x && cell.y == goal.y && cell.z == goal.z) {
+        CheckPlayerReachedGoal(players_.playerId(index));
+    }
+    return true;
+}
+
+bool GameLogic::BoxHitsWall(float x, float z, int layer) const {
+    const float extent = PLAYER_HALF_EXTENT;
+    int minX = static_cast<int>(std::floor(x - extent + 0.5f));
+    int maxX = static_cast<int>(std::floor(x + extent + 0.5f));
+    int minZ = static_cast<int>(std::floor(z - extent + 0.5f));
+    int maxZ = static_cast<int>(std::floor(z + extent + 0.5f));
+    for (int cz = minZ; cz <= maxZ; ++cz) {
+        for (int cx = minX; cx <= maxX; ++cx) {
+            if (maze_.isWall(cx, cz, layer)) {
+                return true;
+            }
+        }
+    }
     return false;
 }
 
+float GameLogic::SweepAxis(float position, float delta, float across, int layer, bool alongX) const {
+    if (delta == 0.0f) {
+        return position;
+    }
+    
+    // 格子i覆盖 [i-0.5, i+0.5)；碰撞盒在垂直方向覆盖的格子范围
+    const float extent = PLAYER_HALF_EXTENT;
+    const float epsilon = 1e-4f;
+    int acrossMin = static_cast<int>(std::floor(across - extent + 0.5f));
+    int acrossMax = static_cast<int>(std::floor(across + extent + 0.5f));
+    
+    float sign = delta > 0.0f ? 1.0f : -1.0f;
+    float lead = position + sign * extent;
+    int startCell = static_cast<int>(std::floor(lead + 0.5f));
+    int endCell = static_cast<int>(std::floor(lead + delta + 0.5f));
+    int step = delta > 0.0f ? 1 : -1;
+    
+    // 逐格检查前沿经过的单元格（DDA），遇到墙就停在墙前
+    for (int cell = startCell + step; cell != endCell + step; cell += step) {
+        for (int a = acrossMin; a <= acrossMax; ++a) {
+            bool wall = alongX ? maze_.isWall(cell, a, layer) : maze_.isWall(a, cell, layer);
+            if (wall) {
+                float boundary = static_cast<float>(cell) - sign * 0.5f;
+                float stop = boundary - sign * (extent + epsilon);
+                // 已经贴墙时不再后退
+                return delta > 0.0f ? std::max(position, stop) : std::min(position, stop);
+            }
+        }
+    }
+    return position + delta;
+}
+
 bool GameLogic::PurchaseItem(int playerId, ItemType itemType) {
-    auto it = players_.find(playerId);
-    if (it == players_.end()) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS) {
         return false;
     }
     
-    PlayerState& player = it->second;
     int price = 0;
     
     // 根据道具类型设置价格
@@ -115,9 +304,10 @@ bool GameLogic::PurchaseItem(int playerId, ItemType itemType) {
     }
     
     // 检查金币是否足够
-    if (player.coins >= price) {
-        player.coins -= price;
-        player.inventory[itemType]++;
+    uint16_t& count = players_.itemCount(index, itemType);
+    if (players_.coins(index) >= price && count < UINT16_MAX) {
+        players_.coins(index) -= price;
+        ++count;
         return true;
     }
     
@@ -126,12 +316,11 @@ bool GameLogic::PurchaseItem(int playerId, ItemType itemType) {
 
 bool GameLogic::UseItem(int playerId, ItemType itemType, int targetPlayerId, 
                        const std::tuple<int, int, int>& targetPos) {
-    auto it = players_.find(playerId);
-    if (it == players_.end() || it->second.inventory[itemType] <= 0) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS || players_.itemCount(index, itemType) == 0) {
         return false;
     }
-    
-    PlayerState& player = it->second;
+    PlayerStore::Handle handle = players_.handleOf(playerId);
     
     // 使用道具
     switch (itemType) {
@@ -145,24 +334,29 @@ bool GameLogic::UseItem(int playerId, ItemType itemType, int targetPlayerId,
             ApplyHammer(playerId, targetPos);
             break;
         case ItemType::KILL_SWORD:
-            if (targetPlayerId != -1) {
-                ApplyKillSword(playerId, targetPlayerId);
+            if (targetPlayerId == -1) {
+                return false;  // 没有目标时不消耗道具
             }
+            ApplyKillSword(playerId, targetPlayerId);
             break;
         case ItemType::SLOW_TRAP:
             ApplySlowTrap(playerId, targetPos);
             break;
         case ItemType::SWAP_ITEM:
-            if (targetPlayerId != -1) {
-                ApplySwapItem(playerId, targetPlayerId);
+            if (targetPlayerId == -1) {
+                return false;
             }
+            ApplySwapItem(playerId, targetPlayerId);
             break;
         default:
             return false;
     }
     
-    // 减少道具数量
-    player.inventory[itemType]--;
+    // 减少道具数量（道具效果不会增删玩家，这里只是保险）
+    index = players_.indexOf(handle);
+    if (index != PlayerStore::NPOS) {
+        --players_.itemCount(index, itemType);
+    }
     return true;
 }
 
@@ -171,158 +365,293 @@ bool GameLogic::CollectCoin(int playerId, int coinId) {
         return false;
     }
     
-    auto it = players_.find(playerId);
-    if (it == players_.end()) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS) {
         return false;
     }
     
     // 收集金币
     coinCollected_[coinId] = true;
-    it->second.coins++;
+    Position coinCell = ToGrid(coinPositions_[coinId]);
+    spatial_.clearCoin(coinCell.x, coinCell.y, coinCell.z);
+    players_.coins(index)++;
     remainingCoins_--;
     
     return true;
 }
 
 bool GameLogic::CheckPlayerReachedGoal(int playerId) {
-    auto it = players_.find(playerId);
-    if (it == players_.end() || it->second.reachedGoal) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS || players_.hasFlag(index, PLAYER_REACHED_GOAL)) {
         return false;
     }
     
-    PlayerState& player = it->second;
-    player.reachedGoal = true;
-    player.finishRank = nextFinishRank_++;
+    players_.setFlag(index, PLAYER_REACHED_GOAL, true);
+    players_.finishRank(index) = nextFinishRank_++;
     
     // 给予金币奖励
-    int reward = CalculateCoinReward(player.finishRank);
-    player.coins += reward;
+    int reward = CalculateCoinReward(players_.finishRank(index));
+    players_.coins(index) += reward;
     
     finishedPlayersCount_++;
     return true;
 }
 
 PlayerState GameLogic::GetPlayerState(int playerId) const {
-    auto it = players_.find(playerId);
-    if (it != players_.end()) {
-        return it->second;
+    PlayerState state;
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS) {
+        return state; // 返回默认状态
+    }
+    
+    state.playerId = playerId;
+    state.x = players_.x(index);
+    state.y = players_.y(index);
+    state.z = players_.z(index);
+    state.rotation = players_.rotation(index);
+    state.isAlive = players_.hasFlag(index, PLAYER_ALIVE);
+    state.hasCompass = players_.hasFlag(index, PLAYER_HAS_COMPASS);
+    state.hasSpeedBoost = players_.hasFlag(index, PLAYER_SPEED_BOOST);
+    state.speedBoostEndTime = players_.speedBoostEnd(index);
+    state.coins = players_.coins(index);
+    state.inventory = players_.inventory(index);
+    state.reachedGoal = players_.hasFlag(index, PLAYER_REACHED_GOAL);
+    state.finishRank = players_.finishRank(index);
+    return state;
+}
+
+PlayerView GameLogic::GetPlayerView(int playerId) const {
+    size_t index = players_.indexOf(playerId);
+    return index != PlayerStore::NPOS ? PlayerView(&players_, index) : PlayerView();
+}
+
+bool GameLogic::SetPlayerRotation(int playerId, float rotation) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS) {
+        return false;
+    }
+    
+    players_.setRotation(index, rotation);
+    return true;
+}
+
+WorldSnapshot GameLogic::CaptureSnapshot(uint32_t tick) const {
+    WorldSnapshot snapshot;
+    CaptureSnapshot(tick, snapshot);
+    return snapshot;
+}
+
+void GameLogic::CaptureSnapshot(uint32_t tick, WorldSnapshot& snapshot) const {
+    snapshot.tick = tick;
+    
+    // 按稠密数组线性收集，再按playerId排序
+    snapshot.players.clear();
+    snapshot.players.reserve(players_.size());
+    for (size_t i = 0; i < players_.size(); ++i) {
+        snapshot.players.push_back({players_.playerId(i), players_.x(i), players_.y(i), players_.z(i),
+                                    players_.rotation(i), players_.hasFlag(i, PLAYER_ALIVE), players_.coins(i)});
+    }
+    std::sort(snapshot.players.begin(), snapshot.players.end(),
+              [](const PlayerSnapshot& a, const PlayerSnapshot& b) { return a.playerId < b.playerId; });
+    
+    snapshot.coinCollected.assign(coinCollected_.begin(), coinCollected_.end());
+    
+    // wallRepairTimes_ 中的墙壁即当前仍处于破坏状态的墙壁（map已按坐标排序）
+    snapshot.brokenWalls.clear();
+    snapshot.brokenWalls.reserve(wallRepairTimes_.size());
+    for (const auto& pair : wallRepairTimes_) {
+        snapshot.brokenWalls.push_back(pair.first);
     }
-    return PlayerState(); // 返回默认状态
 }
 
 bool GameLogic::AddPlayer(int playerId, const std::tuple<int, int, int>& startPos) {
-    if (players_.find(playerId) != players_.end()) {
+    if (players_.insert(playerId) == PlayerStore::INVALID_HANDLE) {
         return false; // 玩家已存在
     }
     
-    PlayerState newPlayer;
-    newPlayer.playerId = playerId;
-    newPlayer.x = static_cast<float>(std::get<0>(startPos));
-    newPlayer.y = static_cast<float>(std::get<1>(startPos));
-    newPlayer.z = static_cast<float>(std::get<2>(startPos));
-    newPlayer.isAlive = true;
-    newPlayer.hasCompass = false;
-    newPlayer.hasSpeedBoost = false;
-    newPlayer.coins = 0;
-    newPlayer.reachedGoal = false;
-    newPlayer.finishRank = 0;
-    
-    // 初始化道具库存
-    newPlayer.inventory[ItemType::SPEED_POTION] = 0;
-    newPlayer.inventory[ItemType::COMPASS] = 0;
-    newPlayer.inventory[ItemType::HAMMER] = 0;
-    newPlayer.inventory[ItemType::KILL_SWORD] = 0;
-    newPlayer.inventory[ItemType::SLOW_TRAP] = 0;
-    newPlayer.inventory[ItemType::SWAP_ITEM] = 0;
-    
-    players_[playerId] = newPlayer;
+    // 新玩家的其余字段（金币、道具库存、名次等）均为零
+    size_t index = players_.indexOf(playerId);
+    players_.x(index) = static_cast<float>(std::get<0>(startPos));
+    players_.y(index) = static_cast<float>(std::get<1>(startPos));
+    players_.z(index) = static_cast<float>(std::get<2>(startPos));
+    players_.setFlag(index, PLAYER_ALIVE, true);
+    
+    UpdatePlayerCell(index);
     return true;
 }
 
 bool GameLogic::RemovePlayer(int playerId) {
-    return players_.erase(playerId) > 0;
+    CancelPlayerTimers(playerId);
+    spatial_.removePlayer(playerId);
+    return players_.erase(playerId);
 }
 
 void GameLogic::RespawnPlayer(int playerId) {
-    auto it = players_.find(playerId);
-    if (it == players_.end()) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS) {
         return;
     }
     
-    PlayerState& player = it->second;
     auto spawnPoint = FindRandomSpawnPoint();
     
-    player.x = static_cast<float>(std::get<0>(spawnPoint));
-    player.y = static_cast<float>(std::get<1>(spawnPoint));
-    player.z = static_cast<float>(std::get<2>(spawnPoint));
-    player.isAlive = true;
-    player.hasSpeedBoost = false;
+    players_.x(index) = static_cast<float>(std::get<0>(spawnPoint));
+    players_.y(index) = static_cast<float>(std::get<1>(spawnPoint));
+    players_.z(index) = static_cast<float>(std::get<2>(spawnPoint));
+    players_.setFlag(index, PLAYER_ALIVE, true);
+    players_.setFlag(index, PLAYER_SPEED_BOOST, false);
+    CancelPlayerTimers(playerId);
+    UpdatePlayerCell(index);
     // 保留金币和道具，但重置其他状态
 }
 
 void GameLogic::Update() {
-    auto currentTime = std::chrono::steady_clock::now();
-    
-    // 检查所有玩家的速度提升是否过期
-    for (auto& pair : players_) {
-        CheckSpeedBoostExpiry(pair.first);
-    }
-    
-    // 检查减速带是否过期（30秒后消失）
-    slowTraps_.erase(
-        std::remove_if(slowTraps_.begin(), slowTraps_.end(),
-            [currentTime](const auto& trap) {
-                return std::chrono::duration_cast<std::chrono::seconds>(
-                    currentTime - std::get<3>(trap)).count() > 30;
-            }),
-        slowTraps_.end()
-    );
-    
-    // 修复被破坏的墙壁（60秒后恢复）
-    for (auto it = wallRepairTimes_.begin(); it != wallRepairTimes_.end();) {
-        if (std::chrono::duration_cast<std::chrono::seconds>(currentTime - it->second).count() > 60) {
-            // 恢复墙壁
-            auto pos = it->first;
-            mazeLayout_[std::get<1>(pos)][std::get<0>(pos)][std::get<2>(pos)] = true;
-            it = wallRepairTimes_.erase(it);
-        } else {
-            ++it;
-        }
+    MetricTimer timer(UpdateDurationMetric());
+    
+    // 先结算本帧的移动输入，再处理到期的定时事件
+    ProcessInputQueue();
+    timers_.advance(NowMs());
+}
+
+TimerWheel::TimerId GameLogic::ScheduleAfter(std::chrono::milliseconds delay, TimerWheel::Callback callback) {
+    return timers_.scheduleAt(NowMs() + static_cast<uint64_t>(delay.count()), std::move(callback));
+}
+
+void GameLogic::CancelPlayerTimers(int playerId) {
+    auto it = playerTimers_.find(playerId);
+    if (it == playerTimers_.end()) {
+        return;
     }
+    timers_.cancel(it->second.speedBoost);
+    timers_.cancel(it->second.respawn);
+    playerTimers_.erase(it);
 }
 
 bool GameLogic::CheckCollision(float x, float y, float z) const {
-    // 转换为网格坐标
-    int gridX = static_cast<int>(std::round(x));
-    int gridY = static_cast<int>(std::round(y));
-    int gridZ = static_cast<int>(std::round(z));
-    
-    // 检查边界
-    if (gridX < 0 || gridX >= config_.mazeWidth ||
-        gridY < 0 || gridY >= config_.mazeLayers ||
-        gridZ < 0 || gridZ >= config_.mazeHeight) {
-        return true;
+    // 转换为网格坐标，越界视为墙壁
+    Position cell = ToGrid(x, y, z);
+    return maze_.isWall(cell.x, cell.y, cell.z);
+}
+
+bool GameLogic::SetWall(const std::tuple<int, int, int>& pos, bool wall) {
+    Position cell = ToGrid(pos);
+    if (!maze_.setWall(cell.x, cell.y, cell.z, wall)) {
+        return false;
+    }
+    size_t index = maze_.indexOf(cell.x, cell.y, cell.z);
+    if (wall) {
+        walkable_.erase(index);
+    } else {
+        walkable_.insert(index);
+    }
+    return true;
+}
+
+bool GameLogic::GetCompassHint(int playerId, CompassHint& hint) const {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS || !players_.hasFlag(index, PLAYER_HAS_COMPASS)) {
+        return false;
+    }
+    
+    Position cell = ToGrid(players_.x(index), players_.y(index), players_.z(index));
+    uint32_t distance = goalField_.distanceAt(cell.x, cell.y, cell.z);
+    if (distance == NavigationField::UNREACHABLE) {
+        return false;
     }
     
-    // 检查墙壁碰撞
-    return mazeLayout_[gridY][gridX][gridZ];
+    hint = CompassHint();
+    hint.distance = static_cast<int>(distance);
+    Direction direction;
+    if (goalField_.nextStep(maze_, cell.x, cell.y, cell.z, direction)) {
+        int dx, dy, dlayer;
+        NavigationField::directionOffset(direction, dx, dy, dlayer);
+        hint.dx = dx;
+        hint.dy = dlayer;
+        hint.dz = dy;
+    }
+    return true;
 }
 
-void GameLogic::ApplySpeedPotion(int playerId) {
-    auto it = players_.find(playerId);
-    if (it == players_.end()) return;
+int GameLogic::GetDistanceToGoal(float x, float y, float z) const {
+    Position cell = ToGrid(x, y, z);
+    uint32_t distance = goalField_.distanceAt(cell.x, cell.y, cell.z);
+    return distance == NavigationField::UNREACHABLE ? -1 : static_cast<int>(distance);
+}
+
+std::vector<int> GameLogic::GetPlayersNear(const std::tuple<int, int, int>& pos, int radius) const {
+    Position cell = ToGrid(pos);
+    return spatial_.queryPlayers(cell.x, cell.y, cell.z, radius);
+}
+
+int GameLogic::FindNearestPlayer(const std::tuple<int, int, int>& pos, int radius, int excludePlayerId) const {
+    Position cell = ToGrid(pos);
+    int nearest = -1;
+    float nearestDistance = 0.0f;
+    spatial_.forEachPlayerNear(cell.x, cell.y, cell.z, radius, [&](int playerId) {
+        size_t index = players_.indexOf(playerId);
+        if (playerId == excludePlayerId || index == PlayerStore::NPOS || !players_.hasFlag(index, PLAYER_ALIVE)) {
+            return;
+        }
+        float dx = players_.x(index) - std::get<0>(pos);
+        float dz = players_.z(index) - std::get<2>(pos);
+        float distance = dx * dx + dz * dz;
+        if (nearest == -1 || distance < nearestDistance || (distance == nearestDistance && playerId < nearest)) {
+            nearest = playerId;
+            nearestDistance = distance;
+        }
+    });
+    return nearest;
+}
+
+void GameLogic::UpdatePlayerCell(size_t index) {
+    int playerId = players_.playerId(index);
+    Position cell = ToGrid(players_.x(index), players_.y(index), players_.z(index));
+    if (!spatial_.updatePlayer(playerId, cell.x, cell.y, cell.z) || !players_.hasFlag(index, PLAYER_ALIVE)) {
+        return;
+    }
     
-    PlayerState& player = it->second;
-    player.hasSpeedBoost = true;
-    player.speedBoostEndTime = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    // 进入新格子时自动拾取金币
+    int coinId = spatial_.coinAt(cell.x, cell.y, cell.z);
+    if (coinId != SpatialIndex::NONE) {
+        CollectCoin(playerId, coinId);
+    }
+}
+
+void GameLogic::PlaceCoinsInIndex() {
+    for (size_t i = 0; i < coinPositions_.size(); ++i) {
+        Position cell = ToGrid(coinPositions_[i]);
+        if (coinCollected_[i]) {
+            spatial_.clearCoin(cell.x, cell.y, cell.z);
+        } else {
+            spatial_.setCoin(cell.x, cell.y, cell.z, static_cast<int>(i));
+        }
+    }
+}
+
+void GameLogic::ApplySpeedPotion(int playerId) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS) return;
+    
+    players_.setFlag(index, PLAYER_SPEED_BOOST, true);
+    players_.speedBoostEnd(index) = std::chrono::steady_clock::now() + SPEED_BOOST_DURATION;
+    
+    // 重复使用时重新计时；回调持有句柄，玩家离开后句柄失效
+    PlayerStore::Handle handle = players_.handleOf(playerId);
+    TimerWheel::TimerId& timer = playerTimers_[playerId].speedBoost;
+    timers_.cancel(timer);
+    timer = ScheduleAfter(SPEED_BOOST_DURATION, [this, handle, playerId]() {
+        size_t index = players_.indexOf(handle);
+        if (index != PlayerStore::NPOS) {
+            players_.setFlag(index, PLAYER_SPEED_BOOST, false);
+        }
+        playerTimers_[playerId].speedBoost = TimerWheel::INVALID_TIMER;
+    });
 }
 
 void GameLogic::ApplyCompass(int playerId) {
-    auto it = players_.find(playerId);
-    if (it == players_.end()) return;
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS) return;
     
-    PlayerState& player = it->second;
-    player.hasCompass = true;
+    players_.setFlag(index, PLAYER_HAS_COMPASS, true);
 }
 
 void GameLogic::ApplyHammer(int playerId, const std::tuple<int, int, int>& targetPos) {
@@ -330,58 +659,84 @@ void GameLogic::ApplyHammer(int playerId, const std::tuple<int, int, int>& targe
     int y = std::get<1>(targetPos);
     int z = std::get<2>(targetPos);
     
-    // 检查目标位置是否有效
-    if (x >= 0 && x < config_.mazeWidth &&
+    // 检查目标位置是否有效且是墙壁（不能破坏迷宫外边界）
+    if (x > 0 && x < config_.mazeWidth - 1 &&
         y >= 0 && y < config_.mazeLayers &&
-        z >= 0 && z < config_.mazeHeight &&
-        mazeLayout_[y][x][z]) {  // 确保是墙壁
+        z > 0 && z < config_.mazeHeight - 1 &&
+        maze_.isWall(x, z, y) && wallRepairTimes_.find(targetPos) == wallRepairTimes_.end()) {
         
         // 破坏墙壁
-        mazeLayout_[y][x][z] = false;
+        SetWall(targetPos, false);
+        goalField_.onCellOpened(maze_, ToGrid(targetPos));
         brokenWalls_.push_back(targetPos);
-        wallRepairTimes_[targetPos] = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+        wallRepairTimes_[targetPos] = std::chrono::steady_clock::now() + WALL_REPAIR_DELAY;
+        
+        // 60秒后恢复墙壁
+        ScheduleAfter(WALL_REPAIR_DELAY, [this, targetPos]() {
+            SetWall(targetPos, true);
+            goalField_.onCellBlocked(maze_, ToGrid(targetPos));
+            brokenWalls_.erase(std::remove(brokenWalls_.begin(), brokenWalls_.end(), targetPos),
+                               brokenWalls_.end());
+            wallRepairTimes_.erase(targetPos);
+        });
     }
 }
 
 void GameLogic::ApplyKillSword(int playerId, int targetPlayerId) {
-    auto targetIt = players_.find(targetPlayerId);
-    if (targetIt == players_.end() || !targetIt->second.isAlive) {
+    size_t targetIndex = players_.indexOf(targetPlayerId);
+    if (targetIndex == PlayerStore::NPOS || !players_.hasFlag(targetIndex, PLAYER_ALIVE)) {
         return;
     }
     
-    // 杀死目标玩家
-    targetIt->second.isAlive = false;
+    // 杀死目标玩家，死亡期间不能移动
+    players_.setFlag(targetIndex, PLAYER_ALIVE, false);
     
-    // 3秒后重生
-    // 注意：在实际实现中，这里应该使用计时器或在下一次更新时重生
-    RespawnPlayer(targetPlayerId);
+    // 3秒后重生（RespawnPlayer 会清除玩家的定时事件）
+    TimerWheel::TimerId& timer = playerTimers_[targetPlayerId].respawn;
+    timers_.cancel(timer);
+    timer = ScheduleAfter(RESPAWN_DELAY, [this, targetPlayerId]() {
+        playerTimers_[targetPlayerId].respawn = TimerWheel::INVALID_TIMER;
+        RespawnPlayer(targetPlayerId);
+    });
 }
 
 void GameLogic::ApplySlowTrap(int playerId, const std::tuple<int, int, int>& targetPos) {
-    // 放置减速带
-    slowTraps_.emplace_back(
-        std::get<0>(targetPos),
-        std::get<1>(targetPos),
-        std::get<2>(targetPos),
-        std::chrono::steady_clock::now()
-    );
+    // 没有指定有效位置时放在玩家脚下
+    std::tuple<int, int, int> trapPos = targetPos;
+    Position cell = ToGrid(trapPos);
+    if (maze_.isWall(cell.x, cell.y, cell.z)) {
+        size_t index = players_.indexOf(playerId);
+        if (index == PlayerStore::NPOS) {
+            return;
+        }
+        cell = ToGrid(players_.x(index), players_.y(index), players_.z(index));
+        trapPos = ToWorld(cell);
+    }
+    
+    // 放置减速带，30秒后消失
+    int trapId = nextTrapId_++;
+    slowTraps_[trapId] = trapPos;
+    spatial_.addTrap(cell.x, cell.y, cell.z);
+    ScheduleAfter(SLOW_TRAP_DURATION, [this, trapId, cell]() {
+        spatial_.removeTrap(cell.x, cell.y, cell.z);
+        slowTraps_.erase(trapId);
+    });
 }
 
 void GameLogic::ApplySwapItem(int playerId, int targetPlayerId) {
-    auto player1It = players_.find(playerId);
-    auto player2It = players_.find(targetPlayerId);
+    size_t index1 = players_.indexOf(playerId);
+    size_t index2 = players_.indexOf(targetPlayerId);
     
-    if (player1It == players_.end() || player2It == players_.end()) {
+    if (index1 == PlayerStore::NPOS || index2 == PlayerStore::NPOS) {
         return;
     }
     
     // 交换玩家位置
-    PlayerState& player1 = player1It->second;
-    PlayerState& player2 = player2It->second;
-    
-    std::swap(player1.x, player2.x);
-    std::swap(player1.y, player2.y);
-    std::swap(player1.z, player2.z);
+    std::swap(players_.x(index1), players_.x(index2));
+    std::swap(players_.y(index1), players_.y(index2));
+    std::swap(players_.z(index1), players_.z(index2));
+    UpdatePlayerCell(index1);
+    UpdatePlayerCell(index2);
 }
 
 int GameLogic::CalculateCoinReward(int rank) const {
@@ -389,53 +744,40 @@ int GameLogic::CalculateCoinReward(int rank) const {
     return 61 - rank;  // 61 - 1 = 60, 61 - 2 = 59, ...
 }
 
-void GameLogic::CheckSpeedBoostExpiry(int playerId) {
-    auto it = players_.find(playerId);
-    if (it == players_.end() || !it->second.hasSpeedBoost) {
-        return;
-    }
-    
-    PlayerState& player = it->second;
-    if (std::chrono::steady_clock::now() > player.speedBoostEndTime) {
-        player.hasSpeedBoost = false;
-    }
-}
-
-std::tuple<int, int, int> GameLogic::FindRandomSpawnPoint() const {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> disX(0, config_.mazeWidth - 1);
-    std::uniform_int_distribution<> disY(0, config_.mazeLayers - 1);
-    std::uniform_int_distribution<> disZ(0, config_.mazeHeight - 1);
-    
-    // 寻找空位置（非墙壁）
-    while (true) {
-        int x = disX(gen);
-        int y = disY(gen);
-        int z = disZ(gen);
-        
-        if (!mazeLayout_[y][x][z]) {  // 如果是空位置
-            return {x, y, z};
+std::tuple<int, int, int> GameLogic::FindRandomSpawnPoint() {
+    // 从非墙格子中直接抽取，只需排除走不到终点的孤立区域；距离场尚未建立时不检查
+    bool requireReachable = goalField_.isBuilt();
+    for (int attempt = 0; attempt < MAX_SPAWN_ATTEMPTS; ++attempt) {
+        size_t cell = walkable_.sample(rng_);
+        if (cell == CellSet::NPOS) {
+            break;
+        }
+        Position position = maze_.positionOf(cell);
+        if (!requireReachable ||
+            goalField_.distanceAt(position.x, position.y, position.z) != NavigationField::UNREACHABLE) {
+            return ToWorld(position);
         }
     }
+    return startPosition_;
 }
 
 // ========== 为CommandSystem扩展的实现 ==========
 
 bool GameLogic::GiveItem(int playerId, ItemType itemType, int count) {
-    auto it = players_.find(playerId);
-    if (it == players_.end()) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS) {
         return false;
     }
     
-    PlayerState& player = it->second;
-    player.inventory[itemType] += count;
+    // 库存为16位计数，超出范围时截断
+    int total = players_.itemCount(index, itemType) + count;
+    players_.itemCount(index, itemType) = static_cast<uint16_t>(std::max(0, std::min(total, int(UINT16_MAX))));
     return true;
 }
 
 bool GameLogic::TeleportPlayer(int playerId, float x, float y, float z) {
-    auto it = players_.find(playerId);
-    if (it == players_.end()) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS) {
         return false;
     }
     
@@ -444,22 +786,22 @@ bool GameLogic::TeleportPlayer(int playerId, float x, float y, float z) {
         return false;
     }
     
-    PlayerState& player = it->second;
-    player.x = x;
-    player.y = y;
-    player.z = z;
+    players_.x(index) = x;
+    players_.y(index) = y;
+    players_.z(index) = z;
+    UpdatePlayerCell(index);
     
     return true;
 }
 
 bool GameLogic::KillPlayer(int playerId) {
-    auto it = players_.find(playerId);
-    if (it == players_.end() || !it->second.isAlive) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS || !players_.hasFlag(index, PLAYER_ALIVE)) {
         return false;
     }
     
     // 标记玩家为死亡
-    it->second.isAlive = false;
+    players_.setFlag(index, PLAYER_ALIVE, false);
     
     // 立即重生
     RespawnPlayer(playerId);
@@ -468,43 +810,38 @@ bool GameLogic::KillPlayer(int playerId) {
 }
 
 bool GameLogic::SetPlayerCoins(int playerId, int coins) {
-    auto it = players_.find(playerId);
-    if (it == players_.end()) {
+    size_t index = players_.indexOf(playerId);
+    if (index == PlayerStore::NPOS) {
         return false;
     }
     
-    it->second.coins = coins;
+    players_.coins(index) = coins;
     return true;
 }
 
 std::vector<int> GameLogic::GetAllPlayerIds() const {
-    std::vector<int> playerIds;
-    for (const auto& pair : players_) {
-        playerIds.push_back(pair.first);
-    }
+    std::vector<int> playerIds = players_.getIds();
+    std::sort(playerIds.begin(), playerIds.end());
     return playerIds;
 }
 
 void GameLogic::ResetGameState() {
     // 重置所有玩家状态
-    for (auto& pair : players_) {
-        PlayerState& player = pair.second;
-        
+    for (size_t i = 0; i < players_.size(); ++i) {
         // 重置位置到起点
-        player.x = static_cast<float>(std::get<0>(startPosition_));
-        player.y = static_cast<float>(std::get<1>(startPosition_));
-        player.z = static_cast<float>(std::get<2>(startPosition_));
+        players_.x(i) = static_cast<float>(std::get<0>(startPosition_));
+        players_.y(i) = static_cast<float>(std::get<1>(startPosition_));
+        players_.z(i) = static_cast<float>(std::get<2>(startPosition_));
         
         // 重置游戏状态
-        player.isAlive = true;
-        player.hasCompass = false;
-        player.hasSpeedBoost = false;
-        player.reachedGoal = false;
-        player.finishRank = 0;
+        players_.setFlag(i, PLAYER_ALIVE, true);
+        players_.setFlag(i, PLAYER_HAS_COMPASS, false);
+        players_.setFlag(i, PLAYER_SPEED_BOOST, false);
+        players_.setFlag(i, PLAYER_REACHED_GOAL, false);
+        players_.finishRank(i) = 0;
+        UpdatePlayerCell(i);
         
         // 保留金币和道具库存
-        // player.coins 保持不变
-        // player.inventory 保持不变
     }
     
     // 重置金币收集状态
@@ -515,37 +852,28 @@ void GameLogic::ResetGameState() {
     finishedPlayersCount_ = 0;
     nextFinishRank_ = 1;
     
-    // 清除减速带
+    // 取消所有定时事件，清除减速带，并重新登记金币
+    timers_.clear();
+    playerTimers_.clear();
+    for (const auto& trap : slowTraps_) {
+        Position cell = ToGrid(trap.second);
+        spatial_.removeTrap(cell.x, cell.y, cell.z);
+    }
     slowTraps_.clear();
+    PlaceCoinsInIndex();
     
     // 恢复所有被破坏的墙壁
     for (const auto& wallPos : brokenWalls_) {
-        int x = std::get<0>(wallPos);
-        int y = std::get<1>(wallPos);
-        int z = std::get<2>(wallPos);
-        if (x >= 0 && x < config_.mazeWidth &&
-            y >= 0 && y < config_.mazeLayers &&
-            z >= 0 && z < config_.mazeHeight) {
-            mazeLayout_[y][x][z] = true;
-        }
+        SetWall(wallPos, true);
+    }
+    if (!brokenWalls_.empty()) {
+        goalField_.build(maze_, ToGrid(endPosition_));
     }
     brokenWalls_.clear();
     wallRepairTimes_.clear();
 }
 
 bool GameLogic::IsValidPosition(float x, float y, float z) const {
-    // 转换为网格坐标
-    int gridX = static_cast<int>(std::round(x));
-    int gridY = static_cast<int>(std::round(y));
-    int gridZ = static_cast<int>(std::round(z));
-    
-    // 检查边界
-    if (gridX < 0 || gridX >= config_.mazeWidth ||
-        gridY < 0 || gridY >= config_.mazeLayers ||
-        gridZ < 0 || gridZ >= config_.mazeHeight) {
-        return false;
-    }
-    
-    // 检查是否为墙壁
-    return !mazeLayout_[gridY][gridX][gridZ];
-}
\ No newline at end of file
+    // 在迷宫范围内且不是墙壁
+    return !CheckCollision(x, y, z);
+}
@@ -0,0 +1,577 @@
+#include "GameMessageHandlers.h"
+#include "PlayerManager.h"
+#include "DataManager.h"
+#include "NetworkManager.h"
+#include "SnapshotReplicator.h"
+#include "TickScheduler.h"
+#include "MessageRouter.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+
+// 聊天消息长度上限（字节，客户端限制为200个字符）
+const size_t MAX_CHAT_MESSAGE_LENGTH = 800;
+
+// 一次聊天历史请求最多返回的条数
+const int MAX_CHAT_HISTORY_LINES = 200;
+const int DEFAULT_CHAT_HISTORY_LINES = 50;
+
+// 解析客户端移动方向
+bool ParseMoveDirection(const std::string& name, MoveDirection& direction) {
+    if (name == "forward") direction = MoveDirection::FORWARD;
+    else if (name == "backward") direction = MoveDirection::BACKWARD;
+    else if (name == "left") direction = MoveDirection::LEFT;
+    else if (name == "right") direction = MoveDirection::RIGHT;
+    else if (name == "up") direction = MoveDirection::UP;
+    else if (name == "down") direction = MoveDirection::DOWN;
+    else return false;
+    return true;
+}
+
+nlohmann::json PositionToJson(const PlayerView& player) {
+    return {{"x", player.x()}, {"y", player.y()}, {"z", player.z()}};
+}
+
+} // namespace
+
+GameMessageHandlers::GameMessageHandlers(GameLogic& gameLogic, PlayerManager& playerManager,
+                                         DataManager& dataManager, NetworkManager& networkManager,
+                                         SnapshotReplicator& snapshotReplicator, TickScheduler& tickScheduler)
+    : gameLogic_(gameLogic), playerManager_(playerManager), dataManager_(dataManager), networkManager_(networkManager),
+      snapshotReplicator_(snapshotReplicator), tickScheduler_(tickScheduler) {}
+
+void GameMessageHandlers::SetMazeChunks(std::shared_ptr<const MazeChunkSet> chunks) {
+    mazeChunks_ = std::move(chunks);
+    mazeChunkFrames_.clear();
+    if (!mazeChunks_) {
+        return;
+    }
+    for (const std::string& chunk : mazeChunks_->chunks) {
+        std::string message = encodeMazeChunkMessage(chunk);
+        mazeChunkFrames_.push_back(
+            PreparedFrame::binary(reinterpret_cast<const uint8_t*>(message.data()), message.size()));
+    }
+}
+
+void GameMessageHandlers::RegisterRoutes(MessageRouter& router) {
+    using namespace std::placeholders;
+
+    router.onConnection(std::bind(&GameMessageHandlers::HandleConnection, this, _1, _2));
+
+    router.onJson("auth", std::bind(&GameMessageHandlers::HandleAuth, this, _1, _2));
+    router.onJson("move", std::bind(&GameMessageHandlers::HandleMove, this, _1, _2));
+    router.onJson("snapshot_ack", std::bind(&GameMessageHandlers::HandleSnapshotAck, this, _1, _2));
+    router.onJson("ping", std::bind(&GameMessageHandlers::HandlePing, this, _1, _2));
+    router.onJson("purchase_item", std::bind(&GameMessageHandlers::HandlePurchaseItem, this, _1, _2));
+    router.onJson("use_item", std::bind(&GameMessageHandlers::HandleUseItem, this, _1, _2));
+    router.onJson("collect_coin", std::bind(&GameMessageHandlers::HandleCollectCoin, this, _1, _2));
+    router.onJson("chat_message", std::bind(&GameMessageHandlers::HandleChatMessage, this, _1, _2));
+    router.onJson("chat_history", std::bind(&GameMessageHandlers::HandleChatHistory, this, _1, _2));
+
+    router.onBinary<InputMessage>(BinaryOpcode::INPUT, "bin:input",
+        std::bind(&GameMessageHandlers::HandleInput, this, _1, _2));
+    router.onBinary<PingMessage>(BinaryOpcode::PING, "bin:ping",
+        std::bind(&GameMessageHandlers::HandleBinaryPing, this, _1, _2));
+    router.onBinary<SnapshotAckMessage>(BinaryOpcode::SNAPSHOT_ACK, "bin:snapshot_ack",
+        std::bind(&GameMessageHandlers::HandleBinarySnapshotAck, this, _1, _2));
+}
+
+// ==================== 连接与认证 ====================
+
+void GameMessageHandlers::HandleConnection(int clientId, bool connected) {
+    Logger& logger = Logger::getInstance();
+    if (connected) {
+        logger.info(LogCategory::NETWORK, "客户端连接: " + std::to_string(clientId));
+        return;
+    }
+
+    logger.info(LogCategory::NETWORK, "客户端断开: " + std::to_string(clientId));
+
+    // 注销玩家并通知其他客户端
+    auto it = sessions_.find(clientId);
+    if (it == sessions_.end()) {
+        return;
+    }
+
+    gameLogic_.RemovePlayer(clientId);
+    playerManager_.LogoutPlayer(it->second.playerId);
+    snapshotReplicator_.RemoveClient(clientId);
+
+    nlohmann::json leaveMessage;
+    leaveMessage["type"] = "player_leave";
+    leaveMessage["playerId"] = it->second.playerId;
+    leaveMessage["entityId"] = clientId;
+    BroadcastToSessions(leaveMessage.dump(), clientId);
+
+    std::string playerId = it->second.playerId;
+    sessions_.erase(it);
+    if (sessionListener_) {
+        sessionListener_(clientId, playerId, false);
+    }
+}
+
+void GameMessageHandlers::HandleAuth(int clientId, const nlohmann::json& message) {
+    Logger& logger = Logger::getInstance();
+
+    std::string playerId = message.value("playerId", "");
+    std::string playerName = message.value("playerName", "");
+    std::string token = message.value("token", "");
+    // 客户端支持的二进制协议版本，版本一致时高频消息改用二进制帧
+    WireFormat wireFormat = message.value("binaryProtocol", 0) == BINARY_PROTOCOL_VERSION
+        ? WireFormat::BINARY : WireFormat::JSON;
+
+    logger.info(LogCategory::NETWORK, "处理认证请求 - 玩家: " + playerName + ", ID: " + playerId);
+
+    // 没有有效的playerId时先用上次下发的令牌找回玩家，否则注册新玩家并下发新令牌
+    if (playerId.empty() || !playerManager_.IsValidPlayerId(playerId)) {
+        playerId = playerManager_.FindPlayerByToken(token);
+        if (playerId.empty()) {
+            playerId = playerManager_.RegisterAnonymousPlayer(token);
+        }
+
+        if (playerId.empty()) {
+            nlohmann::json authResponse;
+            authResponse["type"] = "auth_failed";
+            authResponse["message"] = "无法注册玩家，请重试";
+            authResponse["status"] = "failed";
+            networkManager_.sendToClient(clientId, authResponse.dump());
+            logger.error(LogCategory::PLAYER, "玩家注册失败: " + playerName);
+            return;
+        }
+    }
+
+    if (!playerManager_.LoginPlayer(playerId)) {
+        nlohmann::json authResponse;
+        authResponse["type"] = "auth_failed";
+        authResponse["message"] = "登录失败，请重试";
+        authResponse["status"] = "failed";
+        networkManager_.sendToClient(clientId, authResponse.dump());
+        logger.warning(LogCategory::PLAYER, "玩家登录失败: " + playerName);
+        return;
+    }
+
+    // 加入游戏世界（重复认证时保留原有状态）
+    bool isNewSession = sessions_.find(clientId) == sessions_.end();
+    if (isNewSession) {
+        gameLogic_.AddPlayer(clientId, gameLogic_.GetStartPosition());
+    }
+    snapshotReplicator_.AddClient(clientId, wireFormat);
+    // 重复认证时保留 lastCompass，不重发没有变化的指南针提示
+    ClientSession& current = sessions_[clientId];
+    current.playerId = playerId;
+    current.playerName = playerName;
+    current.wireFormat = wireFormat;
+    if (sessionListener_) {
+        sessionListener_(clientId, playerId, true);
+    }
+    PlayerView playerState = gameLogic_.GetPlayerView(clientId);
+
+    // 二进制客户端直接推送所在层及相邻层的迷宫分块，其余层（和JSON客户端）按清单通过HTTP获取
+    std::vector<int> pushedLayers;
+    if (wireFormat == WireFormat::BINARY && !mazeChunkFrames_.empty()) {
+        int layer = static_cast<int>(std::round(playerState.y()));
+        for (int l = layer - 1; l <= layer + 1; ++l) {
+            if (l >= 0 && l < static_cast<int>(mazeChunkFrames_.size())) {
+                pushedLayers.push_back(l);
+            }
+        }
+    }
+
+    // 发送认证成功消息
+    nlohmann::json authResponse;
+    authResponse["type"] = "auth_success";
+    authResponse["playerId"] = playerId;
+    authResponse["playerName"] = playerName;
+    authResponse["entityId"] = clientId;
+    authResponse["roomId"] = roomId_;
+    authResponse["tickRate"] = tickScheduler_.getTickRate();
+    authResponse["protocol"] = wireFormat == WireFormat::BINARY ? "binary" : "json";
+    authResponse["protocolVersion"] = BINARY_PROTOCOL_VERSION;
+    if (mazeChunks_) {
+        authResponse["maze"] = MazeManifestToJson(pushedLayers);
+    }
+    authResponse["status"] = "success";
+    // 令牌即玩家记录中的cookie（由MAC地址注册的玩家没有令牌）
+    token = playerManager_.GetPlayerData(playerId).cookie;
+    if (PlayerManager::IsIssuedToken(token)) {
+        authResponse["token"] = token;
+    }
+    networkManager_.sendToClient(clientId, authResponse.dump());
+    for (int layer : pushedLayers) {
+        networkManager_.sendPrepared(clientId, mazeChunkFrames_[layer]);
+    }
+
+    // 发送初始游戏数据
+    nlohmann::json playerDataResponse;
+    playerDataResponse["type"] = "player_data";
+    playerDataResponse["playerId"] = playerId;
+    playerDataResponse["playerName"] = playerName;
+    playerDataResponse["coins"] = playerState.coins();
+    playerDataResponse["position"] = PositionToJson(playerState);
+    playerDataResponse["inventory"] = InventoryToJson(playerState);
+    networkManager_.sendToClient(clientId, playerDataResponse.dump());
+
+    if (isNewSession) {
+        // 告知新玩家已在线的其他玩家，并通知其他玩家有人加入
+        for (const auto& session : sessions_) {
+            if (session.first == clientId) {
+                continue;
+            }
+            nlohmann::json existingPlayer;
+            existingPlayer["type"] = "player_join";
+            existingPlayer["playerId"] = session.second.playerId;
+            existingPlayer["playerName"] = session.second.playerName;
+            existingPlayer["entityId"] = session.first;
+            networkManager_.sendToClient(clientId, existingPlayer.dump());
+        }
+
+        nlohmann::json joinMessage;
+        joinMessage["type"] = "player_join";
+        joinMessage["playerId"] = playerId;
+        joinMessage["playerName"] = playerName;
+        joinMessage["entityId"] = clientId;
+        joinMessage["position"] = PositionToJson(playerState);
+        BroadcastToSessions(joinMessage.dump(), clientId);
+    }
+
+    logger.info(LogCategory::PLAYER, "玩家认证成功: " + playerName + " (ID: " + playerId + ")");
+}
+
+// ==================== 移动与同步 ====================
+
+void GameMessageHandlers::HandleMove(int clientId, const nlohmann::json& data) {
+    uint8_t directionBits = 0;
+    auto directions = data.find("directions");
+    if (directions != data.end() && directions->is_array()) {
+        for (const auto& name : *directions) {
+            MoveDirection direction;
+            if (name.is_string() && ParseMoveDirection(name.get<std::string>(), direction)) {
+                directionBits |= static_cast<uint8_t>(1u << static_cast<int>(direction));
+            }
+        }
+    }
+
+    float rotation = 0.0f;
+    bool hasRotation = false;
+    auto value = data.find("rotation");
+    if (value != data.end()) {
+        if (value->is_number()) {
+            rotation = value->get<float>();
+            hasRotation = true;
+        } else if (value->is_object() && value->contains("y") && (*value)["y"].is_number()) {
+            rotation = (*value)["y"].get<float>();
+            hasRotation = true;
+        }
+    }
+
+    ApplyPlayerInput(clientId, directionBits, hasRotation ? &rotation : nullptr);
+}
+
+void GameMessageHandlers::HandleInput(int clientId, const InputMessage& input) {
+    ApplyPlayerInput(clientId, input.directions, &input.rotation);
+}
+
+void GameMessageHandlers::ApplyPlayerInput(int clientId, uint8_t directionBits, const float* rotation) {
+    if (!FindSession(clientId)) {
+        return;
+    }
+    // 输入在下一帧统一结算，服务器权威计算位置，结果随快照下发
+    gameLogic_.QueueInput(clientId, directionBits, rotation && std::isfinite(*rotation) ? rotation : nullptr);
+}
+
+void GameMessageHandlers::HandleSnapshotAck(int clientId, const nlohmann::json& data) {
+    snapshotReplicator_.Acknowledge(clientId, data.value("tick", 0u));
+}
+
+void GameMessageHandlers::HandleBinarySnapshotAck(int clientId, const SnapshotAckMessage& ack) {
+    snapshotReplicator_.Acknowledge(clientId, ack.tick);
+}
+
+void GameMessageHandlers::HandlePing(int clientId, const nlohmann::json& data) {
+    nlohmann::json pongResponse;
+    pongResponse["type"] = "pong";
+    pongResponse["timestamp"] = data.value("timestamp", 0.0);
+    networkManager_.sendToClient(clientId, pongResponse.dump());
+}
+
+void GameMessageHandlers::HandleBinaryPing(int clientId, const PingMessage& ping) {
+    std::string pong = encodePongMessage(ping.timestamp);
+    networkManager_.sendPrepared(clientId,
+        PreparedFrame::binary(reinterpret_cast<const uint8_t*>(pong.data()), pong.size()));
+}
+
+void GameMessageHandlers::SendCompassUpdates() {
+    for (auto& session : sessions_) {
+        CompassHint hint;
+        if (!gameLogic_.GetCompassHint(session.first, hint)) {
+            continue;
+        }
+
+        const CompassHint& last = session.second.lastCompass;
+        if (hint.distance == last.distance && hint.dx == last.dx && hint.dy == last.dy && hint.dz == last.dz) {
+            continue;
+        }
+        session.second.lastCompass = hint;
+
+        nlohmann::json compass;
+        compass["type"] = "compass";
+        compass["direction"] = {{"x", hint.dx}, {"y", hint.dy}, {"z", hint.dz}};
+        compass["distance"] = hint.distance;
+        networkManager_.sendToClient(session.first, compass.dump());
+    }
+}
+
+// ==================== 道具与金币 ====================
+
+void GameMessageHandlers::HandlePurchaseItem(int clientId, const nlohmann::json& data) {
+    if (!FindSession(clientId)) {
+        return;
+    }
+
+    ItemType itemType;
+    if (!ParseItemType(data.value("itemType", ""), itemType)) {
+        SendError(clientId, "INVALID_TARGET", "未知的道具类型");
+        return;
+    }
+
+    if (!gameLogic_.PurchaseItem(clientId, itemType)) {
+        SendError(clientId, "INSUFFICIENT_COINS");
+        return;
+    }
+
+    SendGameState(clientId);
+}
+
+void GameMessageHandlers::HandleUseItem(int clientId, const nlohmann::json& data) {
+    const ClientSession* session = FindSession(clientId);
+    if (!session) {
+        return;
+    }
+
+    ItemType itemType;
+    if (!ParseItemType(data.value("itemType", ""), itemType)) {
+        SendError(clientId, "INVALID_TARGET", "未知的道具类型");
+        return;
+    }
+
+    // 目标玩家：优先使用实体编号，其次使用playerId
+    int targetClientId = -1;
+    if (data.contains("targetEntityId") && data["targetEntityId"].is_number_integer()) {
+        targetClientId = data["targetEntityId"].get<int>();
+    } else if (data.contains("targetPlayerId") && data["targetPlayerId"].is_string()) {
+        targetClientId = FindClientByPlayerId(data["targetPlayerId"].get<std::string>());
+    }
+
+    std::tuple<int, int, int> targetPos{-1, -1, -1};
+    auto position = data.find("targetPosition");
+    if (position != data.end() && position->is_object()) {
+        targetPos = std::make_tuple(
+            static_cast<int>(std::lround(position->value("x", -1.0))),
+            static_cast<int>(std::lround(position->value("y", -1.0))),
+            static_cast<int>(std::lround(position->value("z", -1.0))));
+    }
+
+    bool needsTarget = itemType == ItemType::KILL_SWORD || itemType == ItemType::SWAP_ITEM;
+    if (needsTarget && targetClientId < 0 && std::get<0>(targetPos) >= 0) {
+        // 只给了目标位置：选择该位置附近最近的玩家
+        targetClientId = gameLogic_.FindNearestPlayer(targetPos, 1, clientId);
+    }
+    if (needsTarget && (targetClientId < 0 || !FindSession(targetClientId) || targetClientId == clientId)) {
+        SendError(clientId, "INVALID_TARGET");
+        return;
+    }
+
+    if (!gameLogic_.UseItem(clientId, itemType, targetClientId, targetPos)) {
+        SendError(clientId, "ITEM_NOT_OWNED");
+        return;
+    }
+
+    // 可见效果广播给所有人，库存只发给使用者
+    nlohmann::json effectMessage;
+    effectMessage["type"] = "item_used";
+    effectMessage["playerId"] = session->playerId;
+    effectMessage["itemType"] = data.value("itemType", "");
+    if (itemType == ItemType::SPEED_POTION) {
+        effectMessage["effect"] = "speed";
+        effectMessage["targetPosition"] = PositionToJson(gameLogic_.GetPlayerView(clientId));
+    } else if (itemType == ItemType::KILL_SWORD) {
+        effectMessage["effect"] = "death";
+        effectMessage["targetPosition"] = PositionToJson(gameLogic_.GetPlayerView(targetClientId));
+    }
+    BroadcastToSessions(effectMessage.dump(), clientId);
+
+    effectMessage["inventory"] = InventoryToJson(gameLogic_.GetPlayerView(clientId));
+    networkManager_.sendToClient(clientId, effectMessage.dump());
+}
+
+void GameMessageHandlers::HandleCollectCoin(int clientId, const nlohmann::json& data) {
+    const ClientSession* session = FindSession(clientId);
+    if (!session) {
+        return;
+    }
+
+    int coinId = data.value("coinId", -1);
+    const auto& coinPositions = gameLogic_.GetCoinPositions();
+    if (coinId < 0 || coinId >= static_cast<int>(coinPositions.size())) {
+        SendError(clientId, "INVALID_TARGET");
+        return;
+    }
+
+    // 只允许拾取身边的金币（同一层，水平距离不超过1格）
+    PlayerView player = gameLogic_.GetPlayerView(clientId);
+    const auto& coin = coinPositions[coinId];
+    if (std::lround(player.y()) != std::get<1>(coin) ||
+        std::fabs(player.x() - std::get<0>(coin)) > 1.0f ||
+        std::fabs(player.z() - std::get<2>(coin)) > 1.0f) {
+        SendError(clientId, "INVALID_TARGET", "距离金币太远");
+        return;
+    }
+
+    if (!gameLogic_.CollectCoin(clientId, coinId)) {
+        return;  // 已被他人拾取，快照会同步最新状态
+    }
+
+    nlohmann::json event;
+    event["type"] = "game_event";
+    event["eventType"] = "coin_collected";
+    event["playerId"] = session->playerId;
+    event["coinId"] = coinId;
+    event["totalCoins"] = gameLogic_.GetPlayerView(clientId).coins();
+    BroadcastToSessions(event.dump());
+}
+
+// ==================== 聊天 ====================
+
+void GameMessageHandlers::HandleChatMessage(int clientId, const nlohmann::json& data) {
+    const ClientSession* session = FindSession(clientId);
+    if (!session) {
+        return;
+    }
+
+    std::string text = data.value("message", "");
+    if (text.empty()) {
+        return;
+    }
+    if (text.size() > MAX_CHAT_MESSAGE_LENGTH) {
+        text.resize(MAX_CHAT_MESSAGE_LENGTH);
+    }
+
+    nlohmann::json chatMessage;
+    chatMessage["type"] = "chat_message";
+    chatMessage["playerId"] = session->playerId;
+    chatMessage["playerName"] = session->playerName;
+    chatMessage["message"] = text;
+    // 截断可能切开UTF-8字符，替换非法字节而不是抛出异常
+    BroadcastToSessions(chatMessage.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+
+    dataManager_.AppendChatLog(session->playerName, text);
+}
+
+void GameMessageHandlers::HandleChatHistory(int clientId, const nlohmann::json& data) {
+    if (!FindSession(clientId)) {
+        return;
+    }
+
+    int limit = DEFAULT_CHAT_HISTORY_LINES;
+    if (data.contains("limit") && data["limit"].is_number_integer()) {
+        limit = std::max(1, std::min(data["limit"].get<int>(), MAX_CHAT_HISTORY_LINES));
+    }
+
+    nlohmann::json response;
+    response["type"] = "chat_history";
+    response["messages"] = dataManager_.GetChatLog(limit);
+    networkManager_.sendToClient(clientId, response.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+}
+
+// ==================== 辅助函数 ====================
+
+void GameMessageHandlers::BroadcastToSessions(const std::string& message, int excludeClientId) {
+    SharedFrame frame = PreparedFrame::text(message);
+    for (const auto& session : sessions_) {
+        if (session.first != excludeClientId) {
+            networkManager_.sendPrepared(session.first, frame);
+        }
+    }
+}
+
+void GameMessageHandlers::SendError(int clientId, const std::string& code, const std::string& message) {
+    nlohmann::json error;
+    error["type"] = "error";
+    error["code"] = code;
+    if (!message.empty()) {
+        error["message"] = message;
+    }
+    networkManager_.sendToClient(clientId, error.dump());
+}
+
+void GameMessageHandlers::SendGameState(int clientId) {
+    PlayerView player = gameLogic_.GetPlayerView(clientId);
+    nlohmann::json state;
+    state["type"] = "game_state";
+    state["coins"] = player.coins();
+    state["inventory"] = InventoryToJson(player);
+    networkManager_.sendToClient(clientId, state.dump());
+}
+
+const GameMessageHandlers::ClientSession* GameMessageHandlers::FindSession(int clientId) const {
+    auto it = sessions_.find(clientId);
+    return it != sessions_.end() ? &it->second : nullptr;
+}
+
+int GameMessageHandlers::FindClientByPlayerId(const std::string& playerId) const {
+    for (const auto& session : sessions_) {
+        if (session.second.playerId == playerId) {
+            return session.first;
+        }
+    }
+    return -1;
+}
+
+nlohmann::json GameMessageHandlers::InventoryToJson(const PlayerView& player) const {
+    auto count = [&player](ItemType itemType) {
+        return player.itemCount(itemType);
+    };
+    return {
+        {"speed_potion", count(ItemType::SPEED_POTION)},
+        {"compass", count(ItemType::COMPASS)},
+        {"hammer", count(ItemType::HAMMER)},
+        {"sword", count(ItemType::KILL_SWORD)},
+        {"slow_trap", count(ItemType::SLOW_TRAP)},
+        {"swap_item", count(ItemType::SWAP_ITEM)}
+    };
+}
+
+nlohmann::json GameMessageHandlers::MazeManifestToJson(const std::vector<int>& pushedLayers) const {
+    // 哈希以十六进制字符串发送（超出JavaScript数字的精确范围）
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(mazeChunks_->mazeHash));
+
+    nlohmann::json urls = nlohmann::json::array();
+    for (int layer = 0; layer < mazeChunks_->layers; ++layer) {
+        urls.push_back(mazeChunks_->chunkPath(layer));
+    }
+    return {
+        {"hash", hash},
+        {"width", mazeChunks_->width},
+        {"height", mazeChunks_->height},
+        {"layers", mazeChunks_->layers},
+        {"chunks", urls},
+        {"pushed", pushedLayers}
+    };
+}
+
+bool GameMessageHandlers::ParseItemType(const std::string& name, ItemType& itemType) {
+    if (name == "speed_potion") itemType = ItemType::SPEED_POTION;
+    else if (name == "compass") itemType = ItemType::COMPASS;
+    else if (name == "hammer") itemType = ItemType::HAMMER;
+    else if (name == "kill_sword" || name == "sword") itemType = ItemType::KILL_SWORD;
+    else if (name == "slow_trap") itemType = ItemType::SLOW_TRAP;
+    else if (name == "swap_item") itemType = ItemType::SWAP_ITEM;
+    else return false;
+    return true;
+}
@@ -0,0 +1,129 @@
+#include "InterestManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+// 世界坐标到单元格（列=x，行=z，层=y），与 GameLogic 的换算一致
+struct Cell {
+    int x, y, layer;
+};
+
+Cell ToCell(float x, float y, float z) {
+    return {static_cast<int>(std::round(x)), static_cast<int>(std::round(z)), static_cast<int>(std::round(y))};
+}
+
+} // namespace
+
+InterestManager::InterestManager(const GameLogic& gameLogic, const InterestConfig& config)
+    : gameLogic_(gameLogic), config_(config) {
+    config_.nearRadius = std::max(0, config_.nearRadius);
+    config_.sightRadius = std::max(config_.nearRadius, config_.sightRadius);
+    config_.farRadius = std::max(config_.nearRadius, config_.farRadius);
+    config_.reducedInterval = std::max(1, config_.reducedInterval);
+    config_.hysteresis = std::max(0, config_.hysteresis);
+}
+
+void InterestManager::ComputeRelevantSet(int viewerId, float x, float y, float z,
+                                         const std::vector<int>& wasVisible, std::vector<Entry>& result) const {
+    result.clear();
+    result.push_back({viewerId, Interest::FULL});
+
+    const SpatialIndex& spatial = gameLogic_.GetSpatialIndex();
+    const PlayerStore& players = gameLogic_.GetPlayers();
+    const Cell viewer = ToCell(x, y, z);
+
+    auto slack = [&](int playerId) {
+        return std::binary_search(wasVisible.begin(), wasVisible.end(), playerId) ? config_.hysteresis : 0;
+    };
+
+    // 同层：近处全速，视线可见全速，较远（被遮挡）降频；相邻层：只同步附近的玩家，降频
+    auto classify = [&](size_t index) {
+        int playerId = players.playerId(index);
+        if (playerId == viewerId) {
+            return;
+        }
+        Cell cell = ToCell(players.x(index), players.y(index), players.z(index));
+        int distance = std::max(std::abs(cell.x - viewer.x), std::abs(cell.y - viewer.y));
+        int bonus = slack(playerId);
+        if (cell.layer == viewer.layer) {
+            if (distance <= config_.nearRadius + bonus) {
+                result.push_back({playerId, Interest::FULL});
+            } else if (distance <= config_.sightRadius + bonus &&
+                       HasLineOfSight(viewer.x, viewer.y, cell.x, cell.y, viewer.layer)) {
+                result.push_back({playerId, Interest::FULL});
+            } else if (distance <= config_.farRadius + bonus) {
+                result.push_back({playerId, Interest::REDUCED});
+            }
+        } else if (std::abs(cell.layer - viewer.layer) == 1 && distance <= config_.nearRadius + bonus) {
+            result.push_back({playerId, Interest::REDUCED});
+        }
+    };
+
+    int sameLayerRadius = std::max(config_.sightRadius, config_.farRadius) + config_.hysteresis;
+    int adjacentRadius = config_.nearRadius + config_.hysteresis;
+    size_t cellsToScan = static_cast<size_t>(2 * sameLayerRadius + 1) * (2 * sameLayerRadius + 1) +
+                         2 * static_cast<size_t>(2 * adjacentRadius + 1) * (2 * adjacentRadius + 1);
+
+    // 玩家比要扫描的格子少得多时直接遍历玩家，否则只查询空间索引中范围内的格子
+    if (players.size() * 4 < cellsToScan) {
+        for (size_t index = 0; index < players.size(); ++index) {
+            classify(index);
+        }
+    } else {
+        auto visit = [&](int playerId) {
+            size_t index = players.indexOf(playerId);
+            if (index != PlayerStore::NPOS) {
+                classify(index);
+            }
+        };
+        spatial.forEachPlayerNear(viewer.x, viewer.y, viewer.layer, sameLayerRadius, visit);
+        spatial.forEachPlayerNear(viewer.x, viewer.y, viewer.layer - 1, adjacentRadius, visit);
+        spatial.forEachPlayerNear(viewer.x, viewer.y, viewer.layer + 1, adjacentRadius, visit);
+    }
+
+    std::sort(result.begin(), result.end(), [](const Entry& a, const Entry& b) { return a.playerId < b.playerId; });
+}
+
+bool InterestManager::IsReducedTick(int playerId, uint32_t tick) const {
+    return (tick + static_cast<uint32_t>(playerId)) % static_cast<uint32_t>(config_.reducedInterval) == 0;
+}
+
+bool InterestManager::HasLineOfSight(int x0, int y0, int x1, int y1, int layer) const {
+    const MazeGrid& maze = gameLogic_.GetMaze();
+    if (!maze.inBounds(x0, y0, layer) || !maze.inBounds(x1, y1, layer)) {
+        return false;
+    }
+
+    // Bresenham 直线；斜向跨格时两侧的格子都是墙视为遮挡（不能从墙角的缝隙看过去）
+    int dx = std::abs(x1 - x0);
+    int dy = -std::abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int error = dx + dy;
+    int x = x0;
+    int y = y0;
+
+    while (x != x1 || y != y1) {
+        int doubled = 2 * error;
+        bool stepX = doubled >= dy;
+        bool stepY = doubled <= dx;
+        if (stepX && stepY && maze.isWall(x + sx, y, layer) && maze.isWall(x, y + sy, layer)) {
+            return false;
+        }
+        if (stepX) {
+            error += dy;
+            x += sx;
+        }
+        if (stepY) {
+            error += dx;
+            y += sy;
+        }
+        if (maze.isWall(x, y, layer)) {
+            return false;
+        }
+    }
+    return true;
+}
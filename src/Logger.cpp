@@ -7,14 +7,55 @@
 #include <chrono>
 #include <mutex>
 #include <filesystem>
+#include <ctime>
+#include <cstdint>
 
 namespace fs = std::filesystem;
 
+namespace {
+
+// 每批最多写出的记录数
+constexpr size_t MAX_BATCH_RECORDS = 1024;
+
+// 队列满时警告和错误日志的重试次数
+constexpr int FULL_QUEUE_RETRIES = 64;
+
+// 写线程空闲时的最长等待，生产者错过唤醒时日志最多延迟这么久
+constexpr auto WRITER_IDLE_WAIT = std::chrono::milliseconds(50);
+
+const char* LevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARNING: return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+    }
+    return "UNKNOWN";
+}
+
+int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::tm LocalTime(std::time_t time) {
+    std::tm tm;
+#ifdef _WIN32
+    localtime_s(&tm, &time);
+#else
+    localtime_r(&time, &tm);
+#endif
+    return tm;
+}
+
+} // namespace
+
 Logger::Logger()
-    : currentLevel_(LogLevel::INFO)
+    : currentLevel_(static_cast<int>(LogLevel::INFO))
     , consoleOutput_(true)
     , fileOutput_(true)
-    , logDirectory_("Data") {
+    , logDirectory_("Data")
+    , queue_(new Record[QUEUE_CAPACITY]) {
     
     // 初始化日志级别颜色
     levelColors_[LogLevel::DEBUG] = "\033[36m";
@@ -30,9 +71,23 @@ Logger::Logger()
     categoryPrefixes_[LogCategory::COMMAND] = "CMD";
     categoryPrefixes_[LogCategory::DATABASE] = "DB";
     categoryPrefixes_[LogCategory::WEB] = "WEB";
+    
+    // 槽位 i 的初始序号为 i，表示可供第 i 次写入
+    for (size_t i = 0; i < QUEUE_CAPACITY; ++i) {
+        queue_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    
+    writer_ = std::thread(&Logger::writerLoop, this);
 }
 
 Logger::~Logger() {
+    // 写线程写完队列中剩余的记录后退出
+    stopping_ = true;
+    wakeup_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    
     if (logFile_.is_open()) {
         logFile_.close();
     }
@@ -44,105 +99,220 @@ Logger& Logger::getInstance() {
 }
 
 bool Logger::initialize(const std::string& logDirectory) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    logDirectory_ = logDirectory;
-    
-    if (!ensureLogDirectory()) {
-        std::cerr << "Failed to create log directory: " << logDirectory_ << std::endl;
-        return false;
-    }
-    
-    rotateLogFileIfNeeded();
-    
-    // 直接记录初始化消息，避免递归调用logSystemEvent
-    std::string message = "Logger initialized - Log directory: " + logDirectory_;
-    std::string timestamp = getCurrentTimeString();
-    std::string levelStr = "INFO";
-    std::string categoryStr = "SYS";
-    
-    std::stringstream logMessage;
-    logMessage << "[" << timestamp << "] " << "[" << levelStr << "] " << "[" << categoryStr << "] " << message;
-    
-    std::string fullMessage = logMessage.str();
-    
-    // 输出到控制台
-    if (consoleOutput_) {
-        outputToConsole(LogLevel::INFO, fullMessage);
-    }
-    
-    // 输出到文件
-    if (fileOutput_) {
-        writeToFile(fullMessage);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        logDirectory_ = logDirectory;
+        
+        if (!ensureLogDirectory()) {
+            std::cerr << "Failed to create log directory: " << logDirectory_ << std::endl;
+            return false;
+        }
+        
+        currentLogDate_.clear();
+        rotateLogFileIfNeeded(getCurrentDateString());
     }
     
+    log(LogLevel::INFO, LogCategory::SYSTEM, "Logger initialized - Log directory: " + logDirectory);
     return true;
 }
 
 void Logger::setLogLevel(LogLevel level) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    currentLevel_ = level;
+    currentLevel_ = static_cast<int>(level);
     
-    // 避免递归调用log，直接输出到std::cout
+    // 直接输出到std::cout
     std::cout << "Log level set to: " << getLevelString(level) << std::endl;
 }
 
 void Logger::setConsoleOutput(bool enabled) {
-    std::lock_guard<std::mutex> lock(mutex_);
     consoleOutput_ = enabled;
     
-    // 避免递归调用log，直接输出到std::cout
+    // 直接输出到std::cout
     std::cout << "Console output " << (enabled ? "enabled" : "disabled") << std::endl;
 }
 
 void Logger::setFileOutput(bool enabled) {
-    std::lock_guard<std::mutex> lock(mutex_);
     fileOutput_ = enabled;
     
-    // 避免递归调用log，直接输出到std::cout
+    // 直接输出到std::cout
     std::cout << "File output " << (enabled ? "enabled" : "disabled") << std::endl;
 }
 
 void Logger::log(LogLevel level, LogCategory category, const std::string& message) {
-    if (static_cast<int>(level) < static_cast<int>(currentLevel_)) {
+    if (!isEnabled(level)) {
         return;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    rotateLogFileIfNeeded();
+    int64_t timeMs = NowMs();
+    if (!tryPush(level, category, timeMs, message)) {
+        // 警告和错误不轻易丢弃：唤醒写线程并让出CPU重试几次
+        bool pushed = false;
+        if (level >= LogLevel::WARNING) {
+            for (int attempt = 0; attempt < FULL_QUEUE_RETRIES && !pushed; ++attempt) {
+                wakeup_.notify_one();
+                std::this_thread::yield();
+                pushed = tryPush(level, category, timeMs, message);
+            }
+        }
+        if (!pushed) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
     
-    std::string timestamp = getCurrentTimeString();
-    std::string levelStr = getLevelString(level);
-    std::string categoryStr = getCategoryString(category);
+    if (writerIdle_.load(std::memory_order_acquire)) {
+        wakeup_.notify_one();
+    }
+}
+
+bool Logger::tryPush(LogLevel level, LogCategory category, int64_t timeMs, const std::string& message) {
+    // 有界多生产者队列：槽位序号等于写入位置时可写，写完后序号+1交给写线程
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    Record* record;
+    while (true) {
+        record = &queue_[pos & (QUEUE_CAPACITY - 1)];
+        size_t sequence = record->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;   // 队列已满
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+    
+    record->level = level;
+    record->category = category;
+    record->timeMs = timeMs;
+    record->message.assign(message);   // 复用槽位字符串的容量
+    record->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void Logger::flush() {
+    size_t target = enqueuePos_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (writtenPos_.load(std::memory_order_acquire) < target && writer_.joinable()) {
+        wakeup_.notify_one();
+        drained_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+void Logger::writerLoop() {
+    while (true) {
+        if (drainBatch() > 0) {
+            drained_.notify_all();
+            continue;
+        }
+        
+        if (stopping_) {
+            break;
+        }
+        
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        writerIdle_.store(true, std::memory_order_release);
+        wakeup_.wait_for(lock, WRITER_IDLE_WAIT, [this] {
+            const Record& next = queue_[dequeuePos_ & (QUEUE_CAPACITY - 1)];
+            return stopping_ || next.sequence.load(std::memory_order_acquire) == dequeuePos_ + 1;
+        });
+        writerIdle_.store(false, std::memory_order_release);
+    }
+}
+
+size_t Logger::drainBatch() {
+    bool toConsole = consoleOutput_;
+    bool toFile = fileOutput_;
+    bool inputInProgress = toConsole && g_commandInputInProgress;
+    bool consoleStarted = false;
+    fileBuffer_.clear();
+    
+    auto emit = [&](const Record& record) {
+        lineBuffer_.clear();
+        formatRecord(record, lineBuffer_);
+        if (toFile) {
+            fileBuffer_ += lineBuffer_;
+            fileBuffer_ += '\n';
+        }
+        if (toConsole) {
+            // 如果有命令正在输入，先清除当前行再输出日志，批末重新显示命令提示符和输入内容
+            if (!consoleStarted && inputInProgress) {
+                std::cout << "\r\033[K";
+            }
+            consoleStarted = true;
+            outputToConsole(record.level, lineBuffer_);
+        }
+    };
     
-    std::stringstream logMessage;
-    logMessage << "[" << timestamp << "] " << "[" << levelStr << "] " << "[" << categoryStr << "] " << message;
+    size_t count = 0;
+    while (count < MAX_BATCH_RECORDS) {
+        Record& record = queue_[dequeuePos_ & (QUEUE_CAPACITY - 1)];
+        if (record.sequence.load(std::memory_order_acquire) != dequeuePos_ + 1) {
+            break;
+        }
+        emit(record);
+        record.sequence.store(dequeuePos_ + QUEUE_CAPACITY, std::memory_order_release);
+        ++dequeuePos_;
+        ++count;
+    }
     
-    std::string fullMessage = logMessage.str();
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reportedDropped_) {
+        Record notice;
+        notice.level = LogLevel::WARNING;
+        notice.timeMs = NowMs();
+        notice.message = "日志队列已满，丢弃 " + std::to_string(dropped - reportedDropped_) + " 条日志";
+        reportedDropped_ = dropped;
+        emit(notice);
+    }
     
-    // 输出到控制台
-    if (consoleOutput_) {
-        // 如果有命令正在输入，先清除当前行再输出日志，然后重新显示命令提示符和输入内容
-        if (g_commandInputInProgress) {
-            // 移动到行首并清除当前行
-            std::cout << "\r\033[K";
-            // 输出日志
-            outputToConsole(level, fullMessage);
-            // 重新显示命令提示符和当前输入的内容
-            // writeToFile("测试项:g_currentInputLine=" + g_currentInputLine);
+    if (consoleStarted) {
+        if (inputInProgress) {
             std::cout << "\033[1;32m命令>\033[0m " << g_currentInputLine;
-            std::cout.flush();
-        } else {
-            // 直接输出日志
-            outputToConsole(level, fullMessage);
-            std::cout.flush();
         }
+        std::cout.flush();
     }
     
-    // 输出到文件
-    if (fileOutput_) {
-        writeToFile(fullMessage);
+    if (!fileBuffer_.empty()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rotateLogFileIfNeeded(cachedDate_);
+        writeToFile(fileBuffer_);
     }
+    
+    writtenPos_.store(dequeuePos_, std::memory_order_release);
+    return count;
+}
+
+void Logger::formatRecord(const Record& record, std::string& out) {
+    // 时间前缀和日期每秒只格式化一次
+    int64_t second = record.timeMs / 1000;
+    if (second != cachedSecond_) {
+        cachedSecond_ = second;
+        std::tm tm = LocalTime(static_cast<std::time_t>(second));
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+        cachedTimePrefix_ = buffer;
+        std::strftime(buffer, sizeof(buffer), "%Y%m%d", &tm);
+        cachedDate_ = buffer;
+    }
+    
+    int milliseconds = static_cast<int>(record.timeMs % 1000);
+    char millis[5] = {'.', static_cast<char>('0' + milliseconds / 100),
+                      static_cast<char>('0' + milliseconds / 10 % 10),
+                      static_cast<char>('0' + milliseconds % 10), '\0'};
+    
+    out += '[';
+    out += cachedTimePrefix_;
+    out += millis;
+    out += "] [";
+    out += LevelName(record.level);
+    out += "] [";
+    auto it = categoryPrefixes_.find(record.category);
+    out += it != categoryPrefixes_.end() ? it->second : "UNKNOWN";
+    out += "] ";
+    out += record.message;
 }
 
 void Logger::debug(LogCategory category, const std::string& message) {
@@ -162,6 +332,10 @@ void Logger::error(LogCategory category, const std::string& message) {
 }
 
 void Logger::logPlayerAction(const std::string& playerId, const std::string& action, const std::string& details) {
+    if (!isEnabled(LogLevel::INFO)) {
+        return;
+    }
+    
     std::string message = "Player " + playerId + " " + action;
     if (!details.empty()) {
         message += " (" + details + ")";
@@ -170,6 +344,10 @@ void Logger::logPlayerAction(const std::string& playerId, const std::string& act
 }
 
 void Logger::logCommand(const std::string& executor, const std::string& command, const std::string& target, bool success) {
+    if (!isEnabled(LogLevel::INFO)) {
+        return;
+    }
+    
     std::string message = executor + " executed command: " + command;
     if (!target.empty()) {
         message += " on " + target;
@@ -179,6 +357,10 @@ void Logger::logCommand(const std::string& executor, const std::string& command,
 }
 
 void Logger::logSystemEvent(const std::string& event, const std::string& details) {
+    if (!isEnabled(LogLevel::INFO)) {
+        return;
+    }
+    
     std::string message = event;
     if (!details.empty()) {
         message += " - " + details;
@@ -187,21 +369,26 @@ void Logger::logSystemEvent(const std::string& event, const std::string& details
 }
 
 std::string Logger::getLogFilePath() const {
+    std::lock_guard<std::mutex> lock(mutex_);
     return currentLogFile_;
 }
 
 void Logger::cleanupOldLogs(int daysToKeep) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::string logDirectory;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        logDirectory = logDirectory_;
+    }
     
     try {
-        if (!fs::exists(logDirectory_)) {
+        if (!fs::exists(logDirectory)) {
             return;
         }
         
         auto now = std::chrono::system_clock::now();
         auto cutoffTime = now - std::chrono::hours(24 * daysToKeep);
         
-        for (const auto& entry : fs::directory_iterator(logDirectory_)) {
+        for (const auto& entry : fs::directory_iterator(logDirectory)) {
             if (entry.is_regular_file()) {
                 std::string filename = entry.path().filename().string();
                 
@@ -227,27 +414,6 @@ void Logger::cleanupOldLogs(int daysToKeep) {
     }
 }
 
-std::string Logger::getCurrentTimeString() const {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
-    
-    std::stringstream ss;
-    
-    std::tm tm;
-#ifdef _WIN32
-    localtime_s(&tm, &time_t);
-#else
-    localtime_r(&time_t, &tm);
-#endif
-    
-    ss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    ss << "." << std::setfill('0') << std::setw(3) << milliseconds.count();
-    
-    return ss.str();
-}
-
 std::string Logger::getCurrentISOTimeString() const {
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
@@ -261,32 +427,14 @@ std::string Logger::getCurrentISOTimeString() const {
 }
 
 std::string Logger::getCurrentDateString() const {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    
-    std::stringstream ss;
-    
-    std::tm tm;
-#ifdef _WIN32
-    localtime_s(&tm, &time_t);
-#else
-    localtime_r(&time_t, &tm);
-#endif
-    
-    ss << std::put_time(&tm, "%Y%m%d");
-    return ss.str();
+    std::tm tm = LocalTime(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y%m%d", &tm);
+    return buffer;
 }
 
 std::string Logger::getLevelString(LogLevel level) const {
-    static const std::map<LogLevel, std::string> levelStrings = {
-        {LogLevel::DEBUG, "DEBUG"},
-        {LogLevel::INFO, "INFO"},
-        {LogLevel::WARNING, "WARN"},
-        {LogLevel::ERROR, "ERROR"}
-    };
-    
-    auto it = levelStrings.find(level);
-    return it != levelStrings.end() ? it->second : "UNKNOWN";
+    return LevelName(level);
 }
 
 std::string Logger::getCategoryString(LogCategory category) const {
@@ -308,10 +456,14 @@ bool Logger::ensureLogDirectory() const {
     }
 }
 
-void Logger::rotateLogFileIfNeeded() {
-    std::string today = getCurrentDateString();
-    std::string newLogFile = (fs::path(logDirectory_) / ("server_" + today + ".log")).string();
+void Logger::rotateLogFileIfNeeded(const std::string& dateString) {
+    // 只在日期变化时重新构建路径
+    if (dateString.empty() || dateString == currentLogDate_) {
+        return;
+    }
+    currentLogDate_ = dateString;
     
+    std::string newLogFile = (fs::path(logDirectory_) / ("server_" + dateString + ".log")).string();
     if (currentLogFile_ != newLogFile) {
         if (logFile_.is_open()) {
             logFile_.close();
@@ -326,9 +478,10 @@ void Logger::rotateLogFileIfNeeded() {
     }
 }
 
-void Logger::writeToFile(const std::string& logMessage) {
+void Logger::writeToFile(const std::string& text) {
+    // 每批只写一次并 flush 一次
     if (logFile_.is_open()) {
-        logFile_ << logMessage << std::endl;
+        logFile_.write(text.data(), static_cast<std::streamsize>(text.size()));
         logFile_.flush();
     }
 }
@@ -355,8 +508,6 @@ void Logger::outputToConsole(LogLevel level, const std::string& message) {
     SetConsoleTextAttribute(hConsole, originalColor);
     std::cout << std::endl;
 #else
-    std::string colorCode = levelColors_.at(level);
-    std::string resetCode = "\033[0m";
-    std::cout << colorCode << message << resetCode << std::endl;
+    std::cout << levelColors_.at(level) << message << "\033[0m\n";
 #endif
 }
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include "MazeChunks.h"
+#include "MazeFile.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+size_t WallBitmapBytes(size_t layerCells) {
+    return (layerCells + 7) / 8;
+}
+
+constexpr size_t SPECIAL_ENTRY_SIZE = 5;
+
+void AppendU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+uint32_t ReadU32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+// 尺寸和类型平面的哈希：相同的迷宫总是得到相同的URL
+uint64_t MazeHash(const MazeGrid& maze) {
+    int32_t dimensions[3] = {maze.getWidth(), maze.getHeight(), maze.getLayers()};
+    uint64_t hash = mazeFileChecksum(reinterpret_cast<const uint8_t*>(dimensions), sizeof(dimensions));
+    return hash ^ mazeFileChecksum(maze.cellData(), maze.getCellCount()) * 1099511628211ULL;
+}
+
+} // namespace
+
+std::string MazeChunkSet::chunkPath(int layer) const {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "/maze/%016llx/%d.bin", static_cast<unsigned long long>(mazeHash), layer);
+    return buffer;
+}
+
+size_t MazeChunkSet::totalBytes() const {
+    size_t total = 0;
+    for (const std::string& chunk : chunks) {
+        total += chunk.size();
+    }
+    return total;
+}
+
+bool encodeMazeChunks(const MazeGrid& maze, MazeChunkSet& chunks) {
+    if (maze.empty() || maze.getWidth() > 0xFFFF || maze.getHeight() > 0xFFFF || maze.getLayers() > 0xFFFF) {
+        return false;
+    }
+
+    MazeChunkSet result;
+    result.mazeHash = MazeHash(maze);
+    result.width = maze.getWidth();
+    result.height = maze.getHeight();
+    result.layers = maze.getLayers();
+
+    const size_t layerCells = static_cast<size_t>(result.width) * result.height;
+    const uint8_t* cells = maze.cellData();
+
+    for (int layer = 0; layer < result.layers; ++layer) {
+        const uint8_t* layerData = cells + layer * layerCells;
+
+        std::string bitmap(WallBitmapBytes(layerCells), '\0');
+        std::string specials;
+        uint32_t specialCount = 0;
+        for (size_t i = 0; i < layerCells; ++i) {
+            CellType type = static_cast<CellType>(layerData[i]);
+            if (type == CellType::WALL) {
+                bitmap[i >> 3] = static_cast<char>(bitmap[i >> 3] | (1u << (i & 7)));
+            } else if (type != CellType::PATH) {
+                AppendU32(specials, static_cast<uint32_t>(i));
+                specials.push_back(static_cast<char>(layerData[i]));
+                specialCount++;
+            }
+        }
+
+        MazeChunkHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.magic = MAZE_CHUNK_MAGIC;
+        header.version = MAZE_CHUNK_VERSION;
+        header.headerSize = sizeof(MazeChunkHeader);
+        header.mazeHash = result.mazeHash;
+        header.width = static_cast<uint16_t>(result.width);
+        header.height = static_cast<uint16_t>(result.height);
+        header.layers = static_cast<uint16_t>(result.layers);
+        header.layer = static_cast<uint16_t>(layer);
+        header.specialCount = specialCount;
+
+        std::string chunk;
+        chunk.reserve(sizeof(header) + bitmap.size() + specials.size());
+        chunk.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        chunk += bitmap;
+        chunk += specials;
+        result.chunks.push_back(std::move(chunk));
+    }
+
+    chunks = std::move(result);
+    return true;
+}
+
+bool decodeMazeChunk(const uint8_t* data, size_t size, MazeGrid& maze) {
+    if (size < sizeof(MazeChunkHeader)) {
+        return false;
+    }
+    MazeChunkHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != MAZE_CHUNK_MAGIC || header.version != MAZE_CHUNK_VERSION ||
+        header.headerSize < sizeof(MazeChunkHeader) || header.headerSize > size) {
+        return false;
+    }
+    if (header.width != maze.getWidth() || header.height != maze.getHeight() ||
+        header.layers != maze.getLayers() || header.layer >= header.layers) {
+        return false;
+    }
+
+    const size_t layerCells = static_cast<size_t>(header.width) * header.height;
+    const size_t bitmapBytes = WallBitmapBytes(layerCells);
+    if (size != header.headerSize + bitmapBytes + static_cast<size_t>(header.specialCount) * SPECIAL_ENTRY_SIZE) {
+        return false;
+    }
+
+    const uint8_t* bitmap = data + header.headerSize;
+    std::vector<uint8_t> cells(layerCells);
+    for (size_t i = 0; i < layerCells; ++i) {
+        bool wall = (bitmap[i >> 3] >> (i & 7)) & 1;
+        cells[i] = static_cast<uint8_t>(wall ? CellType::WALL : CellType::PATH);
+    }
+
+    const uint8_t* special = bitmap + bitmapBytes;
+    for (uint32_t n = 0; n < header.specialCount; ++n, special += SPECIAL_ENTRY_SIZE) {
+        uint32_t index = ReadU32(special);
+        if (index >= layerCells || special[4] > static_cast<uint8_t>(CellType::END)) {
+            return false;
+        }
+        cells[index] = special[4];
+    }
+
+    return maze.assignLayer(header.layer, cells.data());
+}
@@ -0,0 +1,222 @@
+#include "MazeFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+    #define MAZE_FILE_NO_MMAP
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+// 迷宫尺寸上限，防止损坏的头部导致巨大的分配
+constexpr uint64_t MAX_CELL_COUNT = uint64_t(1) << 32;
+
+size_t WallPlaneBytes(uint64_t cellCount) {
+    return static_cast<size_t>((cellCount + 63) / 64 * sizeof(uint64_t));
+}
+
+void AppendIndex(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint32_t ReadIndex(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+           (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+} // namespace
+
+uint64_t mazeFileChecksum(const uint8_t* data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool saveMazeFile(const std::string& path, const MazeGrid& maze, uint64_t seed) {
+    if (maze.empty() || maze.getCellCount() > MAX_CELL_COUNT) {
+        return false;
+    }
+
+    MazeFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = MAZE_FILE_MAGIC;
+    header.version = MAZE_FILE_VERSION;
+    header.headerSize = sizeof(MazeFileHeader);
+    header.width = maze.getWidth();
+    header.height = maze.getHeight();
+    header.layers = maze.getLayers();
+    header.seed = seed;
+    for (int i = 0; i < 3; ++i) {
+        header.start[i] = -1;
+        header.end[i] = -1;
+    }
+
+    // 载荷：墙壁位平面 + 楼梯表 + 金币表
+    size_t wallBytes = WallPlaneBytes(maze.getCellCount());
+    std::vector<uint8_t> payload(wallBytes);
+    std::memcpy(payload.data(), maze.wallData(), wallBytes);
+
+    std::vector<uint32_t> stairs, coins;
+    size_t layerStride = maze.getLayerStride();
+    for (size_t i = 0; i < maze.getCellCount(); ++i) {
+        CellType type = maze.cellAt(i);
+        if (type == CellType::STAIR_DOWN && i + layerStride < maze.getCellCount() &&
+            maze.cellAt(i + layerStride) == CellType::STAIR_UP) {
+            stairs.push_back(static_cast<uint32_t>(i));
+        } else if (type == CellType::COIN) {
+            coins.push_back(static_cast<uint32_t>(i));
+        } else if (type == CellType::START || type == CellType::END) {
+            Position cell = maze.positionOf(i);
+            int32_t* target = type == CellType::START ? header.start : header.end;
+            target[0] = cell.x;
+            target[1] = cell.y;
+            target[2] = cell.z;
+        }
+    }
+    for (uint32_t index : stairs) {
+        AppendIndex(payload, index);
+    }
+    for (uint32_t index : coins) {
+        AppendIndex(payload, index);
+    }
+    header.stairCount = static_cast<uint32_t>(stairs.size());
+    header.coinCount = static_cast<uint32_t>(coins.size());
+    header.checksum = mazeFileChecksum(payload.data(), payload.size());
+
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        if (!file.good()) {
+            file.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool parseMazeFile(const uint8_t* data, size_t size, MazeGrid& maze, MazeFileInfo* info) {
+    if (size < sizeof(MazeFileHeader)) {
+        return false;
+    }
+
+    MazeFileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != MAZE_FILE_MAGIC || header.version != MAZE_FILE_VERSION ||
+        header.headerSize != sizeof(MazeFileHeader) ||
+        header.width <= 0 || header.height <= 0 || header.layers <= 0) {
+        return false;
+    }
+
+    uint64_t cellCount = static_cast<uint64_t>(header.width) * header.height * header.layers;
+    if (cellCount > MAX_CELL_COUNT) {
+        return false;
+    }
+
+    size_t wallBytes = WallPlaneBytes(cellCount);
+    uint64_t payloadSize = wallBytes + (static_cast<uint64_t>(header.stairCount) + header.coinCount) * 4;
+    if (size != sizeof(MazeFileHeader) + payloadSize) {
+        return false;
+    }
+
+    const uint8_t* payload = data + sizeof(MazeFileHeader);
+    if (mazeFileChecksum(payload, static_cast<size_t>(payloadSize)) != header.checksum) {
+        return false;
+    }
+
+    // 先在临时网格中恢复，全部校验通过后再交换，失败时不破坏调用方的网格
+    MazeGrid grid;
+    grid.assignWalls(header.width, header.height, header.layers, payload);
+
+    const uint8_t* table = payload + wallBytes;
+    size_t layerStride = grid.getLayerStride();
+    for (uint32_t i = 0; i < header.stairCount; ++i, table += 4) {
+        uint32_t index = ReadIndex(table);
+        if (index + layerStride >= cellCount) {
+            return false;
+        }
+        grid.setCellAt(index, CellType::STAIR_DOWN);
+        grid.setCellAt(index + layerStride, CellType::STAIR_UP);
+    }
+    for (uint32_t i = 0; i < header.coinCount; ++i, table += 4) {
+        uint32_t index = ReadIndex(table);
+        if (index >= cellCount) {
+            return false;
+        }
+        grid.setCellAt(index, CellType::COIN);
+    }
+    if (header.start[0] >= 0) {
+        grid.setCell(header.start[0], header.start[1], header.start[2], CellType::START);
+    }
+    if (header.end[0] >= 0) {
+        grid.setCell(header.end[0], header.end[1], header.end[2], CellType::END);
+    }
+
+    maze = std::move(grid);
+    if (info) {
+        info->seed = header.seed;
+        info->version = header.version;
+        info->fileSize = size;
+    }
+    return true;
+}
+
+bool loadMazeFile(const std::string& path, MazeGrid& maze, MazeFileInfo* info) {
+#ifdef MAZE_FILE_NO_MMAP
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parseMazeFile(data.data(), data.size(), maze, info);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+
+    bool ok = parseMazeFile(static_cast<const uint8_t*>(mapped), size, maze, info);
+    munmap(mapped, size);
+    return ok;
+#endif
+}
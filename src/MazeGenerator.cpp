@@ -1,28 +1,60 @@
 #include "MazeGenerator.h"
-#include <fstream>
-#include <random>
+#include "NavigationField.h"
+#include "MazeFile.h"
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include <iostream>
 
 MazeGenerator::MazeGenerator(int width, int height, int layers) 
-    : width(width), height(height), layers(layers), coinCount(0) {
-    maze.resize(layers);
-    for (int z = 0; z < layers; z++) {
-        maze[z].resize(height);
-        for (int y = 0; y < height; y++) {
-            maze[z][y].resize(width, CellType::WALL);
-        }
-    }
+    : width(width), height(height), layers(layers), maze(width, height, layers), coinCount(0), seed(0) {
 }
 
 MazeGenerator::~MazeGenerator() {}
 
 void MazeGenerator::generateMaze() {
-    initializeMaze();
+    std::random_device rd;
+    generateMaze((static_cast<uint64_t>(rd()) << 32) | rd());
+}
+
+void MazeGenerator::generateMaze(uint64_t newSeed, int threadCount) {
+    seed = newSeed;
+    rng = makeStream(seed, static_cast<uint64_t>(layers));
+    coinCount = 0;
+    
+    // 各层互不依赖，分给工作线程生成到各自的缓冲区
+    std::vector<std::vector<uint8_t>> layerCells(layers);
+    auto buildLayer = [this, &layerCells](int layer) {
+        std::mt19937_64 layerRng = makeStream(seed, static_cast<uint64_t>(layer));
+        generateLayer(layerCells[layer], layerRng);
+    };
+    
+    int workers = threadCount > 0 ? threadCount : static_cast<int>(std::thread::hardware_concurrency());
+    workers = std::max(1, std::min(workers, layers));
+    if (workers == 1) {
+        for (int z = 0; z < layers; z++) {
+            buildLayer(z);
+        }
+    } else {
+        std::atomic<int> nextLayer(0);
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+        for (int i = 0; i < workers; i++) {
+            threads.emplace_back([&nextLayer, &buildLayer, this]() {
+                for (int z = nextLayer++; z < layers; z = nextLayer++) {
+                    buildLayer(z);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
     
-    // 为每一层生成迷宫
+    // 相邻层可能共用墙壁位的同一个字，合并在当前线程完成
+    maze.reset(width, height, layers);
     for (int z = 0; z < layers; z++) {
-        recursiveDivision(1, width - 2, 1, height - 2, z, true);
+        maze.assignLayer(z, layerCells[z].data());
     }
     
     addStairs();
@@ -30,29 +62,30 @@ void MazeGenerator::generateMaze() {
     distributeCoins();
 }
 
-void MazeGenerator::initializeMaze() {
-    // 初始化所有单元格为墙
-    for (int z = 0; z < layers; z++) {
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                maze[z][y][x] = CellType::WALL;
-            }
-        }
+std::mt19937_64 MazeGenerator::makeStream(uint64_t seed, uint64_t stream) {
+    // splitmix64 混合种子和流编号，相邻编号得到的种子也互不相关
+    uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return std::mt19937_64(z ^ (z >> 31));
+}
+
+void MazeGenerator::generateLayer(std::vector<uint8_t>& cells, std::mt19937_64& layerRng) const {
+    // 内部为通路、四周为墙，一次写完
+    cells.assign(static_cast<size_t>(width) * height, static_cast<uint8_t>(CellType::PATH));
+    uint8_t wall = static_cast<uint8_t>(CellType::WALL);
+    std::fill(cells.begin(), cells.begin() + width, wall);
+    std::fill(cells.end() - width, cells.end(), wall);
+    for (int y = 1; y < height - 1; y++) {
+        cells[static_cast<size_t>(y) * width] = wall;
+        cells[static_cast<size_t>(y) * width + width - 1] = wall;
     }
     
-    // 设置边界
-    for (int z = 0; z < layers; z++) {
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                if (x == 0 || x == width - 1 || y == 0 || y == height - 1) {
-                    maze[z][y][x] = CellType::WALL;
-                }
-            }
-        }
-    }
+    recursiveDivision(cells, layerRng, 1, width - 2, 1, height - 2, true);
 }
 
-void MazeGenerator::recursiveDivision(int minX, int maxX, int minY, int maxY, int layer, bool horizontal) {
+void MazeGenerator::recursiveDivision(std::vector<uint8_t>& cells, std::mt19937_64& gen,
+                                      int minX, int maxX, int minY, int maxY, bool horizontal) const {
     // 添加边界检查，确保索引在有效范围内
     if (minX < 1 || maxX >= width - 1 || minY < 1 || maxY >= height - 1) {
         return;
@@ -62,280 +95,185 @@ void MazeGenerator::recursiveDivision(int minX, int maxX, int minY, int maxY, in
         return;
     }
     
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
+    auto cell = [&cells, this](int x, int y) -> uint8_t& {
+        return cells[static_cast<size_t>(y) * width + x];
+    };
     
     if (horizontal) {
         // 水平分割 - 确保wallY在有效范围内
         int rangeY = (maxY - minY) / 2 - 1;
         if (rangeY <= 0) return;
         
-        int wallY = minY + 2 * (gen() % rangeY) + 1;
+        int wallY = minY + 2 * static_cast<int>(gen() % rangeY) + 1;
         if (wallY >= height - 1) wallY = height - 2;
         
         // 创建墙
-        for (int x = minX; x <= maxX && x < width; x++) {
-            if (wallY < height) {
-                maze[layer][wallY][x] = CellType::WALL;
-            }
+        for (int x = minX; x <= maxX; x++) {
+            cell(x, wallY) = static_cast<uint8_t>(CellType::WALL);
         }
         
         // 开一个门 - 确保doorX在有效范围内
         int rangeX = (maxX - minX) / 2;
         if (rangeX <= 0) return;
         
-        int doorX = minX + 2 * (gen() % rangeX) + 1;
+        int doorX = minX + 2 * static_cast<int>(gen() % rangeX) + 1;
         if (doorX >= width - 1) doorX = width - 2;
-        
-        if (wallY < height && doorX < width) {
-            maze[layer][wallY][doorX] = CellType::PATH;
-        }
+        cell(doorX, wallY) = static_cast<uint8_t>(CellType::PATH);
         
         // 递归处理上下两个区域
-        recursiveDivision(minX, maxX, minY, wallY - 1, layer, !horizontal);
-        recursiveDivision(minX, maxX, wallY + 1, maxY, layer, !horizontal);
+        recursiveDivision(cells, gen, minX, maxX, minY, wallY - 1, !horizontal);
+        recursiveDivision(cells, gen, minX, maxX, wallY + 1, maxY, !horizontal);
     } else {
         // 垂直分割 - 确保wallX在有效范围内
         int rangeX = (maxX - minX) / 2 - 1;
         if (rangeX <= 0) return;
         
-        int wallX = minX + 2 * (gen() % rangeX) + 1;
+        int wallX = minX + 2 * static_cast<int>(gen() % rangeX) + 1;
         if (wallX >= width - 1) wallX = width - 2;
         
         // 创建墙
-        for (int y = minY; y <= maxY && y < height; y++) {
-            if (wallX < width) {
-                maze[layer][y][wallX] = CellType::WALL;
-            }
+        for (int y = minY; y <= maxY; y++) {
+            cell(wallX, y) = static_cast<uint8_t>(CellType::WALL);
         }
         
         // 开一个门 - 确保doorY在有效范围内
         int rangeY = (maxY - minY) / 2;
         if (rangeY <= 0) return;
         
-        int doorY = minY + 2 * (gen() % rangeY) + 1;
+        int doorY = minY + 2 * static_cast<int>(gen() % rangeY) + 1;
         if (doorY >= height - 1) doorY = height - 2;
-        
-        if (doorY < height && wallX < width) {
-            maze[layer][doorY][wallX] = CellType::PATH;
-        }
+        cell(wallX, doorY) = static_cast<uint8_t>(CellType::PATH);
         
         // 递归处理左右两个区域
-        recursiveDivision(minX, wallX - 1, minY, maxY, layer, !horizontal);
-        recursiveDivision(wallX + 1, maxX, minY, maxY, layer, !horizontal);
+        recursiveDivision(cells, gen, minX, wallX - 1, minY, maxY, !horizontal);
+        recursiveDivision(cells, gen, wallX + 1, maxX, minY, maxY, !horizontal);
     }
 }
 
 void MazeGenerator::addStairs() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
+    std::mt19937_64& gen = rng;
     
-    // 在每层之间添加楼梯连接
+    // 在每层之间添加楼梯连接：候选为上下两层都是通路的内部格子（层内编号 y * width + x）
+    CellSet candidates;
     for (int z = 0; z < layers - 1; z++) {
+        candidates.reset(static_cast<size_t>(width) * height);
+        for (int y = 1; y < height - 1; y++) {
+            for (int x = 1; x < width - 1; x++) {
+                if (maze.getCell(x, y, z) == CellType::PATH && maze.getCell(x, y, z + 1) == CellType::PATH) {
+                    candidates.insert(static_cast<size_t>(y) * width + x);
+                }
+            }
+        }
+        
         // 每层添加2-3个楼梯
         int stairCount = 2 + (gen() % 2);
-        
         for (int i = 0; i < stairCount; i++) {
-            int attempts = 0;
-            while (attempts < 100) {
-                int x = 1 + gen() % (width - 2);
-                int y = 1 + gen() % (height - 2);
-                
-                // 确保位置是路径且不在边界上
-                if (maze[z][y][x] == CellType::PATH && 
-                    maze[z + 1][y][x] == CellType::PATH &&
-                    !isBorder(x, y, z) && !isBorder(x, y, z + 1)) {
-                    
-                    maze[z][y][x] = CellType::STAIR_DOWN;
-                    maze[z + 1][y][x] = CellType::STAIR_UP;
-                    break;
-                }
-                attempts++;
+            size_t cell = candidates.take(gen);
+            if (cell == CellSet::NPOS) {
+                break;
             }
+            int x = static_cast<int>(cell % width);
+            int y = static_cast<int>(cell / width);
+            maze.setCell(x, y, z, CellType::STAIR_DOWN);
+            maze.setCell(x, y, z + 1, CellType::STAIR_UP);
         }
     }
 }
 
 void MazeGenerator::placeStartAndEnd() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    
-    // 起点在第一层
-    int attempts = 0;
-    bool startFound = false;
-    while (attempts < 100) {
-        int x = 1 + gen() % (width - 2);
-        int y = 1 + gen() % (height - 2);
-        
-        if (x > 0 && x < width - 1 && y > 0 && y < height - 1 &&
-            maze[0][y][x] == CellType::PATH && !isBorder(x, y, 0)) {
-            startPosition = Position(x, y, 0);
-            maze[0][y][x] = CellType::START;
-            startFound = true;
-            break;
-        }
-        attempts++;
-    }
+    std::mt19937_64& gen = rng;
     
-    // 如果没有找到合适的起点，使用备用位置
-    if (!startFound) {
-        for (int y = 1; y < height - 1; y++) {
-            for (int x = 1; x < width - 1; x++) {
-                if (maze[0][y][x] == CellType::PATH) {
-                    startPosition = Position(x, y, 0);
-                    maze[0][y][x] = CellType::START;
-                    startFound = true;
-                    break;
-                }
-            }
-            if (startFound) break;
-        }
-    }
-    
-    // 如果还是没有找到，使用默认位置
-    if (!startFound) {
+    // 起点在第一层的内部通路格子中随机选择
+    CellSet candidates;
+    addPathCells(candidates, 0, 1);
+    size_t cell = candidates.sample(gen);
+    if (cell != CellSet::NPOS) {
+        startPosition = maze.positionOf(cell);
+        maze.setCell(startPosition.x, startPosition.y, 0, CellType::START);
+    } else {
+        // 第一层没有通路时使用默认位置
         startPosition = Position(1, 1, 0);
         if (isValidPosition(1, 1, 0)) {
-            maze[0][1][1] = CellType::START;
+            maze.setCell(1, 1, 0, CellType::START);
         }
     }
     
     // 终点在最高层，距离起点足够远
     endPosition = findFarthestPosition(startPosition);
     if (isValidPosition(endPosition.x, endPosition.y, endPosition.z)) {
-        maze[endPosition.z][endPosition.y][endPosition.x] = CellType::END;
+        maze.setCell(endPosition.x, endPosition.y, endPosition.z, CellType::END);
     }
 }
 
 void MazeGenerator::distributeCoins() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
+    std::mt19937_64& gen = rng;
     
-    // 生成100-120个金币
+    // 生成100-120个金币，放在所有层的内部通路格子上（起点、终点和楼梯已不是通路）
     coinCount = 100 + (gen() % 21);
-    int coinsPlaced = 0;
-    int attempts = 0;
+    CellSet candidates;
+    addPathCells(candidates, 0, layers);
     
-    while (coinsPlaced < coinCount && attempts < 10000) {
-        int x = 1 + gen() % (width - 2);
-        int y = 1 + gen() % (height - 2);
-        int z = gen() % layers;
-        
-        // 确保位置是路径，且不是起点或终点
-        if (maze[z][y][x] == CellType::PATH && 
-            !(x == startPosition.x && y == startPosition.y && z == startPosition.z) &&
-            !(x == endPosition.x && y == endPosition.y && z == endPosition.z)) {
-            
-            maze[z][y][x] = CellType::COIN;
-            coinsPlaced++;
+    int coinsPlaced = 0;
+    while (coinsPlaced < coinCount) {
+        size_t cell = candidates.take(gen);
+        if (cell == CellSet::NPOS) {
+            break;
         }
-        attempts++;
+        maze.setCellAt(cell, CellType::COIN);
+        coinsPlaced++;
     }
     
     coinCount = coinsPlaced; // 实际放置的金币数量
 }
 
-Position MazeGenerator::findFarthestPosition(const Position& from) const {
-    Position farthest;
-    int maxDistance = 0;
-    
-    // 在最高层寻找距离最远的位置
-    int z = layers - 1;
-    for (int y = 1; y < height - 1; y++) {
-        for (int x = 1; x < width - 1; x++) {
-            if (maze[z][y][x] == CellType::PATH) {
-                int dist = calculateDistance(from, Position(x, y, z));
-                if (dist > maxDistance) {
-                    maxDistance = dist;
-                    farthest = Position(x, y, z);
+void MazeGenerator::addPathCells(CellSet& cells, int firstLayer, int lastLayer) const {
+    cells.reset(maze.getCellCount());
+    for (int z = firstLayer; z < lastLayer; z++) {
+        for (int y = 1; y < height - 1; y++) {
+            for (int x = 1; x < width - 1; x++) {
+                if (maze.getCell(x, y, z) == CellType::PATH) {
+                    cells.insert(maze.indexOf(x, y, z));
                 }
             }
         }
     }
+}
+
+Position MazeGenerator::findFarthestPosition(const Position& from) const {
+    // 按真实路径距离（含楼梯）选择最远的位置，优先最高层
+    NavigationField field;
+    field.build(maze, from);
     
-    // 确保距离至少是迷宫尺寸的1/3
-    int minRequiredDistance = (width + height + layers) / 3;
-    if (maxDistance < minRequiredDistance) {
-        // 如果找不到足够远的点，选择最远的可用点
-        return farthest;
+    Position farthest = from;
+    if (!field.findFarthest(maze, CellType::PATH, layers - 1, farthest)) {
+        // 最高层不可达时退而求其次，在所有层中选择
+        field.findFarthest(maze, CellType::PATH, -1, farthest);
     }
-    
     return farthest;
 }
 
 bool MazeGenerator::saveToFile(const std::string& filename) {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        return false;
-    }
-    
-    // 写入尺寸信息
-    file.write(reinterpret_cast<const char*>(&width), sizeof(width));
-    file.write(reinterpret_cast<const char*>(&height), sizeof(height));
-    file.write(reinterpret_cast<const char*>(&layers), sizeof(layers));
-    
-    // 写入迷宫数据
-    for (int z = 0; z < layers; z++) {
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                CellType cell = maze[z][y][x];
-                file.write(reinterpret_cast<const char*>(&cell), sizeof(cell));
-            }
-        }
-    }
-    
-    file.close();
-    return true;
+    // 与 DataManager 使用同一种二进制迷宫文件格式
+    return saveMazeFile(filename, maze, seed);
 }
 
 bool MazeGenerator::loadFromFile(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
+    MazeFileInfo info;
+    if (!loadMazeFile(filename, maze, &info)) {
         return false;
     }
     
-    // 读取尺寸信息
-    int newWidth, newHeight, newLayers;
-    file.read(reinterpret_cast<char*>(&newWidth), sizeof(newWidth));
-    file.read(reinterpret_cast<char*>(&newHeight), sizeof(newHeight));
-    file.read(reinterpret_cast<char*>(&newLayers), sizeof(newLayers));
-    
-    if (newWidth != width || newHeight != height || newLayers != layers) {
-        // 尺寸不匹配，需要重新调整
-        width = newWidth;
-        height = newHeight;
-        layers = newLayers;
-        
-        maze.resize(layers);
-        for (int z = 0; z < layers; z++) {
-            maze[z].resize(height);
-            for (int y = 0; y < height; y++) {
-                maze[z][y].resize(width);
-            }
-        }
-    }
-    
-    // 读取迷宫数据
-    for (int z = 0; z < layers; z++) {
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                CellType cell;
-                file.read(reinterpret_cast<char*>(&cell), sizeof(cell));
-                maze[z][y][x] = cell;
-                
-                // 更新起点和终点位置
-                if (cell == CellType::START) {
-                    startPosition = Position(x, y, z);
-                } else if (cell == CellType::END) {
-                    endPosition = Position(x, y, z);
-                } else if (cell == CellType::COIN) {
-                    coinCount++;
-                }
-            }
-        }
-    }
+    width = maze.getWidth();
+    height = maze.getHeight();
+    layers = maze.getLayers();
+    seed = info.seed;
     
-    file.close();
+    // 更新起点、终点位置和金币数量
+    std::vector<Position> starts = maze.findCells(CellType::START);
+    std::vector<Position> ends = maze.findCells(CellType::END);
+    startPosition = starts.empty() ? Position() : starts.front();
+    endPosition = ends.empty() ? Position() : ends.front();
+    coinCount = static_cast<int>(maze.findCells(CellType::COIN).size());
     return true;
 }
 
@@ -343,7 +281,7 @@ CellType MazeGenerator::getCellType(int x, int y, int z) const {
     if (!isValidPosition(x, y, z)) {
         return CellType::WALL;
     }
-    return maze[z][y][x];
+    return maze.getCell(x, y, z);
 }
 
 bool MazeGenerator::canMove(int x, int y, int z, Direction dir) const {
@@ -351,29 +289,26 @@ bool MazeGenerator::canMove(int x, int y, int z, Direction dir) const {
         return false;
     }
     
-    CellType currentCell = maze[z][y][x];
+    CellType currentCell = maze.getCell(x, y, z);
     
     switch (dir) {
         case Direction::NORTH:
             return isValidPosition(x, y - 1, z) && 
-                   maze[z][y - 1][x] != CellType::WALL;
+                   maze.getCell(x, y - 1, z) != CellType::WALL;
         case Direction::SOUTH:
             return isValidPosition(x, y + 1, z) && 
-                   maze[z][y + 1][x] != CellType::WALL;
+                   maze.getCell(x, y + 1, z) != CellType::WALL;
         case Direction::EAST:
             return isValidPosition(x + 1, y, z) && 
-                   maze[z][y][x + 1] != CellType::WALL;
+                   maze.getCell(x + 1, y, z) != CellType::WALL;
         case Direction::WEST:
             return isValidPosition(x - 1, y, z) && 
-                   maze[z][y][x - 1] != CellType::WALL;
+                   maze.getCell(x - 1, y, z) != CellType::WALL;
         case Direction::UP:
-            return currentCell == CellType::STAIR_UP && 
-                   isValidPosition(x, y, z + 1) && 
-                   maze[z + 1][y][x] != CellType::WALL;
+            // addStairs 在下层放 STAIR_DOWN、上层放 STAIR_UP
+            return currentCell == CellType::STAIR_DOWN && maze.hasStairLink(x, y, z);
         case Direction::DOWN:
-            return currentCell == CellType::STAIR_DOWN && 
-                   isValidPosition(x, y, z - 1) && 
-                   maze[z - 1][y][x] != CellType::WALL;
+            return currentCell == CellType::STAIR_UP && maze.hasStairLink(x, y, z - 1);
         default:
             return false;
     }
@@ -399,7 +334,3 @@ bool MazeGenerator::isValidPosition(int x, int y, int z) const {
 bool MazeGenerator::isBorder(int x, int y, int z) const {
     return x == 0 || x == width - 1 || y == 0 || y == height - 1;
 }
-
-int MazeGenerator::calculateDistance(const Position& a, const Position& b) const {
-    return std::abs(a.x - b.x) + std::abs(a.y - b.y) + std::abs(a.z - b.z);
-}
\ No newline at end of file
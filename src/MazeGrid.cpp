@@ -0,0 +1,134 @@
+#include "MazeGrid.h"
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+
+MazeGrid::MazeGrid()
+    : width(0), height(0), layers(0), cellCount(0), layerStride(0), wallWords(0) {}
+
+MazeGrid::MazeGrid(int width, int height, int layers, CellType fill)
+    : MazeGrid() {
+    reset(width, height, layers, fill);
+}
+
+void MazeGrid::reset(int newWidth, int newHeight, int newLayers, CellType type) {
+    if (newWidth <= 0 || newHeight <= 0 || newLayers <= 0) {
+        newWidth = newHeight = newLayers = 0;
+    }
+
+    width = newWidth;
+    height = newHeight;
+    layers = newLayers;
+    layerStride = static_cast<size_t>(width) * height;
+    cellCount = layerStride * layers;
+    wallWords = (cellCount + 63) / 64;
+
+    storage.assign(wallWords + (cellCount + 7) / 8, 0);
+    fill(type);
+}
+
+void MazeGrid::fill(CellType type) {
+    if (cellCount == 0) {
+        return;
+    }
+
+    std::memset(cellBytes(), static_cast<uint8_t>(type), cellCount);
+
+    uint64_t word = type == CellType::WALL ? ~uint64_t(0) : 0;
+    std::fill(storage.begin(), storage.begin() + wallWords, word);
+    // 清除最后一个字中超出单元格数量的位，保证countWalls和比较结果正确
+    if (word && (cellCount & 63)) {
+        storage[wallWords - 1] = (uint64_t(1) << (cellCount & 63)) - 1;
+    }
+}
+
+void MazeGrid::setCellAt(size_t index, CellType type) {
+    cellBytes()[index] = static_cast<uint8_t>(type);
+    setWallAt(index, type == CellType::WALL);
+}
+
+void MazeGrid::setWallAt(size_t index, bool wall) {
+    uint64_t mask = uint64_t(1) << (index & 63);
+    if (wall) {
+        storage[index >> 6] |= mask;
+    } else {
+        storage[index >> 6] &= ~mask;
+    }
+}
+
+bool MazeGrid::setCell(int x, int y, int layer, CellType type) {
+    if (!inBounds(x, y, layer)) {
+        return false;
+    }
+    setCellAt(indexOf(x, y, layer), type);
+    return true;
+}
+
+bool MazeGrid::setWall(int x, int y, int layer, bool wall) {
+    if (!inBounds(x, y, layer)) {
+        return false;
+    }
+    setWallAt(indexOf(x, y, layer), wall);
+    return true;
+}
+
+void MazeGrid::assignWalls(int newWidth, int newHeight, int newLayers, const void* words) {
+    reset(newWidth, newHeight, newLayers, CellType::PATH);
+    if (cellCount == 0) {
+        return;
+    }
+
+    std::memcpy(storage.data(), words, wallWords * sizeof(uint64_t));
+    if (cellCount & 63) {
+        storage[wallWords - 1] &= (uint64_t(1) << (cellCount & 63)) - 1;
+    }
+
+    // 全零的字整体跳过
+    uint8_t* cells = cellBytes();
+    for (size_t w = 0; w < wallWords; ++w) {
+        uint64_t bits = storage[w];
+        for (size_t bit = 0; bits != 0; ++bit, bits >>= 1) {
+            if (bits & 1u) {
+                cells[(w << 6) + bit] = static_cast<uint8_t>(CellType::WALL);
+            }
+        }
+    }
+}
+
+bool MazeGrid::assignLayer(int layer, const uint8_t* cells) {
+    if (static_cast<unsigned>(layer) >= static_cast<unsigned>(layers)) {
+        return false;
+    }
+
+    size_t begin = static_cast<size_t>(layer) * layerStride;
+    std::memcpy(cellBytes() + begin, cells, layerStride);
+    for (size_t i = 0; i < layerStride; ++i) {
+        setWallAt(begin + i, cells[i] == static_cast<uint8_t>(CellType::WALL));
+    }
+    return true;
+}
+
+std::vector<Position> MazeGrid::findCells(CellType type) const {
+    std::vector<Position> result;
+    const uint8_t* cells = cellBytes();
+    uint8_t value = static_cast<uint8_t>(type);
+    for (size_t i = 0; i < cellCount; ++i) {
+        if (cells[i] == value) {
+            result.push_back(positionOf(i));
+        }
+    }
+    return result;
+}
+
+size_t MazeGrid::countWalls() const {
+    size_t count = 0;
+    for (size_t i = 0; i < wallWords; ++i) {
+        count += std::bitset<64>(storage[i]).count();
+    }
+    return count;
+}
+
+bool MazeGrid::operator==(const MazeGrid& other) const {
+    return width == other.width && height == other.height && layers == other.layers &&
+           storage == other.storage;
+}
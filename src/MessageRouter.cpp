@@ -0,0 +1,186 @@
+#include "MessageRouter.h"
+#include "Logger.h"
+#include "Metrics.h"
+
+#include <array>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+class MessageRouter::Impl {
+public:
+    // 统计直接记入指标注册表；多个房间的路由器注册同名路由时共享同一组指标
+    struct Route {
+        std::string name;
+        JsonHandler jsonHandler;
+        BinaryHandler binaryHandler;
+
+        MetricCounter& count;
+        MetricCounter& errors;
+        MetricHistogram& latency;
+
+        Route(const std::string& routeName, const std::string& kind)
+            : name(routeName)
+            , count(MetricsRegistry::getInstance().counter(
+                  "netlab_router_messages_total{" + routeLabels(kind, routeName) + "}",
+                  "Messages dispatched by the message router"))
+            , errors(MetricsRegistry::getInstance().counter(
+                  "netlab_router_errors_total{" + routeLabels(kind, routeName) + "}",
+                  "Messages that failed to decode or whose handler threw"))
+            , latency(MetricsRegistry::getInstance().histogram(
+                  "netlab_router_handler_seconds{" + routeLabels(kind, routeName) + "}",
+                  "Message handler duration")) {
+        }
+
+        void record(std::chrono::steady_clock::duration elapsed, bool ok) {
+            count.add();
+            if (!ok) {
+                errors.add();
+            }
+            latency.recordDuration(elapsed);
+        }
+
+        static std::string routeLabels(const std::string& kind, const std::string& routeName) {
+            return "kind=\"" + kind + "\",route=\"" + routeName + "\"";
+        }
+    };
+
+    Impl()
+        : unknownJson(MetricsRegistry::getInstance().counter(
+              "netlab_router_unknown_messages_total{kind=\"json\"}", "Messages with no registered route"))
+        , unknownBinary(MetricsRegistry::getInstance().counter(
+              "netlab_router_unknown_messages_total{kind=\"binary\"}", "Messages with no registered route")) {
+    }
+
+    Route* addRoute(const std::string& name, const std::string& kind) {
+        routes.push_back(std::unique_ptr<Route>(new Route(name, kind)));
+        return routes.back().get();
+    }
+
+    std::vector<std::unique_ptr<Route>> routes;
+
+    std::unordered_map<uint32_t, Route*> jsonRoutes;
+    std::array<Route*, 256> binaryRoutes{};
+    ConnectionHandler connectionHandler;
+    MetricCounter& unknownJson;
+    MetricCounter& unknownBinary;
+};
+
+MessageRouter::MessageRouter() : m_impl(new Impl()) {}
+
+MessageRouter::~MessageRouter() = default;
+
+uint32_t MessageRouter::hashType(const char* data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool MessageRouter::onJson(const std::string& type, JsonHandler handler) {
+    uint32_t hash = hashType(type.data(), type.size());
+    auto it = m_impl->jsonRoutes.find(hash);
+    if (it != m_impl->jsonRoutes.end()) {
+        Logger::getInstance().error(LogCategory::NETWORK, "消息类型注册冲突: " + type + " / " + it->second->name);
+        return false;
+    }
+
+    Impl::Route* route = m_impl->addRoute(type, "json");
+    route->jsonHandler = std::move(handler);
+    m_impl->jsonRoutes[hash] = route;
+    return true;
+}
+
+bool MessageRouter::registerBinary(BinaryOpcode opcode, const std::string& name, BinaryHandler handler) {
+    Impl::Route*& slot = m_impl->binaryRoutes[static_cast<uint8_t>(opcode)];
+    if (slot) {
+        Logger::getInstance().error(LogCategory::NETWORK, "二进制操作码重复注册: " + name + " / " + slot->name);
+        return false;
+    }
+
+    Impl::Route* route = m_impl->addRoute(name, "binary");
+    route->binaryHandler = std::move(handler);
+    slot = route;
+    return true;
+}
+
+void MessageRouter::onConnection(ConnectionHandler handler) {
+    m_impl->connectionHandler = std::move(handler);
+}
+
+void MessageRouter::dispatchText(int clientId, const std::string& message) {
+    // NetworkManager投递的连接事件
+    if (message == "CONNECT" || message == "DISCONNECT") {
+        if (m_impl->connectionHandler) {
+            m_impl->connectionHandler(clientId, message == "CONNECT");
+        }
+        return;
+    }
+
+    nlohmann::json jsonData = nlohmann::json::parse(message, nullptr, false);
+    if (jsonData.is_discarded() || !jsonData.is_object()) {
+        m_impl->unknownJson.add();
+        Logger::getInstance().warning(LogCategory::NETWORK, "无法解析的消息，客户端: " + std::to_string(clientId));
+        return;
+    }
+
+    auto typeIt = jsonData.find("type");
+    const std::string* type = (typeIt != jsonData.end() && typeIt->is_string())
+        ? typeIt->get_ptr<const std::string*>() : nullptr;
+    Impl::Route* route = nullptr;
+    if (type) {
+        auto it = m_impl->jsonRoutes.find(hashType(type->data(), type->size()));
+        if (it != m_impl->jsonRoutes.end() && it->second->name == *type) {
+            route = it->second;
+        }
+    }
+    if (!route) {
+        m_impl->unknownJson.add();
+        LOG_DEBUG(LogCategory::NETWORK, "未注册的消息类型: " + (type ? *type : std::string("<none>")));
+        return;
+    }
+
+    // 客户端的 sendMessage 把参数放在 data 字段中
+    auto dataIt = jsonData.find("data");
+    const nlohmann::json& data = (dataIt != jsonData.end() && dataIt->is_object()) ? *dataIt : jsonData;
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = true;
+    try {
+        route->jsonHandler(clientId, data);
+    } catch (const std::exception& e) {
+        ok = false;
+        Logger::getInstance().error(LogCategory::NETWORK,
+            "消息处理异常 [" + route->name + "]: " + std::string(e.what()));
+    }
+    route->record(std::chrono::steady_clock::now() - start, ok);
+}
+
+void MessageRouter::dispatchBinary(int clientId, const std::string& payload) {
+    BinaryOpcode opcode;
+    if (!readBinaryHeader(payload, opcode)) {
+        m_impl->unknownBinary.add();
+        Logger::getInstance().warning(LogCategory::NETWORK, "无效的二进制消息，客户端: " + std::to_string(clientId));
+        return;
+    }
+
+    Impl::Route* route = m_impl->binaryRoutes[static_cast<uint8_t>(opcode)];
+    if (!route) {
+        m_impl->unknownBinary.add();
+        Logger::getInstance().warning(LogCategory::NETWORK, "未知的二进制操作码: " +
+            std::to_string(static_cast<int>(opcode)) + "，客户端: " + std::to_string(clientId));
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = false;
+    try {
+        ok = route->binaryHandler(clientId, payload);
+    } catch (const std::exception& e) {
+        Logger::getInstance().error(LogCategory::NETWORK,
+            "消息处理异常 [" + route->name + "]: " + std::string(e.what()));
+    }
+    route->record(std::chrono::steady_clock::now() - start, ok);
+}
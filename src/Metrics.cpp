@@ -0,0 +1,347 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+
+namespace {
+
+std::atomic<size_t> nextShard{0};
+
+// 直方图导出的分位数
+const double EXPORT_QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+std::string FormatNumber(double value) {
+    char buffer[32];
+    if (std::isfinite(value) && value == std::floor(value) && std::fabs(value) < 1e15) {
+        std::snprintf(buffer, sizeof(buffer), "%.0f", value);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    }
+    return buffer;
+}
+
+// 纳秒转为便于阅读的时间
+std::string FormatDuration(double ns) {
+    char buffer[32];
+    if (ns < 1e3) {
+        std::snprintf(buffer, sizeof(buffer), "%.0fns", ns);
+    } else if (ns < 1e6) {
+        std::snprintf(buffer, sizeof(buffer), "%.1fus", ns / 1e3);
+    } else if (ns < 1e9) {
+        std::snprintf(buffer, sizeof(buffer), "%.2fms", ns / 1e6);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.2fs", ns / 1e9);
+    }
+    return buffer;
+}
+
+// "name{label=\"x\"}" -> "name"
+std::string BaseName(const std::string& name) {
+    return name.substr(0, name.find('{'));
+}
+
+// 给带标签或不带标签的名称追加标签和后缀
+std::string WithLabel(const std::string& name, const std::string& suffix, const std::string& label) {
+    size_t brace = name.find('{');
+    std::string base = name.substr(0, brace);
+    std::string labels = brace == std::string::npos ? std::string() : name.substr(brace + 1, name.size() - brace - 2);
+    if (!label.empty()) {
+        labels = labels.empty() ? label : labels + "," + label;
+    }
+    return base + suffix + (labels.empty() ? std::string() : "{" + labels + "}");
+}
+
+} // namespace
+
+size_t metricShardIndex() {
+    static thread_local size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARD_COUNT;
+    return shard;
+}
+
+uint64_t MetricCounter::value() const {
+    uint64_t total = 0;
+    for (const Slot& slot : slots) {
+        total += slot.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double HistogramSnapshot::percentile(double q) const {
+    if (count == 0 || buckets.empty()) {
+        return 0.0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * count));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            double lower = static_cast<double>(MetricHistogram::bucketLower(i));
+            double upper = static_cast<double>(MetricHistogram::bucketUpper(i));
+            return std::min((lower + upper) / 2.0, static_cast<double>(max));
+        }
+    }
+    return static_cast<double>(max);
+}
+
+MetricHistogram::MetricHistogram()
+    : shards(new Shard[METRIC_SHARD_COUNT]) {
+    for (size_t s = 0; s < METRIC_SHARD_COUNT; ++s) {
+        for (auto& bucket : shards[s].buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+size_t MetricHistogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    int magnitude = 63 - __builtin_clzll(value);
+#else
+    int magnitude = 63;
+    while (!(value >> magnitude)) {
+        --magnitude;
+    }
+#endif
+    if (magnitude > MAX_MAGNITUDE) {
+        return BUCKET_COUNT - 1;
+    }
+    int shift = magnitude - SUB_BUCKET_BITS;
+    return static_cast<size_t>(shift + 1) * SUB_BUCKETS + ((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t MetricHistogram::bucketLower(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    return (SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+}
+
+uint64_t MetricHistogram::bucketUpper(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index + 1;
+    }
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    return (SUB_BUCKETS + index % SUB_BUCKETS + 1) << shift;
+}
+
+void MetricHistogram::record(uint64_t valueNs) {
+    Shard& shard = shards[metricShardIndex()];
+    shard.buckets[bucketIndex(valueNs)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(valueNs, std::memory_order_relaxed);
+
+    uint64_t currentMax = shard.max.load(std::memory_order_relaxed);
+    while (valueNs > currentMax &&
+           !shard.max.compare_exchange_weak(currentMax, valueNs, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSnapshot MetricHistogram::snapshot() const {
+    HistogramSnapshot result;
+    result.buckets.assign(BUCKET_COUNT, 0);
+    for (size_t s = 0; s < METRIC_SHARD_COUNT; ++s) {
+        const Shard& shard = shards[s];
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            result.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        result.sum += shard.sum.load(std::memory_order_relaxed);
+        result.max = std::max(result.max, shard.max.load(std::memory_order_relaxed));
+    }
+    // 按桶求和，保证 count 与分位数计算一致
+    for (uint64_t bucket : result.buckets) {
+        result.count += bucket;
+    }
+    return result;
+}
+
+MetricsRegistry::MetricsRegistry()
+    : startTime(std::chrono::steady_clock::now())
+    , lastSummaryTime(startTime) {
+}
+
+MetricsRegistry& MetricsRegistry::getInstance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+MetricsRegistry::Metric& MetricsRegistry::findOrCreate(const std::string& name, const std::string& help, MetricType type) {
+    auto it = metrics.find(name);
+    if (it == metrics.end()) {
+        it = metrics.emplace(name, Metric{type, help, nullptr, nullptr, nullptr, nullptr, nullptr}).first;
+    }
+    return it->second;
+}
+
+MetricCounter& MetricsRegistry::counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Metric& metric = findOrCreate(name, help, MetricType::COUNTER);
+    if (!metric.counter) {
+        metric.counter = std::make_unique<MetricCounter>();
+    }
+    return *metric.counter;
+}
+
+MetricGauge& MetricsRegistry::gauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Metric& metric = findOrCreate(name, help, MetricType::GAUGE);
+    if (!metric.gauge) {
+        metric.gauge = std::make_unique<MetricGauge>();
+    }
+    return *metric.gauge;
+}
+
+MetricHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Metric& metric = findOrCreate(name, help, MetricType::HISTOGRAM);
+    if (!metric.histogram) {
+        metric.histogram = std::make_unique<MetricHistogram>();
+    }
+    return *metric.histogram;
+}
+
+void MetricsRegistry::gaugeCallback(const std::string& name, const std::string& help, std::function<double()> callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Metric& metric = findOrCreate(name, help, MetricType::CALLBACK);
+    metric.callback = std::move(callback);
+}
+
+void MetricsRegistry::counterCallback(const std::string& name, const std::string& help,
+                                      std::function<uint64_t()> callback) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Metric& metric = findOrCreate(name, help, MetricType::COUNTER_CALLBACK);
+    metric.counterCallback = std::move(callback);
+}
+
+double MetricsRegistry::getUptimeSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+std::vector<MetricsRegistry::MetricView> MetricsRegistry::collect() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<MetricView> views;
+    views.reserve(metrics.size());
+    for (const auto& [name, metric] : metrics) {
+        views.push_back({name, metric.type, metric.help, metric.counter.get(), metric.gauge.get(),
+                         metric.histogram.get(), metric.callback, metric.counterCallback});
+    }
+    return views;
+}
+
+std::string MetricsRegistry::renderPrometheus() {
+    std::vector<MetricView> views = collect();
+    std::string out;
+    out.reserve(8192);
+
+    // 同一基础名称的多个带标签序列只输出一次 HELP/TYPE
+    std::set<std::string> described;
+    auto describe = [&](const std::string& name, const std::string& help, const char* type) {
+        std::string base = BaseName(name);
+        if (described.insert(base).second) {
+            out += "# HELP " + base + " " + help + "\n";
+            out += "# TYPE " + base + " " + type + "\n";
+        }
+    };
+
+    describe("netlab_uptime_seconds", "Seconds since the server started", "gauge");
+    out += "netlab_uptime_seconds " + FormatNumber(getUptimeSeconds()) + "\n";
+
+    for (const MetricView& metric : views) {
+        const std::string& name = metric.name;
+        switch (metric.type) {
+            case MetricType::COUNTER:
+                describe(name, metric.help, "counter");
+                out += name + " " + FormatNumber(static_cast<double>(metric.counter->value())) + "\n";
+                break;
+            case MetricType::GAUGE:
+                describe(name, metric.help, "gauge");
+                out += name + " " + FormatNumber(static_cast<double>(metric.gauge->value())) + "\n";
+                break;
+            case MetricType::CALLBACK:
+                if (metric.callback) {
+                    describe(name, metric.help, "gauge");
+                    out += name + " " + FormatNumber(metric.callback()) + "\n";
+                }
+                break;
+            case MetricType::COUNTER_CALLBACK:
+                if (metric.counterCallback) {
+                    describe(name, metric.help, "counter");
+                    out += name + " " + FormatNumber(static_cast<double>(metric.counterCallback())) + "\n";
+                }
+                break;
+            case MetricType::HISTOGRAM: {
+                describe(name, metric.help, "summary");
+                HistogramSnapshot snapshot = metric.histogram->snapshot();
+                for (double q : EXPORT_QUANTILES) {
+                    out += WithLabel(name, "", "quantile=\"" + FormatNumber(q) + "\"") + " " +
+                           FormatNumber(snapshot.percentile(q) / 1e9) + "\n";
+                }
+                out += WithLabel(name, "_sum", "") + " " + FormatNumber(static_cast<double>(snapshot.sum) / 1e9) + "\n";
+                out += WithLabel(name, "_count", "") + " " + FormatNumber(static_cast<double>(snapshot.count)) + "\n";
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+std::string MetricsRegistry::renderSummary() {
+    std::vector<MetricView> views = collect();
+    std::lock_guard<std::mutex> lock(summaryMutex);
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - lastSummaryTime).count();
+    lastSummaryTime = now;
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "Uptime: %.0fs (rates over last %.1fs)\n", getUptimeSeconds(), elapsed);
+    std::string out = line;
+
+    for (const MetricView& metric : views) {
+        const std::string& name = metric.name;
+        switch (metric.type) {
+            case MetricType::COUNTER:
+            case MetricType::COUNTER_CALLBACK: {
+                if (metric.type == MetricType::COUNTER_CALLBACK && !metric.counterCallback) {
+                    break;
+                }
+                uint64_t value = metric.type == MetricType::COUNTER ? metric.counter->value() : metric.counterCallback();
+                uint64_t& last = lastSummaryValues[name];
+                double rate = elapsed > 0 ? static_cast<double>(value - std::min(last, value)) / elapsed : 0.0;
+                last = value;
+                std::snprintf(line, sizeof(line), "  %-48s %14llu  (%.1f/s)\n", name.c_str(),
+                              static_cast<unsigned long long>(value), rate);
+                out += line;
+                break;
+            }
+            case MetricType::GAUGE:
+                std::snprintf(line, sizeof(line), "  %-48s %14lld\n", name.c_str(),
+                              static_cast<long long>(metric.gauge->value()));
+                out += line;
+                break;
+            case MetricType::CALLBACK:
+                if (metric.callback) {
+                    out += "  " + name + std::string(name.size() < 48 ? 48 - name.size() : 0, ' ') + " " +
+                           FormatNumber(metric.callback()) + "\n";
+                }
+                break;
+            case MetricType::HISTOGRAM: {
+                HistogramSnapshot snapshot = metric.histogram->snapshot();
+                std::snprintf(line, sizeof(line), "  %-48s n=%llu p50=%s p99=%s p999=%s max=%s\n", name.c_str(),
+                              static_cast<unsigned long long>(snapshot.count),
+                              FormatDuration(snapshot.percentile(0.5)).c_str(),
+                              FormatDuration(snapshot.percentile(0.99)).c_str(),
+                              FormatDuration(snapshot.percentile(0.999)).c_str(),
+                              FormatDuration(static_cast<double>(snapshot.max)).c_str());
+                out += line;
+                break;
+            }
+        }
+    }
+
+    if (!out.empty() && out.back() == '\n') {
+        out.pop_back();
+    }
+    return out;
+}
@@ -0,0 +1,251 @@
+#include "NavigationField.h"
+#include <queue>
+#include <utility>
+#include <functional>
+
+namespace {
+
+const Direction ALL_DIRECTIONS[] = {
+    Direction::NORTH, Direction::EAST, Direction::SOUTH,
+    Direction::WEST, Direction::UP, Direction::DOWN
+};
+
+// 从 (x, y, layer) 能否沿direction走一步
+bool canStep(const MazeGrid& maze, int x, int y, int layer, Direction direction) {
+    switch (direction) {
+        case Direction::NORTH: return !maze.isWall(x, y - 1, layer);
+        case Direction::SOUTH: return !maze.isWall(x, y + 1, layer);
+        case Direction::EAST:  return !maze.isWall(x + 1, y, layer);
+        case Direction::WEST:  return !maze.isWall(x - 1, y, layer);
+        case Direction::UP:    return maze.hasStairLink(x, y, layer);
+        case Direction::DOWN:  return maze.hasStairLink(x, y, layer - 1);
+    }
+    return false;
+}
+
+} // namespace
+
+NavigationField::NavigationField() : width(0), height(0), layers(0), lastUpdateCount(0) {}
+
+void NavigationField::directionOffset(Direction direction, int& dx, int& dy, int& dlayer) {
+    dx = dy = dlayer = 0;
+    switch (direction) {
+        case Direction::NORTH: dy = -1; break;
+        case Direction::SOUTH: dy = 1; break;
+        case Direction::EAST:  dx = 1; break;
+        case Direction::WEST:  dx = -1; break;
+        case Direction::UP:    dlayer = 1; break;
+        case Direction::DOWN:  dlayer = -1; break;
+    }
+}
+
+template <typename Visitor>
+void NavigationField::forEachNeighbor(const MazeGrid& maze, size_t index, Visitor visit) const {
+    Position pos = maze.positionOf(index);
+    for (Direction direction : ALL_DIRECTIONS) {
+        if (canStep(maze, pos.x, pos.y, pos.z, direction)) {
+            int dx, dy, dlayer;
+            directionOffset(direction, dx, dy, dlayer);
+            visit(maze.indexOf(pos.x + dx, pos.y + dy, pos.z + dlayer));
+        }
+    }
+}
+
+void NavigationField::build(const MazeGrid& maze, const Position& goal) {
+    target = goal;
+    width = maze.getWidth();
+    height = maze.getHeight();
+    layers = maze.getLayers();
+    distances.assign(maze.getCellCount(), UNREACHABLE);
+    lastUpdateCount = 0;
+
+    if (maze.isWall(goal.x, goal.y, goal.z)) {
+        return;
+    }
+
+    // 单位步长的BFS，队列用vector加读指针实现
+    std::vector<size_t> queue;
+    queue.reserve(maze.getCellCount());
+    size_t start = maze.indexOf(goal.x, goal.y, goal.z);
+    distances[start] = 0;
+    queue.push_back(start);
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        size_t current = queue[head];
+        uint32_t next = distances[current] + 1;
+        forEachNeighbor(maze, current, [&](size_t neighbor) {
+            if (distances[neighbor] == UNREACHABLE) {
+                distances[neighbor] = next;
+                queue.push_back(neighbor);
+            }
+        });
+    }
+    lastUpdateCount = queue.size();
+}
+
+void NavigationField::onCellOpened(const MazeGrid& maze, const Position& cell) {
+    lastUpdateCount = 0;
+    if (distances.size() != maze.getCellCount() || maze.isWall(cell.x, cell.y, cell.z)) {
+        return;
+    }
+
+    size_t index = maze.indexOf(cell.x, cell.y, cell.z);
+    uint32_t best = cell == target ? 0 : UNREACHABLE;
+    forEachNeighbor(maze, index, [&](size_t neighbor) {
+        if (distances[neighbor] != UNREACHABLE && distances[neighbor] + 1 < best) {
+            best = distances[neighbor] + 1;
+        }
+    });
+    if (best == UNREACHABLE || best >= distances[index]) {
+        return;
+    }
+
+    // 距离只会变小：从新打通的格子向外传播
+    distances[index] = best;
+    std::vector<size_t> queue(1, index);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        size_t current = queue[head];
+        uint32_t next = distances[current] + 1;
+        forEachNeighbor(maze, current, [&](size_t neighbor) {
+            if (distances[neighbor] > next) {
+                distances[neighbor] = next;
+                queue.push_back(neighbor);
+            }
+        });
+    }
+    lastUpdateCount = queue.size();
+}
+
+void NavigationField::onCellBlocked(const MazeGrid& maze, const Position& cell) {
+    lastUpdateCount = 0;
+    if (distances.size() != maze.getCellCount() || !maze.inBounds(cell.x, cell.y, cell.z)) {
+        return;
+    }
+
+    size_t index = maze.indexOf(cell.x, cell.y, cell.z);
+    if (distances[index] == UNREACHABLE) {
+        return;  // 没有最短路径经过这个格子
+    }
+
+    // 1. 收集最短路径树中位于该格子下游的所有格子，它们的距离可能变大
+    std::vector<char> affected(distances.size(), 0);
+    std::vector<size_t> region(1, index);
+    affected[index] = 1;
+    for (size_t head = 0; head < region.size(); ++head) {
+        size_t current = region[head];
+        uint32_t next = distances[current] + 1;
+        // 被阻挡的格子本身已是墙壁，按旧的邻接关系展开它的邻居
+        Position pos = maze.positionOf(current);
+        for (Direction direction : ALL_DIRECTIONS) {
+            int dx, dy, dlayer;
+            directionOffset(direction, dx, dy, dlayer);
+            if (!maze.inBounds(pos.x + dx, pos.y + dy, pos.z + dlayer)) {
+                continue;
+            }
+            size_t neighbor = maze.indexOf(pos.x + dx, pos.y + dy, pos.z + dlayer);
+            if (!affected[neighbor] && distances[neighbor] == next && !maze.wallAt(neighbor)) {
+                affected[neighbor] = 1;
+                region.push_back(neighbor);
+            }
+        }
+    }
+
+    for (size_t current : region) {
+        distances[current] = UNREACHABLE;
+    }
+
+    // 2. 受影响区域的边界格子从区域外的邻居取得初始距离，再按距离从小到大传播
+    typedef std::pair<uint32_t, size_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontier;
+    for (size_t current : region) {
+        if (maze.wallAt(current)) {
+            continue;
+        }
+        uint32_t best = maze.positionOf(current) == target ? 0 : UNREACHABLE;
+        forEachNeighbor(maze, current, [&](size_t neighbor) {
+            if (!affected[neighbor] && distances[neighbor] != UNREACHABLE && distances[neighbor] + 1 < best) {
+                best = distances[neighbor] + 1;
+            }
+        });
+        if (best != UNREACHABLE) {
+            distances[current] = best;
+            frontier.push(Entry(best, current));
+        }
+    }
+
+    while (!frontier.empty()) {
+        Entry entry = frontier.top();
+        frontier.pop();
+        if (entry.first > distances[entry.second]) {
+            continue;
+        }
+        uint32_t next = entry.first + 1;
+        forEachNeighbor(maze, entry.second, [&](size_t neighbor) {
+            if (distances[neighbor] > next) {
+                distances[neighbor] = next;
+                frontier.push(Entry(next, neighbor));
+            }
+        });
+    }
+    lastUpdateCount = region.size();
+}
+
+uint32_t NavigationField::distanceAt(int x, int y, int layer) const {
+    if (static_cast<unsigned>(x) >= static_cast<unsigned>(width) ||
+        static_cast<unsigned>(y) >= static_cast<unsigned>(height) ||
+        static_cast<unsigned>(layer) >= static_cast<unsigned>(layers)) {
+        return UNREACHABLE;
+    }
+    return distances[(static_cast<size_t>(layer) * height + y) * width + x];
+}
+
+bool NavigationField::nextStep(const MazeGrid& maze, int x, int y, int layer, Direction& direction) const {
+    if (distances.size() != maze.getCellCount() || maze.isWall(x, y, layer)) {
+        return false;
+    }
+
+    uint32_t current = distances[maze.indexOf(x, y, layer)];
+    if (current == 0 || current == UNREACHABLE) {
+        return false;
+    }
+
+    for (Direction candidate : ALL_DIRECTIONS) {
+        if (!canStep(maze, x, y, layer, candidate)) {
+            continue;
+        }
+        int dx, dy, dlayer;
+        directionOffset(candidate, dx, dy, dlayer);
+        if (distances[maze.indexOf(x + dx, y + dy, layer + dlayer)] == current - 1) {
+            direction = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool NavigationField::findFarthest(const MazeGrid& maze, CellType type, int layer, Position& result) const {
+    if (distances.size() != maze.getCellCount()) {
+        return false;
+    }
+
+    size_t begin = 0;
+    size_t end = distances.size();
+    if (layer >= 0) {
+        if (layer >= maze.getLayers()) {
+            return false;
+        }
+        begin = static_cast<size_t>(layer) * maze.getLayerStride();
+        end = begin + maze.getLayerStride();
+    }
+
+    bool found = false;
+    uint32_t farthest = 0;
+    for (size_t i = begin; i < end; ++i) {
+        if (distances[i] != UNREACHABLE && maze.cellAt(i) == type && (!found || distances[i] > farthest)) {
+            farthest = distances[i];
+            result = maze.positionOf(i);
+            found = true;
+        }
+    }
+    return found;
+}
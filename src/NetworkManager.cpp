@@ -1,14 +1,19 @@
 #include "NetworkManager.h"
 #include "Logger.h"
+#include "EventPoller.h"
+#include "WebSocketFrame.h"
+#include "Metrics.h"
 
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <deque>
 #include <algorithm>
 #include <cstring>
 #include <openssl/sha.h>
-#include <queue>
 #include <functional>
+#include <condition_variable>
+#include <chrono>
 
 #ifdef _WIN32
     #include <winsock2.h>
@@ -19,23 +24,31 @@
     #include <sys/socket.h>
     #include <netinet/in.h>
     #include <arpa/inet.h>
+    #include <sys/uio.h>
     #include <unistd.h>
     #include <fcntl.h>
+    #include <climits>
     #define SOCKET int
     #define INVALID_SOCKET -1
     #define SOCKET_ERROR -1
     #define closesocket close
 #endif
 
-// WebSocket帧类型
-enum WebSocketOpcode {
-    CONTINUATION_FRAME = 0x0,
-    TEXT_FRAME = 0x1,
-    BINARY_FRAME = 0x2,
-    CLOSE_FRAME = 0x8,
-    PING_FRAME = 0x9,
-    PONG_FRAME = 0xA
-};
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0  // Windows/macOS没有该标志（macOS使用SO_NOSIGPIPE）
+#endif
+
+// 握手阶段限制
+static const size_t MAX_HANDSHAKE_SIZE = 8192;                   // 升级请求最大长度
+static const int HANDSHAKE_TIMEOUT_MS = 5000;                    // 升级请求必须在此时间内完成
+static const int HANDSHAKE_SWEEP_INTERVAL_MS = 500;              // 超时检查间隔
+
+// 单次批量发送最多合并的帧数
+#if defined(IOV_MAX) && IOV_MAX < 64
+static const int MAX_SEND_BATCH = IOV_MAX;
+#else
+static const int MAX_SEND_BATCH = 64;
+#endif
 
 // 客户端连接信息
 struct ClientConnection {
@@ -43,6 +56,39 @@ struct ClientConnection {
     SOCKET socket;
     std::string ipAddress;
     bool handshakeCompleted;
+    std::string handshakeBuffer;                                 // 尚未完整的HTTP升级请求
+    std::chrono::steady_clock::time_point acceptedAt;            // accept时间，用于统计握手延迟
+    std::chrono::steady_clock::time_point handshakeDeadline;
+    WebSocketFrameParser frameParser;                            // 接收缓冲区与增量帧解析（仅所属I/O线程访问）
+    WebSocketMessageBatch receivedMessages;                      // 解析结果，载荷缓冲区跨读事件复用（仅所属I/O线程访问）
+    
+    // 发送队列（受分片锁保护，只由所属I/O线程写入socket）
+    std::deque<SharedFrame> sendQueue;
+    size_t sendQueueBytes = 0;                                   // 队列中帧的总字节数
+    size_t sendOffset = 0;                                       // 队首帧已发送的字节数
+    bool flushScheduled = false;                                 // 已在dirtyConnections中
+    bool writeBlocked = false;                                   // 内核发送缓冲区已满，等待可写事件
+    bool closing = false;                                        // 已因慢消费者被断开
+};
+
+// 握手状态推进结果
+enum class HandshakeStatus {
+    PENDING,     // 请求头尚未接收完整
+    COMPLETED,   // 已升级为WebSocket
+    FAILED       // 请求无效或过大，需要关闭连接
+};
+
+// I/O工作线程：独占一个连接分片，运行自己的事件循环
+struct IoWorker {
+    int index = 0;
+    EventPoller poller;
+    std::thread thread;
+    std::mutex mutex;                                      // 保护connections和pendingConnections
+    std::unordered_map<int, ClientConnection> connections;
+    std::vector<ClientConnection> pendingConnections;      // 监听线程交付、尚未注册的连接
+    std::vector<int> dirtyConnections;                     // 有新待发送数据的连接
+    std::atomic<int> connectionCount{0};                   // 已完成握手的连接数
+    int handshakingCount = 0;                              // 握手中的连接数（仅工作线程访问）
 };
 
 class NetworkManager::Impl {
@@ -50,40 +96,112 @@ public:
     std::atomic<bool> running{false};
     std::atomic<bool> forceShutdown{false}; // 添加强制关闭标志
     int serverPort;
+    int ioThreadCount = 1;
     SOCKET serverSocket;
     std::thread serverThread;
-    std::mutex clientsMutex;
-    std::unordered_map<int, ClientConnection> clients;
+    EventPoller acceptPoller;
+    std::vector<std::unique_ptr<IoWorker>> workers;
     std::function<void(int, const std::string&)> messageCallback;
+    std::function<void(int, const std::string&)> binaryMessageCallback;
+    
+    // 设置后I/O线程直接交给该函数，不经过入站队列
+    std::function<void(int, std::string&&, bool)> incomingMessageHandler;
     std::atomic<int> nextClientId{1};
     
+    // 发送队列上限与慢消费者策略
+    std::atomic<size_t> maxQueuedBytes{1024 * 1024};
+    std::atomic<size_t> maxQueuedFrames{512};
+    std::atomic<SlowConsumerPolicy> slowConsumerPolicy{SlowConsumerPolicy::DROP_OLDEST};
+    
+    // 入站消息队列：I/O线程写入，模拟线程通过processIncomingMessages取出
+    std::mutex incomingMutex;
+    std::condition_variable incomingCondition;
+    struct IncomingMessage {
+        int clientId;
+        bool binary;
+        std::string payload;
+    };
+    std::deque<IncomingMessage> incomingMessages;
+    
+    // 运行指标
+    MetricsRegistry& metrics = MetricsRegistry::getInstance();
+    MetricCounter& acceptedConnections = metrics.counter("netlab_ws_connections_accepted_total", "WebSocket TCP connections accepted");
+    MetricCounter& failedHandshakes = metrics.counter("netlab_ws_handshake_failures_total", "WebSocket upgrades that failed or timed out");
+    MetricHistogram& handshakeLatency = metrics.histogram("netlab_ws_handshake_seconds", "Time from accept to completed WebSocket upgrade");
+    MetricCounter& receivedBytes = metrics.counter("netlab_ws_received_bytes_total", "Bytes read from WebSocket sockets");
+    MetricCounter& receivedMessages = metrics.counter("netlab_ws_messages_received_total", "WebSocket data messages posted to the simulation thread");
+    MetricHistogram& readDuration = metrics.histogram("netlab_ws_read_seconds", "handleClientDataAsync duration per readiness event");
+    MetricCounter& sentBytes = metrics.counter("netlab_ws_sent_bytes_total", "Bytes written to WebSocket sockets");
+    MetricCounter& sentFrames = metrics.counter("netlab_ws_frames_sent_total", "WebSocket frames fully written");
+    MetricCounter& sendCalls = metrics.counter("netlab_ws_send_syscalls_total", "sendmsg/WSASend calls on WebSocket sockets");
+    MetricCounter& unicastFrames = metrics.counter("netlab_ws_frames_queued_total{kind=\"unicast\"}", "Frames queued for sending");
+    MetricCounter& broadcastFrames = metrics.counter("netlab_ws_frames_queued_total{kind=\"broadcast\"}", "Frames queued for sending");
+    MetricHistogram& broadcastDuration = metrics.histogram("netlab_ws_broadcast_seconds", "broadcastPrepared duration (enqueue to all clients)");
+    MetricCounter& droppedFrames = metrics.counter("netlab_ws_frames_dropped_total", "Droppable frames discarded from full send queues");
+    MetricCounter& slowConsumerDisconnects = metrics.counter("netlab_ws_slow_consumer_disconnects_total", "Clients disconnected for send queue overflow");
+    
     // WebSocket常量
     static const std::string WEB_SOCKET_GUID;
     
-    // 服务器线程函数
+    // 监听socket在轮询器中的token
+    static const uint64_t LISTEN_TOKEN = 0;
+    
+    // 监听线程函数
     void serverThreadFunc();
     
-    // 处理新连接
-    void handleNewConnection(SOCKET clientSocket, const std::string& clientIp);
+    // I/O工作线程函数
+    void workerThreadFunc(IoWorker* worker);
+    
+    // 接收所有等待中的连接并按客户端ID分配给工作线程
+    void acceptPendingConnections();
+    
+    // 根据客户端ID找到所属的工作线程
+    IoWorker& workerFor(int clientId) {
+        return *workers[static_cast<size_t>(clientId) % workers.size()];
+    }
     
-    // 处理客户端数据
-    void handleClientData(int clientId);
+    // 注销并关闭客户端socket
+    void closeClientSocket(IoWorker& worker, SOCKET socket);
     
-    // 异步处理新连接
-    void handleNewConnectionAsync(SOCKET clientSocket, const std::string& clientIp);
+    // 投递入站消息到模拟线程；处理函数可能把回收的缓冲区换回message
+    void postIncomingMessage(int clientId, std::string&& message, bool binary = false);
+    
+    // 注册新连接，进入握手状态
+    void handleNewConnectionAsync(IoWorker& worker, const ClientConnection& pending);
     
     // 异步处理客户端数据
-    void handleClientDataAsync(int clientId);
+    void handleClientDataAsync(IoWorker& worker, int clientId);
+    
+    // 追加握手数据并尝试完成升级，多余的字节写入leftover
+    HandshakeStatus advanceHandshake(IoWorker& worker, int clientId, const uint8_t* data, size_t length,
+                                     std::vector<uint8_t>& leftover);
+    
+    // 关闭超过截止时间仍未完成握手的连接
+    void sweepHandshakeDeadlines(IoWorker& worker);
+    
+    // 从分片中移除连接，已握手的连接会通知模拟线程
+    void removeConnection(IoWorker& worker, int clientId, bool abnormal);
+    
+    // 解析接收缓冲区中的所有完整帧并分发，返回false表示连接应关闭
+    bool processReceivedFrames(IoWorker& worker, ClientConnection& connection);
+    
+    // 把帧加入连接的发送队列并安排I/O线程刷新（需持有分片锁）
+    // 超出上限时按慢消费者策略处理，返回false表示帧未入队
+    bool enqueueFrameLocked(IoWorker& worker, ClientConnection& connection, const SharedFrame& frame);
+    
+    // 用writev/WSASend批量写出发送队列（需持有分片锁），返回false表示连接出错
+    bool flushSendQueueLocked(IoWorker& worker, ClientConnection& connection);
+    
+    // 刷新所有被标记的连接
+    void flushDirtyConnections(IoWorker& worker);
+    
+    // socket可写时继续刷新
+    void handleWritable(IoWorker& worker, int clientId);
     
     // WebSocket握手
     bool performWebSocketHandshake(SOCKET clientSocket, const std::string& request);
     
-    // WebSocket帧编码/解码
-    std::vector<uint8_t> encodeWebSocketFrame(const std::string& message);
-    std::string decodeWebSocketFrame(const std::vector<uint8_t>& data);
-    
-    // 发送原始数据
-    bool sendRawData(SOCKET socket, const std::vector<uint8_t>& data);
+    // 直接发送原始数据（仅用于握手阶段）
     bool sendRawData(SOCKET socket, const std::string& data);
     
     // Base64编码
@@ -103,9 +221,16 @@ NetworkManager& NetworkManager::getInstance() {
     return instance;
 }
 
-bool NetworkManager::initialize(int port) {
+bool NetworkManager::initialize(int port, int ioThreads) {
     m_impl->serverPort = port;
     
+    // 0表示按CPU核心数自动选择
+    if (ioThreads <= 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        ioThreads = static_cast<int>(std::max(1u, std::min(cores, 4u)));
+    }
+    m_impl->ioThreadCount = ioThreads;
+    
 #ifdef _WIN32
     WSADATA wsaData;
     if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
@@ -114,139 +239,152 @@ bool NetworkManager::initialize(int port) {
     }
 #endif
 
-    Logger::getInstance().info(LogCategory::NETWORK, "Network manager initialized for port " + std::to_string(port));
+    Logger::getInstance().info(LogCategory::NETWORK, "Network manager initialized for port " + std::to_string(port) +
+        " with " + std::to_string(ioThreads) + " I/O threads");
     return true;
 }
 
 void NetworkManager::Impl::serverThreadFunc() {
-    Logger::getInstance().info(LogCategory::NETWORK, "WebSocket服务器线程启动（异步模式）");
-    
-    // 创建socket事件队列
-    std::queue<std::function<void()>> eventQueue;
-    std::mutex eventQueueMutex;
-    
-    while (running) {
-        // 阶段1: 处理新连接（无锁）
-        if (serverSocket != INVALID_SOCKET) {
-            fd_set serverReadfds;
-            FD_ZERO(&serverReadfds);
-            FD_SET(serverSocket, &serverReadfds);
-            
-            timeval serverTimeout;
-            serverTimeout.tv_sec = 0;
-            serverTimeout.tv_usec = 10000; // 10ms
-            
-            int serverActivity = select(serverSocket + 1, &serverReadfds, nullptr, nullptr, &serverTimeout);
-            
-            if (serverActivity > 0 && FD_ISSET(serverSocket, &serverReadfds)) {
-                sockaddr_in clientAddr;
-                socklen_t clientLen = sizeof(clientAddr);
-                SOCKET clientSocket = accept(serverSocket, (sockaddr*)&clientAddr, &clientLen);
-                
-                if (clientSocket != INVALID_SOCKET) {
-                    char clientIP[INET_ADDRSTRLEN];
-                    inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
-                    
-                    // 异步处理新连接
-                    std::string clientIPStr(clientIP);
-                    std::function<void()> connectTask = [this, clientSocket, clientIPStr]() {
-                        this->handleNewConnectionAsync(clientSocket, clientIPStr);
-                    };
-                    
-                    {
-                        std::lock_guard<std::mutex> lock(eventQueueMutex);
-                        eventQueue.push(connectTask);
-                    }
-                }
-            }
+    Logger::getInstance().info(LogCategory::NETWORK,
+        std::string("WebSocket监听线程启动（") + acceptPoller.backendName() + "）");
+
+    std::vector<EventPoller::Event> events;
+
+    while (running && !forceShutdown) {
+        int count = acceptPoller.wait(events, -1);
+        if (count < 0) {
+            Logger::getInstance().error(LogCategory::NETWORK, "事件轮询失败，监听线程退出");
+            break;
         }
-        
-        // 阶段2: 收集所有客户端socket（短暂持锁）
-        std::vector<std::pair<int, SOCKET>> clientSockets;
-        {
-            std::lock_guard<std::mutex> lock(clientsMutex);
-            for (const auto& pair : clients) {
-                if (pair.second.socket != INVALID_SOCKET) {
-                    clientSockets.emplace_back(pair.first, pair.second.socket);
-                }
+
+        for (const auto& event : events) {
+            if (event.token == LISTEN_TOKEN && running && !forceShutdown) {
+                acceptPendingConnections();
             }
         }
-        
-        // 阶段3: 检查客户端数据（无锁）
-        if (!clientSockets.empty()) {
-            fd_set clientReadfds;
-            FD_ZERO(&clientReadfds);
-            
-            int maxSocket = -1;
-            for (const auto& pair : clientSockets) {
-                FD_SET(pair.second, &clientReadfds);
-                if (pair.second > maxSocket) {
-                    maxSocket = pair.second;
-                }
-            }
-            
-            timeval clientTimeout;
-            clientTimeout.tv_sec = 0;
-            clientTimeout.tv_usec = 10000; // 10ms
-            
-            int clientActivity = select(maxSocket + 1, &clientReadfds, nullptr, nullptr, &clientTimeout);
-            
-            if (clientActivity > 0) {
-                for (const auto& pair : clientSockets) {
-                    if (FD_ISSET(pair.second, &clientReadfds)) {
-                        // 异步处理客户端数据
-                        int clientId = pair.first;
-                        std::function<void()> dataTask = [this, clientId]() {
-                            this->handleClientDataAsync(clientId);
-                        };
-                        
-                        {
-                            std::lock_guard<std::mutex> lock(eventQueueMutex);
-                            eventQueue.push(dataTask);
-                        }
-                    }
-                }
-            }
+    }
+
+    Logger::getInstance().info(LogCategory::NETWORK, "WebSocket监听线程退出");
+}
+
+void NetworkManager::Impl::workerThreadFunc(IoWorker* worker) {
+    Logger::getInstance().info(LogCategory::NETWORK,
+        "I/O工作线程 " + std::to_string(worker->index) + " 启动");
+
+    std::vector<EventPoller::Event> events;
+    events.reserve(256);
+    std::vector<ClientConnection> pending;
+    auto nextSweep = std::chrono::steady_clock::now();
+
+    while (running && !forceShutdown) {
+        // 只在有真实事件或被唤醒时返回；有握手中的连接时定期检查超时
+        int timeoutMs = worker->handshakingCount > 0 ? HANDSHAKE_SWEEP_INTERVAL_MS : -1;
+        int count = worker->poller.wait(events, timeoutMs);
+        if (count < 0) {
+            Logger::getInstance().error(LogCategory::NETWORK, "事件轮询失败，I/O工作线程退出");
+            break;
         }
-        
-        // 阶段4: 处理事件队列（无阻塞）
-        std::queue<std::function<void()>> tasksToProcess;
+
+        // 处理监听线程交付的新连接
         {
-            std::lock_guard<std::mutex> lock(eventQueueMutex);
-            tasksToProcess = eventQueue;
-            while (!eventQueue.empty()) {
-                eventQueue.pop();
-            }
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            pending.swap(worker->pendingConnections);
         }
-        
-        // 阶段5: 执行任务（无锁）
-        while (!tasksToProcess.empty()) {
-            auto task = tasksToProcess.front();
-            tasksToProcess.pop();
-            
+        for (const auto& connection : pending) {
+            handleNewConnectionAsync(*worker, connection);
+        }
+        pending.clear();
+
+        for (const auto& event : events) {
+            if (!running || forceShutdown) {
+                break;
+            }
+
             try {
-                task();
+                int clientId = static_cast<int>(event.token);
+                if (event.events & EventPoller::EVENT_WRITE) {
+                    handleWritable(*worker, clientId);
+                }
+                if (event.events & (EventPoller::EVENT_READ | EventPoller::EVENT_ERROR)) {
+                    handleClientDataAsync(*worker, clientId);
+                }
             } catch (const std::exception& e) {
-                Logger::getInstance().error(LogCategory::NETWORK, 
+                Logger::getInstance().error(LogCategory::NETWORK,
                     "任务执行异常: " + std::string(e.what()));
             }
         }
-        
-        // 检查停止信号
-        if (!running || forceShutdown) {
-            Logger::getInstance().info(LogCategory::NETWORK, "服务器线程检测到停止信号，退出循环");
+
+        // 写出其他线程排入的帧
+        flushDirtyConnections(*worker);
+
+        if (worker->handshakingCount > 0 && std::chrono::steady_clock::now() >= nextSweep) {
+            sweepHandshakeDeadlines(*worker);
+            nextSweep = std::chrono::steady_clock::now() + std::chrono::milliseconds(HANDSHAKE_SWEEP_INTERVAL_MS);
+        }
+    }
+
+    Logger::getInstance().info(LogCategory::NETWORK,
+        "I/O工作线程 " + std::to_string(worker->index) + " 退出");
+}
+
+// 边缘触发下需要一直accept到EWOULDBLOCK
+void NetworkManager::Impl::acceptPendingConnections() {
+    while (running && !forceShutdown) {
+        sockaddr_in clientAddr;
+        socklen_t clientLen = sizeof(clientAddr);
+        SOCKET clientSocket = accept(serverSocket, (sockaddr*)&clientAddr, &clientLen);
+        if (clientSocket == INVALID_SOCKET) {
             break;
         }
-        
-        // 短暂休眠避免CPU占用过高
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        acceptedConnections.add();
+
+        char clientIP[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
+
+#ifdef SO_NOSIGPIPE
+        int noSigPipe = 1;
+        setsockopt(clientSocket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+        // 在accept时分配客户端ID，决定连接所属的分片
+        ClientConnection connection;
+        connection.clientId = nextClientId++;
+        connection.socket = clientSocket;
+        connection.ipAddress = clientIP;
+        connection.handshakeCompleted = false;
+        connection.acceptedAt = std::chrono::steady_clock::now();
+
+        IoWorker& worker = workerFor(connection.clientId);
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.pendingConnections.push_back(connection);
+        }
+        worker.poller.wakeup();
     }
-    
-    Logger::getInstance().info(LogCategory::NETWORK, "WebSocket服务器线程退出");
 }
 
-// 异步处理新连接
-void NetworkManager::Impl::handleNewConnectionAsync(SOCKET clientSocket, const std::string& clientIp) {
+// 从轮询器注销后再关闭socket
+void NetworkManager::Impl::closeClientSocket(IoWorker& worker, SOCKET socket) {
+    worker.poller.remove(static_cast<intptr_t>(socket));
+    closesocket(socket);
+}
+
+void NetworkManager::Impl::postIncomingMessage(int clientId, std::string&& message, bool binary) {
+    if (incomingMessageHandler) {
+        incomingMessageHandler(clientId, std::move(message), binary);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        incomingMessages.push_back({clientId, binary, std::move(message)});
+    }
+    incomingCondition.notify_one();
+}
+
+// 注册新连接：握手完全由事件驱动，等待中的连接不占用线程
+void NetworkManager::Impl::handleNewConnectionAsync(IoWorker& worker, const ClientConnection& pending) {
+    SOCKET clientSocket = pending.socket;
+    
     // 设置非阻塞模式
 #ifdef _WIN32
     u_long mode = 1;
@@ -258,325 +396,472 @@ void NetworkManager::Impl::handleNewConnectionAsync(SOCKET clientSocket, const s
     }
 #endif
 
-    // 读取握手请求
+    ClientConnection client = pending;
+    client.handshakeCompleted = false;
+    client.handshakeDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(HANDSHAKE_TIMEOUT_MS);
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.connections[client.clientId] = std::move(client);
+    }
+    
+    // 注册到本线程的轮询器，token即客户端ID；已到达的数据会立即触发读事件
+    if (!worker.poller.add(static_cast<intptr_t>(clientSocket), EventPoller::EVENT_READ, static_cast<uint64_t>(pending.clientId))) {
+        Logger::getInstance().error(LogCategory::NETWORK, 
+            "注册客户端socket失败 - IP: " + pending.ipAddress);
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.connections.erase(pending.clientId);
+        }
+        closesocket(clientSocket);
+        return;
+    }
+    worker.handshakingCount++;
+}
+
+HandshakeStatus NetworkManager::Impl::advanceHandshake(IoWorker& worker, int clientId, const uint8_t* data, size_t length,
+                                                      std::vector<uint8_t>& leftover) {
     std::string request;
-    std::vector<uint8_t> buffer(4096);
-    int totalBytesReceived = 0;
-    const int maxAttempts = 10; // 减少尝试次数
-    int attempts = 0;
-    bool gotCompleteRequest = false;
-    
-    while (attempts < maxAttempts && !gotCompleteRequest && running && !forceShutdown) {
-        int bytesReceived = recv(clientSocket, (char*)buffer.data(), buffer.size(), 0);
+    std::string clientIp;
+    SOCKET clientSocket = INVALID_SOCKET;
+    
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        auto it = worker.connections.find(clientId);
+        if (it == worker.connections.end()) {
+            return HandshakeStatus::FAILED;
+        }
         
-        if (bytesReceived > 0) {
-            request.append(buffer.begin(), buffer.begin() + bytesReceived);
-            totalBytesReceived += bytesReceived;
-            
-            if (request.find("\r\n\r\n") != std::string::npos) {
-                gotCompleteRequest = true;
-                break;
-            }
-            
-            if (totalBytesReceived > 8192) {
+        ClientConnection& connection = it->second;
+        connection.handshakeBuffer.append(reinterpret_cast<const char*>(data), length);
+        clientIp = connection.ipAddress;
+        
+        size_t headerEnd = connection.handshakeBuffer.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            if (connection.handshakeBuffer.size() > MAX_HANDSHAKE_SIZE) {
                 Logger::getInstance().warning(LogCategory::NETWORK, 
-                    "请求过大 - IP: " + clientIp + " - 长度: " + std::to_string(totalBytesReceived));
-                break;
-            }
-        } else if (bytesReceived == 0) {
-            closesocket(clientSocket);
-            return;
-        } else {
-#ifdef _WIN32
-            int error = WSAGetLastError();
-            if (error != WSAEWOULDBLOCK) {
-#else
-            if (errno != EWOULDBLOCK && errno != EAGAIN) {
-#endif
-                closesocket(clientSocket);
-                return;
+                    "请求过大 - IP: " + clientIp + " - 长度: " + std::to_string(connection.handshakeBuffer.size()));
+                return HandshakeStatus::FAILED;
             }
+            return HandshakeStatus::PENDING;
         }
         
-        attempts++;
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // 请求头之后的字节已经属于WebSocket帧
+        request = connection.handshakeBuffer.substr(0, headerEnd + 4);
+        leftover.assign(connection.handshakeBuffer.begin() + headerEnd + 4, connection.handshakeBuffer.end());
+        std::string().swap(connection.handshakeBuffer);
+        clientSocket = connection.socket;
+    }
+    
+    if (!performWebSocketHandshake(clientSocket, request)) {
+        Logger::getInstance().warning(LogCategory::NETWORK, 
+            "WebSocket握手失败 - IP: " + clientIp);
         
-        // 检查停止信号
-        if (!running || forceShutdown) {
-            closesocket(clientSocket);
-            return;
+        std::string response = 
+            "HTTP/1.1 400 Bad Request\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Length: 25\r\n"
+            "Connection: close\r\n\r\n"
+            "Invalid WebSocket request";
+        sendRawData(clientSocket, response);
+        return HandshakeStatus::FAILED;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        auto it = worker.connections.find(clientId);
+        if (it == worker.connections.end()) {
+            return HandshakeStatus::FAILED;
         }
+        it->second.handshakeCompleted = true;
+        handshakeLatency.recordDuration(std::chrono::steady_clock::now() - it->second.acceptedAt);
     }
+    worker.handshakingCount--;
+    worker.connectionCount++;
+    
+    Logger::getInstance().info(LogCategory::NETWORK, 
+        "WebSocket客户端连接 - IP: " + clientIp + 
+        " | 客户端ID: " + std::to_string(clientId) +
+        " | I/O线程: " + std::to_string(worker.index));
+    return HandshakeStatus::COMPLETED;
+}
 
-    if (totalBytesReceived > 0 && !request.empty()) {
-        if (performWebSocketHandshake(clientSocket, request)) {
-            int clientId = nextClientId++;
-            
-            // 添加到客户端列表（短暂持锁）
-            {
-                std::lock_guard<std::mutex> lock(clientsMutex);
-                ClientConnection client;
-                client.clientId = clientId;
-                client.socket = clientSocket;
-                client.ipAddress = clientIp;
-                client.handshakeCompleted = true;
-                clients[clientId] = client;
+void NetworkManager::Impl::sweepHandshakeDeadlines(IoWorker& worker) {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<int> expired;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        for (const auto& pair : worker.connections) {
+            if (!pair.second.handshakeCompleted && now >= pair.second.handshakeDeadline) {
+                expired.push_back(pair.first);
             }
-            
-            Logger::getInstance().info(LogCategory::NETWORK, 
-                "WebSocket客户端连接 - IP: " + clientIp + 
-                " | 客户端ID: " + std::to_string(clientId));
-        } else {
-            Logger::getInstance().warning(LogCategory::NETWORK, 
-                "WebSocket握手失败 - IP: " + clientIp);
-            
-            std::string response = 
-                "HTTP/1.1 400 Bad Request\r\n"
-                "Content-Type: text/plain\r\n"
-                "Content-Length: 23\r\n"
-                "Connection: close\r\n\r\n"
-                "Invalid WebSocket request";
-            sendRawData(clientSocket, response);
-            
-            closesocket(clientSocket);
         }
-    } else {
-        closesocket(clientSocket);
+    }
+    
+    for (int clientId : expired) {
+        Logger::getInstance().warning(LogCategory::NETWORK, 
+            "握手超时 - ID: " + std::to_string(clientId));
+        removeConnection(worker, clientId, true);
     }
 }
 
-// 异步处理客户端数据
-void NetworkManager::Impl::handleClientDataAsync(int clientId) {
-    SOCKET clientSocket = INVALID_SOCKET;
-    
-    // 获取socket（短暂持锁）
+void NetworkManager::Impl::removeConnection(IoWorker& worker, int clientId, bool abnormal) {
+    bool notify = false;
     {
-        std::lock_guard<std::mutex> lock(clientsMutex);
-        auto it = clients.find(clientId);
-        if (it != clients.end()) {
-            clientSocket = it->second.socket;
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        auto it = worker.connections.find(clientId);
+        if (it == worker.connections.end()) {
+            return;
+        }
+        
+        const ClientConnection& connection = it->second;
+        if (connection.handshakeCompleted) {
+            worker.connectionCount--;
+            notify = true;
+            
+            if (abnormal) {
+                Logger::getInstance().warning(LogCategory::NETWORK, 
+                    "客户端连接异常断开 - IP: " + connection.ipAddress + 
+                    " | ID: " + std::to_string(clientId));
+            } else {
+                Logger::getInstance().info(LogCategory::NETWORK, 
+                    "客户端断开连接 - IP: " + connection.ipAddress + 
+                    " | ID: " + std::to_string(clientId));
+            }
+        } else {
+            worker.handshakingCount--;
+            failedHandshakes.add();
         }
+        
+        closeClientSocket(worker, connection.socket);
+        worker.connections.erase(it);
     }
     
-    if (clientSocket == INVALID_SOCKET) {
-        return;
+    if (notify) {
+        postIncomingMessage(clientId, "DISCONNECT");
     }
-    
-    // 检查强制关闭标志
-    if (forceShutdown) {
-        return;
+}
+
+bool NetworkManager::Impl::enqueueFrameLocked(IoWorker& worker, ClientConnection& connection,
+                                              const SharedFrame& frame) {
+    if (connection.closing) {
+        return false;
     }
     
-    // 确保socket是非阻塞的
+    connection.sendQueue.push_back(frame);
+    connection.sendQueueBytes += frame->size();
+    
+    // 超出上限：丢弃最旧的可丢弃帧（队首已部分发送的帧不能丢）
+    size_t byteLimit = maxQueuedBytes;
+    size_t frameLimit = maxQueuedFrames;
+    if (connection.sendQueueBytes > byteLimit || connection.sendQueue.size() > frameLimit) {
+        if (slowConsumerPolicy == SlowConsumerPolicy::DROP_OLDEST) {
+            auto it = connection.sendQueue.begin();
+            if (connection.sendOffset > 0) {
+                ++it;
+            }
+            while (it != connection.sendQueue.end() &&
+                   (connection.sendQueueBytes > byteLimit || connection.sendQueue.size() > frameLimit)) {
+                if ((*it)->droppable()) {
+                    connection.sendQueueBytes -= (*it)->size();
+                    it = connection.sendQueue.erase(it);
+                    droppedFrames.add();
+                } else {
+                    ++it;
+                }
+            }
+        }
+        
+        // 仍然超限（无可丢弃帧或策略为断开）：断开慢消费者
+        if (connection.sendQueueBytes > byteLimit || connection.sendQueue.size() > frameLimit) {
+            Logger::getInstance().warning(LogCategory::NETWORK, 
+                "发送队列溢出，断开慢速客户端 - ID: " + std::to_string(connection.clientId) +
+                " | 排队字节: " + std::to_string(connection.sendQueueBytes));
+            connection.closing = true;
+            slowConsumerDisconnects.add();
+            connection.sendQueue.clear();
+            connection.sendQueueBytes = 0;
+            connection.sendOffset = 0;
 #ifdef _WIN32
-    u_long mode = 1;
-    ioctlsocket(clientSocket, FIONBIO, &mode);
+            shutdown(connection.socket, SD_BOTH);
 #else
-    int flags = fcntl(clientSocket, F_GETFL, 0);
-    if (flags != -1) {
-        fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK);
-    }
+            shutdown(connection.socket, SHUT_RDWR);
 #endif
+            return false;
+        }
+    }
     
-    std::vector<uint8_t> buffer(4096);
-    int bytesReceived = recv(clientSocket, (char*)buffer.data(), buffer.size(), 0);
-    
-    if (bytesReceived > 0) {
-        buffer.resize(bytesReceived);
-        
-        // 重新获取锁来检查握手状态和处理消息
-        {
-            std::lock_guard<std::mutex> lock(clientsMutex);
-            auto it = clients.find(clientId);
-            if (it == clients.end()) return;
-            
-            if (it->second.handshakeCompleted) {
-                std::string message = decodeWebSocketFrame(buffer);
-                if (!message.empty()) {
-                    std::string logMessage = message;
-                    if (logMessage.length() > 200) {
-                        logMessage = logMessage.substr(0, 200) + "...[截断]";
-                    }
-                    Logger::getInstance().debug(LogCategory::NETWORK, 
-                        "收到客户端消息 - ID: " + std::to_string(clientId) + 
-                        " | 长度: " + std::to_string(bytesReceived));
-                    
-                    if (messageCallback) {
-                        messageCallback(clientId, message);
-                    }
-                }
-            }
+    // 等待可写事件时由事件驱动刷新，否则交给I/O线程
+    if (!connection.flushScheduled && !connection.writeBlocked) {
+        connection.flushScheduled = true;
+        bool wasEmpty = worker.dirtyConnections.empty();
+        worker.dirtyConnections.push_back(connection.clientId);
+        if (wasEmpty) {
+            worker.poller.wakeup();
         }
-    } else if (bytesReceived == 0) {
-        // 正常断开连接
-        closesocket(clientSocket);
-        
-        // 重新获取锁来移除客户端
-        {
-            std::lock_guard<std::mutex> lock(clientsMutex);
-            auto it = clients.find(clientId);
-            if (it != clients.end()) {
-                std::string ip = it->second.ipAddress;
-                clients.erase(it);
-                
-                Logger::getInstance().info(LogCategory::NETWORK, 
-                    "客户端断开连接 - IP: " + ip + 
-                    " | ID: " + std::to_string(clientId));
-            }
+    }
+    return true;
+}
+
+bool NetworkManager::Impl::flushSendQueueLocked(IoWorker& worker, ClientConnection& connection) {
+    while (!connection.sendQueue.empty()) {
+        // 从队首开始合并多个帧，一次系统调用写出
+        int count = 0;
+#ifdef _WIN32
+        WSABUF buffers[MAX_SEND_BATCH];
+#else
+        iovec buffers[MAX_SEND_BATCH];
+#endif
+        size_t offset = connection.sendOffset;
+        for (auto it = connection.sendQueue.begin(); it != connection.sendQueue.end() && count < MAX_SEND_BATCH; ++it) {
+            const PreparedFrame& bytes = **it;
+#ifdef _WIN32
+            buffers[count].buf = (char*)bytes.data() + offset;
+            buffers[count].len = static_cast<ULONG>(bytes.size() - offset);
+#else
+            buffers[count].iov_base = (void*)(bytes.data() + offset);
+            buffers[count].iov_len = bytes.size() - offset;
+#endif
+            offset = 0;
+            count++;
         }
         
-        if (messageCallback) {
-            messageCallback(clientId, "DISCONNECT");
-        }
-    } else {
-        // 连接错误
 #ifdef _WIN32
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
+        DWORD bytesWritten = 0;
+        int result = WSASend(connection.socket, buffers, count, &bytesWritten, 0, nullptr, nullptr);
+        bool wouldBlock = result == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK;
+        bool failed = result == SOCKET_ERROR && !wouldBlock;
+        size_t sent = result == SOCKET_ERROR ? 0 : static_cast<size_t>(bytesWritten);
 #else
-        if (errno != EWOULDBLOCK && errno != EAGAIN) {
+        msghdr message{};
+        message.msg_iov = buffers;
+        message.msg_iovlen = count;
+        ssize_t result = sendmsg(connection.socket, &message, MSG_NOSIGNAL);
+        bool wouldBlock = result < 0 && (errno == EWOULDBLOCK || errno == EAGAIN);
+        bool failed = result < 0 && !wouldBlock && errno != EINTR;
+        size_t sent = result < 0 ? 0 : static_cast<size_t>(result);
 #endif
-            closesocket(clientSocket);
-            
-            // 重新获取锁来移除客户端
-            {
-                std::lock_guard<std::mutex> lock(clientsMutex);
-                auto it = clients.find(clientId);
-                if (it != clients.end()) {
-                    std::string ip = it->second.ipAddress;
-                    clients.erase(it);
-                    
-                    Logger::getInstance().warning(LogCategory::NETWORK, 
-                        "客户端连接异常断开 - IP: " + ip + 
-                        " | ID: " + std::to_string(clientId));
-                }
+        if (failed) {
+            return false;
+        }
+        sendCalls.add();
+        sentBytes.add(sent);
+        
+        if (wouldBlock) {
+            // 内核缓冲区已满，改为等待可写事件
+            break;
+        }
+        
+        // 弹出已完整发送的帧
+        while (sent > 0) {
+            size_t frameSize = connection.sendQueue.front()->size();
+            size_t remaining = frameSize - connection.sendOffset;
+            if (sent >= remaining) {
+                sent -= remaining;
+                connection.sendQueueBytes -= frameSize;
+                connection.sendOffset = 0;
+                connection.sendQueue.pop_front();
+                sentFrames.add();
+            } else {
+                connection.sendOffset += sent;
+                sent = 0;
             }
-            
-            if (messageCallback) {
-                messageCallback(clientId, "DISCONNECT");
+        }
+    }
+    
+    // 只在有待发数据时关注可写事件：水平触发的轮询后端上，空队列仍关注可写会让I/O线程空转
+    bool blocked = !connection.sendQueue.empty();
+    if (blocked != connection.writeBlocked) {
+        connection.writeBlocked = blocked;
+        worker.poller.modify(static_cast<intptr_t>(connection.socket),
+                             EventPoller::EVENT_READ | (blocked ? static_cast<uint32_t>(EventPoller::EVENT_WRITE) : 0u),
+                             static_cast<uint64_t>(connection.clientId));
+    }
+    return true;
+}
+
+void NetworkManager::Impl::flushDirtyConnections(IoWorker& worker) {
+    std::vector<int> failed;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.dirtyConnections.empty()) {
+            return;
+        }
+        
+        for (int clientId : worker.dirtyConnections) {
+            auto it = worker.connections.find(clientId);
+            if (it == worker.connections.end()) {
+                continue;
+            }
+            it->second.flushScheduled = false;
+            if (!it->second.writeBlocked && !flushSendQueueLocked(worker, it->second)) {
+                failed.push_back(clientId);
             }
         }
+        worker.dirtyConnections.clear();
+    }
+    
+    for (int clientId : failed) {
+        removeConnection(worker, clientId, true);
     }
 }
 
-void NetworkManager::Impl::handleNewConnection(SOCKET clientSocket, const std::string& clientIp) {
-    // 设置非阻塞模式
-#ifdef _WIN32
-    u_long mode = 1;
-    ioctlsocket(clientSocket, FIONBIO, &mode);
-#else
-    int flags = fcntl(clientSocket, F_GETFL, 0);
-    fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK);
-#endif
+void NetworkManager::Impl::handleWritable(IoWorker& worker, int clientId) {
+    bool ok = true;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        auto it = worker.connections.find(clientId);
+        if (it == worker.connections.end() || !it->second.writeBlocked) {
+            return;
+        }
+        // writeBlocked 保持为true：队列发完后由 flushSendQueueLocked 取消可写关注
+        ok = flushSendQueueLocked(worker, it->second);
+    }
+    
+    if (!ok) {
+        removeConnection(worker, clientId, true);
+    }
+}
 
-    // 读取握手请求 - 使用更宽松的超时和缓冲区
-    std::string request;
-    std::vector<uint8_t> buffer(4096); // 更大的缓冲区
-    int totalBytesReceived = 0;
-    const int maxAttempts = 20; // 更多尝试次数
-    int attempts = 0;
-    bool gotCompleteRequest = false;
-    
-    while (attempts < maxAttempts && !gotCompleteRequest) {
-        int bytesReceived = recv(clientSocket, (char*)buffer.data(), buffer.size(), 0);
-        
-        if (bytesReceived > 0) {
-            request.append(buffer.begin(), buffer.begin() + bytesReceived);
-            totalBytesReceived += bytesReceived;
-            
-            // 检查是否收到完整的HTTP请求（以\r\n\r\n结束）
-            if (request.find("\r\n\r\n") != std::string::npos) {
-                gotCompleteRequest = true;
-                break; // 收到完整请求
+bool NetworkManager::Impl::processReceivedFrames(IoWorker& worker, ClientConnection& connection) {
+    WebSocketMessageBatch& messages = connection.receivedMessages;
+    messages.clear();
+    WebSocketFrameParser::Result result = connection.frameParser.parse(messages);
+    
+    // 先分发错误之前已经完整解析的帧
+    for (auto& message : messages) {
+        switch (message.opcode) {
+            case TEXT_FRAME:
+                LOG_DEBUG(LogCategory::NETWORK, 
+                    "收到客户端消息 - ID: " + std::to_string(connection.clientId) + 
+                    " | 长度: " + std::to_string(message.payload.size()));
+                
+                // 游戏逻辑在模拟线程上处理
+                postIncomingMessage(connection.clientId, std::move(message.payload));
+                receivedMessages.add();
+                break;
+                
+            case BINARY_FRAME:
+                // 二进制协议消息同样交给模拟线程
+                postIncomingMessage(connection.clientId, std::move(message.payload), true);
+                receivedMessages.add();
+                break;
+                
+            case PING_FRAME: {
+                SharedFrame pong = PreparedFrame::create(PONG_FRAME,
+                    reinterpret_cast<const uint8_t*>(message.payload.data()), message.payload.size());
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                enqueueFrameLocked(worker, connection, pong);
+                break;
             }
-            
-            // 如果请求过大，可能有问题
-            if (totalBytesReceived > 8192) {
-                Logger::getInstance().warning(LogCategory::NETWORK, 
-                    "请求过大 - IP: " + clientIp + " - 长度: " + std::to_string(totalBytesReceived));
+                
+            case PONG_FRAME:
                 break;
+                
+            case CLOSE_FRAME: {
+                // 回应关闭帧后断开
+                uint16_t code = CLOSE_NORMAL;
+                if (message.payload.size() >= 2) {
+                    code = static_cast<uint16_t>((static_cast<uint8_t>(message.payload[0]) << 8) |
+                                                 static_cast<uint8_t>(message.payload[1]));
+                }
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                enqueueFrameLocked(worker, connection, PreparedFrame::close(code));
+                flushSendQueueLocked(worker, connection);
+                return false;
+            }
+        }
+    }
+    
+    if (result != WebSocketFrameParser::Result::OK) {
+        bool tooBig = result == WebSocketFrameParser::Result::MESSAGE_TOO_BIG;
+        Logger::getInstance().warning(LogCategory::NETWORK, 
+            std::string(tooBig ? "WebSocket消息过大" : "WebSocket协议错误") + 
+            " - ID: " + std::to_string(connection.clientId));
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        enqueueFrameLocked(worker, connection, PreparedFrame::close(tooBig ? CLOSE_MESSAGE_TOO_BIG : CLOSE_PROTOCOL_ERROR));
+        flushSendQueueLocked(worker, connection);
+        return false;
+    }
+    return true;
+}
+
+// 异步处理客户端数据
+void NetworkManager::Impl::handleClientDataAsync(IoWorker& worker, int clientId) {
+    ClientConnection* connection = nullptr;
+    
+    // 连接只会在本线程被移除，取得的指针在本次处理期间一直有效
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        auto it = worker.connections.find(clientId);
+        if (it != worker.connections.end()) {
+            connection = &it->second;
+        }
+    }
+    
+    if (connection == nullptr) {
+        return;
+    }
+    
+    MetricTimer timer(readDuration);
+    SOCKET clientSocket = connection->socket;
+    bool handshakeCompleted = connection->handshakeCompleted;
+    uint8_t handshakeChunk[4096];
+    
+    // 边缘触发：一直读到EWOULDBLOCK
+    while (!forceShutdown) {
+        int bytesReceived;
+        if (handshakeCompleted) {
+            // 直接读入连接的环形缓冲区
+            size_t available = 0;
+            uint8_t* dest = connection->frameParser.buffer().writableRegion(4096, available);
+            bytesReceived = recv(clientSocket, (char*)dest, static_cast<int>(available), 0);
+            if (bytesReceived > 0) {
+                connection->frameParser.buffer().commitWrite(bytesReceived);
+            }
+        } else {
+            bytesReceived = recv(clientSocket, (char*)handshakeChunk, sizeof(handshakeChunk), 0);
+            if (bytesReceived > 0) {
+                std::vector<uint8_t> leftover;
+                HandshakeStatus status = advanceHandshake(worker, clientId, handshakeChunk, bytesReceived, leftover);
+                if (status == HandshakeStatus::FAILED) {
+                    removeConnection(worker, clientId, true);
+                    return;
+                }
+                if (status == HandshakeStatus::PENDING) {
+                    continue;
+                }
+                handshakeCompleted = true;
+                connection->frameParser.buffer().append(leftover.data(), leftover.size());
+            }
+        }
+        
+        if (bytesReceived > 0) {
+            receivedBytes.add(static_cast<uint64_t>(bytesReceived));
+            if (!connection->frameParser.buffer().empty() && !processReceivedFrames(worker, *connection)) {
+                removeConnection(worker, clientId, false);
+                return;
             }
         } else if (bytesReceived == 0) {
-            // 连接关闭
-            closesocket(clientSocket);
+            removeConnection(worker, clientId, false);
             return;
         } else {
-            // 错误或没有数据可读
 #ifdef _WIN32
             int error = WSAGetLastError();
             if (error != WSAEWOULDBLOCK) {
 #else
             if (errno != EWOULDBLOCK && errno != EAGAIN) {
 #endif
-                closesocket(clientSocket);
-                return;
+                removeConnection(worker, clientId, true);
             }
+            return;
         }
-        
-        attempts++;
-        std::this_thread::sleep_for(std::chrono::milliseconds(20)); // 更长的等待时间
-    }
-
-    if (totalBytesReceived > 0 && !request.empty()) {
-        Logger::getInstance().debug(LogCategory::NETWORK, 
-            "收到握手请求 - IP: " + clientIp + " - 长度: " + std::to_string(request.length()));
-        
-        if (performWebSocketHandshake(clientSocket, request)) {
-            int clientId = nextClientId++;
-            
-            ClientConnection client;
-            client.clientId = clientId;
-            client.socket = clientSocket;
-            client.ipAddress = clientIp;
-            client.handshakeCompleted = true;
-            
-            {
-                std::lock_guard<std::mutex> lock(clientsMutex);
-                clients[clientId] = client;
-            }
-            
-            // 详细记录连接信息
-            Logger::getInstance().info(LogCategory::NETWORK, 
-                "WebSocket客户端连接 - IP: " + clientIp + 
-                " | 客户端ID: " + std::to_string(clientId) + 
-                " | 当前连接数: " + std::to_string(clients.size()));
-            
-            // 不再发送CONNECT消息，等待客户端发送认证消息
-            
-            // 设置socket为非阻塞模式，避免长时间等待
-#ifdef _WIN32
-            u_long mode = 1;
-            ioctlsocket(clientSocket, FIONBIO, &mode);
-#else
-            int flags = fcntl(clientSocket, F_GETFL, 0);
-            fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK);
-#endif
-        } else {
-            Logger::getInstance().warning(LogCategory::NETWORK, 
-                "WebSocket握手失败 - IP: " + clientIp);
-            
-            // 发送HTTP 400响应
-            std::string response = 
-                "HTTP/1.1 400 Bad Request\r\n"
-                "Content-Type: text/plain\r\n"
-                "Content-Length: 23\r\n"
-                "Connection: close\r\n\r\n"
-                "Invalid WebSocket request";
-            sendRawData(clientSocket, response);
-            
-            closesocket(clientSocket);
-        }
-    } else {
-        Logger::getInstance().warning(LogCategory::NETWORK, 
-            "未收到握手请求 - IP: " + clientIp);
-        closesocket(clientSocket);
     }
 }
 
 bool NetworkManager::Impl::performWebSocketHandshake(SOCKET clientSocket, const std::string& request) {
     // 检查是否是WebSocket升级请求
     if (request.find("GET") != 0) {
-        Logger::getInstance().debug(LogCategory::NETWORK, "握手失败: 不是GET请求");
+        LOG_DEBUG(LogCategory::NETWORK, "握手失败: 不是GET请求");
         return false;
     }
     
@@ -586,7 +871,7 @@ bool NetworkManager::Impl::performWebSocketHandshake(SOCKET clientSocket, const
     
     // 检查Upgrade头
     if (requestLower.find("upgrade: websocket") == std::string::npos) {
-        Logger::getInstance().debug(LogCategory::NETWORK, "握手失败: 缺少Upgrade头");
+        LOG_DEBUG(LogCategory::NETWORK, "握手失败: 缺少Upgrade头");
         return false;
     }
     
@@ -594,7 +879,7 @@ bool NetworkManager::Impl::performWebSocketHandshake(SOCKET clientSocket, const
     if (requestLower.find("connection: upgrade") == std::string::npos && 
         requestLower.find("connection:") != std::string::npos && 
         requestLower.find("upgrade") == std::string::npos) {
-        Logger::getInstance().debug(LogCategory::NETWORK, "握手失败: 缺少Connection: Upgrade头");
+        LOG_DEBUG(LogCategory::NETWORK, "握手失败: 缺少Connection: Upgrade头");
         return false;
     }
     
@@ -606,7 +891,7 @@ bool NetworkManager::Impl::performWebSocketHandshake(SOCKET clientSocket, const
         keyHeader = "Sec-WebSocket-Key: ";
         keyStart = request.find(keyHeader);
         if (keyStart == std::string::npos) {
-            Logger::getInstance().debug(LogCategory::NETWORK, "握手失败: 缺少Sec-WebSocket-Key头");
+            LOG_DEBUG(LogCategory::NETWORK, "握手失败: 缺少Sec-WebSocket-Key头");
             return false;
         }
     }
@@ -616,7 +901,7 @@ bool NetworkManager::Impl::performWebSocketHandshake(SOCKET clientSocket, const
     if (keyEnd == std::string::npos) {
         keyEnd = requestLower.find("\n", keyStart);
         if (keyEnd == std::string::npos) {
-            Logger::getInstance().debug(LogCategory::NETWORK, "握手失败: Sec-WebSocket-Key格式错误");
+            LOG_DEBUG(LogCategory::NETWORK, "握手失败: Sec-WebSocket-Key格式错误");
             return false;
         }
     }
@@ -666,7 +951,7 @@ bool NetworkManager::Impl::performWebSocketHandshake(SOCKET clientSocket, const
     response += "Server: MazeGameServer/1.0\r\n";
     response += "\r\n";
     
-    Logger::getInstance().debug(LogCategory::NETWORK, 
+    LOG_DEBUG(LogCategory::NETWORK, 
         "WebSocket握手成功 - Key: " + webSocketKey + " - Accept: " + acceptKey);
     
     bool success = sendRawData(clientSocket, response);
@@ -728,222 +1013,11 @@ std::string NetworkManager::Impl::base64Encode(const std::string& input) {
     return encoded;
 }
 
-void NetworkManager::Impl::handleClientData(int clientId) {
-    SOCKET clientSocket = INVALID_SOCKET;
-    
-    // 先获取socket，然后释放锁
-    {
-        std::lock_guard<std::mutex> lock(clientsMutex);
-        auto it = clients.find(clientId);
-        if (it == clients.end()) return;
-        clientSocket = it->second.socket;
-    }
-    
-    // 检查强制关闭标志
-    if (forceShutdown) {
-        return;
-    }
-    
-    // 确保socket是非阻塞的
-#ifdef _WIN32
-    u_long mode = 1;
-    ioctlsocket(clientSocket, FIONBIO, &mode);
-#else
-    int flags = fcntl(clientSocket, F_GETFL, 0);
-    if (flags != -1) {
-        fcntl(clientSocket, F_SETFL, flags | O_NONBLOCK);
-    }
-#endif
-    
-    std::vector<uint8_t> buffer(4096);
-    
-    int bytesReceived = recv(clientSocket, (char*)buffer.data(), buffer.size(), 0);
-    
-    if (bytesReceived > 0) {
-        buffer.resize(bytesReceived);
-        
-        // 重新获取锁来检查握手状态和处理消息
-        {
-            std::lock_guard<std::mutex> lock(clientsMutex);
-            auto it = clients.find(clientId);
-            if (it == clients.end()) return;
-            
-            if (it->second.handshakeCompleted) {
-                // WebSocket消息
-                std::string message = decodeWebSocketFrame(buffer);
-                if (!message.empty()) {
-                    // 记录接收到的消息（限制长度以避免日志过大）
-                    std::string logMessage = message;
-                    if (logMessage.length() > 200) {
-                        logMessage = logMessage.substr(0, 200) + "...[截断]";
-                    }
-                    Logger::getInstance().debug(LogCategory::NETWORK, 
-                        "收到客户端消息 - ID: " + std::to_string(clientId) + 
-                        " | IP: " + it->second.ipAddress + 
-                        " | 长度: " + std::to_string(bytesReceived) + 
-                        " | 内容: " + logMessage);
-                    
-                    if (messageCallback) {
-                        messageCallback(clientId, message);
-                    }
-                } else {
-                    Logger::getInstance().warning(LogCategory::NETWORK,
-                        "WebSocket消息解码失败 - ID: " + std::to_string(clientId) +
-                        " | IP: " + it->second.ipAddress);
-                }
-            }
-        }
-    } else if (bytesReceived == 0) {
-        // 正常断开连接
-        closesocket(clientSocket);
-        
-        // 重新获取锁来移除客户端
-        {
-            std::lock_guard<std::mutex> lock(clientsMutex);
-            auto it = clients.find(clientId);
-            if (it != clients.end()) {
-                std::string ip = it->second.ipAddress;
-                clients.erase(it);
-                
-                Logger::getInstance().info(LogCategory::NETWORK, 
-                    "客户端断开连接 - IP: " + ip + 
-                    " | ID: " + std::to_string(clientId) + 
-                    " | 剩余连接数: " + std::to_string(clients.size()));
-            }
-        }
-        
-        if (messageCallback) {
-            messageCallback(clientId, "DISCONNECT");
-        }
-    } else {
-        // 连接错误
-#ifdef _WIN32
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
-#else
-        if (errno != EWOULDBLOCK && errno != EAGAIN) {
-#endif
-            closesocket(clientSocket);
-            
-            // 重新获取锁来移除客户端
-            {
-                std::lock_guard<std::mutex> lock(clientsMutex);
-                auto it = clients.find(clientId);
-                if (it != clients.end()) {
-                    std::string ip = it->second.ipAddress;
-                    clients.erase(it);
-                    
-                    Logger::getInstance().warning(LogCategory::NETWORK, 
-                        "客户端连接异常断开 - IP: " + ip + 
-                        " | ID: " + std::to_string(clientId) + 
-                        " | 错误码: " + std::to_string(
-#ifdef _WIN32
-                        error
-#else
-                        errno
-#endif
-                        ));
-                }
-            }
-            
-            if (messageCallback) {
-                messageCallback(clientId, "DISCONNECT");
-            }
-        }
-    }
-}
-
-std::vector<uint8_t> NetworkManager::Impl::encodeWebSocketFrame(const std::string& message) {
-    std::vector<uint8_t> frame;
-    
-    // FIN位和文本帧操作码
-    frame.push_back(0x81);
-    
-    // 载荷长度
-    size_t length = message.length();
-    if (length <= 125) {
-        frame.push_back(static_cast<uint8_t>(length));
-    } else if (length <= 65535) {
-        frame.push_back(126);
-        frame.push_back(static_cast<uint8_t>((length >> 8) & 0xFF));
-        frame.push_back(static_cast<uint8_t>(length & 0xFF));
-    } else {
-        frame.push_back(127);
-        for (int i = 7; i >= 0; --i) {
-            frame.push_back(static_cast<uint8_t>((length >> (8 * i)) & 0xFF));
-        }
-    }
-    
-    // 添加载荷数据
-    for (char c : message) {
-        frame.push_back(static_cast<uint8_t>(c));
-    }
-    
-    return frame;
-}
-
-std::string NetworkManager::Impl::decodeWebSocketFrame(const std::vector<uint8_t>& data) {
-    if (data.size() < 2) return "";
-    
-    // 检查FIN位和操作码
-    bool fin = (data[0] & 0x80) != 0;
-    uint8_t opcode = data[0] & 0x0F;
-    
-    if (!fin || opcode != TEXT_FRAME) {
-        return ""; // 只处理完整的文本帧
-    }
-    
-    // 解析载荷长度
-    uint8_t secondByte = data[1];
-    bool masked = (secondByte & 0x80) != 0;
-    uint64_t payloadLength = secondByte & 0x7F;
-    
-    size_t index = 2;
-    
-    if (payloadLength == 126) {
-        if (data.size() < 4) return "";
-        payloadLength = (data[2] << 8) | data[3];
-        index += 2;
-    } else if (payloadLength == 127) {
-        if (data.size() < 10) return "";
-        payloadLength = 0;
-        for (int i = 0; i < 8; ++i) {
-            payloadLength = (payloadLength << 8) | data[index++];
-        }
-    }
-    
-    // 解析掩码
-    uint8_t maskingKey[4];
-    if (masked) {
-        if (data.size() < index + 4) return "";
-        for (int i = 0; i < 4; ++i) {
-            maskingKey[i] = data[index++];
-        }
-    }
-    
-    // 解码载荷
-    if (data.size() < index + payloadLength) return "";
-    
-    std::string decoded;
-    for (size_t i = 0; i < payloadLength; ++i) {
-        uint8_t byte = data[index + i];
-        if (masked) {
-            byte ^= maskingKey[i % 4];
-        }
-        decoded += static_cast<char>(byte);
-    }
-    
-    return decoded;
-}
-
-bool NetworkManager::Impl::sendRawData(SOCKET socket, const std::vector<uint8_t>& data) {
-    return sendRawData(socket, std::string(data.begin(), data.end()));
-}
 
 bool NetworkManager::Impl::sendRawData(SOCKET socket, const std::string& data) {
     int totalSent = 0;
     while (totalSent < data.length()) {
-        int sent = send(socket, data.c_str() + totalSent, data.length() - totalSent, 0);
+        int sent = send(socket, data.c_str() + totalSent, data.length() - totalSent, MSG_NOSIGNAL);
         if (sent <= 0) {
             return false;
         }
@@ -1009,11 +1083,39 @@ bool NetworkManager::startServer() {
         return false;
     }
 
+    // 监听socket只注册一次
+    if (!m_impl->acceptPoller.isValid() ||
+        !m_impl->acceptPoller.add(static_cast<intptr_t>(m_impl->serverSocket), EventPoller::EVENT_READ, Impl::LISTEN_TOKEN)) {
+        Logger::getInstance().error(LogCategory::NETWORK, "Failed to register server socket with event poller");
+        closesocket(m_impl->serverSocket);
+        return false;
+    }
+
+    // 创建I/O工作线程分片
+    m_impl->workers.clear();
+    for (int i = 0; i < m_impl->ioThreadCount; ++i) {
+        auto worker = std::make_unique<IoWorker>();
+        worker->index = i;
+        if (!worker->poller.isValid()) {
+            Logger::getInstance().error(LogCategory::NETWORK, "Failed to create event poller for I/O thread");
+            m_impl->workers.clear();
+            m_impl->acceptPoller.remove(static_cast<intptr_t>(m_impl->serverSocket));
+            closesocket(m_impl->serverSocket);
+            return false;
+        }
+        m_impl->workers.push_back(std::move(worker));
+    }
+
     m_impl->running = true;
+    m_impl->forceShutdown = false;
+    for (auto& worker : m_impl->workers) {
+        worker->thread = std::thread(&NetworkManager::Impl::workerThreadFunc, m_impl.get(), worker.get());
+    }
     m_impl->serverThread = std::thread(&NetworkManager::Impl::serverThreadFunc, m_impl.get());
     
     Logger::getInstance().info(LogCategory::NETWORK, 
-        "WebSocket server started on port " + std::to_string(m_impl->serverPort));
+        "WebSocket server started on port " + std::to_string(m_impl->serverPort) +
+        " (" + std::to_string(m_impl->ioThreadCount) + " I/O threads)");
     return true;
 }
 
@@ -1026,135 +1128,61 @@ void NetworkManager::stopServer() {
     auto startTime = std::chrono::high_resolution_clock::now();
     Logger::getInstance().info(LogCategory::NETWORK, "开始关闭WebSocket服务器...");
     
-    // 步骤1: 设置停止标志
-    Logger::getInstance().info(LogCategory::NETWORK, "步骤1: 设置停止标志");
+    // 步骤1: 设置停止标志并唤醒所有轮询线程
     m_impl->running = false;
     m_impl->forceShutdown = true;
-    
-    // 步骤2: 立即关闭服务器socket以阻止新连接
-    Logger::getInstance().info(LogCategory::NETWORK, "步骤2: 关闭服务器socket");
-    if (m_impl->serverSocket != INVALID_SOCKET) {
-        Logger::getInstance().info(LogCategory::NETWORK, "服务器socket有效，准备关闭");
-        closesocket(m_impl->serverSocket);
-        m_impl->serverSocket = INVALID_SOCKET;
-        Logger::getInstance().info(LogCategory::NETWORK, "服务器socket已关闭");
-    } else {
-        Logger::getInstance().info(LogCategory::NETWORK, "服务器socket已无效");
+    m_impl->acceptPoller.wakeup();
+    for (auto& worker : m_impl->workers) {
+        worker->poller.wakeup();
     }
     
-    // 步骤3: 处理客户端连接
-    Logger::getInstance().info(LogCategory::NETWORK, "步骤3: 处理客户端连接，当前有 " + std::to_string(m_impl->clients.size()) + " 个连接");
-    
-    // 先收集所有socket，使用带超时的锁获取
-    std::vector<SOCKET> socketsToClose;
-    bool lockAcquired = false;
-    auto lockStartTime = std::chrono::high_resolution_clock::now();
-    const auto maxLockWaitTime = std::chrono::milliseconds(2000); // 最多等待2秒
-    
-    Logger::getInstance().info(LogCategory::NETWORK, "尝试获取客户端锁（超时: 2秒）...");
-    
-    // 尝试获取锁，带超时
-    while (!lockAcquired) {
-        if (m_impl->clientsMutex.try_lock()) {
-            // 成功获取锁
-            auto lockAcquiredTime = std::chrono::high_resolution_clock::now();
-            auto lockDuration = std::chrono::duration_cast<std::chrono::milliseconds>(lockAcquiredTime - lockStartTime);
-            Logger::getInstance().info(LogCategory::NETWORK, "客户端锁获取成功，耗时: " + std::to_string(lockDuration.count()) + "ms");
-            
-            // 快速收集socket信息
-            for (const auto& pair : m_impl->clients) {
-                if (pair.second.socket != INVALID_SOCKET) {
-                    socketsToClose.push_back(pair.second.socket);
-                }
-            }
-            m_impl->clients.clear();
-            
-            m_impl->clientsMutex.unlock();
-            lockAcquired = true;
-            Logger::getInstance().info(LogCategory::NETWORK, "客户端列表已清空，释放锁");
-            break;
-        } else {
-            // 检查是否超时
-            auto currentTime = std::chrono::high_resolution_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lockStartTime);
-            
-            if (elapsed > maxLockWaitTime) {
-                Logger::getInstance().warning(LogCategory::NETWORK, "获取客户端锁超时，强制继续关闭流程");
-                break;
-            }
-            
-            // 短暂等待后重试
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    // 步骤2: 等待监听线程和I/O线程退出
+    if (m_impl->serverThread.joinable()) {
+        m_impl->serverThread.join();
+    }
+    for (auto& worker : m_impl->workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
         }
     }
     
-    if (!lockAcquired) {
-        Logger::getInstance().warning(LogCategory::NETWORK, "无法获取客户端锁，可能有 " + std::to_string(m_impl->clients.size()) + " 个连接需要强制关闭");
+    // 步骤3: 关闭服务器socket
+    if (m_impl->serverSocket != INVALID_SOCKET) {
+        m_impl->acceptPoller.remove(static_cast<intptr_t>(m_impl->serverSocket));
+        closesocket(m_impl->serverSocket);
+        m_impl->serverSocket = INVALID_SOCKET;
     }
     
-    // 步骤4: 在锁外关闭socket
-    Logger::getInstance().info(LogCategory::NETWORK, "步骤4: 关闭 " + std::to_string(socketsToClose.size()) + " 个客户端socket");
+    // 步骤4: 发送WebSocket关闭帧并关闭所有客户端socket
+    const uint8_t closeFrame[] = {0x88, 0x00};
     int closedCount = 0;
-    for (size_t i = 0; i < socketsToClose.size(); ++i) {
-        SOCKET sock = socketsToClose[i];
-        Logger::getInstance().debug(LogCategory::NETWORK, "关闭socket " + std::to_string(i+1) + "/" + std::to_string(socketsToClose.size()) + ": " + std::to_string(sock));
-        
-        // 设置socket为非阻塞模式以避免阻塞
-        auto setNonBlockStart = std::chrono::high_resolution_clock::now();
-#ifdef _WIN32
-        u_long mode = 1;
-        ioctlsocket(sock, FIONBIO, &mode);
-#else
-        int flags = fcntl(sock, F_GETFL, 0);
-        if (flags != -1) {
-            fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+    for (auto& worker : m_impl->workers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        for (const auto& pair : worker->connections) {
+            if (pair.second.handshakeCompleted) {
+                send(pair.second.socket, (const char*)closeFrame, sizeof(closeFrame), MSG_NOSIGNAL);
+                closedCount++;
+            }
+            m_impl->closeClientSocket(*worker, pair.second.socket);
         }
-#endif
-        auto setNonBlockEnd = std::chrono::high_resolution_clock::now();
-        auto nonBlockDuration = std::chrono::duration_cast<std::chrono::milliseconds>(setNonBlockEnd - setNonBlockStart);
-        Logger::getInstance().debug(LogCategory::NETWORK, "设置非阻塞模式耗时: " + std::to_string(nonBlockDuration.count()) + "ms");
-        
-        // 尝试发送WebSocket关闭帧（非阻塞）
-        auto sendFrameStart = std::chrono::high_resolution_clock::now();
-        try {
-            std::vector<uint8_t> closeFrame = {0x88, 0x00}; // WebSocket关闭帧
-            int result = send(sock, (char*)closeFrame.data(), closeFrame.size(), MSG_NOSIGNAL);
-            auto sendFrameEnd = std::chrono::high_resolution_clock::now();
-            auto sendFrameDuration = std::chrono::duration_cast<std::chrono::milliseconds>(sendFrameEnd - sendFrameStart);
-            Logger::getInstance().debug(LogCategory::NETWORK, "发送关闭帧耗时: " + std::to_string(sendFrameDuration.count()) + "ms, 结果: " + std::to_string(result));
-        } catch (...) {
-            auto sendFrameEnd = std::chrono::high_resolution_clock::now();
-            auto sendFrameDuration = std::chrono::duration_cast<std::chrono::milliseconds>(sendFrameEnd - sendFrameStart);
-            Logger::getInstance().warning(LogCategory::NETWORK, "发送关闭帧异常，耗时: " + std::to_string(sendFrameDuration.count()) + "ms");
+        for (const auto& pending : worker->pendingConnections) {
+            closesocket(pending.socket);
         }
-        
-        // 强制关闭socket
-        auto closeSocketStart = std::chrono::high_resolution_clock::now();
-        closesocket(sock);
-        auto closeSocketEnd = std::chrono::high_resolution_clock::now();
-        auto closeSocketDuration = std::chrono::duration_cast<std::chrono::milliseconds>(closeSocketEnd - closeSocketStart);
-        Logger::getInstance().debug(LogCategory::NETWORK, "关闭socket耗时: " + std::to_string(closeSocketDuration.count()) + "ms");
-        
-        closedCount++;
+        worker->connections.clear();
+        worker->pendingConnections.clear();
+        worker->connectionCount = 0;
     }
+    m_impl->workers.clear();
     
-    Logger::getInstance().info(LogCategory::NETWORK, "已关闭 " + std::to_string(closedCount) + " 个客户端连接");
-    
-    // 步骤5: 处理服务器线程
-    Logger::getInstance().info(LogCategory::NETWORK, "步骤5: 处理服务器线程");
-    if (m_impl->serverThread.joinable()) {
-        Logger::getInstance().info(LogCategory::NETWORK, "服务器线程可连接，准备分离");
-        auto detachStart = std::chrono::high_resolution_clock::now();
-        m_impl->serverThread.detach();
-        auto detachEnd = std::chrono::high_resolution_clock::now();
-        auto detachDuration = std::chrono::duration_cast<std::chrono::milliseconds>(detachEnd - detachStart);
-        Logger::getInstance().info(LogCategory::NETWORK, "线程分离完成，耗时: " + std::to_string(detachDuration.count()) + "ms");
-    } else {
-        Logger::getInstance().info(LogCategory::NETWORK, "服务器线程已分离或不可连接");
+    // 未处理的入站消息不再分发
+    {
+        std::lock_guard<std::mutex> lock(m_impl->incomingMutex);
+        m_impl->incomingMessages.clear();
     }
     
+    Logger::getInstance().info(LogCategory::NETWORK, "已关闭 " + std::to_string(closedCount) + " 个客户端连接");
+    
 #ifdef _WIN32
-    Logger::getInstance().info(LogCategory::NETWORK, "步骤6: 清理Winsock");
     WSACleanup();
 #endif
     
@@ -1164,67 +1192,165 @@ void NetworkManager::stopServer() {
 }
 
 void NetworkManager::sendToClient(int clientId, const std::string& message) {
-    std::lock_guard<std::mutex> lock(m_impl->clientsMutex);
-    auto it = m_impl->clients.find(clientId);
-    if (it != m_impl->clients.end()) {
-        std::vector<uint8_t> frame = m_impl->encodeWebSocketFrame(message);
-        m_impl->sendRawData(it->second.socket, frame);
-        
-        Logger::getInstance().debug(LogCategory::NETWORK, 
-            "Sent message to client " + std::to_string(clientId) + ": " + message);
-    }
+    sendPrepared(clientId, PreparedFrame::text(message));
+    
+    LOG_DEBUG(LogCategory::NETWORK, 
+        "Sent message to client " + std::to_string(clientId) + ": " + message);
+}
+
+void NetworkManager::broadcast(const std::string& message, bool droppable) {
+    broadcastPrepared(PreparedFrame::text(message, droppable));
+    
+    LOG_DEBUG(LogCategory::NETWORK, "Broadcast message: " + message);
 }
 
-void NetworkManager::broadcast(const std::string& message) {
-    std::lock_guard<std::mutex> lock(m_impl->clientsMutex);
-    std::vector<uint8_t> frame = m_impl->encodeWebSocketFrame(message);
+void NetworkManager::broadcastExcept(int excludeClientId, const std::string& message, bool droppable) {
+    broadcastPrepared(PreparedFrame::text(message, droppable), excludeClientId);
     
-    for (const auto& pair : m_impl->clients) {
-        m_impl->sendRawData(pair.second.socket, frame);
+    LOG_DEBUG(LogCategory::NETWORK, 
+        "Broadcast message (excluding " + std::to_string(excludeClientId) + "): " + message);
+}
+
+bool NetworkManager::sendPrepared(int clientId, const SharedFrame& frame) {
+    if (m_impl->workers.empty() || !frame) {
+        return false;
     }
     
-    Logger::getInstance().debug(LogCategory::NETWORK, 
-        "Broadcast message to " + std::to_string(m_impl->clients.size()) + " clients: " + message);
+    IoWorker& worker = m_impl->workerFor(clientId);
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    auto it = worker.connections.find(clientId);
+    if (it == worker.connections.end() || !it->second.handshakeCompleted) {
+        return false;
+    }
+    m_impl->unicastFrames.add();
+    return m_impl->enqueueFrameLocked(worker, it->second, frame);
 }
 
-void NetworkManager::broadcastExcept(int excludeClientId, const std::string& message) {
-    std::lock_guard<std::mutex> lock(m_impl->clientsMutex);
-    std::vector<uint8_t> frame = m_impl->encodeWebSocketFrame(message);
+int NetworkManager::broadcastPrepared(const SharedFrame& frame, int excludeClientId) {
+    if (!frame) {
+        return 0;
+    }
     
+    // 所有接收者共享同一帧，每个连接只是一次指针入队，不会阻塞在任何一个客户端上
+    MetricTimer timer(m_impl->broadcastDuration);
     int count = 0;
-    for (const auto& pair : m_impl->clients) {
-        if (pair.first != excludeClientId) {
-            m_impl->sendRawData(pair.second.socket, frame);
-            count++;
+    for (auto& worker : m_impl->workers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        for (auto& pair : worker->connections) {
+            if (pair.first != excludeClientId && pair.second.handshakeCompleted) {
+                if (m_impl->enqueueFrameLocked(*worker, pair.second, frame)) {
+                    count++;
+                }
+            }
         }
     }
-    
-    Logger::getInstance().debug(LogCategory::NETWORK, 
-        "Broadcast message to " + std::to_string(count) + " clients (excluding " + 
-        std::to_string(excludeClientId) + "): " + message);
+    m_impl->broadcastFrames.add(static_cast<uint64_t>(count));
+    return count;
+}
+
+void NetworkManager::setSendQueueLimits(size_t maxBytes, size_t maxFrames) {
+    m_impl->maxQueuedBytes = maxBytes;
+    m_impl->maxQueuedFrames = maxFrames;
+}
+
+void NetworkManager::setSlowConsumerPolicy(SlowConsumerPolicy policy) {
+    m_impl->slowConsumerPolicy = policy;
 }
 
 int NetworkManager::getConnectedClientsCount() const {
-    std::lock_guard<std::mutex> lock(m_impl->clientsMutex);
-    return m_impl->clients.size();
+    int total = 0;
+    for (const auto& worker : m_impl->workers) {
+        total += worker->connectionCount;
+    }
+    return total;
+}
+
+SendQueueStats NetworkManager::getSendQueueStats() const {
+    SendQueueStats stats;
+    for (const auto& worker : m_impl->workers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        for (const auto& pair : worker->connections) {
+            const ClientConnection& connection = pair.second;
+            stats.totalBytes += connection.sendQueueBytes;
+            stats.totalFrames += connection.sendQueue.size();
+            stats.maxBytes = std::max(stats.maxBytes, connection.sendQueueBytes);
+            if (connection.writeBlocked) {
+                stats.blockedConnections++;
+            }
+        }
+    }
+    return stats;
+}
+
+size_t NetworkManager::getIncomingQueueSize() const {
+    std::lock_guard<std::mutex> lock(m_impl->incomingMutex);
+    return m_impl->incomingMessages.size();
+}
+
+int NetworkManager::getIoThreadCount() const {
+    return m_impl->ioThreadCount;
 }
 
 void NetworkManager::disconnectClient(int clientId) {
-    std::lock_guard<std::mutex> lock(m_impl->clientsMutex);
-    auto it = m_impl->clients.find(clientId);
-    if (it != m_impl->clients.end()) {
-        closesocket(it->second.socket);
-        m_impl->clients.erase(it);
-        
-        Logger::getInstance().info(LogCategory::NETWORK, 
-            "Forcefully disconnected client " + std::to_string(clientId));
-        
-        if (m_impl->messageCallback) {
-            m_impl->messageCallback(clientId, "DISCONNECT");
+    if (m_impl->workers.empty()) {
+        return;
+    }
+    
+    // 只关闭socket的收发，连接由所属I/O线程在读到EOF后移除并通知DISCONNECT
+    IoWorker& worker = m_impl->workerFor(clientId);
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        auto it = worker.connections.find(clientId);
+        if (it == worker.connections.end()) {
+            return;
         }
+#ifdef _WIN32
+        shutdown(it->second.socket, SD_BOTH);
+#else
+        shutdown(it->second.socket, SHUT_RDWR);
+#endif
     }
+    
+    Logger::getInstance().info(LogCategory::NETWORK, 
+        "Forcefully disconnected client " + std::to_string(clientId));
 }
 
 void NetworkManager::setMessageCallback(std::function<void(int, const std::string&)> callback) {
     m_impl->messageCallback = callback;
-}
\ No newline at end of file
+}
+
+void NetworkManager::setBinaryMessageCallback(std::function<void(int, const std::string&)> callback) {
+    m_impl->binaryMessageCallback = callback;
+}
+
+void NetworkManager::setIncomingMessageHandler(std::function<void(int, std::string&&, bool)> handler) {
+    m_impl->incomingMessageHandler = handler;
+}
+
+bool NetworkManager::waitForIncomingMessages(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_impl->incomingMutex);
+    return m_impl->incomingCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+        [this]() { return !m_impl->incomingMessages.empty(); });
+}
+
+int NetworkManager::processIncomingMessages() {
+    std::deque<Impl::IncomingMessage> messages;
+    {
+        std::lock_guard<std::mutex> lock(m_impl->incomingMutex);
+        messages.swap(m_impl->incomingMessages);
+    }
+    
+    for (const auto& message : messages) {
+        const auto& callback = message.binary ? m_impl->binaryMessageCallback : m_impl->messageCallback;
+        if (!callback) {
+            continue;
+        }
+        try {
+            callback(message.clientId, message.payload);
+        } catch (const std::exception& e) {
+            Logger::getInstance().error(LogCategory::NETWORK, 
+                "消息处理异常: " + std::string(e.what()));
+        }
+    }
+    return static_cast<int>(messages.size());
+}
@@ -0,0 +1,431 @@
+#include "PlayerJournal.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <filesystem>
+#include <system_error>
+#include <nlohmann/json.hpp>
+
+#ifdef _WIN32
+    #include <io.h>
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr int SNAPSHOT_VERSION = 1;
+
+json PlayerDataToJson(const PlayerData& player) {
+    return json{
+        {"playerId", player.playerId},
+        {"macAddress", player.macAddress},
+        {"cookie", player.cookie},
+        {"totalCoins", player.totalCoins},
+        {"gamesPlayed", player.gamesPlayed},
+        {"gamesWon", player.gamesWon},
+        {"lastLogin", std::chrono::duration_cast<std::chrono::seconds>(player.lastLogin.time_since_epoch()).count()},
+        {"isOnline", player.isOnline}
+    };
+}
+
+PlayerData JsonToPlayerData(const json& j) {
+    PlayerData player;
+    player.playerId = j.at("playerId").get<std::string>();
+    player.macAddress = j.at("macAddress").get<std::string>();
+    player.cookie = j.value("cookie", "");
+    player.totalCoins = j.value("totalCoins", 0);
+    player.gamesPlayed = j.value("gamesPlayed", 0);
+    player.gamesWon = j.value("gamesWon", 0);
+    player.isOnline = j.value("isOnline", false);
+    player.lastLogin = std::chrono::system_clock::now();
+
+    const json& lastLogin = j.value("lastLogin", json());
+    if (lastLogin.is_number_integer()) {
+        player.lastLogin = std::chrono::system_clock::time_point(std::chrono::seconds(lastLogin.get<int64_t>()));
+    } else if (lastLogin.is_string()) {
+        // 旧版快照保存的是本地时间字符串
+        std::tm tm = {};
+        std::istringstream ss(lastLogin.get<std::string>());
+        if (ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S")) {
+            tm.tm_isdst = -1;
+            player.lastLogin = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+        }
+    }
+    return player;
+}
+
+std::string Dump(const json& j) {
+    // 玩家名来自客户端，可能不是合法UTF-8
+    return j.dump(-1, ' ', false, json::error_handler_t::replace);
+}
+
+// 日志行的校验和：FNV-1a 32位，8位十六进制
+std::string Checksum(const std::string& text) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    char buffer[9];
+    std::snprintf(buffer, sizeof(buffer), "%08x", hash);
+    return buffer;
+}
+
+bool SyncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// 用临时文件原子地替换目标文件，并保证替换本身已落盘
+// Windows 上 MoveFileExW 直接覆盖（WRITE_THROUGH 在返回前刷新）；POSIX 上 rename 之后再同步所在目录，
+// 否则崩溃后可能只留下之后的日志截断而丢失这次 rename
+bool ReplaceFileDurably(const std::string& source, const std::string& target) {
+#ifdef _WIN32
+    return MoveFileExW(std::filesystem::path(source).c_str(), std::filesystem::path(target).c_str(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (std::rename(source.c_str(), target.c_str()) != 0) {
+        return false;
+    }
+    std::filesystem::path directory = std::filesystem::path(target).parent_path();
+    int fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+#endif
+}
+
+} // namespace
+
+PlayerJournal::PlayerJournal() {
+}
+
+PlayerJournal::~PlayerJournal() {
+    close();
+}
+
+bool PlayerJournal::open(const std::string& directory, std::map<std::string, PlayerData>& players) {
+    close();
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    snapshotPath = directory + "/players.json";
+    journalPath = directory + "/players.wal";
+
+    committed.clear();
+    sequence = 0;
+    journalRecords = 0;
+    journalBytes = 0;
+    snapshotStale = false;
+
+    uint64_t snapshotSequence = 0;
+    if (!readSnapshot(snapshotSequence)) {
+        Logger::getInstance().error(LogCategory::DATABASE, "玩家数据快照损坏: " + snapshotPath);
+        return false;
+    }
+    sequence = snapshotSequence;
+    replayJournal(snapshotSequence);
+    size_t replayed = journalRecords;
+
+    // 启动时把重放的日志合并进快照，顺便丢掉日志末尾损坏的部分
+    if (snapshotStale || journalRecords > 0) {
+        if (!compact()) {
+            Logger::getInstance().error(LogCategory::DATABASE, "无法写入玩家数据快照: " + snapshotPath);
+            return false;
+        }
+    } else if (!reopenJournal(false)) {
+        Logger::getInstance().error(LogCategory::DATABASE, "无法打开玩家数据日志: " + journalPath);
+        return false;
+    }
+
+    players = committed;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.clear();
+        flushRequested = 0;
+        flushCompleted = 0;
+        compactRequested = false;
+        lastFlushOk = true;
+        stopRequested = false;
+        running = true;
+    }
+    worker = std::thread(&PlayerJournal::run, this);
+
+    Logger::getInstance().info(LogCategory::DATABASE, "加载玩家数据 " + std::to_string(players.size()) +
+                               " 条，重放日志记录 " + std::to_string(replayed) + " 条");
+    return true;
+}
+
+void PlayerJournal::close() {
+    if (!running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    wakeup.notify_one();
+    worker.join();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    flushed.notify_all();
+
+    if (journal) {
+        std::fclose(journal);
+        journal = nullptr;
+    }
+}
+
+void PlayerJournal::record(const PlayerData& data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending[data.playerId] = data;
+}
+
+bool PlayerJournal::flush(bool compactSnapshot) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!running) {
+        return false;
+    }
+
+    uint64_t ticket = ++flushRequested;
+    if (compactSnapshot) {
+        compactRequested = true;
+    }
+    wakeup.notify_one();
+    flushed.wait(lock, [this, ticket] { return flushCompleted >= ticket || !running; });
+    return flushCompleted >= ticket && lastFlushOk;
+}
+
+void PlayerJournal::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeup.wait_for(lock, flushInterval, [this] {
+            return stopRequested || flushRequested != flushCompleted;
+        });
+
+        bool stopping = stopRequested;
+        bool compactNow = compactRequested || stopping;
+        uint64_t ticket = flushRequested;
+        compactRequested = false;
+
+        std::map<std::string, PlayerData> batch;
+        batch.swap(pending);
+        lock.unlock();
+
+        // I/O 在锁外进行，record() 不会等待磁盘
+        bool appended = batch.empty() || appendRecords(batch);
+        bool ok = appended;
+        if (ok && (compactNow || journalRecords >= compactThreshold)) {
+            ok = compact();
+        }
+
+        lock.lock();
+        if (!appended) {
+            // 放回待写表下次重试，不覆盖期间产生的更新修改
+            for (auto& entry : batch) {
+                pending.emplace(entry.first, std::move(entry.second));
+            }
+        }
+        if (!ok) {
+            Logger::getInstance().error(LogCategory::DATABASE, "玩家数据写入失败: " + journalPath);
+        }
+        lastFlushOk = ok;
+        flushCompleted = ticket;
+        flushed.notify_all();
+
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+bool PlayerJournal::appendRecords(const std::map<std::string, PlayerData>& batch) {
+    static MetricHistogram& appendDuration = MetricsRegistry::getInstance().histogram(
+        "netlab_journal_append_seconds", "Player journal batch append duration including fsync");
+    static MetricCounter& appendedRecords = MetricsRegistry::getInstance().counter(
+        "netlab_journal_records_total", "Player records appended to the journal");
+    MetricTimer timer(appendDuration);
+
+    if (!journal && !reopenJournal(false)) {
+        return false;
+    }
+
+    std::string buffer;
+    uint64_t seq = sequence;
+    for (const auto& entry : batch) {
+        std::string body = Dump(json{{"seq", ++seq}, {"player", PlayerDataToJson(entry.second)}});
+        buffer += Checksum(body);
+        buffer += ' ';
+        buffer += body;
+        buffer += '\n';
+    }
+
+    if (std::fwrite(buffer.data(), 1, buffer.size(), journal) != buffer.size() || !SyncFile(journal)) {
+        // 截掉写了一半的记录，否则之后追加的记录在重放时会被当作损坏内容丢弃
+        std::fclose(journal);
+        journal = nullptr;
+        std::error_code ec;
+        std::filesystem::resize_file(journalPath, journalBytes, ec);
+        return false;
+    }
+
+    for (const auto& entry : batch) {
+        committed[entry.first] = entry.second;
+    }
+    sequence = seq;
+    appendedRecords.add(batch.size());
+    journalRecords += batch.size();
+    journalBytes += buffer.size();
+    return true;
+}
+
+bool PlayerJournal::compact() {
+    static MetricHistogram& compactDuration = MetricsRegistry::getInstance().histogram(
+        "netlab_journal_compact_seconds", "Player snapshot rewrite duration");
+    MetricTimer timer(compactDuration);
+
+    json snapshot;
+    snapshot["version"] = SNAPSHOT_VERSION;
+    snapshot["seq"] = sequence.load();
+    json players = json::array();
+    for (const auto& entry : committed) {
+        players.push_back(PlayerDataToJson(entry.second));
+    }
+    snapshot["players"] = std::move(players);
+    std::string text = Dump(snapshot);
+
+    std::string tempPath = snapshotPath + ".tmp";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size() && SyncFile(file);
+    std::fclose(file);
+    if (!written) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    // 替换失败时旧快照保持不变；目录未能同步时不清空日志，下次压缩重试
+    if (!ReplaceFileDurably(tempPath, snapshotPath)) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    // 快照已包含日志中的全部记录；在清空日志前崩溃也没关系，重放会跳过这些序号
+    snapshotStale = false;
+    return reopenJournal(true);
+}
+
+bool PlayerJournal::readSnapshot(uint64_t& snapshotSequence) {
+    snapshotSequence = 0;
+    std::ifstream file(snapshotPath);
+    if (!file.is_open()) {
+        // 第一次运行，写一个空快照
+        snapshotStale = true;
+        return true;
+    }
+
+    try {
+        json snapshot;
+        file >> snapshot;
+
+        const json* players = &snapshot;
+        if (snapshot.is_object()) {
+            snapshotSequence = snapshot.value("seq", uint64_t(0));
+            players = &snapshot.at("players");
+        } else {
+            // 旧版快照：玩家数组
+            snapshotStale = true;
+        }
+
+        for (const auto& playerJson : *players) {
+            PlayerData player = JsonToPlayerData(playerJson);
+            committed[player.playerId] = player;
+        }
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+void PlayerJournal::replayJournal(uint64_t snapshotSequence) {
+    std::ifstream file(journalPath, std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // 没有换行符结尾的最后一行是写了一半的记录
+        bool complete = !file.eof();
+        size_t space = line.find(' ');
+        if (!complete || space == std::string::npos ||
+            Checksum(line.substr(space + 1)) != line.substr(0, space)) {
+            snapshotStale = true;
+            break;
+        }
+
+        try {
+            json record = json::parse(line.substr(space + 1));
+            uint64_t seq = record.at("seq").get<uint64_t>();
+            if (seq > snapshotSequence) {
+                PlayerData player = JsonToPlayerData(record.at("player"));
+                committed[player.playerId] = player;
+                ++journalRecords;
+                if (seq > sequence) {
+                    sequence = seq;
+                }
+            } else {
+                // 快照之后日志没来得及清空
+                snapshotStale = true;
+            }
+        } catch (const std::exception&) {
+            snapshotStale = true;
+            break;
+        }
+    }
+}
+
+bool PlayerJournal::reopenJournal(bool truncate) {
+    if (journal) {
+        std::fclose(journal);
+        journal = nullptr;
+    }
+
+    journal = std::fopen(journalPath.c_str(), truncate ? "wb" : "ab");
+    if (!journal) {
+        return false;
+    }
+    if (truncate) {
+        journalRecords = 0;
+        journalBytes = 0;
+    } else {
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(journalPath, ec);
+        journalBytes = ec ? 0 : size;
+    }
+    return true;
+}
@@ -1,22 +1,16 @@
 #include "PlayerManager.h"
-#include <fstream>
-#include <sstream>
-#include <random>
 #include <algorithm>
-#include <iomanip>
-#include <ctime>
 #include <filesystem>
-#include <nlohmann/json.hpp>
+#include <cctype>
+#include <cstdio>
 
-using json = nlohmann::json;
-
-PlayerManager::PlayerManager() {
+PlayerManager::PlayerManager() : idGenerator_(std::random_device{}()) {
     // 构造函数
 }
 
 PlayerManager::~PlayerManager() {
-    // 析构时保存数据
-    SaveAllPlayerData();
+    // 析构时写出剩余修改并压缩为快照
+    journal_.close();
 }
 
 bool PlayerManager::Initialize(const std::string& dataPath) {
@@ -34,259 +28,350 @@ std::string PlayerManager::RegisterPlayer(const std::string& macAddress, const s
         return "";
     }
     
-    // 检查是否已存在
-    std::string existingPlayerId = FindPlayerByIdentifier(macAddress, cookie);
-    if (!existingPlayerId.empty()) {
-        return existingPlayerId;
+    // 已注册的玩家（重复认证）只需要读锁
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        uint32_t existing = FindPlayerLocked(macAddress, cookie);
+        if (existing != NOT_FOUND) {
+            return players_[existing].data.playerId;
+        }
     }
     
-    // 生成新玩家ID
-    std::string playerId = GeneratePlayerId();
-    
-    // 创建玩家数据
-    PlayerData newPlayer = CreateDefaultPlayerData(playerId, macAddress, cookie);
-    
-    // 添加到管理器中
-    players_[playerId] = newPlayer;
-    macToPlayerId_[macAddress] = playerId;
-    
-    if (!cookie.empty()) {
-        cookieToPlayerId_[cookie] = playerId;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    // 获取写锁前可能已被其他线程注册
+    uint32_t existing = FindPlayerLocked(macAddress, cookie);
+    if (existing != NOT_FOUND) {
+        return players_[existing].data.playerId;
     }
     
-    // 保存数据
-    SaveAllPlayerData();
+    // 生成新玩家ID并创建玩家数据
+    std::string playerId = GeneratePlayerId();
+    uint32_t handle = AddEntry(CreateDefaultPlayerData(playerId, macAddress, cookie));
+    MarkDirty(handle);
+    
+    return playerId;
+}
+
+std::string PlayerManager::RegisterAnonymousPlayer(std::string& token) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::string playerId = GeneratePlayerId();
+    token = GenerateToken();
+    uint32_t handle = AddEntry(CreateDefaultPlayerData(playerId, GenerateAnonymousMac(), token));
+    MarkDirty(handle);
     
     return playerId;
 }
 
+std::string PlayerManager::FindPlayerByToken(const std::string& token) const {
+    if (!IsIssuedToken(token)) {
+        return "";
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = cookieIndex_.find(token);
+    return it != cookieIndex_.end() ? players_[it->second].data.playerId : "";
+}
+
 bool PlayerManager::LoginPlayer(const std::string& playerId) {
-    auto it = players_.find(playerId);
-    if (it == players_.end()) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    uint32_t handle = FindHandle(playerId);
+    if (handle == NOT_FOUND) {
         return false;
     }
     
     // 更新登录状态和时间
-    it->second.isOnline = true;
-    it->second.lastLogin = std::chrono::system_clock::now();
-    
-    // 添加到在线玩家列表
-    if (std::find(onlinePlayers_.begin(), onlinePlayers_.end(), playerId) == onlinePlayers_.end()) {
-        onlinePlayers_.push_back(playerId);
-    }
+    players_[handle].data.lastLogin = std::chrono::system_clock::now();
+    SetOnline(handle, true);
     
+    MarkDirty(handle);
     return true;
 }
 
 void PlayerManager::LogoutPlayer(const std::string& playerId) {
-    auto it = players_.find(playerId);
-    if (it != players_.end()) {
-        it->second.isOnline = false;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    uint32_t handle = FindHandle(playerId);
+    if (handle != NOT_FOUND) {
+        SetOnline(handle, false);
+        MarkDirty(handle);
     }
-    
-    // 从在线玩家列表中移除
-    onlinePlayers_.erase(
-        std::remove(onlinePlayers_.begin(), onlinePlayers_.end(), playerId),
-        onlinePlayers_.end()
-    );
-    
-    // 保存数据
-    SaveAllPlayerData();
 }
 
 PlayerData PlayerManager::GetPlayerData(const std::string& playerId) const {
-    auto it = players_.find(playerId);
-    if (it != players_.end()) {
-        return it->second;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    uint32_t handle = FindHandle(playerId);
+    if (handle != NOT_FOUND) {
+        return players_[handle].data;
     }
     return PlayerData(); // 返回空数据
 }
 
 bool PlayerManager::UpdatePlayerData(const std::string& playerId, const PlayerData& newData) {
-    auto it = players_.find(playerId);
-    if (it == players_.end()) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    uint32_t handle = FindHandle(playerId);
+    if (handle == NOT_FOUND) {
         return false;
     }
     
-    it->second = newData;
-    SaveAllPlayerData();
+    // 玩家ID保持不变；MAC地址或Cookie变化时更新索引，在线状态与在线集合保持一致
+    PlayerData& data = players_[handle].data;
+    auto unindex = [handle](std::unordered_map<std::string, uint32_t>& index, const std::string& key) {
+        auto it = index.find(key);
+        if (it != index.end() && it->second == handle) {
+            index.erase(it);
+        }
+    };
+    if (newData.macAddress != data.macAddress) {
+        unindex(macIndex_, data.macAddress);
+    }
+    if (newData.cookie != data.cookie) {
+        unindex(cookieIndex_, data.cookie);
+    }
+    
+    // playerIndex_ 的键指向 data.playerId，逐个字段赋值，不修改它
+    data.macAddress = newData.macAddress;
+    data.cookie = newData.cookie;
+    data.totalCoins = newData.totalCoins;
+    data.gamesPlayed = newData.gamesPlayed;
+    data.gamesWon = newData.gamesWon;
+    data.lastLogin = newData.lastLogin;
+    
+    IndexIdentifiers(handle);
+    SetOnline(handle, newData.isOnline);
+    MarkDirty(handle);
     return true;
 }
 
 void PlayerManager::HandlePlayerDeath(const std::string& playerId) {
-    auto it = players_.find(playerId);
-    if (it != players_.end()) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    uint32_t handle = FindHandle(playerId);
+    if (handle != NOT_FOUND) {
         // 没有死亡惩罚，仅标记为离线等待重生
-        it->second.isOnline = false; // 标记为离线等待重生
-        
-        // 从在线玩家列表中移除
-        onlinePlayers_.erase(
-            std::remove(onlinePlayers_.begin(), onlinePlayers_.end(), playerId),
-            onlinePlayers_.end()
-        );
+        SetOnline(handle, false);
+        MarkDirty(handle);
     }
 }
 
 void PlayerManager::RespawnPlayer(const std::string& playerId) {
-    auto it = players_.find(playerId);
-    if (it != players_.end()) {
-        it->second.isOnline = true;
-        
-        // 重新添加到在线玩家列表
-        if (std::find(onlinePlayers_.begin(), onlinePlayers_.end(), playerId) == onlinePlayers_.end()) {
-            onlinePlayers_.push_back(playerId);
-        }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    uint32_t handle = FindHandle(playerId);
+    if (handle != NOT_FOUND) {
+        SetOnline(handle, true);
+        MarkDirty(handle);
     }
 }
 
 bool PlayerManager::IsSessionValid(const std::string& playerId) const {
-    auto it = players_.find(playerId);
-    if (it == players_.end()) {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    uint32_t handle = FindHandle(playerId);
+    if (handle == NOT_FOUND) {
         return false;
     }
     
     // 检查玩家是否在线且会话未过期
     // 这里可以添加更复杂的会话验证逻辑
-    return it->second.isOnline;
+    return players_[handle].onlineSlot != NOT_ONLINE;
 }
 
 bool PlayerManager::IsValidPlayerId(const std::string& playerId) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
     // 检查playerId是否存在于玩家列表中
-    auto it = players_.find(playerId);
-    return it != players_.end();
+    return FindHandle(playerId) != NOT_FOUND;
 }
 
 std::string PlayerManager::FindPlayerByIdentifier(const std::string& macAddress, const std::string& cookie) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    uint32_t handle = FindPlayerLocked(macAddress, cookie);
+    return handle != NOT_FOUND ? players_[handle].data.playerId : "";
+}
+
+uint32_t PlayerManager::FindHandle(const std::string& playerId) const {
+    auto it = playerIndex_.find(playerId);
+    return it != playerIndex_.end() ? it->second : NOT_FOUND;
+}
+
+uint32_t PlayerManager::FindPlayerLocked(const std::string& macAddress, const std::string& cookie) const {
     // 优先使用MAC地址查找
-    auto macIt = macToPlayerId_.find(macAddress);
-    if (macIt != macToPlayerId_.end()) {
+    auto macIt = macIndex_.find(macAddress);
+    if (macIt != macIndex_.end()) {
         return macIt->second;
     }
     
     // 如果提供了cookie，使用cookie查找
     if (!cookie.empty()) {
-        auto cookieIt = cookieToPlayerId_.find(cookie);
-        if (cookieIt != cookieToPlayerId_.end()) {
+        auto cookieIt = cookieIndex_.find(cookie);
+        if (cookieIt != cookieIndex_.end()) {
             return cookieIt->second;
         }
     }
     
-    return "";
+    return NOT_FOUND;
+}
+
+int PlayerManager::GetPlayerCount() const {
+    return playerCount_.load(std::memory_order_relaxed);
+}
+
+int PlayerManager::GetOnlinePlayerCount() const {
+    return onlineCount_.load(std::memory_order_relaxed);
 }
 
 std::vector<std::string> PlayerManager::GetOnlinePlayers() const {
-    return onlinePlayers_;
+    OnlineSnapshot snapshot = GetOnlineSnapshot();
+    std::vector<std::string> result;
+    result.reserve(snapshot->size());
+    for (const PlayerData& player : *snapshot) {
+        result.push_back(player.playerId);
+    }
+    return result;
 }
 
-bool PlayerManager::SaveAllPlayerData() {
-    json playersJson = json::array();
+PlayerManager::OnlineSnapshot PlayerManager::GetOnlineSnapshot() const {
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex_);
+        if (onlineSnapshot_ && snapshotVersion_ == onlineVersion_.load(std::memory_order_acquire)) {
+            return onlineSnapshot_;
+        }
+    }
     
-    for (const auto& pair : players_) {
-        const PlayerData& player = pair.second;
-        
-        json playerJson;
-        playerJson["playerId"] = player.playerId;
-        playerJson["macAddress"] = player.macAddress;
-        playerJson["cookie"] = player.cookie;
-        playerJson["totalCoins"] = player.totalCoins;
-        playerJson["gamesPlayed"] = player.gamesPlayed;
-        playerJson["gamesWon"] = player.gamesWon;
-        
-        // 转换时间戳为可读字符串
-        auto time_t = std::chrono::system_clock::to_time_t(player.lastLogin);
-        std::stringstream timeStream;
-        timeStream << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-        playerJson["lastLogin"] = timeStream.str();
-        playerJson["isOnline"] = player.isOnline;
-        
-        playersJson.push_back(playerJson);
+    // 在读锁下重建（版本只在写锁内修改，重建期间不会变化）
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    uint64_t version = onlineVersion_.load(std::memory_order_acquire);
+    auto snapshot = std::make_shared<std::vector<PlayerData>>();
+    snapshot->reserve(onlinePlayers_.size());
+    for (uint32_t handle : onlinePlayers_) {
+        snapshot->push_back(players_[handle].data);
     }
     
-    std::string filePath = GetPlayerDataFilePath();
-    std::ofstream file(filePath);
-    if (!file.is_open()) {
-        // 如果文件打开失败，尝试创建目录
-        std::filesystem::create_directories(dataPath_);
-        file.open(filePath);
-        if (!file.is_open()) {
-            return false;
-        }
+    std::lock_guard<std::mutex> snapshotLock(snapshotMutex_);
+    if (version > snapshotVersion_) {
+        onlineSnapshot_ = snapshot;
+        snapshotVersion_ = version;
+    }
+    return snapshot;
+}
+
+bool PlayerManager::SaveAllPlayerData() {
+    return journal_.flush(true);
+}
+
+bool PlayerManager::LoadAllPlayerData() {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::map<std::string, PlayerData> loaded;
+    if (!journal_.open(dataPath_, loaded)) {
+        return false;
     }
     
-    file << playersJson.dump(4); // 使用4空格缩进
-    file.close();
+    players_.clear();
+    playerIndex_.clear();
+    macIndex_.clear();
+    cookieIndex_.clear();
+    onlinePlayers_.clear();
+    playerIndex_.reserve(loaded.size());
+    macIndex_.reserve(loaded.size());
+    
+    for (auto& pair : loaded) {
+        AddEntry(std::move(pair.second));
+    }
     
     return true;
 }
 
-bool PlayerManager::LoadAllPlayerData() {
-    std::string filePath = GetPlayerDataFilePath();
-    std::ifstream file(filePath);
-    if (!file.is_open()) {
-        // 文件不存在是正常的（第一次运行），创建空的数据文件
-        SaveAllPlayerData(); // 创建空的玩家数据文件
-        return true;
+uint32_t PlayerManager::AddEntry(PlayerData data) {
+    uint32_t handle = static_cast<uint32_t>(players_.size());
+    data.isOnline = false;
+    players_.push_back({std::move(data), NOT_ONLINE});
+    playerIndex_[players_.back().data.playerId] = handle;
+    IndexIdentifiers(handle);
+    playerCount_.store(static_cast<int>(players_.size()), std::memory_order_relaxed);
+    return handle;
+}
+
+void PlayerManager::IndexIdentifiers(uint32_t handle) {
+    const PlayerData& data = players_[handle].data;
+    macIndex_[data.macAddress] = handle;
+    if (!data.cookie.empty()) {
+        cookieIndex_[data.cookie] = handle;
+    }
+}
+
+void PlayerManager::SetOnline(uint32_t handle, bool online) {
+    PlayerEntry& entry = players_[handle];
+    entry.data.isOnline = online;
+    if (online == (entry.onlineSlot != NOT_ONLINE)) {
+        return;
     }
     
-    try {
-        json playersJson;
-        file >> playersJson;
-        file.close();
-        
-        // 清空现有数据
-        players_.clear();
-        macToPlayerId_.clear();
-        cookieToPlayerId_.clear();
-        onlinePlayers_.clear();
-        
-        for (const auto& playerJson : playersJson) {
-            PlayerData player;
-            player.playerId = playerJson["playerId"];
-            player.macAddress = playerJson["macAddress"];
-            player.cookie = playerJson.value("cookie", "");
-            player.totalCoins = playerJson["totalCoins"];
-            player.gamesPlayed = playerJson["gamesPlayed"];
-            player.gamesWon = playerJson["gamesWon"];
-            player.isOnline = playerJson["isOnline"];
-            
-            // 解析时间戳
-            std::string timeStr = playerJson["lastLogin"];
-            std::tm tm = {};
-            std::istringstream ss(timeStr);
-            
-            // 尝试解析时间格式
-            if (ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S")) {
-                player.lastLogin = std::chrono::system_clock::from_time_t(std::mktime(&tm));
-            } else {
-                // 如果解析失败，使用当前时间
-                player.lastLogin = std::chrono::system_clock::now();
-            }
-            
-            // 添加到管理器
-            players_[player.playerId] = player;
-            macToPlayerId_[player.macAddress] = player.playerId;
-            
-            if (!player.cookie.empty()) {
-                cookieToPlayerId_[player.cookie] = player.playerId;
-            }
-            
-            if (player.isOnline) {
-                onlinePlayers_.push_back(player.playerId);
-            }
+    if (online) {
+        entry.onlineSlot = onlinePlayers_.size();
+        onlinePlayers_.push_back(handle);
+    } else {
+        // 与最后一个交换后移除
+        uint32_t last = onlinePlayers_.back();
+        onlinePlayers_[entry.onlineSlot] = last;
+        players_[last].onlineSlot = entry.onlineSlot;
+        onlinePlayers_.pop_back();
+        entry.onlineSlot = NOT_ONLINE;
+    }
+    onlineCount_.store(static_cast<int>(onlinePlayers_.size()), std::memory_order_relaxed);
+    onlineVersion_.fetch_add(1, std::memory_order_release);
+}
+
+void PlayerManager::MarkDirty(uint32_t handle) {
+    const PlayerEntry& entry = players_[handle];
+    journal_.record(entry.data);
+    // 离线玩家的数据不在快照中
+    if (entry.onlineSlot != NOT_ONLINE) {
+        onlineVersion_.fetch_add(1, std::memory_order_release);
+    }
+}
+
+std::string PlayerManager::GenerateAnonymousMac() {
+    // 本地管理的单播地址（首字节 0x02），其余40位随机；与已有玩家重复时重新生成
+    while (true) {
+        uint64_t bits = idGenerator_();
+        char buffer[18];
+        std::snprintf(buffer, sizeof(buffer), "02:%02X:%02X:%02X:%02X:%02X",
+                      static_cast<unsigned>((bits >> 32) & 0xFF), static_cast<unsigned>((bits >> 24) & 0xFF),
+                      static_cast<unsigned>((bits >> 16) & 0xFF), static_cast<unsigned>((bits >> 8) & 0xFF),
+                      static_cast<unsigned>(bits & 0xFF));
+        if (macIndex_.find(buffer) == macIndex_.end()) {
+            return buffer;
         }
-        
-        return true;
-    } catch (const std::exception& e) {
+    }
+}
+
+std::string PlayerManager::GenerateToken() {
+    // 令牌相当于登录凭据，直接取自系统随机源而不是可预测的ID生成器
+    std::random_device random;
+    while (true) {
+        char buffer[40];
+        std::snprintf(buffer, sizeof(buffer), "tk_%08x%08x%08x%08x",
+                      random(), random(), random(), random());
+        if (cookieIndex_.find(buffer) == cookieIndex_.end()) {
+            return buffer;
+        }
+    }
+}
+
+bool PlayerManager::IsIssuedToken(const std::string& token) {
+    if (token.size() != 35 || token.compare(0, 3, "tk_") != 0) {
         return false;
     }
+    return std::all_of(token.begin() + 3, token.end(), [](char c) { return std::isxdigit(static_cast<unsigned char>(c)); });
 }
 
-std::string PlayerManager::GeneratePlayerId() const {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(100000, 999999);
-    
-    return "PLAYER_" + std::to_string(dis(gen));
+std::string PlayerManager::GeneratePlayerId() {
+    // 6位编号，冲突时重新生成；连续冲突说明编号空间快满了，改用更长的编号
+    uint64_t low = 100000;
+    for (int attempt = 1; ; ++attempt) {
+        std::uniform_int_distribution<uint64_t> dis(low, low * 10 - 1);
+        std::string playerId = "PLAYER_" + std::to_string(dis(idGenerator_));
+        if (playerIndex_.find(playerId) == playerIndex_.end()) {
+            return playerId;
+        }
+        if (attempt % 16 == 0) {
+            low *= 10;
+        }
+    }
 }
 
 PlayerData PlayerManager::CreateDefaultPlayerData(const std::string& playerId, 
@@ -338,7 +423,3 @@ bool PlayerManager::ValidateMacAddress(const std::string& macAddress) const {
     
     return true;
 }
-
-std::string PlayerManager::GetPlayerDataFilePath() const {
-    return dataPath_ + "/players.json";
-}
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "PlayerStore.h"
+#include <cmath>
+
+PlayerStore::Handle PlayerStore::insert(int playerId) {
+    if (slotById.find(playerId) != slotById.end()) {
+        return INVALID_HANDLE;
+    }
+
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+
+    uint32_t dense = static_cast<uint32_t>(ids.size());
+    slots[slot].dense = dense;
+    slots[slot].used = true;
+    slotById[playerId] = slot;
+
+    ids.push_back(playerId);
+    xs.push_back(0.0f);
+    ys.push_back(0.0f);
+    zs.push_back(0.0f);
+    rotations.push_back(0.0f);
+    rotationSins.push_back(0.0f);
+    rotationCoses.push_back(1.0f);
+    flags.push_back(0);
+    coinCounts.push_back(0);
+    finishRanks.push_back(0);
+    inventories.push_back(Inventory());
+    inventories.back().fill(0);
+    speedBoostEnds.push_back(std::chrono::steady_clock::time_point());
+    slotOfDense.push_back(slot);
+
+    return makeHandle(slot, slots[slot].generation);
+}
+
+bool PlayerStore::erase(int playerId) {
+    auto it = slotById.find(playerId);
+    if (it == slotById.end()) {
+        return false;
+    }
+
+    uint32_t slot = it->second;
+    size_t index = slots[slot].dense;
+    size_t last = ids.size() - 1;
+
+    // 用末尾元素填补空位
+    if (index != last) {
+        ids[index] = ids[last];
+        xs[index] = xs[last];
+        ys[index] = ys[last];
+        zs[index] = zs[last];
+        rotations[index] = rotations[last];
+        rotationSins[index] = rotationSins[last];
+        rotationCoses[index] = rotationCoses[last];
+        flags[index] = flags[last];
+        coinCounts[index] = coinCounts[last];
+        finishRanks[index] = finishRanks[last];
+        inventories[index] = inventories[last];
+        speedBoostEnds[index] = speedBoostEnds[last];
+        slotOfDense[index] = slotOfDense[last];
+        slots[slotOfDense[index]].dense = static_cast<uint32_t>(index);
+    }
+
+    ids.pop_back();
+    xs.pop_back();
+    ys.pop_back();
+    zs.pop_back();
+    rotations.pop_back();
+    rotationSins.pop_back();
+    rotationCoses.pop_back();
+    flags.pop_back();
+    coinCounts.pop_back();
+    finishRanks.pop_back();
+    inventories.pop_back();
+    speedBoostEnds.pop_back();
+    slotOfDense.pop_back();
+
+    slots[slot].used = false;
+    ++slots[slot].generation;   // 旧句柄失效
+    if (slots[slot].generation == 0) {
+        slots[slot].generation = 1;
+    }
+    freeSlots.push_back(slot);
+    slotById.erase(it);
+    return true;
+}
+
+void PlayerStore::clear() {
+    ids.clear();
+    xs.clear();
+    ys.clear();
+    zs.clear();
+    rotations.clear();
+    rotationSins.clear();
+    rotationCoses.clear();
+    flags.clear();
+    coinCounts.clear();
+    finishRanks.clear();
+    inventories.clear();
+    speedBoostEnds.clear();
+    slotOfDense.clear();
+
+    // 保留槽位代数，防止旧句柄在清空后重新生效
+    freeSlots.clear();
+    for (uint32_t slot = 0; slot < slots.size(); ++slot) {
+        if (slots[slot].used) {
+            slots[slot].used = false;
+            ++slots[slot].generation;
+            if (slots[slot].generation == 0) {
+                slots[slot].generation = 1;
+            }
+        }
+        freeSlots.push_back(slot);
+    }
+    slotById.clear();
+}
+
+size_t PlayerStore::indexOf(int playerId) const {
+    auto it = slotById.find(playerId);
+    return it != slotById.end() ? slots[it->second].dense : NPOS;
+}
+
+size_t PlayerStore::indexOf(Handle handle) const {
+    uint32_t slot = static_cast<uint32_t>(handle & 0xFFFFFFFFu);
+    uint32_t generation = static_cast<uint32_t>(handle >> 32);
+    if (handle == INVALID_HANDLE || slot >= slots.size() ||
+        !slots[slot].used || slots[slot].generation != generation) {
+        return NPOS;
+    }
+    return slots[slot].dense;
+}
+
+PlayerStore::Handle PlayerStore::handleOf(int playerId) const {
+    auto it = slotById.find(playerId);
+    return it != slotById.end() ? makeHandle(it->second, slots[it->second].generation) : INVALID_HANDLE;
+}
+
+void PlayerStore::setRotation(size_t i, float rotation) {
+    rotations[i] = rotation;
+    rotationSins[i] = std::sin(rotation);
+    rotationCoses[i] = std::cos(rotation);
+}
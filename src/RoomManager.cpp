@@ -0,0 +1,805 @@
+#include "RoomManager.h"
+#include "MazeGenerator.h"
+#include "NetworkManager.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <future>
+#include <random>
+#include <nlohmann/json.hpp>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// 当前进程允许使用的CPU
+std::vector<int> AvailableCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        int count = std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < count; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+bool PinCurrentThread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+uint64_t RandomSeed() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device();
+}
+
+} // namespace
+
+// ==================== Room ====================
+
+Room::Room(int roomId, uint64_t mazeSeed, const RoomConfig& config,
+           PlayerManager& playerManager, DataManager& dataManager, NetworkManager& networkManager)
+    : roomId_(roomId), mazeSeed_(mazeSeed), capacity_(std::max(1, config.roomCapacity)),
+      networkManager_(networkManager), interestManager_(gameLogic_, config.interest), tickScheduler_(config.tickRate),
+      handlers_(gameLogic_, playerManager, dataManager, networkManager, snapshotReplicator_, tickScheduler_),
+      idleSince_(TickScheduler::Clock::now()) {
+    handlers_.SetRoomId(roomId);
+    spareBuffers_.reserve(MAX_SPARE_BUFFERS);
+    recycled_.reserve(MAX_SPARE_BUFFERS);
+}
+
+Room::~Room() {}
+
+bool Room::Initialize(const MazeGrid& maze) {
+    if (!gameLogic_.Initialize(maze)) {
+        return false;
+    }
+    auto chunks = std::make_shared<MazeChunkSet>();
+    if (encodeMazeChunks(gameLogic_.GetMaze(), *chunks)) {
+        mazeChunks_ = chunks;
+        handlers_.SetMazeChunks(mazeChunks_);
+    }
+    handlers_.RegisterRoutes(messageRouter_);
+    return true;
+}
+
+void Room::PushMessage(int clientId, std::string&& payload, bool binary) {
+    std::lock_guard<std::mutex> lock(inboxMutex_);
+    inbox_.push_back({clientId, binary, std::move(payload)});
+    queuedMessages_.fetch_add(1, std::memory_order_relaxed);
+    if (!spareBuffers_.empty()) {
+        payload = std::move(spareBuffers_.back());
+        spareBuffers_.pop_back();
+    }
+}
+
+void Room::PushTask(Task task) {
+    std::lock_guard<std::mutex> lock(inboxMutex_);
+    tasks_.push_back(std::move(task));
+}
+
+bool Room::Run(TickScheduler::Clock::time_point& nextTick) {
+    runningTasks_.clear();   // 上次运行中任务抛出异常时剩下的任务不再执行
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        processing_.swap(inbox_);
+        runningTasks_.swap(tasks_);
+        for (std::string& buffer : recycled_) {
+            if (spareBuffers_.size() >= MAX_SPARE_BUFFERS) {
+                break;
+            }
+            spareBuffers_.push_back(std::move(buffer));
+        }
+    }
+    recycled_.clear();
+
+    // 先处理消息，本帧即可结算新到的输入
+    if (!processing_.empty()) {
+        queuedMessages_.fetch_sub(processing_.size(), std::memory_order_relaxed);
+        for (const Message& message : processing_) {
+            try {
+                if (message.binary) {
+                    messageRouter_.dispatchBinary(message.clientId, message.payload);
+                } else {
+                    messageRouter_.dispatchText(message.clientId, message.payload);
+                }
+            } catch (const std::exception& e) {
+                Logger::getInstance().error(LogCategory::NETWORK,
+                    "房间 " + std::to_string(roomId_) + " 消息处理异常: " + std::string(e.what()));
+            }
+        }
+        // 载荷缓冲区交还给I/O线程复用
+        for (Message& message : processing_) {
+            if (recycled_.size() < MAX_SPARE_BUFFERS && message.payload.capacity() <= MAX_SPARE_CAPACITY) {
+                message.payload.clear();
+                recycled_.push_back(std::move(message.payload));
+            }
+        }
+        processing_.clear();
+    }
+
+    for (Task& task : runningTasks_) {
+        task(*this);
+    }
+    runningTasks_.clear();
+
+    ticked_ = false;
+    nextTick = tickScheduler_.runDue([this](uint32_t tick, double) { Tick(tick); });
+    return ticked_;
+}
+
+void Room::DrainTasks() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex_);
+        tasks.swap(tasks_);
+        queuedMessages_.fetch_sub(inbox_.size(), std::memory_order_relaxed);
+        inbox_.clear();
+    }
+    for (Task& task : tasks) {
+        task(*this);
+    }
+}
+
+void Room::Tick(uint32_t tick) {
+    ticked_ = true;
+    gameLogic_.Update();
+    std::shared_ptr<WorldSnapshot> snapshot = snapshotReplicator_.AcquireSnapshot();
+    gameLogic_.CaptureSnapshot(tick, *snapshot);
+    snapshotReplicator_.PushSnapshot(std::move(snapshot));
+    snapshotReplicator_.Broadcast(networkManager_, &interestManager_);
+    handlers_.SendCompassUpdates();
+}
+
+// ==================== RoomManager ====================
+
+RoomManager::RoomManager(const RoomConfig& config, PlayerManager& playerManager, DataManager& dataManager,
+                         NetworkManager& networkManager)
+    : config_(config), playerManager_(playerManager), dataManager_(dataManager), networkManager_(networkManager) {
+    config_.roomCapacity = std::max(1, config_.roomCapacity);
+    config_.maxRooms = std::max(1, config_.maxRooms);
+}
+
+RoomManager::~RoomManager() {
+    Stop();
+}
+
+bool RoomManager::Initialize(const MazeGrid& defaultMaze, uint64_t defaultSeed) {
+    RoomPtr room = CreateRoom(DEFAULT_ROOM_ID, &defaultMaze, defaultSeed);
+    if (!room) {
+        return false;
+    }
+    if (roomListener_) {
+        roomListener_(*room, true);
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    rooms_[DEFAULT_ROOM_ID] = room;
+    return true;
+}
+
+RoomManager::RoomPtr RoomManager::CreateRoom(int roomId, const MazeGrid* maze, uint64_t seed) {
+    RoomPtr room = std::make_shared<Room>(roomId, seed, config_, playerManager_, dataManager_, networkManager_);
+
+    bool initialized;
+    if (maze) {
+        initialized = room->Initialize(*maze);
+    } else {
+        // 单线程生成：调用方是I/O线程，不占用其他核心
+        MazeGenerator generator(config_.mazeWidth, config_.mazeHeight, config_.mazeLayers);
+        generator.generateMaze(seed, 1);
+        initialized = room->Initialize(generator.getGrid());
+    }
+    if (!initialized) {
+        Logger::getInstance().error(LogCategory::GAME, "房间 " + std::to_string(roomId) + " 初始化失败");
+        return nullptr;
+    }
+
+    Room* roomPtr = room.get();
+    room->handlers_.SetSessionListener([this, roomPtr](int clientId, const std::string& playerId, bool joined) {
+        OnSessionChanged(*roomPtr, clientId, playerId, joined);
+    });
+    return room;
+}
+
+bool RoomManager::Start() {
+    if (running_) {
+        return true;
+    }
+
+    std::vector<int> cpus = AvailableCpus();
+    int threadCount = config_.simulationThreads > 0 ? config_.simulationThreads : static_cast<int>(cpus.size());
+
+    workers_.clear();
+    for (int i = 0; i < threadCount; ++i) {
+        std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+        worker->index = i;
+#ifdef __linux__
+        worker->cpu = config_.pinThreads ? cpus[i % cpus.size()] : -1;
+#endif
+        workers_.push_back(std::move(worker));
+    }
+
+    running_ = true;
+    for (auto& worker : workers_) {
+        Worker* workerPtr = worker.get();
+        worker->thread = std::thread([this, workerPtr] { WorkerLoop(*workerPtr); });
+    }
+
+    // 已创建的房间（默认房间）开始推进
+    std::vector<RoomPtr> rooms;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& pair : rooms_) {
+            rooms.push_back(pair.second);
+        }
+    }
+    for (const RoomPtr& room : rooms) {
+        Schedule(room);
+    }
+
+    Logger::getInstance().info(LogCategory::GAME, "模拟线程池已启动: " + std::to_string(threadCount) + " 个线程" +
+        (workers_[0]->cpu >= 0 ? "（已绑定CPU核心）" : "") +
+        "，每房间 " + std::to_string(config_.roomCapacity) + " 人，最多 " + std::to_string(config_.maxRooms) + " 个房间");
+    return true;
+}
+
+void RoomManager::Stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        ++wakeEpoch_;
+    }
+    idleCondition_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    // 释放队列中的房间引用，仍在排队的任务在当前线程上执行
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->readyMutex);
+        worker->ready.clear();
+        worker->timers = {};
+    }
+    std::vector<RoomPtr> rooms;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& pair : rooms_) {
+            rooms.push_back(pair.second);
+        }
+    }
+    for (const RoomPtr& room : rooms) {
+        room->DrainTasks();
+    }
+}
+
+// ==================== 消息路由 ====================
+
+void RoomManager::RouteMessage(int clientId, std::string&& payload, bool binary) {
+    // 断开：解除分配，房间在自己的线程上注销玩家
+    if (!binary && payload == "DISCONNECT") {
+        RoomPtr room;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto it = clientRooms_.find(clientId);
+            if (it == clientRooms_.end()) {
+                return;
+            }
+            room = it->second;
+            room->members_.fetch_sub(1, std::memory_order_relaxed);
+            clientRooms_.erase(it);
+        }
+        room->PushMessage(clientId, std::move(payload), false);
+        Schedule(room);
+        return;
+    }
+
+    RoomPtr room;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = clientRooms_.find(clientId);
+        if (it != clientRooms_.end()) {
+            room = it->second;
+        }
+    }
+
+    // 未分配房间的连接只接受auth，其余消息在认证前本来也会被忽略
+    if (!room) {
+        if (binary) {
+            return;
+        }
+        room = AssignRoom(clientId, payload);
+        if (!room) {
+            return;
+        }
+    }
+
+    room->PushMessage(clientId, std::move(payload), binary);
+    Schedule(room);
+}
+
+RoomManager::RoomPtr RoomManager::AssignRoom(int clientId, const std::string& payload) {
+    nlohmann::json message = nlohmann::json::parse(payload, nullptr, false);
+    if (message.is_discarded() || !message.is_object() || message.value("type", "") != "auth") {
+        return nullptr;
+    }
+    int requestedRoom = 0;
+    if (message.contains("roomId") && message["roomId"].is_number_integer()) {
+        requestedRoom = message["roomId"].get<int>();
+    }
+
+    // 调用方持有写锁
+    auto assign = [this, clientId](const RoomPtr& room) {
+        clientRooms_[clientId] = room;
+        room->members_.fetch_add(1, std::memory_order_relaxed);
+    };
+    auto isOpen = [](const RoomPtr& room) {
+        return !room->closed_ && room->GetMemberCount() < room->GetCapacity();
+    };
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        // 指定的房间不存在或已满时按常规匹配
+        auto requested = rooms_.find(requestedRoom);
+        if (requested != rooms_.end() && isOpen(requested->second)) {
+            assign(requested->second);
+            return requested->second;
+        }
+        for (const auto& pair : rooms_) {
+            if (isOpen(pair.second)) {
+                assign(pair.second);
+                return pair.second;
+            }
+        }
+    }
+
+    // 所有房间都满了：在锁外生成迷宫，创建新房间
+    RoomPtr room;
+    if (GetRoomCount() < config_.maxRooms) {
+        int roomId = nextRoomId_.fetch_add(1);
+        uint64_t seed = config_.hasMazeSeed ? config_.mazeSeed + static_cast<uint64_t>(roomId) : RandomSeed();
+        room = CreateRoom(roomId, nullptr, seed);
+    }
+    if (room) {
+        // 先通知再加入房间表，其他连接分配进来时房间资源（迷宫分块的URL）已经可用
+        if (roomListener_) {
+            roomListener_(*room, true);
+        }
+        bool added = false;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            if (static_cast<int>(rooms_.size()) < config_.maxRooms) {
+                rooms_[room->GetRoomId()] = room;
+                assign(room);
+                added = true;
+            }
+        }
+        if (!added) {
+            if (roomListener_) {
+                roomListener_(*room, false);
+            }
+            room.reset();
+        }
+    }
+
+    if (!room) {
+        nlohmann::json response;
+        response["type"] = "auth_failed";
+        response["message"] = "服务器已满，请稍后重试";
+        response["status"] = "failed";
+        networkManager_.sendToClient(clientId, response.dump());
+        Logger::getInstance().warning(LogCategory::GAME, "所有房间已满，拒绝连接: " + std::to_string(clientId));
+        return nullptr;
+    }
+
+    Logger::getInstance().info(LogCategory::GAME, "创建房间 " + std::to_string(room->GetRoomId()) +
+                               "，迷宫种子: " + std::to_string(room->GetMazeSeed()));
+    return room;
+}
+
+bool RoomManager::Post(int roomId, Room::Task task) {
+    RoomPtr room;
+    {
+        // 持有读锁入队，关闭房间（写锁）之前入队的任务一定会被执行
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = rooms_.find(roomId);
+        if (it == rooms_.end()) {
+            return false;
+        }
+        room = it->second;
+        room->PushTask(std::move(task));
+    }
+    Schedule(room);
+    return true;
+}
+
+bool RoomManager::Execute(int roomId, const Room::Task& task) {
+    if (!running_) {
+        // 线程池未运行，没有其他线程访问房间
+        RoomPtr room;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            auto it = rooms_.find(roomId);
+            if (it == rooms_.end()) {
+                return false;
+            }
+            room = it->second;
+        }
+        task(*room);
+        return true;
+    }
+
+    std::promise<void> done;
+    std::future<void> finished = done.get_future();
+    bool posted = Post(roomId, [&task, &done](Room& room) {
+        try {
+            task(room);
+            done.set_value();
+        } catch (...) {
+            done.set_exception(std::current_exception());
+        }
+    });
+    if (!posted) {
+        return false;
+    }
+    finished.get();
+    return true;
+}
+
+int RoomManager::ExecuteMany(const std::vector<std::pair<int, Room::Task>>& tasks) {
+    if (!running_) {
+        int executed = 0;
+        for (const auto& pair : tasks) {
+            if (Execute(pair.first, pair.second)) {
+                executed++;
+            }
+        }
+        return executed;
+    }
+
+    // 先全部投递再等待，房间分布在不同线程上时并行执行
+    std::vector<std::promise<void>> done(tasks.size());
+    std::vector<std::future<void>> finished;
+    finished.reserve(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        const Room::Task& task = tasks[i].second;
+        std::promise<void>& promise = done[i];
+        bool posted = Post(tasks[i].first, [&task, &promise](Room& room) {
+            try {
+                task(room);
+                promise.set_value();
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        });
+        if (posted) {
+            finished.push_back(promise.get_future());
+        }
+    }
+
+    // 等待全部完成后再抛出异常（任务引用了调用方的局部变量）
+    std::exception_ptr error;
+    for (std::future<void>& future : finished) {
+        try {
+            future.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return static_cast<int>(finished.size());
+}
+
+int RoomManager::ExecuteAll(const Room::Task& task) {
+    std::vector<std::pair<int, Room::Task>> tasks;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& pair : rooms_) {
+            tasks.emplace_back(pair.first, task);
+        }
+    }
+    return ExecuteMany(tasks);
+}
+
+bool RoomManager::FindPlayer(const std::string& playerId, int& roomId, int& clientId) const {
+    std::lock_guard<std::mutex> lock(playersMutex_);
+    auto it = playerLocations_.find(playerId);
+    if (it == playerLocations_.end()) {
+        return false;
+    }
+    roomId = it->second.roomId;
+    clientId = it->second.clientId;
+    return true;
+}
+
+std::vector<RoomPlayer> RoomManager::GetPlayers() const {
+    std::vector<RoomPlayer> result;
+    std::lock_guard<std::mutex> lock(playersMutex_);
+    result.reserve(playerLocations_.size());
+    for (const auto& pair : playerLocations_) {
+        result.push_back({pair.first, pair.second.roomId, pair.second.clientId});
+    }
+    return result;
+}
+
+void RoomManager::OnSessionChanged(Room& room, int clientId, const std::string& playerId, bool joined) {
+    room.sessionCount_.store(static_cast<int>(room.handlers_.GetSessionCount()), std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(playersMutex_);
+    if (joined) {
+        playerLocations_[playerId] = {room.GetRoomId(), clientId};
+        return;
+    }
+    // 同一玩家可能已在其他连接上重新登录
+    auto it = playerLocations_.find(playerId);
+    if (it != playerLocations_.end() && it->second.roomId == room.GetRoomId() && it->second.clientId == clientId) {
+        playerLocations_.erase(it);
+    }
+}
+
+// ==================== 调度 ====================
+
+void RoomManager::Schedule(const RoomPtr& room) {
+    int state = room->runState_.load();
+    while (true) {
+        if (state == Room::IDLE) {
+            if (room->runState_.compare_exchange_weak(state, Room::QUEUED)) {
+                Enqueue(room, room->homeWorker_.load(std::memory_order_relaxed));
+                return;
+            }
+        } else if (state == Room::RUNNING) {
+            if (room->runState_.compare_exchange_weak(state, Room::RUNNING_DIRTY)) {
+                return;
+            }
+        } else {
+            return;  // 已在队列中，或运行结束后会再次入队
+        }
+    }
+}
+
+void RoomManager::Enqueue(const RoomPtr& room, int workerIndex) {
+    if (workers_.empty()) {
+        return;
+    }
+    Worker& worker = *workers_[static_cast<size_t>(workerIndex) % workers_.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.readyMutex);
+        worker.ready.push_back(room);
+    }
+
+    // 有空闲线程时唤醒一个（不一定是目标线程，被唤醒的线程会窃取）
+    if (idleWorkers_.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex_);
+            ++wakeEpoch_;
+        }
+        idleCondition_.notify_one();
+    }
+}
+
+void RoomManager::WorkerLoop(Worker& worker) {
+    if (worker.cpu >= 0 && !PinCurrentThread(worker.cpu)) {
+        Logger::getInstance().warning(LogCategory::GAME,
+            "模拟线程 " + std::to_string(worker.index) + " 无法绑定到CPU " + std::to_string(worker.cpu));
+    }
+
+    while (running_) {
+        // 到期的房间放入就绪队列
+        Clock::time_point now = Clock::now();
+        while (!worker.timers.empty() && worker.timers.top().deadline <= now) {
+            RoomPtr room = worker.timers.top().room;
+            worker.timers.pop();
+            if (!room->closed_) {
+                Schedule(room);
+            }
+        }
+
+        RoomPtr room = PopReady(worker);
+        if (!room) {
+            room = Steal(worker);
+        }
+        if (room) {
+            RunRoom(worker, room);
+            continue;
+        }
+
+        // 没有可运行的房间：睡到最近的一帧，期间有新消息或新房间时被唤醒
+        std::unique_lock<std::mutex> lock(idleMutex_);
+        uint64_t epoch = wakeEpoch_;
+        idleWorkers_.fetch_add(1);
+        if (running_ && !HasReadyWork()) {
+            auto woken = [this, epoch] { return wakeEpoch_ != epoch || !running_; };
+            if (worker.timers.empty()) {
+                idleCondition_.wait(lock, woken);
+            } else {
+                idleCondition_.wait_until(lock, worker.timers.top().deadline, woken);
+            }
+        }
+        idleWorkers_.fetch_sub(1);
+    }
+}
+
+RoomManager::RoomPtr RoomManager::PopReady(Worker& worker) {
+    std::lock_guard<std::mutex> lock(worker.readyMutex);
+    if (worker.ready.empty()) {
+        return nullptr;
+    }
+    RoomPtr room = std::move(worker.ready.front());
+    worker.ready.pop_front();
+    return room;
+}
+
+RoomManager::RoomPtr RoomManager::Steal(Worker& thief) {
+    size_t count = workers_.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Worker& victim = *workers_[(thief.index + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.readyMutex);
+        if (!victim.ready.empty()) {
+            // 从尾部窃取：所属线程从头部取，两端互不干扰，也优先保留最早入队的房间给所属线程
+            RoomPtr room = std::move(victim.ready.back());
+            victim.ready.pop_back();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return room;
+        }
+    }
+    return nullptr;
+}
+
+bool RoomManager::HasReadyWork() {
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->readyMutex);
+        if (!worker->ready.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RoomManager::RunRoom(Worker& worker, const RoomPtr& room) {
+    // 只有从队列取出房间的线程会把 QUEUED 改为 RUNNING
+    room->runState_.store(Room::RUNNING);
+    room->homeWorker_.store(worker.index, std::memory_order_relaxed);
+    if (room->closed_) {
+        room->runState_.store(Room::IDLE);
+        room->DrainTasks();
+        return;
+    }
+
+    runs_.fetch_add(1, std::memory_order_relaxed);
+    Clock::time_point nextTick;
+    bool ticked = room->Run(nextTick);
+
+    if (ticked && TryCloseRoom(room, Clock::now())) {
+        room->runState_.store(Room::IDLE);
+        return;
+    }
+
+    // 下一帧时间变化（执行了一帧或帧率改变）时登记新的定时器；
+    // 只处理消息的运行不改变时间表，已登记的定时器仍然有效
+    if (nextTick != room->armedDeadline_) {
+        room->armedDeadline_ = nextTick;
+        worker.timers.push({nextTick, room});
+    }
+
+    // 运行期间有新消息或任务，重新入队
+    int state = Room::RUNNING;
+    if (!room->runState_.compare_exchange_strong(state, Room::IDLE)) {
+        room->runState_.store(Room::QUEUED);
+        Enqueue(room, worker.index);
+    }
+}
+
+bool RoomManager::TryCloseRoom(const RoomPtr& room, Clock::time_point now) {
+    if (room->GetRoomId() == DEFAULT_ROOM_ID) {
+        return false;
+    }
+    if (room->GetMemberCount() > 0 || room->GetSessionCount() > 0) {
+        room->wasEmpty_ = false;
+        return false;
+    }
+    if (!room->wasEmpty_) {
+        room->wasEmpty_ = true;
+        room->idleSince_ = now;
+        return false;
+    }
+    if (now - room->idleSince_ < config_.idleTimeout) {
+        return false;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        // 加锁前可能刚有连接分配进来
+        if (room->GetMemberCount() > 0) {
+            return false;
+        }
+        room->closed_ = true;
+        rooms_.erase(room->GetRoomId());
+    }
+    room->DrainTasks();
+    if (roomListener_) {
+        roomListener_(*room, false);
+    }
+    Logger::getInstance().info(LogCategory::GAME, "关闭空闲房间 " + std::to_string(room->GetRoomId()));
+    return true;
+}
+
+// ==================== 统计 ====================
+
+std::vector<RoomInfo> RoomManager::GetRoomInfo() const {
+    std::vector<RoomInfo> result;
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    result.reserve(rooms_.size());
+    for (const auto& pair : rooms_) {
+        const Room& room = *pair.second;
+        RoomInfo info;
+        info.roomId = room.GetRoomId();
+        info.members = room.GetMemberCount();
+        info.sessions = room.GetSessionCount();
+        info.mazeSeed = room.GetMazeSeed();
+        info.tickRate = room.GetTickRate();
+        info.tick = room.GetTickMetrics();
+        result.push_back(info);
+    }
+    return result;
+}
+
+RoomManagerStats RoomManager::GetStats() const {
+    RoomManagerStats stats;
+    std::vector<RoomInfo> rooms = GetRoomInfo();
+    stats.rooms = static_cast<int>(rooms.size());
+    for (const RoomInfo& room : rooms) {
+        stats.members += room.members;
+        stats.sessions += room.sessions;
+        stats.avgTickMs += room.tick.avgTickMs;
+        stats.maxTickMs = std::max(stats.maxTickMs, room.tick.maxTickMs);
+        stats.overruns += room.tick.overruns;
+        stats.skippedTicks += room.tick.skippedTicks;
+    }
+    if (!rooms.empty()) {
+        stats.avgTickMs /= rooms.size();
+    }
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        for (const auto& pair : rooms_) {
+            stats.queuedMessages += pair.second->GetQueuedMessageCount();
+        }
+    }
+    stats.runs = runs_.load(std::memory_order_relaxed);
+    stats.steals = steals_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+int RoomManager::GetRoomCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return static_cast<int>(rooms_.size());
+}
@@ -0,0 +1,489 @@
+#include "SnapshotReplicator.h"
+#include "NetworkManager.h"
+#include "Metrics.h"
+
+#include <nlohmann/json.hpp>
+#include <algorithm>
+
+namespace {
+
+// 坐标和朝向量化后比较和发送，保证客户端持有的值与服务器基线完全一致
+PlayerDelta DiffPlayer(const PlayerSnapshot& current, const PlayerSnapshot* base) {
+    PlayerDelta delta;
+    delta.playerId = current.playerId;
+    delta.x = quantizeCoordinate(current.x);
+    delta.y = quantizeCoordinate(current.y);
+    delta.z = quantizeCoordinate(current.z);
+    delta.rotation = quantizeCoordinate(current.rotation);
+    delta.isAlive = current.isAlive;
+    delta.coins = current.coins;
+
+    if (!base) {
+        delta.fields = DELTA_ALL;
+        return delta;
+    }
+    if (quantizeCoordinate(base->x) != delta.x) delta.fields |= DELTA_X;
+    if (quantizeCoordinate(base->y) != delta.y) delta.fields |= DELTA_Y;
+    if (quantizeCoordinate(base->z) != delta.z) delta.fields |= DELTA_Z;
+    if (quantizeCoordinate(base->rotation) != delta.rotation) delta.fields |= DELTA_ROT;
+    if (base->isAlive != current.isAlive) delta.fields |= DELTA_ALIVE;
+    if (base->coins != current.coins) delta.fields |= DELTA_COINS;
+    return delta;
+}
+
+// 玩家：两边都按playerId升序，归并比较
+void DiffPlayers(const std::vector<PlayerSnapshot>& basePlayers, const std::vector<PlayerSnapshot>& players,
+                 SnapshotDelta& delta) {
+    size_t i = 0, j = 0;
+    while (i < players.size() || j < basePlayers.size()) {
+        if (j >= basePlayers.size() || (i < players.size() && players[i].playerId < basePlayers[j].playerId)) {
+            delta.players.push_back(DiffPlayer(players[i], nullptr));
+            ++i;
+        } else if (i >= players.size() || basePlayers[j].playerId < players[i].playerId) {
+            delta.removedPlayers.push_back(basePlayers[j].playerId);
+            ++j;
+        } else {
+            PlayerDelta player = DiffPlayer(players[i], &basePlayers[j]);
+            if (player.fields != 0) {
+                delta.players.push_back(player);
+            }
+            ++i;
+            ++j;
+        }
+    }
+}
+
+// 金币和墙壁（所有客户端都完整同步）
+void DiffWorld(const WorldSnapshot* baseline, const WorldSnapshot& current, SnapshotDelta& delta) {
+    // 金币：只记录状态发生变化的金币ID
+    for (size_t coinId = 0; coinId < current.coinCollected.size(); ++coinId) {
+        bool before = baseline && coinId < baseline->coinCollected.size() && baseline->coinCollected[coinId];
+        bool now = current.coinCollected[coinId];
+        if (now && !before) {
+            delta.coinsCollected.push_back(static_cast<uint16_t>(coinId));
+        } else if (!now && before) {
+            delta.coinsRestored.push_back(static_cast<uint16_t>(coinId));
+        }
+    }
+
+    // 墙壁：两边都已排序，求差集
+    static const std::vector<std::tuple<int, int, int>> noWalls;
+    const std::vector<std::tuple<int, int, int>>& baseWalls = baseline ? baseline->brokenWalls : noWalls;
+
+    size_t i = 0, j = 0;
+    while (i < current.brokenWalls.size() || j < baseWalls.size()) {
+        if (j >= baseWalls.size() || (i < current.brokenWalls.size() && current.brokenWalls[i] < baseWalls[j])) {
+            delta.wallsBroken.push_back(current.brokenWalls[i++]);
+        } else if (i >= current.brokenWalls.size() || baseWalls[j] < current.brokenWalls[i]) {
+            delta.wallsRepaired.push_back(baseWalls[j++]);
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+}
+
+const PlayerSnapshot* FindPlayer(const std::vector<PlayerSnapshot>& players, int playerId) {
+    auto it = std::lower_bound(players.begin(), players.end(), playerId,
+        [](const PlayerSnapshot& player, int value) { return player.playerId < value; });
+    return it != players.end() && it->playerId == playerId ? &*it : nullptr;
+}
+
+MetricCounter& PlayersFilteredMetric() {
+    static MetricCounter& counter = MetricsRegistry::getInstance().counter(
+        "netlab_snapshot_players_filtered_total", "Player entries left out of snapshots by interest management");
+    return counter;
+}
+
+nlohmann::json EncodeWall(const std::tuple<int, int, int>& wall) {
+    return nlohmann::json::array({std::get<0>(wall), std::get<1>(wall), std::get<2>(wall)});
+}
+
+} // namespace
+
+SnapshotReplicator::SnapshotReplicator(size_t historySize)
+    : historySize_(std::max<size_t>(historySize, 2)) {}
+
+SnapshotReplicator::~SnapshotReplicator() = default;
+
+void SnapshotReplicator::PushSnapshot(WorldSnapshot snapshot) {
+    PushSnapshot(std::make_shared<WorldSnapshot>(std::move(snapshot)));
+}
+
+void SnapshotReplicator::PushSnapshot(std::shared_ptr<WorldSnapshot> snapshot) {
+    history_.push_back(std::move(snapshot));
+    // 客户端持有自己基线的引用，淘汰历史不会影响已确认的基线；没有其他引用的快照留作下一帧复用
+    while (history_.size() > historySize_) {
+        if (history_.front().use_count() == 1 && spareSnapshots_.size() < MAX_SPARE_SNAPSHOTS) {
+            // 历史中的快照都是以非const创建的
+            spareSnapshots_.push_back(std::const_pointer_cast<WorldSnapshot>(history_.front()));
+        }
+        history_.erase(history_.begin());
+    }
+}
+
+std::shared_ptr<WorldSnapshot> SnapshotReplicator::AcquireSnapshot() {
+    if (spareSnapshots_.empty()) {
+        return std::make_shared<WorldSnapshot>();
+    }
+    std::shared_ptr<WorldSnapshot> snapshot = std::move(spareSnapshots_.back());
+    spareSnapshots_.pop_back();
+    return snapshot;
+}
+
+void SnapshotReplicator::CollectFreeViews() {
+    freeViews_.clear();
+    for (size_t i = 0; i < viewPool_.size(); ++i) {
+        if (viewPool_[i].use_count() == 1) {
+            viewPool_[i]->world.reset();   // 不再阻止旧快照被复用
+            freeViews_.push_back(i);
+        }
+    }
+
+    // 客户端离开后空闲视图过多时收缩，每个客户端保留一个
+    if (freeViews_.size() > 2 * clients_.size() + 64) {
+        size_t keep = clients_.size();
+        size_t kept = 0;
+        viewPool_.erase(std::remove_if(viewPool_.begin(), viewPool_.end(),
+            [&](const std::shared_ptr<ClientView>& view) { return view.use_count() == 1 && kept++ >= keep; }),
+            viewPool_.end());
+        freeViews_.clear();
+        for (size_t i = 0; i < viewPool_.size(); ++i) {
+            if (viewPool_[i].use_count() == 1) {
+                freeViews_.push_back(i);
+            }
+        }
+    }
+}
+
+std::shared_ptr<SnapshotReplicator::ClientView> SnapshotReplicator::AcquireView() {
+    if (freeViews_.empty()) {
+        viewPool_.push_back(std::make_shared<ClientView>());
+        return viewPool_.back();
+    }
+    std::shared_ptr<ClientView> view = viewPool_[freeViews_.back()];
+    freeViews_.pop_back();
+    view->players.clear();
+    return view;
+}
+
+SnapshotReplicator::EncodedDelta& SnapshotReplicator::AcquireDelta() {
+    if (deltasUsed_ == deltaPool_.size()) {
+        deltaPool_.emplace_back();
+    }
+    EncodedDelta& entry = deltaPool_[deltasUsed_++];
+    entry.changed = false;
+    entry.delta.clear();
+    return entry;
+}
+
+void SnapshotReplicator::AddClient(int clientId, WireFormat format) {
+    ClientState client;
+    client.format = format;
+    clients_[clientId] = client;
+}
+
+void SnapshotReplicator::RemoveClient(int clientId) {
+    clients_.erase(clientId);
+}
+
+void SnapshotReplicator::Acknowledge(int clientId, uint32_t tick) {
+    auto clientIt = clients_.find(clientId);
+    if (clientIt == clients_.end()) {
+        return;
+    }
+
+    ClientState& client = clientIt->second;
+
+    // 兴趣管理模式：基线是该客户端收到的视图
+    if (!client.sentViews.empty()) {
+        if (client.baselineView && tick <= client.baselineView->tick) {
+            return;
+        }
+        auto it = std::lower_bound(client.sentViews.begin(), client.sentViews.end(), tick,
+            [](const ViewPtr& view, uint32_t value) { return view->tick < value; });
+        if (it != client.sentViews.end() && (*it)->tick == tick) {
+            client.baselineView = *it;
+            // 更早的视图不会再成为基线
+            client.sentViews.erase(client.sentViews.begin(), it);
+        }
+        return;
+    }
+
+    if (client.baseline && tick <= client.baseline->tick) {
+        return;
+    }
+
+    auto it = std::lower_bound(history_.begin(), history_.end(), tick,
+        [](const SnapshotPtr& snapshot, uint32_t value) { return snapshot->tick < value; });
+    if (it != history_.end() && (*it)->tick == tick) {
+        client.baseline = *it;
+    }
+}
+
+int SnapshotReplicator::Broadcast(NetworkManager& networkManager, const InterestManager* interest) {
+    if (history_.empty() || clients_.empty()) {
+        return 0;
+    }
+    deltasUsed_ = 0;
+    int sent = interest && interest->IsEnabled() ? BroadcastFiltered(networkManager, *interest)
+                                                 : BroadcastShared(networkManager, *history_.back());
+
+    // 帧已交给发送队列，池中只保留增量的容量
+    for (size_t i = 0; i < deltasUsed_; ++i) {
+        deltaPool_[i].frames[0].reset();
+        deltaPool_[i].frames[1].reset();
+    }
+    return sent;
+}
+
+int SnapshotReplicator::BroadcastShared(NetworkManager& networkManager, const WorldSnapshot& current) {
+    // 按基线缓存增量，按(基线, 格式)缓存编码结果；不同的基线只有几个（客户端确认的tick相近），线性查找即可
+    sharedDeltas_.clear();
+    int sent = 0;
+
+    for (const auto& pair : clients_) {
+        const WorldSnapshot* baseline = pair.second.baseline.get();
+        if (baseline == &current) {
+            continue;
+        }
+
+        auto it = std::find_if(sharedDeltas_.begin(), sharedDeltas_.end(),
+            [baseline](const std::pair<const WorldSnapshot*, EncodedDelta*>& item) { return item.first == baseline; });
+        if (it == sharedDeltas_.end()) {
+            EncodedDelta& created = AcquireDelta();
+            created.changed = ComputeDelta(baseline, current, created.delta);
+            it = sharedDeltas_.insert(sharedDeltas_.end(), std::make_pair(baseline, &created));
+        }
+        EncodedDelta& entry = *it->second;
+        if (!entry.changed) {
+            continue;
+        }
+
+        // 快照可以在拥塞时丢弃：客户端会继续确认旧基线，下一帧的增量仍然有效
+        bool binary = pair.second.format == WireFormat::BINARY;
+        SharedFrame& frame = entry.frames[binary ? 1 : 0];
+        if (!frame) {
+            if (binary) {
+                encodeSnapshotDelta(entry.delta, encodeBuffer_);
+                frame = PreparedFrame::binary(reinterpret_cast<const uint8_t*>(encodeBuffer_.data()),
+                                              encodeBuffer_.size(), true);
+            } else {
+                frame = PreparedFrame::text(EncodeJson(entry.delta), true);
+            }
+        }
+
+        if (networkManager.sendPrepared(pair.first, frame)) {
+            bytesSent_ += frame->size();
+            sent++;
+        }
+    }
+
+    return sent;
+}
+
+int SnapshotReplicator::BroadcastFiltered(NetworkManager& networkManager, const InterestManager& interest) {
+    const SnapshotPtr& current = history_.back();
+
+    // 第一遍：为每个客户端过滤出本帧的视图（视图对象来自池，玩家数组保留容量）
+    CollectFreeViews();
+    pending_.clear();
+    for (auto& pair : clients_) {
+        ClientState& client = pair.second;
+        const ClientView* prev = client.sentViews.empty() ? client.baselineView.get() : client.sentViews.back().get();
+
+        std::shared_ptr<ClientView> view = AcquireView();
+        view->tick = current->tick;
+        view->world = current;
+        bool shareable = BuildView(pair.first, interest, prev, *view);
+        uint64_t hash = 1469598103934665603ULL;
+        if (shareable) {
+            for (const PlayerSnapshot& player : view->players) {
+                hash = (hash ^ static_cast<uint32_t>(player.playerId)) * 1099511628211ULL;
+            }
+        }
+        pending_.push_back({pair.first, &client, std::move(view), hash, shareable, nullptr});
+    }
+
+    // 玩家集合相同的视图共用一个对象（人群聚在一起时所有客户端的视图相同）：按哈希排序后合并相邻的相同视图
+    auto samePlayers = [](const ClientView& a, const ClientView& b) {
+        return a.players.size() == b.players.size() &&
+               std::equal(a.players.begin(), a.players.end(), b.players.begin(),
+                          [](const PlayerSnapshot& x, const PlayerSnapshot& y) { return x.playerId == y.playerId; });
+    };
+    order_.clear();
+    for (size_t i = 0; i < pending_.size(); ++i) {
+        if (pending_[i].shareable) {
+            order_.push_back(i);
+        }
+    }
+    std::sort(order_.begin(), order_.end(), [this](size_t a, size_t b) {
+        return pending_[a].playersHash != pending_[b].playersHash ? pending_[a].playersHash < pending_[b].playersHash : a < b;
+    });
+    for (size_t k = 1, first = 0; k < order_.size(); ++k) {
+        PendingView& representative = pending_[order_[first]];
+        PendingView& entry = pending_[order_[k]];
+        if (entry.playersHash != representative.playersHash) {
+            first = k;
+        } else if (samePlayers(*entry.view, *representative.view)) {
+            entry.view = representative.view;   // 被替换的视图回到池中
+        }
+    }
+
+    // 按(基线视图, 当前视图)合并增量：排序后相邻的相同组合共用一份增量和编码结果
+    order_.clear();
+    for (size_t i = 0; i < pending_.size(); ++i) {
+        order_.push_back(i);
+    }
+    auto deltaKey = [this](size_t i) {
+        return std::make_pair(pending_[i].client->baselineView.get(), pending_[i].view.get());
+    };
+    std::sort(order_.begin(), order_.end(), [&](size_t a, size_t b) { return deltaKey(a) < deltaKey(b); });
+    for (size_t k = 0; k < order_.size(); ++k) {
+        PendingView& entry = pending_[order_[k]];
+        if (k > 0 && deltaKey(order_[k]) == deltaKey(order_[k - 1])) {
+            entry.delta = pending_[order_[k - 1]].delta;
+            continue;
+        }
+        const ClientView* base = entry.client->baselineView.get();
+        entry.delta = &AcquireDelta();
+        SnapshotDelta& delta = entry.delta->delta;
+        delta.tick = current->tick;
+        delta.baseline = base ? base->tick : 0;
+        static const std::vector<PlayerSnapshot> noPlayers;
+        DiffPlayers(base ? base->players : noPlayers, entry.view->players, delta);
+        DiffWorld(base ? base->world.get() : nullptr, *current, delta);
+        entry.delta->changed = base == nullptr || !delta.empty();
+    }
+
+    // 第二遍：按 clientId 顺序编码和发送
+    int sent = 0;
+    for (PendingView& entry : pending_) {
+        EncodedDelta& encoded = *entry.delta;
+        if (!encoded.changed) {
+            continue;
+        }
+
+        bool binary = entry.client->format == WireFormat::BINARY;
+        SharedFrame& frame = encoded.frames[binary ? 1 : 0];
+        if (!frame) {
+            if (binary) {
+                encodeSnapshotDelta(encoded.delta, encodeBuffer_);
+                frame = PreparedFrame::binary(reinterpret_cast<const uint8_t*>(encodeBuffer_.data()),
+                                              encodeBuffer_.size(), true);
+            } else {
+                frame = PreparedFrame::text(EncodeJson(encoded.delta), true);
+            }
+        }
+
+        // 只记录确实入队的视图，被丢弃的帧不会被确认
+        if (networkManager.sendPrepared(entry.clientId, frame)) {
+            bytesSent_ += frame->size();
+            sent++;
+            std::vector<ViewPtr>& sentViews = entry.client->sentViews;
+            sentViews.push_back(entry.view);
+            if (sentViews.size() > historySize_) {
+                sentViews.erase(sentViews.begin());
+            }
+        }
+    }
+
+    // 释放本帧对视图的引用，未被客户端保留的视图回到池中
+    pending_.clear();
+    return sent;
+}
+
+bool SnapshotReplicator::BuildView(int clientId, const InterestManager& interest, const ClientView* prev,
+                                   ClientView& view) {
+    const std::vector<PlayerSnapshot>& players = view.world->players;
+    const PlayerSnapshot* viewer = FindPlayer(players, clientId);
+    if (!viewer) {
+        // 尚未加入游戏的客户端按旧方式同步全部玩家
+        view.players = players;
+        return true;
+    }
+
+    wasVisible_.clear();
+    if (prev) {
+        for (const PlayerSnapshot& player : prev->players) {
+            wasVisible_.push_back(player.playerId);
+        }
+    }
+    interest.ComputeRelevantSet(clientId, viewer->x, viewer->y, viewer->z, wasVisible_, relevant_);
+
+    bool current = true;
+    view.players.reserve(relevant_.size());
+    for (const InterestManager::Entry& entry : relevant_) {
+        const PlayerSnapshot* player = FindPlayer(players, entry.playerId);
+        if (!player) {
+            continue;
+        }
+        // 降频的玩家在非更新帧沿用上次发送的状态（增量中不产生变化）
+        if (entry.interest == Interest::REDUCED && !interest.IsReducedTick(entry.playerId, view.tick) && prev) {
+            const PlayerSnapshot* stale = FindPlayer(prev->players, entry.playerId);
+            if (stale) {
+                player = stale;
+                current = false;
+            }
+        }
+        view.players.push_back(*player);
+    }
+
+    size_t filtered = players.size() - view.players.size();
+    if (filtered > 0) {
+        playersFiltered_ += filtered;
+        PlayersFilteredMetric().add(filtered);
+    }
+    return current;
+}
+
+bool SnapshotReplicator::ComputeDelta(const WorldSnapshot* baseline, const WorldSnapshot& current, SnapshotDelta& delta) {
+    delta.tick = current.tick;
+    delta.baseline = baseline ? baseline->tick : 0;
+
+    static const std::vector<PlayerSnapshot> noPlayers;
+    DiffPlayers(baseline ? baseline->players : noPlayers, current.players, delta);
+    DiffWorld(baseline, current, delta);
+
+    // 完整快照即使没有内容也要发送，以便客户端建立基线
+    return baseline == nullptr || !delta.empty();
+}
+
+std::string SnapshotReplicator::EncodeJson(const SnapshotDelta& delta) {
+    nlohmann::json message;
+    message["type"] = "snapshot";
+    message["tick"] = delta.tick;
+    message["baseline"] = delta.baseline;
+
+    if (!delta.players.empty()) {
+        nlohmann::json players = nlohmann::json::array();
+        for (const PlayerDelta& player : delta.players) {
+            nlohmann::json entry;
+            entry["id"] = player.playerId;
+            if (player.fields & DELTA_X) entry["x"] = dequantizeCoordinate(player.x);
+            if (player.fields & DELTA_Y) entry["y"] = dequantizeCoordinate(player.y);
+            if (player.fields & DELTA_Z) entry["z"] = dequantizeCoordinate(player.z);
+            if (player.fields & DELTA_ROT) entry["r"] = dequantizeCoordinate(player.rotation);
+            if (player.fields & DELTA_ALIVE) entry["alive"] = player.isAlive;
+            if (player.fields & DELTA_COINS) entry["coins"] = player.coins;
+            players.push_back(std::move(entry));
+        }
+        message["players"] = std::move(players);
+    }
+    if (!delta.removedPlayers.empty()) message["removed"] = delta.removedPlayers;
+    if (!delta.coinsCollected.empty()) message["coinsCollected"] = delta.coinsCollected;
+    if (!delta.coinsRestored.empty()) message["coinsRestored"] = delta.coinsRestored;
+
+    if (!delta.wallsBroken.empty()) {
+        nlohmann::json walls = nlohmann::json::array();
+        for (const auto& wall : delta.wallsBroken) walls.push_back(EncodeWall(wall));
+        message["wallsBroken"] = std::move(walls);
+    }
+    if (!delta.wallsRepaired.empty()) {
+        nlohmann::json walls = nlohmann::json::array();
+        for (const auto& wall : delta.wallsRepaired) walls.push_back(EncodeWall(wall));
+        message["wallsRepaired"] = std::move(walls);
+    }
+
+    return message.dump();
+}
@@ -0,0 +1,119 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+
+SpatialIndex::SpatialIndex() : width(0), height(0), layers(0) {}
+
+void SpatialIndex::reset(int newWidth, int newHeight, int newLayers) {
+    if (newWidth <= 0 || newHeight <= 0 || newLayers <= 0) {
+        newWidth = newHeight = newLayers = 0;
+    }
+    width = newWidth;
+    height = newHeight;
+    layers = newLayers;
+    clear();
+}
+
+void SpatialIndex::clear() {
+    size_t cellCount = static_cast<size_t>(width) * height * layers;
+    playerHeads.assign(cellCount, NONE);
+    coins.assign(cellCount, NONE);
+    trapCounts.assign(cellCount, 0);
+    players.clear();
+}
+
+void SpatialIndex::unlink(int playerId) {
+    PlayerEntry& entry = players[playerId];
+    if (entry.cell == NONE) {
+        return;
+    }
+
+    if (entry.prev != NONE) {
+        players[entry.prev].next = entry.next;
+    } else {
+        playerHeads[static_cast<size_t>(entry.cell)] = entry.next;
+    }
+    if (entry.next != NONE) {
+        players[entry.next].prev = entry.prev;
+    }
+    entry.cell = NONE;
+    entry.prev = entry.next = NONE;
+}
+
+bool SpatialIndex::updatePlayer(int playerId, int x, int y, int layer) {
+    int64_t cell = inBounds(x, y, layer) ? static_cast<int64_t>(indexOf(x, y, layer)) : NONE;
+
+    auto it = players.find(playerId);
+    if (it != players.end() && it->second.cell == cell) {
+        return false;
+    }
+    if (it != players.end()) {
+        unlink(playerId);
+    }
+
+    PlayerEntry& entry = players[playerId];
+    entry.cell = cell;
+    if (cell != NONE) {
+        // 插入到链表头
+        int& head = playerHeads[static_cast<size_t>(cell)];
+        entry.prev = NONE;
+        entry.next = head;
+        if (head != NONE) {
+            players[head].prev = playerId;
+        }
+        head = playerId;
+    }
+    return true;
+}
+
+void SpatialIndex::removePlayer(int playerId) {
+    if (players.find(playerId) == players.end()) {
+        return;
+    }
+    unlink(playerId);
+    players.erase(playerId);
+}
+
+std::vector<int> SpatialIndex::queryPlayers(int x, int y, int layer, int radius) const {
+    std::vector<int> result;
+    forEachPlayerNear(x, y, layer, radius, [&result](int playerId) {
+        result.push_back(playerId);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void SpatialIndex::setCoin(int x, int y, int layer, int coinId) {
+    if (inBounds(x, y, layer)) {
+        coins[indexOf(x, y, layer)] = coinId;
+    }
+}
+
+void SpatialIndex::clearCoin(int x, int y, int layer) {
+    setCoin(x, y, layer, NONE);
+}
+
+int SpatialIndex::coinAt(int x, int y, int layer) const {
+    return inBounds(x, y, layer) ? coins[indexOf(x, y, layer)] : NONE;
+}
+
+void SpatialIndex::addTrap(int x, int y, int layer) {
+    if (inBounds(x, y, layer)) {
+        uint16_t& count = trapCounts[indexOf(x, y, layer)];
+        if (count < UINT16_MAX) {
+            ++count;
+        }
+    }
+}
+
+void SpatialIndex::removeTrap(int x, int y, int layer) {
+    if (inBounds(x, y, layer)) {
+        uint16_t& count = trapCounts[indexOf(x, y, layer)];
+        if (count > 0) {
+            --count;
+        }
+    }
+}
+
+bool SpatialIndex::hasTrap(int x, int y, int layer) const {
+    return inBounds(x, y, layer) && trapCounts[indexOf(x, y, layer)] > 0;
+}
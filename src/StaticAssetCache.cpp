@@ -0,0 +1,234 @@
+#include "StaticAssetCache.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <cstdio>
+
+#ifdef HAS_ZLIB
+    #include <zlib.h>
+#endif
+#ifdef HAS_BROTLI
+    #include <brotli/encode.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// brotli 压缩等级：11 比 9 只小几个百分点，但启动时压缩慢约10倍
+constexpr int BROTLI_QUALITY = 9;
+
+bool IsCompressibleType(const std::string& contentType) {
+    return contentType.compare(0, 5, "text/") == 0 ||
+           contentType.find("javascript") != std::string::npos ||
+           contentType.find("json") != std::string::npos ||
+           contentType.find("xml") != std::string::npos ||
+           contentType.find("svg") != std::string::npos;
+}
+
+std::string MakeETag(const std::string& content) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : content) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    char buffer[24];
+    std::snprintf(buffer, sizeof(buffer), "\"%016llx\"", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+std::shared_ptr<const std::string> GzipCompress(const std::string& input) {
+#ifdef HAS_ZLIB
+    z_stream stream{};
+    // windowBits 15 + 16 输出gzip格式
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nullptr;
+    }
+
+    std::string output(deflateBound(&stream, static_cast<uLong>(input.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    stream.avail_out = static_cast<uInt>(output.size());
+
+    int result = deflate(&stream, Z_FINISH);
+    size_t written = stream.total_out;
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        return nullptr;
+    }
+    output.resize(written);
+    return std::make_shared<const std::string>(std::move(output));
+#else
+    (void)input;
+    return nullptr;
+#endif
+}
+
+std::shared_ptr<const std::string> BrotliCompress(const std::string& input) {
+#ifdef HAS_BROTLI
+    size_t outputSize = BrotliEncoderMaxCompressedSize(input.size());
+    if (outputSize == 0) {
+        return nullptr;
+    }
+    std::string output(outputSize, '\0');
+    if (!BrotliEncoderCompress(BROTLI_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                               input.size(), reinterpret_cast<const uint8_t*>(input.data()),
+                               &outputSize, reinterpret_cast<uint8_t*>(&output[0]))) {
+        return nullptr;
+    }
+    output.resize(outputSize);
+    return std::make_shared<const std::string>(std::move(output));
+#else
+    (void)input;
+    return nullptr;
+#endif
+}
+
+// 压缩后至少小10%才值得保留
+std::shared_ptr<const std::string> KeepIfSmaller(std::shared_ptr<const std::string> compressed, size_t originalSize) {
+    if (compressed && compressed->size() * 10 < originalSize * 9) {
+        return compressed;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+const std::shared_ptr<const std::string>* StaticAsset::variant(ContentEncoding encoding) const {
+    switch (encoding) {
+        case ContentEncoding::GZIP: return gzipBody ? &gzipBody : nullptr;
+        case ContentEncoding::BROTLI: return brotliBody ? &brotliBody : nullptr;
+        case ContentEncoding::IDENTITY: return &body;
+    }
+    return nullptr;
+}
+
+std::string StaticAsset::variantETag(ContentEncoding encoding) const {
+    if (encoding == ContentEncoding::IDENTITY || etag.size() < 2) {
+        return etag;
+    }
+    // "abc" -> "abc-gz"
+    return etag.substr(0, etag.size() - 1) + (encoding == ContentEncoding::GZIP ? "-gz\"" : "-br\"");
+}
+
+bool StaticAssetCache::load(const std::string& rootPath, const std::unordered_map<std::string, std::string>& mimeTypes) {
+    std::error_code ec;
+    if (!fs::is_directory(rootPath, ec)) {
+        return false;
+    }
+
+    auto loaded = std::make_shared<AssetTable>();
+    for (fs::recursive_directory_iterator it(rootPath, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+
+        auto asset = std::make_shared<StaticAsset>();
+        asset->filePath = it->path().string();
+        asset->size = it->file_size(ec);
+        if (ec) {
+            ec.clear();
+            continue;
+        }
+
+        std::string extension = it->path().extension().string();
+        auto mime = mimeTypes.find(extension);
+        asset->contentType = mime != mimeTypes.end() ? mime->second : "application/octet-stream";
+
+        if (asset->size <= MAX_CACHED_FILE_SIZE) {
+            std::ifstream file(asset->filePath, std::ios::binary);
+            if (!file.is_open()) {
+                continue;
+            }
+            std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            asset->size = content.size();
+            asset->etag = MakeETag(content);
+
+            if (content.size() >= MIN_COMPRESS_SIZE && IsCompressibleType(asset->contentType)) {
+                asset->gzipBody = KeepIfSmaller(GzipCompress(content), content.size());
+                asset->brotliBody = KeepIfSmaller(BrotliCompress(content), content.size());
+                loaded->compressedBytes += (asset->gzipBody ? asset->gzipBody->size() : 0) +
+                                           (asset->brotliBody ? asset->brotliBody->size() : 0);
+            }
+            loaded->totalBytes += content.size();
+            asset->body = std::make_shared<const std::string>(std::move(content));
+        } else {
+            // 大文件按大小和修改时间生成ETag
+            auto modified = fs::last_write_time(it->path(), ec).time_since_epoch().count();
+            char buffer[48];
+            std::snprintf(buffer, sizeof(buffer), "\"%llx-%llx\"",
+                          static_cast<unsigned long long>(asset->size), static_cast<unsigned long long>(modified));
+            asset->etag = buffer;
+            ec.clear();
+        }
+
+        std::string urlPath = "/" + fs::relative(it->path(), rootPath, ec).generic_string();
+        if (ec) {
+            ec.clear();
+            continue;
+        }
+        loaded->assets[urlPath] = std::move(asset);
+    }
+
+    std::atomic_store(&current, std::shared_ptr<const AssetTable>(std::move(loaded)));
+    return true;
+}
+
+std::shared_ptr<const StaticAssetCache::AssetTable> StaticAssetCache::table() const {
+    return std::atomic_load(&current);
+}
+
+std::shared_ptr<const StaticAsset> StaticAssetCache::find(const std::string& urlPath) const {
+    std::shared_ptr<const AssetTable> assets = table();
+    if (!assets) {
+        return nullptr;
+    }
+    auto it = assets->assets.find(urlPath);
+    return it != assets->assets.end() ? it->second : nullptr;
+}
+
+size_t StaticAssetCache::getAssetCount() const {
+    std::shared_ptr<const AssetTable> assets = table();
+    return assets ? assets->assets.size() : 0;
+}
+
+uint64_t StaticAssetCache::getTotalBytes() const {
+    std::shared_ptr<const AssetTable> assets = table();
+    return assets ? assets->totalBytes : 0;
+}
+
+uint64_t StaticAssetCache::getCompressedBytes() const {
+    std::shared_ptr<const AssetTable> assets = table();
+    return assets ? assets->compressedBytes : 0;
+}
+
+std::shared_ptr<const StaticAsset> StaticAssetCache::makeAsset(std::string content, const std::string& contentType,
+                                                               const std::string& cacheControl, bool compress) {
+    auto asset = std::make_shared<StaticAsset>();
+    asset->contentType = contentType;
+    asset->cacheControl = cacheControl;
+    asset->size = content.size();
+    asset->etag = MakeETag(content);
+    if (compress && content.size() >= MIN_COMPRESS_SIZE) {
+        asset->gzipBody = KeepIfSmaller(GzipCompress(content), content.size());
+        asset->brotliBody = KeepIfSmaller(BrotliCompress(content), content.size());
+    }
+    asset->body = std::make_shared<const std::string>(std::move(content));
+    return asset;
+}
+
+bool StaticAssetCache::isEncodingSupported(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::IDENTITY: return true;
+#ifdef HAS_ZLIB
+        case ContentEncoding::GZIP: return true;
+#endif
+#ifdef HAS_BROTLI
+        case ContentEncoding::BROTLI: return true;
+#endif
+        default: return false;
+    }
+}
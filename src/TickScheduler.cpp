@@ -0,0 +1,89 @@
+#include "TickScheduler.h"
+#include "Logger.h"
+#include "Metrics.h"
+
+#include <algorithm>
+
+TickScheduler::TickScheduler(int tickRate)
+    : tickRate_(std::max(MIN_TICK_RATE, std::min(MAX_TICK_RATE, tickRate))) {}
+
+void TickScheduler::setTickRate(int tickRate) {
+    tickRate_ = std::max(MIN_TICK_RATE, std::min(MAX_TICK_RATE, tickRate));
+}
+
+void TickScheduler::run(const TickCallback& onTick, const IdleCallback& onIdle, const StopPredicate& shouldStop) {
+    while (!shouldStop()) {
+        Clock::time_point nextTime = runDue(onTick);
+
+        // 空闲时处理消息；仍落后时以0超时调用，保证消息不会被帧饿死
+        Clock::time_point now = Clock::now();
+        int timeoutMs = 0;
+        if (nextTime > now) {
+            // 向上取整，宁可晚醒不足1ms也不空转
+            timeoutMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                nextTime - now + std::chrono::microseconds(999)).count());
+        }
+        onIdle(timeoutMs);
+    }
+}
+
+TickScheduler::Clock::time_point TickScheduler::runDue(const TickCallback& onTick) {
+    static MetricHistogram& tickDuration = MetricsRegistry::getInstance().histogram(
+        "netlab_tick_seconds", "Duration of one simulation tick");
+    static MetricHistogram& tickLag = MetricsRegistry::getInstance().histogram(
+        "netlab_tick_lag_seconds", "Delay between scheduled and actual tick start");
+
+    Clock::time_point now = Clock::now();
+    int rate = tickRate_.load();
+    if (!started_ || rate != currentRate_) {
+        // 首次调用时立即执行第一帧；帧率变化时从当前时刻重新排期
+        currentRate_ = rate;
+        interval_ = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / currentRate_));
+        nextTime_ = started_ ? now + interval_ : now;
+        started_ = true;
+    }
+
+    if (now < nextTime_) {
+        return nextTime_;
+    }
+
+    // 落后太多（例如调试暂停或系统休眠）时放弃追赶，避免连续补帧拖垮服务器
+    if (now - nextTime_ > interval_ * MAX_CATCHUP_TICKS) {
+        uint64_t skipped = static_cast<uint64_t>((now - nextTime_) / interval_);
+        {
+            std::lock_guard<std::mutex> lock(metricsMutex_);
+            metrics_.skippedTicks += skipped;
+        }
+        Logger::getInstance().warning(LogCategory::GAME,
+            "游戏帧落后 " + std::to_string(skipped) + " 帧，重新对齐时间表");
+        nextTime_ = now;
+    }
+
+    double deltaSeconds = std::chrono::duration<double>(interval_).count();
+    Clock::time_point tickStart = Clock::now();
+    tickLag.recordDuration(tickStart - nextTime_);
+    onTick(nextTick_++, deltaSeconds);
+    Clock::duration elapsed = Clock::now() - tickStart;
+    tickDuration.recordDuration(elapsed);
+    recordTick(std::chrono::duration<double, std::milli>(elapsed).count(), deltaSeconds * 1000.0);
+
+    // 按绝对时间推进，不以本帧结束时间为基准
+    nextTime_ += interval_;
+    return nextTime_;
+}
+
+void TickScheduler::recordTick(double tickMs, double intervalMs) {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    metrics_.tickCount++;
+    metrics_.lastTickMs = tickMs;
+    metrics_.avgTickMs = metrics_.tickCount == 1 ? tickMs : metrics_.avgTickMs * 0.9 + tickMs * 0.1;
+    metrics_.maxTickMs = std::max(metrics_.maxTickMs, tickMs);
+    if (tickMs > intervalMs) {
+        metrics_.overruns++;
+    }
+}
+
+TickMetrics TickScheduler::getMetrics() const {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    return metrics_;
+}
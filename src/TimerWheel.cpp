@@ -0,0 +1,158 @@
+#include "TimerWheel.h"
+
+TimerWheel::TimerWheel(uint32_t resolutionMs)
+    : resolution(resolutionMs > 0 ? resolutionMs : 1), currentTick(0), activeCount(0) {
+    clear();
+}
+
+void TimerWheel::reset(uint64_t nowMs) {
+    clear();
+    currentTick = nowMs / resolution;
+}
+
+void TimerWheel::clear() {
+    for (auto& level : slots) {
+        level.fill(NONE);
+    }
+    nodes.clear();
+    freeNodes.clear();
+    activeCount = 0;
+}
+
+TimerWheel::TimerId TimerWheel::scheduleAt(uint64_t expiryMs, Callback callback) {
+    uint32_t index;
+    if (!freeNodes.empty()) {
+        index = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    Node& node = nodes[index];
+    // 当前刻度的槽已经处理过，最早只能在下一个刻度触发
+    uint64_t expiryTick = (expiryMs + resolution - 1) / resolution;
+    node.expiryTick = expiryTick > currentTick ? expiryTick : currentTick + 1;
+    node.callback = std::move(callback);
+    insert(index);
+    ++activeCount;
+
+    return (static_cast<TimerId>(node.generation) << 32) | index;
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    if (id == INVALID_TIMER || index >= nodes.size() ||
+        nodes[index].generation != generation || nodes[index].level < 0) {
+        return false;
+    }
+
+    unlink(index);
+    release(index);
+    return true;
+}
+
+size_t TimerWheel::advance(uint64_t nowMs) {
+    uint64_t targetTick = nowMs / resolution;
+    size_t fired = 0;
+
+    while (currentTick < targetTick) {
+        if (activeCount == 0) {
+            // 没有定时器时直接跳到目标时间
+            currentTick = targetTick;
+            break;
+        }
+
+        ++currentTick;
+
+        // 低层转完一圈时，从上层下放对应槽
+        for (int level = 1; level < LEVELS; ++level) {
+            uint64_t shift = static_cast<uint64_t>(SLOT_BITS) * level;
+            if ((currentTick & ((uint64_t(1) << shift) - 1)) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        // 逐个摘下并触发当前槽中的定时器；回调可能取消同一槽中的其他定时器
+        uint32_t& head = slots[0][currentTick & (SLOTS - 1)];
+        while (head != NONE) {
+            uint32_t index = head;
+            unlink(index);
+            Callback callback = std::move(nodes[index].callback);
+            release(index);
+            ++fired;
+            if (callback) {
+                callback();
+            }
+        }
+    }
+
+    return fired;
+}
+
+void TimerWheel::insert(uint32_t index) {
+    Node& node = nodes[index];
+    uint64_t delta = node.expiryTick - currentTick;
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    // 超出最高层范围的定时器放在最高层最远的槽，转到时会重新分配
+    uint64_t expiryTick = node.expiryTick;
+    uint64_t maxDelta = (uint64_t(1) << (SLOT_BITS * LEVELS)) - 1;
+    if (delta > maxDelta) {
+        expiryTick = currentTick + maxDelta;
+    }
+
+    node.level = static_cast<int16_t>(level);
+    node.slot = static_cast<uint8_t>((expiryTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+
+    uint32_t& head = slots[level][node.slot];
+    node.prev = NONE;
+    node.next = head;
+    if (head != NONE) {
+        nodes[head].prev = index;
+    }
+    head = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes[index];
+    if (node.prev != NONE) {
+        nodes[node.prev].next = node.next;
+    } else {
+        slots[node.level][node.slot] = node.next;
+    }
+    if (node.next != NONE) {
+        nodes[node.next].prev = node.prev;
+    }
+    node.prev = node.next = NONE;
+}
+
+void TimerWheel::release(uint32_t index) {
+    Node& node = nodes[index];
+    node.level = -1;
+    node.callback = nullptr;
+    ++node.generation;   // 旧的TimerId失效
+    if (node.generation == 0) {
+        node.generation = 1;
+    }
+    freeNodes.push_back(index);
+    --activeCount;
+}
+
+void TimerWheel::cascade(int level) {
+    uint32_t slot = static_cast<uint32_t>((currentTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    uint32_t index = slots[level][slot];
+    slots[level][slot] = NONE;
+
+    while (index != NONE) {
+        uint32_t next = nodes[index].next;
+        insert(index);
+        index = next;
+    }
+}
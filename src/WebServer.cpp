@@ -1,26 +1,233 @@
 #include "WebServer.h"
 #include "Logger.h"
+#include "EventPoller.h"
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <thread>
 #include <chrono>
 #include <cstring>
+#include <deque>
+#include <algorithm>
+#include <filesystem>
 #ifdef _WIN32
     #include <winsock2.h>
     #include <ws2tcpip.h>
     #pragma comment(lib, "ws2_32.lib")
+    typedef int socklen_t;
 #else
     #include <sys/socket.h>
+    #include <sys/uio.h>
     #include <netinet/in.h>
+    #include <netinet/tcp.h>
     #include <unistd.h>
     #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <cerrno>
+    #define SOCKET int
+    #define INVALID_SOCKET -1
+    #define closesocket close
 #endif
+#ifdef __linux__
+    #include <sys/sendfile.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+// 请求头最大长度，超过时返回431并关闭连接
+const size_t MAX_REQUEST_HEADER_SIZE = 16 * 1024;
+
+// 请求体最大长度（只支持GET/HEAD，请求体会被丢弃）
+const size_t MAX_REQUEST_BODY_SIZE = 1024 * 1024;
+
+// 发送队列超过此大小时暂停处理后续的流水线请求
+const size_t MAX_PENDING_OUTPUT = 4 * 1024 * 1024;
+
+// keep-alive 空闲超时和单连接最多处理的请求数
+const int KEEP_ALIVE_TIMEOUT_MS = 15000;
+const int MAX_REQUESTS_PER_CONNECTION = 1000;
+
+// 单次 sendfile 的最大字节数
+const size_t SENDFILE_CHUNK = 1024 * 1024;
+
+// 监听socket在轮询器中的token
+const uint64_t LISTEN_TOKEN = 0;
+
+bool IsWouldBlock() {
+#ifdef _WIN32
+    int error = WSAGetLastError();
+    return error == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+void SetNonBlocking(SOCKET socket) {
+#ifdef _WIN32
+    u_long mode = 1;
+    ioctlsocket(socket, FIONBIO, &mode);
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    fcntl(socket, F_SETFL, flags | O_NONBLOCK);
+#endif
+}
+
+std::string ToLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+// 发送两段连续数据（响应头剩余部分 + 响应体剩余部分），返回发送的字节数，出错返回-1
+long SendParts(SOCKET socket, const char* first, size_t firstSize, const char* second, size_t secondSize,
+               bool& wouldBlock) {
+    wouldBlock = false;
+#ifdef _WIN32
+    const char* data = firstSize > 0 ? first : second;
+    size_t size = firstSize > 0 ? firstSize : secondSize;
+    int sent = send(socket, data, static_cast<int>(std::min<size_t>(size, INT_MAX)), 0);
+#else
+    iovec parts[2];
+    int count = 0;
+    if (firstSize > 0) {
+        parts[count].iov_base = const_cast<char*>(first);
+        parts[count].iov_len = firstSize;
+        ++count;
+    }
+    if (secondSize > 0) {
+        parts[count].iov_base = const_cast<char*>(second);
+        parts[count].iov_len = secondSize;
+        ++count;
+    }
+    msghdr message{};
+    message.msg_iov = parts;
+    message.msg_iovlen = count;
+    ssize_t sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+#endif
+    if (sent < 0) {
+        wouldBlock = IsWouldBlock();
+        return wouldBlock ? 0 : -1;
+    }
+    return static_cast<long>(sent);
+}
+
+// Accept-Encoding 中是否接受某个编码（q=0 表示拒绝）
+bool AcceptsEncoding(const std::string& acceptEncoding, const std::string& name) {
+    std::stringstream stream(acceptEncoding);
+    std::string token;
+    while (std::getline(stream, token, ',')) {
+        size_t semicolon = token.find(';');
+        std::string coding = token.substr(0, semicolon);
+        coding.erase(0, coding.find_first_not_of(" \t"));
+        coding.erase(coding.find_last_not_of(" \t") + 1);
+        if (coding != name && coding != "*") {
+            continue;
+        }
+        if (semicolon != std::string::npos) {
+            std::string params = token.substr(semicolon + 1);
+            size_t q = params.find("q=");
+            if (q != std::string::npos && std::atof(params.c_str() + q + 2) <= 0.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
 
-WebServer::WebServer() 
+// If-None-Match 是否命中该文件的任一编码版本
+bool ETagMatches(const std::string& ifNoneMatch, const StaticAsset& asset) {
+    std::stringstream stream(ifNoneMatch);
+    std::string token;
+    while (std::getline(stream, token, ',')) {
+        token.erase(0, token.find_first_not_of(" \t"));
+        token.erase(token.find_last_not_of(" \t") + 1);
+        if (token.compare(0, 2, "W/") == 0) {
+            token.erase(0, 2);
+        }
+        if (token == "*" || token == asset.etag ||
+            token == asset.variantETag(ContentEncoding::GZIP) ||
+            token == asset.variantETag(ContentEncoding::BROTLI)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+// 一个已解析的请求
+struct HttpRequest {
+    std::string method;
+    std::string path;       // 已解码，不含查询字符串
+    std::string version;
+    std::unordered_map<std::string, std::string> headers;
+    std::string raw;        // 原始请求头，传给自定义路由
+    bool isHead = false;
+    bool keepAlive = false;
+
+    std::string header(const std::string& name) const {
+        auto it = headers.find(name);
+        return it != headers.end() ? it->second : std::string();
+    }
+};
+
+// 待发送的一个响应
+struct HttpOutput {
+    std::string head;                              // 响应头（小响应连同响应体）
+    std::shared_ptr<const std::string> body;       // 缓存中的响应体，共享不复制
+    size_t offset = 0;                             // head + body 已发送的字节数
+#ifdef __linux__
+    int fileDescriptor = -1;                       // 未缓存的大文件，用 sendfile 发送
+    off_t fileOffset = 0;
+    uint64_t fileRemaining = 0;
+#endif
+
+    size_t memorySize() const { return head.size() + (body ? body->size() : 0); }
+};
+
+// 一个客户端连接（只由所属工作线程访问）
+struct HttpConnection {
+    SOCKET socket = INVALID_SOCKET;
+    std::string input;                             // 尚未处理的请求数据
+    std::deque<HttpOutput> output;
+    size_t outputBytes = 0;                        // 发送队列中剩余的字节数
+    int requestCount = 0;
+    bool closeAfterWrite = false;                  // 发送完队列后关闭
+    bool writeBlocked = false;                     // 等待可写事件
+    std::chrono::steady_clock::time_point lastActivity;
+
+    ~HttpConnection() {
+#ifdef __linux__
+        for (HttpOutput& pending : output) {
+            if (pending.fileDescriptor >= 0) {
+                close(pending.fileDescriptor);
+            }
+        }
+#endif
+    }
+};
+
+// I/O工作线程
+struct HttpWorker {
+    EventPoller poller;
+    std::thread thread;
+    std::mutex mutex;                                          // 保护pendingSockets
+    std::vector<SOCKET> pendingSockets;                        // 监听线程交付、尚未注册的连接
+    std::unordered_map<SOCKET, std::unique_ptr<HttpConnection>> connections;
+};
+
+WebServer::WebServer()
     : httpPort_(8080)
-    , serverRunning_(false) {
-    
+    , workerCount_(0)
+    , serverRunning_(false)
+    , requestsServed_(0)
+    , openConnections_(0) {
+
     // 初始化MIME类型映射
     mimeTypes_[".html"] = "text/html; charset=utf-8";
     mimeTypes_[".htm"] = "text/html; charset=utf-8";
@@ -50,45 +257,97 @@ WebServer& WebServer::getInstance() {
 }
 
 bool WebServer::initialize(const std::string& webRootPath, int httpPort) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    webRootPath_ = webRootPath;
-    httpPort_ = httpPort;
-    
-    // 检查web根目录是否存在
-    std::ifstream testFile(webRootPath_ + "/index.html");
-    if (!testFile.is_open()) {
-        Logger::getInstance().error(LogCategory::WEB, "WebServer: 未找到网站根目录: " + webRootPath_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        webRootPath_ = webRootPath;
+        httpPort_ = httpPort;
+
+        // 检查web根目录是否存在
+        std::ifstream testFile(webRootPath_ + "/index.html");
+        if (!testFile.is_open()) {
+            Logger::getInstance().error(LogCategory::WEB, "WebServer: 未找到网站根目录: " + webRootPath_);
+            return false;
+        }
+        testFile.close();
+    }
+
+    if (!reloadAssets()) {
         return false;
     }
-    testFile.close();
-    
+
     Logger::getInstance().info(LogCategory::WEB, "WebServer: 已使用网站根目录初始化: " + webRootPath_);
     return true;
 }
 
+bool WebServer::reloadAssets() {
+    auto startTime = std::chrono::steady_clock::now();
+    if (!assetCache_.load(webRootPath_, mimeTypes_)) {
+        Logger::getInstance().error(LogCategory::WEB, "WebServer: 无法加载静态文件: " + webRootPath_);
+        return false;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+
+    Logger::getInstance().info(LogCategory::WEB, "WebServer: 预加载静态文件 " + std::to_string(assetCache_.getAssetCount()) +
+        " 个，" + std::to_string(assetCache_.getTotalBytes() / 1024) + " KB（压缩版本 " +
+        std::to_string(assetCache_.getCompressedBytes() / 1024) + " KB），耗时 " + std::to_string(elapsed.count()) + "ms");
+    return true;
+}
+
 bool WebServer::startServer() {
     if (serverRunning_) {
         Logger::getInstance().warning(LogCategory::WEB, "WebServer: 服务器已在运行");
         return true;
     }
-    
+
+    int workerCount = workerCount_;
+    if (workerCount <= 0) {
+        workerCount = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
     serverRunning_ = true;
+    workers_.clear();
+    for (int i = 0; i < workerCount; ++i) {
+        auto worker = std::make_unique<HttpWorker>();
+        if (!worker->poller.isValid()) {
+            Logger::getInstance().error(LogCategory::WEB, "WebServer: 无法创建事件轮询器");
+            serverRunning_ = false;
+            stopServer();
+            return false;
+        }
+        workers_.push_back(std::move(worker));
+    }
+    for (auto& worker : workers_) {
+        worker->thread = std::thread(&WebServer::workerLoop, this, worker.get());
+    }
     serverThread_ = std::make_unique<std::thread>(&WebServer::serverLoop, this);
-    
-    Logger::getInstance().info(LogCategory::WEB, "WebServer: HTTP server started on port " + std::to_string(httpPort_));
+
+    Logger::getInstance().info(LogCategory::WEB, "WebServer: HTTP server started on port " + std::to_string(httpPort_) +
+        " (" + std::to_string(workerCount) + " I/O threads)");
     return true;
 }
 
 void WebServer::stopServer() {
-    if (!serverRunning_) return;
-    
-    serverRunning_ = false;
+    bool wasRunning = serverRunning_.exchange(false);
+
     if (serverThread_ && serverThread_->joinable()) {
         serverThread_->join();
     }
-    
-    Logger::getInstance().info(LogCategory::WEB, "WebServer: HTTP server stopped");
+    serverThread_.reset();
+
+    for (auto& worker : workers_) {
+        worker->poller.wakeup();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    workers_.clear();
+
+    if (wasRunning) {
+        Logger::getInstance().info(LogCategory::WEB, "WebServer: HTTP server stopped");
+    }
 }
 
 void WebServer::serverLoop() {
@@ -101,31 +360,21 @@ void WebServer::serverLoop() {
     }
 #endif
 
-    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket < 0) {
+    SOCKET serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (serverSocket == INVALID_SOCKET) {
         Logger::getInstance().error(LogCategory::WEB, "WebServer: Failed to create socket");
 #ifdef _WIN32
         WSACleanup();
 #endif
         return;
     }
-    
+
     // 设置socket为非阻塞模式以便优雅关闭
-#ifdef _WIN32
-    u_long mode = 1;
-    ioctlsocket(serverSocket, FIONBIO, &mode);
-#else
-    int flags = fcntl(serverSocket, F_GETFL, 0);
-    fcntl(serverSocket, F_SETFL, flags | O_NONBLOCK);
-#endif
+    SetNonBlocking(serverSocket);
 
     // 设置SO_REUSEADDR
     int opt = 1;
-#ifdef _WIN32
-    if (setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt)) < 0) {
-#else
-    if (setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-#endif
+    if (setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&opt), sizeof(opt)) < 0) {
         Logger::getInstance().warning(LogCategory::WEB, "WebServer: setsockopt failed");
     }
 
@@ -136,196 +385,532 @@ void WebServer::serverLoop() {
 
     if (bind(serverSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) < 0) {
         Logger::getInstance().error(LogCategory::WEB, "WebServer: Failed to bind to port " + std::to_string(httpPort_));
-#ifdef _WIN32
         closesocket(serverSocket);
+#ifdef _WIN32
         WSACleanup();
-#else
-        close(serverSocket);
 #endif
         return;
     }
 
-    if (listen(serverSocket, 10) < 0) {
+    if (listen(serverSocket, SOMAXCONN) < 0) {
         Logger::getInstance().error(LogCategory::WEB, "WebServer: Failed to listen on socket");
+        closesocket(serverSocket);
 #ifdef _WIN32
+        WSACleanup();
+#endif
+        return;
+    }
+
+    EventPoller acceptPoller;
+    if (!acceptPoller.isValid() ||
+        !acceptPoller.add(static_cast<intptr_t>(serverSocket), EventPoller::EVENT_READ, LISTEN_TOKEN)) {
+        Logger::getInstance().error(LogCategory::WEB, "WebServer: 无法注册监听socket");
         closesocket(serverSocket);
+#ifdef _WIN32
         WSACleanup();
-#else
-        close(serverSocket);
 #endif
         return;
     }
 
     Logger::getInstance().info(LogCategory::WEB, "WebServer: Listening on port " + std::to_string(httpPort_));
 
+    std::vector<EventPoller::Event> events;
+    size_t nextWorker = 0;
     while (serverRunning_) {
-        // 设置超时以定期检查serverRunning_
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(serverSocket, &readfds);
-        
-        timeval timeout{};
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
-
-        int activity = select(serverSocket + 1, &readfds, nullptr, nullptr, &timeout);
-        
-        if (activity < 0) {
-            Logger::getInstance().error(LogCategory::WEB, "WebServer: select error");
+        // 定时返回以检查serverRunning_
+        int count = acceptPoller.wait(events, 200);
+        if (count < 0) {
+            Logger::getInstance().error(LogCategory::WEB, "WebServer: 事件轮询失败");
             break;
         }
-        
-        if (!serverRunning_) break;
-        
-        if (activity == 0) {
-            // 超时，继续循环
+        if (count == 0 || !serverRunning_) {
             continue;
         }
 
-        sockaddr_in clientAddr{};
-        socklen_t clientLen = sizeof(clientAddr);
-        
-        int clientSocket = accept(serverSocket, (sockaddr*)&clientAddr, &clientLen);
-        if (clientSocket < 0) {
-            if (serverRunning_) {
-                Logger::getInstance().error(LogCategory::WEB, "WebServer: Failed to accept client connection");
+        // 接受所有排队的连接，按轮转交给工作线程
+        while (serverRunning_) {
+            sockaddr_in clientAddr{};
+            socklen_t clientLen = sizeof(clientAddr);
+            SOCKET clientSocket = accept(serverSocket, (sockaddr*)&clientAddr, &clientLen);
+            if (clientSocket == INVALID_SOCKET) {
+                if (!IsWouldBlock() && serverRunning_) {
+                    Logger::getInstance().error(LogCategory::WEB, "WebServer: Failed to accept client connection");
+                }
+                break;
             }
-            continue;
-        }
 
-        // 处理客户端请求
-        char buffer[4096];
-        int bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-        
-        if (bytesRead > 0) {
-            buffer[bytesRead] = '\0';
-            std::string request(buffer);
-            
-            std::string response = handleRequest(request);
-            
-            send(clientSocket, response.c_str(), response.length(), 0);
-        }
-
-#ifdef _WIN32
-        closesocket(clientSocket);
-#else
-        close(clientSocket);
+            SetNonBlocking(clientSocket);
+            int noDelay = 1;
+            setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&noDelay), sizeof(noDelay));
+#ifdef SO_NOSIGPIPE
+            int noSigPipe = 1;
+            setsockopt(clientSocket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
 #endif
+
+            HttpWorker& worker = *workers_[nextWorker];
+            nextWorker = (nextWorker + 1) % workers_.size();
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.pendingSockets.push_back(clientSocket);
+            }
+            worker.poller.wakeup();
+        }
     }
 
-#ifdef _WIN32
+    acceptPoller.remove(static_cast<intptr_t>(serverSocket));
     closesocket(serverSocket);
+#ifdef _WIN32
     WSACleanup();
-#else
-    close(serverSocket);
 #endif
 }
 
-std::string WebServer::handleRequest(const std::string& request) {
-    std::string method, path;
-    std::unordered_map<std::string, std::string> headers;
-    
-    if (!parseHttpRequest(request, method, path, headers)) {
-        // 只记录非空请求的解析失败
-        if (!request.empty() && request.find("\r\n") != std::string::npos) {
-            Logger::getInstance().warning(LogCategory::WEB, "HTTP请求解析失败: " + request.substr(0, 100));
+void WebServer::workerLoop(HttpWorker* worker) {
+    std::vector<EventPoller::Event> events;
+    std::vector<SOCKET> accepted;
+    auto lastSweep = std::chrono::steady_clock::now();
+
+    auto closeConnection = [&](SOCKET socket) {
+        worker->poller.remove(static_cast<intptr_t>(socket));
+        closesocket(socket);
+        worker->connections.erase(socket);
+        --openConnections_;
+    };
+
+    while (serverRunning_) {
+        int count = worker->poller.wait(events, 500);
+        if (count < 0) {
+            Logger::getInstance().error(LogCategory::WEB, "WebServer: 事件轮询失败");
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+
+        // 注册新连接；请求可能在注册前就已到达，所以立即尝试读取一次
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            accepted.swap(worker->pendingSockets);
+        }
+        for (SOCKET socket : accepted) {
+            auto connection = std::make_unique<HttpConnection>();
+            connection->socket = socket;
+            connection->lastActivity = now;
+            if (!worker->poller.add(static_cast<intptr_t>(socket), EventPoller::EVENT_READ, static_cast<uint64_t>(socket))) {
+                closesocket(socket);
+                continue;
+            }
+            HttpConnection& added = *connection;
+            worker->connections[socket] = std::move(connection);
+            ++openConnections_;
+            if (!serviceConnection(*worker, added, true)) {
+                closeConnection(socket);
+            }
+        }
+        accepted.clear();
+
+        for (int i = 0; i < count; ++i) {
+            SOCKET socket = static_cast<SOCKET>(events[i].token);
+            auto it = worker->connections.find(socket);
+            if (it == worker->connections.end()) {
+                continue;
+            }
+            HttpConnection& connection = *it->second;
+            connection.lastActivity = now;
+
+            bool readable = (events[i].events & (EventPoller::EVENT_READ | EventPoller::EVENT_ERROR)) != 0;
+            if (!serviceConnection(*worker, connection, readable)) {
+                closeConnection(socket);
+            }
+        }
+
+        // 关闭空闲的keep-alive连接
+        if (now - lastSweep >= std::chrono::seconds(1)) {
+            lastSweep = now;
+            std::vector<SOCKET> idle;
+            for (const auto& pair : worker->connections) {
+                if (now - pair.second->lastActivity >= std::chrono::milliseconds(KEEP_ALIVE_TIMEOUT_MS)) {
+                    idle.push_back(pair.first);
+                }
+            }
+            for (SOCKET socket : idle) {
+                closeConnection(socket);
+            }
         }
-        return buildHttpResponse(400, "Bad Request", "Invalid HTTP request", "text/plain");
     }
-    
-    // 记录HTTP访问日志
-    std::string clientIP = "unknown";
-    auto userAgentIt = headers.find("User-Agent");
-    std::string userAgent = (userAgentIt != headers.end()) ? userAgentIt->second : "unknown";
-    
-    // Logger::getInstance().info(LogCategory::WEB, "HTTP请求 - 方法: " + method + " | 路径: " + path + " | User-Agent: " + userAgent);
-    
+
+    // 关闭剩余连接
+    std::vector<SOCKET> remaining;
+    for (const auto& pair : worker->connections) {
+        remaining.push_back(pair.first);
+    }
+    for (SOCKET socket : remaining) {
+        closeConnection(socket);
+    }
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        for (SOCKET socket : worker->pendingSockets) {
+            closesocket(socket);
+        }
+        worker->pendingSockets.clear();
+    }
+}
+
+bool WebServer::serviceConnection(HttpWorker& worker, HttpConnection& connection, bool readable) {
+    bool peerClosed = false;
+    if (readable) {
+        // 读到 EWOULDBLOCK，兼容边缘触发
+        char buffer[16 * 1024];
+        while (true) {
+            int received = recv(connection.socket, buffer, sizeof(buffer), 0);
+            if (received > 0) {
+                // 已决定关闭的连接不再接收新请求
+                if (!connection.closeAfterWrite) {
+                    connection.input.append(buffer, received);
+                }
+                continue;
+            }
+            if (received == 0) {
+                peerClosed = true;
+            } else if (!IsWouldBlock()) {
+                return false;
+            }
+            break;
+        }
+    }
+
+    // 处理请求直到输入耗尽或发送阻塞
+    while (true) {
+        size_t pendingInput = connection.input.size();
+        processRequests(connection);
+        if (!flushConnection(worker, connection)) {
+            return false;
+        }
+        if (connection.writeBlocked || connection.input.empty() || connection.input.size() == pendingInput) {
+            break;
+        }
+    }
+
+    if (connection.output.empty() && (connection.closeAfterWrite || peerClosed)) {
+        return false;
+    }
+    return !peerClosed || !connection.output.empty();
+}
+
+void WebServer::processRequests(HttpConnection& connection) {
+    while (!connection.closeAfterWrite && connection.outputBytes < MAX_PENDING_OUTPUT) {
+        size_t headerEnd = connection.input.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            if (connection.input.size() > MAX_REQUEST_HEADER_SIZE) {
+                HttpRequest request;
+                request.keepAlive = false;
+                queueResponse(connection, request, 431, "Request Header Fields Too Large",
+                              "Request header too large", "text/plain");
+                connection.input.clear();
+            }
+            return;
+        }
+
+        HttpRequest request;
+        request.raw = connection.input.substr(0, headerEnd + 4);
+        if (!parseHttpRequest(request.raw, request.method, request.path, request.version, request.headers)) {
+            Logger::getInstance().warning(LogCategory::WEB, "HTTP请求解析失败: " + request.raw.substr(0, 100));
+            queueResponse(connection, request, 400, "Bad Request", "Invalid HTTP request", "text/plain");
+            connection.input.clear();
+            return;
+        }
+
+        // 带请求体的请求：等请求体到齐后整体丢弃，保持流水线对齐
+        size_t bodySize = 0;
+        std::string contentLength = request.header("content-length");
+        if (!contentLength.empty()) {
+            char* end = nullptr;
+            unsigned long long length = std::strtoull(contentLength.c_str(), &end, 10);
+            if (end == contentLength.c_str() || length > MAX_REQUEST_BODY_SIZE) {
+                queueResponse(connection, request, 413, "Payload Too Large", "Request body too large", "text/plain");
+                connection.input.clear();
+                return;
+            }
+            bodySize = static_cast<size_t>(length);
+        }
+        if (connection.input.size() < headerEnd + 4 + bodySize) {
+            return;
+        }
+        connection.input.erase(0, headerEnd + 4 + bodySize);
+
+        // HTTP/1.1 默认保持连接，HTTP/1.0 需要显式请求
+        std::string connectionHeader = ToLower(request.header("connection"));
+        if (request.version == "HTTP/1.1") {
+            request.keepAlive = connectionHeader.find("close") == std::string::npos;
+        } else {
+            request.keepAlive = connectionHeader.find("keep-alive") != std::string::npos;
+        }
+        if (++connection.requestCount >= MAX_REQUESTS_PER_CONNECTION) {
+            request.keepAlive = false;
+        }
+        request.isHead = request.method == "HEAD";
+
+        handleRequest(request, connection);
+        ++requestsServed_;
+
+        if (!request.keepAlive) {
+            connection.closeAfterWrite = true;
+            connection.input.clear();
+        }
+    }
+}
+
+bool WebServer::flushConnection(HttpWorker& worker, HttpConnection& connection) {
+    while (!connection.output.empty()) {
+        HttpOutput& out = connection.output.front();
+        size_t memorySize = out.memorySize();
+
+        if (out.offset < memorySize) {
+            size_t headSize = out.head.size();
+            const char* first = out.offset < headSize ? out.head.data() + out.offset : nullptr;
+            size_t firstSize = out.offset < headSize ? headSize - out.offset : 0;
+            size_t bodyOffset = out.offset > headSize ? out.offset - headSize : 0;
+            const char* second = out.body ? out.body->data() + bodyOffset : nullptr;
+            size_t secondSize = out.body ? out.body->size() - bodyOffset : 0;
+
+            bool wouldBlock = false;
+            long sent = SendParts(connection.socket, first, firstSize, second, secondSize, wouldBlock);
+            if (sent < 0) {
+                return false;
+            }
+            out.offset += static_cast<size_t>(sent);
+            connection.outputBytes -= static_cast<size_t>(sent);
+            if (wouldBlock) {
+                break;
+            }
+            continue;
+        }
+
+#ifdef __linux__
+        if (out.fileRemaining > 0) {
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(out.fileRemaining, SENDFILE_CHUNK));
+            ssize_t sent = sendfile(connection.socket, out.fileDescriptor, &out.fileOffset, chunk);
+            if (sent < 0) {
+                if (IsWouldBlock()) {
+                    break;
+                }
+                return false;
+            }
+            if (sent == 0) {
+                return false;   // 文件在发送期间被截断
+            }
+            out.fileRemaining -= static_cast<uint64_t>(sent);
+            connection.outputBytes -= static_cast<size_t>(sent);
+            continue;
+        }
+        if (out.fileDescriptor >= 0) {
+            close(out.fileDescriptor);
+            out.fileDescriptor = -1;
+        }
+#endif
+        connection.output.pop_front();
+    }
+
+    // 发送缓冲区满时等待可写事件，发完后取消
+    bool blocked = !connection.output.empty();
+    if (blocked != connection.writeBlocked) {
+        uint32_t events = EventPoller::EVENT_READ | (blocked ? static_cast<uint32_t>(EventPoller::EVENT_WRITE) : 0u);
+        worker.poller.modify(static_cast<intptr_t>(connection.socket), events, static_cast<uint64_t>(connection.socket));
+        connection.writeBlocked = blocked;
+    }
+    return true;
+}
+
+void WebServer::handleRequest(const HttpRequest& request, HttpConnection& connection) {
     // 处理GET和HEAD请求
-    bool isHeadRequest = (method == "HEAD");
-    if (method != "GET" && method != "HEAD") {
-        Logger::getInstance().warning(LogCategory::WEB, "不支持的HTTP方法 - 方法: " + method + " | 路径: " + path);
-        return buildHttpResponse(405, "Method Not Allowed", "Only GET and HEAD methods are supported", "text/plain", false);
+    if (request.method != "GET" && request.method != "HEAD") {
+        Logger::getInstance().warning(LogCategory::WEB, "不支持的HTTP方法 - 方法: " + request.method + " | 路径: " + request.path);
+        queueResponse(connection, request, 405, "Method Not Allowed", "Only GET and HEAD methods are supported",
+                      "text/plain", "Allow: GET, HEAD\r\n");
+        return;
     }
-    
-    // URL解码路径
-    path = urlDecode(path);
-    
-    // 检查自定义路由
+
+    std::string path = request.path;
+
+    // 检查自定义路由（处理函数访问游戏状态，串行执行）
     {
         std::lock_guard<std::mutex> lock(mutex_);
         auto it = customRoutes_.find(path);
         if (it != customRoutes_.end()) {
-            std::string customResponse = it->second(request);
+            std::string customResponse = it->second.handler(request.raw);
             // 根据路径确定内容类型
-            std::string contentType = "text/html";
-            if (path.find("/api/") == 0) {
-                contentType = "application/json; charset=utf-8";
+            std::string contentType = it->second.contentType;
+            if (contentType.empty()) {
+                contentType = path.find("/api/") == 0 ? "application/json; charset=utf-8" : "text/html";
             }
-            
-            Logger::getInstance().debug(LogCategory::WEB, "处理API路由 - 路径: " + path + " | 响应长度: " + std::to_string(customResponse.length()));
-            
-            return buildHttpResponse(200, "OK", customResponse, contentType, isHeadRequest);
+
+            LOG_DEBUG(LogCategory::WEB, "处理API路由 - 路径: " + path + " | 响应长度: " + std::to_string(customResponse.length()));
+
+            queueResponse(connection, request, 200, "OK", customResponse, contentType, "Cache-Control: no-store\r\n");
+            return;
         }
     }
-    
+
+    // 发布的资源
+    std::shared_ptr<const StaticAsset> published;
+    {
+        std::lock_guard<std::mutex> lock(publishedMutex_);
+        auto it = publishedAssets_.find(path);
+        if (it != publishedAssets_.end()) {
+            published = it->second;
+        }
+    }
+    if (published) {
+        serveAsset(request, *published, connection);
+        return;
+    }
+
     // 默认路由处理
     if (path == "/") {
         path = "/index.html";
     }
-    
-    // 安全检查
+
+    // 缓存中查找，没有扩展名时尝试添加.html
+    std::shared_ptr<const StaticAsset> asset = assetCache_.find(path);
+    if (!asset && path.find('.') == std::string::npos) {
+        asset = assetCache_.find(path + ".html");
+    }
+    if (asset) {
+        serveAsset(request, *asset, connection);
+        return;
+    }
+
+    // 启动后新增的文件：从磁盘读取（不缓存）
     if (!isSafePath(path)) {
         Logger::getInstance().warning(LogCategory::WEB, "路径安全检查失败 - 路径: " + path);
-        return buildHttpResponse(403, "Forbidden", "Access denied", "text/plain", isHeadRequest);
+        queueResponse(connection, request, 403, "Forbidden", "Access denied", "text/plain");
+        return;
     }
-    
-    // 构建完整文件路径
+
     std::string fullPath = webRootPath_ + path;
-    
-    // 读取文件内容
     std::string fileContent;
-    if (!readFile(fullPath, fileContent)) {
-        // 文件不存在，尝试添加.html扩展名
-        if (fullPath.find('.') == std::string::npos) {
-            fullPath += ".html";
-            if (!readFile(fullPath, fileContent)) {
-                Logger::getInstance().warning(LogCategory::WEB, 
-                    "文件未找到 - 路径: " + path + " | 完整路径: " + fullPath);
-                return buildHttpResponse(404, "Not Found", "File not found: " + path, "text/plain", isHeadRequest);
-            }
+    if (!std::filesystem::is_regular_file(fullPath) || !readFile(fullPath, fileContent)) {
+        Logger::getInstance().warning(LogCategory::WEB,
+            "文件未找到 - 路径: " + path + " | 完整路径: " + fullPath);
+        queueResponse(connection, request, 404, "Not Found", "File not found: " + path, "text/plain");
+        return;
+    }
+
+    std::string contentType = getMimeType(fullPath);
+
+    LOG_DEBUG(LogCategory::WEB, "提供静态文件 - 路径: " + path + " | 类型: " + contentType + " | 大小: " + std::to_string(fileContent.length()) + " bytes");
+
+    queueResponse(connection, request, 200, "OK", fileContent, contentType, "Cache-Control: no-cache\r\n");
+}
+
+void WebServer::serveAsset(const HttpRequest& request, const StaticAsset& asset, HttpConnection& connection) {
+    // 压缩协商：优先br，其次gzip
+    ContentEncoding encoding = ContentEncoding::IDENTITY;
+    std::string acceptEncoding = ToLower(request.header("accept-encoding"));
+    if (asset.brotliBody && AcceptsEncoding(acceptEncoding, "br")) {
+        encoding = ContentEncoding::BROTLI;
+    } else if (asset.gzipBody && AcceptsEncoding(acceptEncoding, "gzip")) {
+        encoding = ContentEncoding::GZIP;
+    }
+    std::string etag = asset.variantETag(encoding);
+
+    std::string headers;
+    headers += "ETag: " + etag + "\r\n";
+    headers += "Cache-Control: " + (asset.cacheControl.empty() ? std::string("no-cache") : asset.cacheControl) + "\r\n";
+    if (asset.isCompressible()) {
+        headers += "Vary: Accept-Encoding\r\n";
+    }
+
+    // 条件请求命中时只返回304
+    std::string ifNoneMatch = request.header("if-none-match");
+    if (!ifNoneMatch.empty() && ETagMatches(ifNoneMatch, asset)) {
+        HttpOutput out;
+        out.head = "HTTP/1.1 304 Not Modified\r\n" + headers +
+                   (request.keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n") + "\r\n";
+        connection.outputBytes += out.memorySize();
+        connection.output.push_back(std::move(out));
+        return;
+    }
+
+    if (encoding == ContentEncoding::GZIP) {
+        headers += "Content-Encoding: gzip\r\n";
+    } else if (encoding == ContentEncoding::BROTLI) {
+        headers += "Content-Encoding: br\r\n";
+    }
+
+    const std::shared_ptr<const std::string>* body = asset.variant(encoding);
+    uint64_t contentLength = body && *body ? (*body)->size() : asset.size;
+
+    HttpOutput out;
+    out.head = buildHttpHead(200, "OK", asset.contentType, contentLength, request.keepAlive, headers);
+
+    if (!request.isHead) {
+        if (body && *body) {
+            out.body = *body;
         } else {
-            Logger::getInstance().warning(LogCategory::WEB, 
-                "文件未找到 - 路径: " + path + " | 完整路径: " + fullPath);
-            return buildHttpResponse(404, "Not Found", "File not found: " + path, "text/plain", isHeadRequest);
+#ifdef __linux__
+            // 未缓存的大文件：sendfile 零拷贝发送
+            out.fileDescriptor = open(asset.filePath.c_str(), O_RDONLY);
+            if (out.fileDescriptor < 0) {
+                queueResponse(connection, request, 404, "Not Found", "File not found: " + request.path, "text/plain");
+                return;
+            }
+            out.fileRemaining = asset.size;
+            connection.outputBytes += asset.size;
+#else
+            std::string content;
+            if (!readFile(asset.filePath, content)) {
+                queueResponse(connection, request, 404, "Not Found", "File not found: " + request.path, "text/plain");
+                return;
+            }
+            out.body = std::make_shared<const std::string>(std::move(content));
+#endif
         }
     }
-    
-    // 获取MIME类型
-    std::string contentType = getMimeType(fullPath);
-    
-    Logger::getInstance().debug(LogCategory::WEB, "提供静态文件 - 路径: " + path + " | 类型: " + contentType + " | 大小: " + std::to_string(fileContent.length()) + " bytes");
-    
-    return buildHttpResponse(200, "OK", fileContent, contentType, isHeadRequest);
+
+    connection.outputBytes += out.memorySize();
+    connection.output.push_back(std::move(out));
+}
+
+void WebServer::queueResponse(HttpConnection& connection, const HttpRequest& request,
+                              int statusCode, const std::string& statusText,
+                              const std::string& content, const std::string& contentType,
+                              const std::string& extraHeaders) {
+    HttpOutput out;
+    out.head = buildHttpResponse(statusCode, statusText, content, contentType, request.isHead,
+                                 request.keepAlive, extraHeaders);
+    connection.outputBytes += out.memorySize();
+    connection.output.push_back(std::move(out));
+
+    if (!request.keepAlive) {
+        connection.closeAfterWrite = true;
+    }
 }
 
-bool WebServer::parseHttpRequest(const std::string& request, 
-                                std::string& method, 
-                                std::string& path, 
+bool WebServer::parseHttpRequest(const std::string& request,
+                                std::string& method,
+                                std::string& path,
+                                std::string& version,
                                 std::unordered_map<std::string, std::string>& headers) {
     std::istringstream stream(request);
     std::string line;
-    
+
     // 解析请求行
     if (!std::getline(stream, line)) return false;
-    
+
     std::istringstream requestLine(line);
-    if (!(requestLine >> method >> path)) return false;
-    
+    if (!(requestLine >> method >> path >> version)) return false;
+    if (version.compare(0, 5, "HTTP/") != 0) return false;
+
+    // 去掉查询字符串和片段，再做URL解码
+    size_t queryPos = path.find_first_of("?#");
+    if (queryPos != std::string::npos) {
+        path.erase(queryPos);
+    }
+    path = urlDecode(path);
+
     // 解析headers
     while (std::getline(stream, line) && line != "\r") {
         size_t colonPos = line.find(':');
         if (colonPos != std::string::npos) {
-            std::string key = line.substr(0, colonPos);
+            std::string key = ToLower(line.substr(0, colonPos));
             std::string value = line.substr(colonPos + 1);
             // 去除首尾空白字符
             value.erase(0, value.find_first_not_of(" \t\r\n"));
@@ -333,30 +918,49 @@ bool WebServer::parseHttpRequest(const std::string& request,
             headers[key] = value;
         }
     }
-    
+
     return true;
 }
 
-std::string WebServer::buildHttpResponse(int statusCode, 
+std::string WebServer::buildHttpResponse(int statusCode,
                                         const std::string& statusText,
-                                        const std::string& content, 
+                                        const std::string& content,
                                         const std::string& contentType,
-                                        bool isHeadRequest) {
-    std::stringstream response;
-    
-    response << "HTTP/1.1 " << statusCode << " " << statusText << "\r\n";
-    response << "Content-Type: " << contentType << "\r\n";
-    response << "Content-Length: " << content.length() << "\r\n";
-    response << "Connection: close\r\n";
-    response << "Access-Control-Allow-Origin: *\r\n";
-    response << "\r\n";
-    
+                                        bool isHeadRequest,
+                                        bool keepAlive,
+                                        const std::string& extraHeaders) {
+    std::string response = buildHttpHead(statusCode, statusText, contentType, content.length(), keepAlive, extraHeaders);
+
     // HEAD请求不返回内容体
     if (!isHeadRequest) {
-        response << content;
+        response += content;
     }
-    
-    return response.str();
+
+    return response;
+}
+
+std::string WebServer::buildHttpHead(int statusCode,
+                                    const std::string& statusText,
+                                    const std::string& contentType,
+                                    uint64_t contentLength,
+                                    bool keepAlive,
+                                    const std::string& extraHeaders) {
+    std::string head;
+    head.reserve(256 + extraHeaders.size());
+
+    head += "HTTP/1.1 " + std::to_string(statusCode) + " " + statusText + "\r\n";
+    head += "Content-Type: " + contentType + "\r\n";
+    head += "Content-Length: " + std::to_string(contentLength) + "\r\n";
+    head += extraHeaders;
+    if (keepAlive) {
+        head += "Connection: keep-alive\r\n";
+        head += "Keep-Alive: timeout=" + std::to_string(KEEP_ALIVE_TIMEOUT_MS / 1000) + "\r\n";
+    } else {
+        head += "Connection: close\r\n";
+    }
+    head += "Access-Control-Allow-Origin: *\r\n";
+    head += "\r\n";
+    return head;
 }
 
 std::string WebServer::getMimeType(const std::string& filePath) const {
@@ -390,12 +994,18 @@ bool WebServer::readFile(const std::string& filePath, std::string& content) cons
 std::string WebServer::urlDecode(const std::string& str) const {
     std::string result;
     result.reserve(str.length());
-    
+
+    auto hexValue = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
     for (size_t i = 0; i < str.length(); ++i) {
-        if (str[i] == '%' && i + 2 < str.length()) {
-            std::string hex = str.substr(i + 1, 2);
-            char ch = static_cast<char>(std::stoi(hex, nullptr, 16));
-            result += ch;
+        // 非法的转义序列按原样保留
+        if (str[i] == '%' && i + 2 < str.length() && hexValue(str[i + 1]) >= 0 && hexValue(str[i + 2]) >= 0) {
+            result += static_cast<char>(hexValue(str[i + 1]) * 16 + hexValue(str[i + 2]));
             i += 2;
         } else if (str[i] == '+') {
             result += ' ';
@@ -403,7 +1013,7 @@ std::string WebServer::urlDecode(const std::string& str) const {
             result += str[i];
         }
     }
-    
+
     return result;
 }
 
@@ -450,10 +1060,21 @@ bool WebServer::isSafePath(const std::string& path) const {
     return true;
 }
 
+void WebServer::publishAsset(const std::string& urlPath, std::shared_ptr<const StaticAsset> asset) {
+    std::lock_guard<std::mutex> lock(publishedMutex_);
+    publishedAssets_[urlPath] = std::move(asset);
+}
+
+void WebServer::unpublishAsset(const std::string& urlPath) {
+    std::lock_guard<std::mutex> lock(publishedMutex_);
+    publishedAssets_.erase(urlPath);
+}
+
 void WebServer::addRoute(const std::string& path, 
-                         std::function<std::string(const std::string&)> handler) {
+                         std::function<std::string(const std::string&)> handler,
+                         const std::string& contentType) {
     std::lock_guard<std::mutex> lock(mutex_);
-    customRoutes_[path] = handler;
+    customRoutes_[path] = CustomRoute{handler, contentType};
     
     Logger::getInstance().info(LogCategory::WEB, "WebServer: Added custom route: " + path);
-}
\ No newline at end of file
+}
@@ -0,0 +1,275 @@
+#include "WebSocketFrame.h"
+
+#include <cstring>
+#include <algorithm>
+
+// ==================== ByteRingBuffer ====================
+
+static const size_t MIN_RING_CAPACITY = 4096;
+
+uint8_t* ByteRingBuffer::writableRegion(size_t minFree, size_t& available) {
+    if (buffer_.size() - size_ < minFree || buffer_.empty()) {
+        grow(size_ + std::max(minFree, static_cast<size_t>(1)));
+    }
+
+    size_t capacity = buffer_.size();
+    size_t tail = (head_ + size_) & (capacity - 1);
+    if (tail >= head_ && size_ != capacity) {
+        // 空闲区在尾部到缓冲区末尾（以及开头到head_）
+        available = capacity - tail;
+    } else {
+        available = head_ - tail;
+    }
+    return buffer_.data() + tail;
+}
+
+void ByteRingBuffer::commitWrite(size_t length) {
+    size_ += length;
+}
+
+void ByteRingBuffer::append(const uint8_t* data, size_t length) {
+    while (length > 0) {
+        size_t available = 0;
+        uint8_t* dest = writableRegion(length, available);
+        size_t chunk = std::min(available, length);
+        std::memcpy(dest, data, chunk);
+        commitWrite(chunk);
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void ByteRingBuffer::copyOut(size_t offset, uint8_t* dest, size_t length) const {
+    size_t capacity = buffer_.size();
+    size_t start = (head_ + offset) & (capacity - 1);
+    size_t first = std::min(length, capacity - start);
+    std::memcpy(dest, buffer_.data() + start, first);
+    if (first < length) {
+        std::memcpy(dest + first, buffer_.data(), length - first);
+    }
+}
+
+void ByteRingBuffer::consume(size_t length) {
+    length = std::min(length, size_);
+    size_ -= length;
+    head_ = size_ == 0 ? 0 : (head_ + length) & (buffer_.size() - 1);
+}
+
+void ByteRingBuffer::grow(size_t minCapacity) {
+    size_t newCapacity = std::max(buffer_.size(), MIN_RING_CAPACITY);
+    while (newCapacity < minCapacity) {
+        newCapacity <<= 1;
+    }
+    if (newCapacity == buffer_.size()) {
+        return;
+    }
+
+    std::vector<uint8_t> newBuffer(newCapacity);
+    if (size_ > 0) {
+        copyOut(0, newBuffer.data(), size_);
+    }
+    buffer_.swap(newBuffer);
+    head_ = 0;
+}
+
+// ==================== 掩码处理 ====================
+
+void unmaskWebSocketPayload(uint8_t* data, size_t length, const uint8_t mask[4], size_t offset) {
+    // 按offset旋转掩码，使之与data[0]对齐
+    uint8_t rotated[8];
+    for (int i = 0; i < 8; ++i) {
+        rotated[i] = mask[(offset + i) & 3];
+    }
+    uint64_t wideMask;
+    std::memcpy(&wideMask, rotated, sizeof(wideMask));
+
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        word ^= wideMask;
+        std::memcpy(data + i, &word, sizeof(word));
+    }
+    for (; i < length; ++i) {
+        data[i] ^= rotated[i & 7];
+    }
+}
+
+// ==================== 帧编码 ====================
+
+size_t webSocketFrameHeaderSize(size_t payloadLength) {
+    if (payloadLength <= 125) return 2;
+    if (payloadLength <= 65535) return 4;
+    return 10;
+}
+
+size_t writeWebSocketFrameHeader(uint8_t* header, uint8_t opcode, size_t payloadLength) {
+    header[0] = static_cast<uint8_t>(0x80 | (opcode & 0x0F));
+    if (payloadLength <= 125) {
+        header[1] = static_cast<uint8_t>(payloadLength);
+        return 2;
+    }
+    if (payloadLength <= 65535) {
+        header[1] = 126;
+        header[2] = static_cast<uint8_t>((payloadLength >> 8) & 0xFF);
+        header[3] = static_cast<uint8_t>(payloadLength & 0xFF);
+        return 4;
+    }
+    header[1] = 127;
+    for (int i = 0; i < 8; ++i) {
+        header[2 + i] = static_cast<uint8_t>((static_cast<uint64_t>(payloadLength) >> (8 * (7 - i))) & 0xFF);
+    }
+    return 10;
+}
+
+// ==================== PreparedFrame ====================
+
+PreparedFrame::PreparedFrame(uint8_t opcode, const uint8_t* payload, size_t length, bool droppable)
+    : bytes_(webSocketFrameHeaderSize(length) + length), droppable_(droppable) {
+    headerSize_ = writeWebSocketFrameHeader(bytes_.data(), opcode, length);
+    if (length > 0) {
+        std::memcpy(bytes_.data() + headerSize_, payload, length);
+    }
+}
+
+SharedFrame PreparedFrame::create(uint8_t opcode, const uint8_t* payload, size_t length, bool droppable) {
+    return std::make_shared<const PreparedFrame>(opcode, payload, length, droppable);
+}
+
+SharedFrame PreparedFrame::text(const std::string& payload, bool droppable) {
+    return create(TEXT_FRAME, reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), droppable);
+}
+
+SharedFrame PreparedFrame::binary(const uint8_t* payload, size_t length, bool droppable) {
+    return create(BINARY_FRAME, payload, length, droppable);
+}
+
+SharedFrame PreparedFrame::close(uint16_t code) {
+    uint8_t payload[2] = {static_cast<uint8_t>((code >> 8) & 0xFF), static_cast<uint8_t>(code & 0xFF)};
+    return create(CLOSE_FRAME, payload, sizeof(payload));
+}
+
+// ==================== WebSocketMessageBatch ====================
+
+WebSocketMessage& WebSocketMessageBatch::append(uint8_t opcode) {
+    if (count_ == messages_.size()) {
+        messages_.emplace_back();
+    }
+    WebSocketMessage& message = messages_[count_++];
+    message.opcode = opcode;
+    if (message.payload.capacity() > MAX_RETAINED_CAPACITY) {
+        std::string().swap(message.payload);
+    } else {
+        message.payload.clear();
+    }
+    return message;
+}
+
+// ==================== WebSocketFrameParser ====================
+
+WebSocketFrameParser::WebSocketFrameParser(size_t maxMessageSize)
+    : maxMessageSize_(maxMessageSize) {}
+
+WebSocketFrameParser::Result WebSocketFrameParser::parse(WebSocketMessageBatch& messages) {
+    while (buffer_.size() >= 2) {
+        uint8_t firstByte = buffer_.peek(0);
+        uint8_t secondByte = buffer_.peek(1);
+
+        bool fin = (firstByte & 0x80) != 0;
+        uint8_t opcode = firstByte & 0x0F;
+        bool masked = (secondByte & 0x80) != 0;
+        uint64_t payloadLength = secondByte & 0x7F;
+
+        // 未协商扩展时保留位必须为0；客户端帧必须带掩码
+        if ((firstByte & 0x70) != 0 || !masked) {
+            return Result::PROTOCOL_ERROR;
+        }
+
+        bool isControl = (opcode & 0x08) != 0;
+        if (isControl && (!fin || payloadLength > 125)) {
+            return Result::PROTOCOL_ERROR;
+        }
+
+        size_t headerSize = 2;
+        if (payloadLength == 126) {
+            if (buffer_.size() < 4) break;
+            payloadLength = (static_cast<uint64_t>(buffer_.peek(2)) << 8) | buffer_.peek(3);
+            headerSize = 4;
+        } else if (payloadLength == 127) {
+            if (buffer_.size() < 10) break;
+            payloadLength = 0;
+            for (int i = 0; i < 8; ++i) {
+                payloadLength = (payloadLength << 8) | buffer_.peek(2 + i);
+            }
+            headerSize = 10;
+        }
+        headerSize += 4;  // 掩码
+
+        // 在等待完整载荷之前就检查上限，避免缓冲区无限增长
+        size_t pendingSize = inFragment_ && !isControl ? fragmentPayload_.size() : 0;
+        if (payloadLength > maxMessageSize_ || pendingSize + payloadLength > maxMessageSize_) {
+            return Result::MESSAGE_TOO_BIG;
+        }
+
+        if (buffer_.size() < headerSize + payloadLength) {
+            break;
+        }
+
+        uint8_t mask[4];
+        buffer_.copyOut(headerSize - 4, mask, 4);
+
+        // 把载荷解掩码追加到out末尾
+        auto readPayload = [&](std::string& out) {
+            size_t offset = out.size();
+            out.resize(offset + static_cast<size_t>(payloadLength));
+            if (payloadLength > 0) {
+                uint8_t* payloadData = reinterpret_cast<uint8_t*>(&out[offset]);
+                buffer_.copyOut(headerSize, payloadData, static_cast<size_t>(payloadLength));
+                unmaskWebSocketPayload(payloadData, static_cast<size_t>(payloadLength), mask);
+            }
+        };
+
+        switch (opcode) {
+            case CONTINUATION_FRAME:
+                if (!inFragment_) {
+                    return Result::PROTOCOL_ERROR;
+                }
+                readPayload(fragmentPayload_);
+                if (fin) {
+                    // 交换而不是拷贝：重组缓冲区换回批次中的旧字符串
+                    messages.append(fragmentOpcode_).payload.swap(fragmentPayload_);
+                    fragmentPayload_.clear();
+                    inFragment_ = false;
+                }
+                break;
+
+            case TEXT_FRAME:
+            case BINARY_FRAME:
+                if (inFragment_) {
+                    return Result::PROTOCOL_ERROR;
+                }
+                if (fin) {
+                    readPayload(messages.append(opcode).payload);
+                } else {
+                    inFragment_ = true;
+                    fragmentOpcode_ = opcode;
+                    fragmentPayload_.clear();
+                    readPayload(fragmentPayload_);
+                }
+                break;
+
+            case CLOSE_FRAME:
+            case PING_FRAME:
+            case PONG_FRAME:
+                // 控制帧可以穿插在分片之间
+                readPayload(messages.append(opcode).payload);
+                break;
+
+            default:
+                return Result::PROTOCOL_ERROR;
+        }
+        buffer_.consume(headerSize + static_cast<size_t>(payloadLength));
+    }
+
+    return Result::OK;
+}
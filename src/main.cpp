@@ -5,6 +5,8 @@
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <map>
+#include <mutex>
 #include <csignal>
 #include <cstdlib>
 #include <nlohmann/json.hpp>
@@ -18,6 +20,8 @@
 #include "CommandSystem.h"
 #include "WebServer.h"
 #include "GlobalState.h"
+#include "RoomManager.h"
+#include "Metrics.h"
 
 using json = nlohmann::json;
 
@@ -133,6 +137,42 @@ void signalHandler(int signal) {
     }
 }
 
+// 迷宫分块的HTTP发布：房间创建时发布其分块URL，最后一个使用该迷宫的房间关闭时撤销
+// 相同的迷宫（相同的哈希）在多个房间间共享同一组URL
+class MazeChunkPublisher {
+public:
+    explicit MazeChunkPublisher(WebServer& webServer) : webServer_(webServer) {}
+    
+    void onRoom(const Room& room, bool opened) {
+        const std::shared_ptr<const MazeChunkSet>& chunks = room.GetMazeChunks();
+        if (!chunks) {
+            return;
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        int& refCount = refCounts_[chunks->mazeHash];
+        if (opened) {
+            if (refCount++ == 0) {
+                for (int layer = 0; layer < chunks->layers; ++layer) {
+                    webServer_.publishAsset(chunks->chunkPath(layer),
+                        StaticAssetCache::makeAsset(chunks->chunks[layer], "application/octet-stream",
+                                                    "public, max-age=31536000, immutable", true));
+                }
+            }
+        } else if (--refCount <= 0) {
+            for (int layer = 0; layer < chunks->layers; ++layer) {
+                webServer_.unpublishAsset(chunks->chunkPath(layer));
+            }
+            refCounts_.erase(chunks->mazeHash);
+        }
+    }
+    
+private:
+    WebServer& webServer_;
+    std::mutex mutex_;
+    std::map<uint64_t, int> refCounts_;
+};
+
 // 命令行参数解析
 struct CommandLineArgs {
     int port = 8080;
@@ -141,6 +181,15 @@ struct CommandLineArgs {
     bool enableConsoleLog = true;
     bool enableFileLog = true;
     LogLevel logLevel = LogLevel::INFO;
+    int ioThreads = 0;  // 0表示自动
+    int tickRate = 20;  // 游戏逻辑帧率（Hz）
+    bool hasMazeSeed = false;
+    uint64_t mazeSeed = 0;  // 生成新迷宫时使用的种子
+    int simulationThreads = 0;  // 0表示按CPU核心数
+    bool pinThreads = true;
+    int roomCapacity = GameConfig().maxPlayers;
+    int maxRooms = 256;
+    bool interestManagement = true;
 };
 
 CommandLineArgs parseCommandLine(int argc, char* argv[]) {
@@ -173,6 +222,35 @@ CommandLineArgs parseCommandLine(int argc, char* argv[]) {
                 else if (level == "warning") args.logLevel = LogLevel::WARNING;
                 else if (level == "error") args.logLevel = LogLevel::ERROR;
             }
+        } else if (arg == "--io-threads") {
+            if (i + 1 < argc) {
+                args.ioThreads = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--tick-rate") {
+            if (i + 1 < argc) {
+                args.tickRate = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--maze-seed") {
+            if (i + 1 < argc) {
+                args.mazeSeed = std::stoull(argv[++i]);
+                args.hasMazeSeed = true;
+            }
+        } else if (arg == "--sim-threads") {
+            if (i + 1 < argc) {
+                args.simulationThreads = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--room-size") {
+            if (i + 1 < argc) {
+                args.roomCapacity = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--max-rooms") {
+            if (i + 1 < argc) {
+                args.maxRooms = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--no-pin-threads") {
+            args.pinThreads = false;
+        } else if (arg == "--no-interest") {
+            args.interestManagement = false;
         } else if (arg == "-h" || arg == "--help") {
             std::cout << "用法: " << argv[0] << " [选项]\n"
                       << "选项:\n"
@@ -182,6 +260,14 @@ CommandLineArgs parseCommandLine(int argc, char* argv[]) {
                       << "  --no-console-log         禁用控制台日志输出\n"
                       << "  --no-file-log            禁用文件日志输出\n"
                       << "  --log-level LEVEL        设置日志级别 (debug, info, warning, error)\n"
+                      << "  --io-threads N           设置网络I/O线程数 (默认: 自动)\n"
+                      << "  --tick-rate HZ           设置游戏逻辑帧率 (默认: 20)\n"
+                      << "  --maze-seed N            生成新迷宫时使用的种子 (默认: 随机)\n"
+                      << "  --sim-threads N          设置模拟线程数 (默认: CPU核心数)\n"
+                      << "  --room-size N            设置每个房间的玩家上限 (默认: " << GameConfig().maxPlayers << ")\n"
+                      << "  --max-rooms N            设置房间数上限 (默认: 256)\n"
+                      << "  --no-pin-threads         不把模拟线程绑定到CPU核心\n"
+                      << "  --no-interest            关闭兴趣管理，向每个客户端同步所有玩家\n"
                       << "  -h, --help               显示此帮助信息\n";
             exit(0);
         }
@@ -304,6 +390,19 @@ void setConsoleTitle(const std::string& title) {
 #endif
 }
 
+// 运行时间格式化为 "1d 2h 3m 4s"
+std::string FormatUptime(double seconds) {
+    long long total = static_cast<long long>(seconds);
+    long long days = total / 86400;
+    long long hours = total % 86400 / 3600;
+    long long minutes = total % 3600 / 60;
+    std::string result;
+    if (days > 0) result += std::to_string(days) + "d ";
+    if (days > 0 || hours > 0) result += std::to_string(hours) + "h ";
+    if (days > 0 || hours > 0 || minutes > 0) result += std::to_string(minutes) + "m ";
+    return result + std::to_string(total % 60) + "s";
+}
+
 int main(int argc, char* argv[]) {
     // 设置控制台标题
     setConsoleTitle("3D迷宫游戏服务器");
@@ -348,56 +447,34 @@ int main(int argc, char* argv[]) {
         // 3. 生成或加载迷宫
         std::unique_ptr<MazeGenerator> mazeGenerator = std::make_unique<MazeGenerator>(50, 50, 7);
         
-        std::vector<std::vector<std::vector<bool>>> mazeLayout;
-        std::vector<std::tuple<int, int, int>> coinPositions;
-        std::tuple<int, int, int> startPos, endPos;
+        MazeGrid maze;
+        uint64_t mazeSeed = 0;
         
         // 尝试加载现有迷宫数据
-        if (!dataManager->LoadMazeData(mazeLayout, coinPositions, startPos, endPos)) {
+        if (!dataManager->LoadMazeData(maze, &mazeSeed)) {
             logger.info(LogCategory::GAME, "未找到迷宫数据，生成新迷宫...");
-            mazeGenerator->generateMaze();
-            
-            // 转换迷宫数据格式
-            int width = mazeGenerator->getWidth();
-            int height = mazeGenerator->getHeight();
-            int layers = mazeGenerator->getLayers();
-            
-            mazeLayout.resize(layers, std::vector<std::vector<bool>>(
-                height, std::vector<bool>(width, false)));
-            
-            // 填充迷宫布局
-            for (int z = 0; z < layers; ++z) {
-                for (int y = 0; y < height; ++y) {
-                    for (int x = 0; x < width; ++x) {
-                        CellType cellType = mazeGenerator->getCellType(x, y, z);
-                        mazeLayout[z][y][x] = (cellType == CellType::WALL);
-                    }
-                }
+            auto generateStart = std::chrono::steady_clock::now();
+            if (args.hasMazeSeed) {
+                mazeGenerator->generateMaze(args.mazeSeed);
+            } else {
+                mazeGenerator->generateMaze();
             }
-            
-            // 获取起点和终点
-            Position start = mazeGenerator->getStartPosition();
-            Position end = mazeGenerator->getEndPosition();
-            startPos = {start.x, start.y, start.z};
-            endPos = {end.x, end.y, end.z};
+            maze = mazeGenerator->getGrid();
+            mazeSeed = mazeGenerator->getSeed();
+            auto generateMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - generateStart).count();
+            logger.info(LogCategory::GAME, "迷宫生成完成，种子: " + std::to_string(mazeGenerator->getSeed()) +
+                        "，耗时 " + std::to_string(generateMs) + " ms");
             
             // 保存迷宫数据
-            if (!dataManager->SaveMazeData(mazeLayout, coinPositions, startPos, endPos)) {
+            if (!dataManager->SaveMazeData(maze, mazeGenerator->getSeed())) {
                 logger.warning(LogCategory::DATABASE, "无法保存迷宫数据");
             }
         } else {
             logger.info(LogCategory::GAME, "成功加载现有迷宫数据");
         }
         
-        // 4. 初始化游戏逻辑
-        std::unique_ptr<GameLogic> gameLogic = std::make_unique<GameLogic>();
-        if (!gameLogic->Initialize(mazeLayout, coinPositions, startPos, endPos)) {
-            logger.error(LogCategory::GAME, "游戏逻辑初始化失败");
-            return 1;
-        }
-        logger.info(LogCategory::GAME, "游戏逻辑初始化完成");
-        
-        // 5. 初始化玩家管理器
+        // 4. 初始化玩家管理器
         std::unique_ptr<PlayerManager> playerManager = std::make_unique<PlayerManager>();
         if (!playerManager->Initialize(args.dataPath)) {
             logger.error(LogCategory::PLAYER, "玩家管理器初始化失败");
@@ -405,118 +482,45 @@ int main(int argc, char* argv[]) {
         }
         logger.info(LogCategory::PLAYER, "玩家管理器初始化完成");
         
-        // 6. 初始化命令系统
-        std::unique_ptr<CommandSystem> commandSystem = std::make_unique<CommandSystem>(*gameLogic, *playerManager);
-        logger.info(LogCategory::COMMAND, "命令系统初始化完成");
-        
-        // 7. 初始化网络管理器（使用端口+1，避免与Web服务器冲突）
+        // 5. 初始化网络管理器（使用端口+1，避免与Web服务器冲突）
         NetworkManager& networkManager = NetworkManager::getInstance();
         int networkPort = args.port + 1; // WebSocket使用下一个端口
-        if (!networkManager.initialize(networkPort)) {
+        if (!networkManager.initialize(networkPort, args.ioThreads)) {
             logger.error(LogCategory::NETWORK, "网络管理器初始化失败");
             return 1;
         }
         
-        // 设置网络消息回调
-        networkManager.setMessageCallback([&](int clientId, const std::string& message) {
-            // 这里处理网络消息
-            logger.debug(LogCategory::NETWORK, "收到来自客户端 " + std::to_string(clientId) + " 的消息: " + message);
-            
-            // 处理特殊消息类型
-            if (message == "CONNECT") {
-                logger.info(LogCategory::NETWORK, "客户端连接: " + std::to_string(clientId));
-                return;
-            }
-            
-            if (message == "DISCONNECT") {
-                logger.info(LogCategory::NETWORK, "客户端断开: " + std::to_string(clientId));
-                // 注销玩家
-                // 注意：这里需要知道玩家ID，但目前没有存储映射关系
-                return;
-            }
-            
-            // 尝试解析JSON消息
-            try {
-                nlohmann::json jsonData = nlohmann::json::parse(message);
-                std::string messageType = jsonData.value("type", "");
-                
-                if (messageType == "auth") {
-                    // 处理认证消息
-                    std::string playerId = jsonData.value("playerId", "");
-                    std::string playerName = jsonData.value("playerName", "");
-                    std::string token = jsonData.value("token", "");
-                    
-                    logger.info(LogCategory::NETWORK, "处理认证请求 - 玩家: " + playerName + ", ID: " + playerId);
-                    
-                    // 改进的认证逻辑：如果没有有效的playerId，生成一个新的
-                    if (playerId.empty() || !playerManager->IsValidPlayerId(playerId)) {
-                        // 使用客户端IP作为MAC地址的替代，使用playerName作为cookie的替代
-                        std::string clientIdentifier = "client_" + std::to_string(clientId);
-                        playerId = playerManager->RegisterPlayer(clientIdentifier, playerName);
-                        
-                        if (playerId.empty()) {
-                            // 注册失败，发送错误响应
-                            nlohmann::json authResponse;
-                            authResponse["type"] = "auth_failed";
-                            authResponse["message"] = "无法注册玩家，请重试";
-                            authResponse["status"] = "failed";
-                            
-                            networkManager.sendToClient(clientId, authResponse.dump());
-                            logger.error(LogCategory::PLAYER, "玩家注册失败: " + playerName);
-                            return; // 使用return而不是continue，因为我们不在循环中
-                        }
-                    }
-                    
-                    // 登录玩家
-                    if (playerManager->LoginPlayer(playerId)) {
-                        // 发送认证成功消息
-                        nlohmann::json authResponse;
-                        authResponse["type"] = "auth_success";
-                        authResponse["playerId"] = playerId;
-                        authResponse["playerName"] = playerName;
-                        authResponse["status"] = "success";
-                        authResponse["token"] = "session_" + std::to_string(std::time(nullptr)); // 生成简单token
-                        
-                        networkManager.sendToClient(clientId, authResponse.dump());
-                        
-                        // 发送初始游戏数据
-                        nlohmann::json playerDataResponse;
-                        playerDataResponse["type"] = "player_data";
-                        playerDataResponse["playerId"] = playerId;
-                        playerDataResponse["playerName"] = playerName;
-                        playerDataResponse["coins"] = 0; // 初始金币
-                        playerDataResponse["position"] = {{"x", 0}, {"y", 0}, {"z", 0}};
-                        
-                        networkManager.sendToClient(clientId, playerDataResponse.dump());
-                        
-                        logger.info(LogCategory::PLAYER, "玩家认证成功: " + playerName + " (ID: " + playerId + ")");
-                    } else {
-                        // 发送认证失败消息
-                        nlohmann::json authResponse;
-                        authResponse["type"] = "auth_failed";
-                        authResponse["message"] = "登录失败，请重试";
-                        authResponse["status"] = "failed";
-                        
-                        networkManager.sendToClient(clientId, authResponse.dump());
-                        
-                        logger.warning(LogCategory::PLAYER, "玩家登录失败: " + playerName);
-                    }
-                } else if (messageType == "ping") {
-                    // 处理心跳消息
-                    nlohmann::json pongResponse;
-                    pongResponse["type"] = "pong";
-                    pongResponse["timestamp"] = jsonData.value("timestamp", 0);
-                    
-                    networkManager.sendToClient(clientId, pongResponse.dump());
-                }
-                // 可以在这里添加更多消息类型的处理
-                
-            } catch (const std::exception& e) {
-                logger.error(LogCategory::NETWORK, "消息解析错误: " + std::string(e.what()));
-            }
+        logger.info(LogCategory::NETWORK, "网络管理器初始化完成，端口: " + std::to_string(networkPort));
+        
+        // 6. 初始化房间：默认房间使用持久化的迷宫，其余房间按需创建
+        RoomConfig roomConfig;
+        roomConfig.simulationThreads = args.simulationThreads;
+        roomConfig.pinThreads = args.pinThreads;
+        roomConfig.roomCapacity = args.roomCapacity;
+        roomConfig.maxRooms = args.maxRooms;
+        roomConfig.tickRate = args.tickRate;
+        roomConfig.hasMazeSeed = args.hasMazeSeed;
+        roomConfig.mazeSeed = args.mazeSeed;
+        roomConfig.interest.enabled = args.interestManagement;
+        RoomManager roomManager(roomConfig, *playerManager, *dataManager, networkManager);
+        MazeChunkPublisher mazeChunkPublisher(WebServer::getInstance());
+        roomManager.SetRoomListener([&mazeChunkPublisher](const Room& room, bool opened) {
+            mazeChunkPublisher.onRoom(room, opened);
         });
+        if (!roomManager.Initialize(maze, mazeSeed)) {
+            logger.error(LogCategory::GAME, "游戏逻辑初始化失败");
+            return 1;
+        }
+        logger.info(LogCategory::GAME, "游戏逻辑初始化完成");
         
-        logger.info(LogCategory::NETWORK, "网络管理器初始化完成，端口: " + std::to_string(networkPort));
+        // 入站消息在I/O线程上直接投递到所属房间
+        networkManager.setIncomingMessageHandler([&roomManager](int clientId, std::string&& payload, bool binary) {
+            roomManager.RouteMessage(clientId, std::move(payload), binary);
+        });
+        
+        // 7. 初始化命令系统
+        std::unique_ptr<CommandSystem> commandSystem = std::make_unique<CommandSystem>(roomManager, *playerManager);
+        logger.info(LogCategory::COMMAND, "命令系统初始化完成");
         
         // 8. 初始化Web服务器
         WebServer& webServer = WebServer::getInstance();
@@ -526,35 +530,107 @@ int main(int argc, char* argv[]) {
         }
         
         // 添加API路由
-        webServer.addRoute("/api/config", [networkPort](const std::string& request) -> std::string {
+        webServer.addRoute("/api/config", [networkPort, &roomManager](const std::string& request) -> std::string {
+            const RoomConfig& config = roomManager.GetConfig();
             std::string response = 
                 "{\n"
                 "  \"websocketPort\": " + std::to_string(networkPort) + ",\n"
                 "  \"gameVersion\": \"1.0.0\",\n"
                 "  \"serverName\": \"3D迷宫游戏服务器\",\n"
                 "  \"mazeSize\": \"50x50x7\",\n"
-                "  \"maxPlayers\": 50\n"
+                "  \"roomCapacity\": " + std::to_string(config.roomCapacity) + ",\n"
+                "  \"maxRooms\": " + std::to_string(config.maxRooms) + ",\n"
+                "  \"maxPlayers\": " + std::to_string(config.roomCapacity * config.maxRooms) + "\n"
                 "}";
             return response;
         });
         
-        webServer.addRoute("/api/status", [&gameLogic, &playerManager, &networkManager](const std::string& request) -> std::string {
+        webServer.addRoute("/api/status", [&playerManager, &networkManager, &roomManager, &args](const std::string& request) -> std::string {
             int connectedPlayers = networkManager.getConnectedClientsCount();
+            RoomManagerStats rooms = roomManager.GetStats();
             std::string response = 
                 "{\n"
                 "  \"status\": \"running\",\n"
                 "  \"connectedPlayers\": " + std::to_string(connectedPlayers) + ",\n"
                 "  \"totalPlayers\": " + std::to_string(playerManager->GetPlayerCount()) + ",\n"
                 "  \"onlinePlayers\": " + std::to_string(playerManager->GetOnlinePlayerCount()) + ",\n"
-                "  \"uptime\": \"unknown\",\n"
+                "  \"rooms\": " + std::to_string(rooms.rooms) + ",\n"
+                "  \"simulationThreads\": " + std::to_string(roomManager.GetThreadCount()) + ",\n"
+                "  \"tickRate\": " + std::to_string(args.tickRate) + ",\n"
+                "  \"avgTickMs\": " + std::to_string(rooms.avgTickMs) + ",\n"
+                "  \"maxTickMs\": " + std::to_string(rooms.maxTickMs) + ",\n"
+                "  \"tickOverruns\": " + std::to_string(rooms.overruns) + ",\n"
+                "  \"uptime\": \"" + FormatUptime(MetricsRegistry::getInstance().getUptimeSeconds()) + "\",\n"
+                "  \"uptimeSeconds\": " + std::to_string(static_cast<long long>(MetricsRegistry::getInstance().getUptimeSeconds())) + ",\n"
                 "  \"serverTime\": \"" + Logger::getInstance().getCurrentISOTimeString() + "\"\n"
                 "}";
             return response;
         });
         
+        webServer.addRoute("/api/rooms", [&roomManager](const std::string& request) -> std::string {
+            json rooms = json::array();
+            for (const RoomInfo& info : roomManager.GetRoomInfo()) {
+                rooms.push_back({
+                    {"roomId", info.roomId},
+                    {"members", info.members},
+                    {"players", info.sessions},
+                    {"mazeSeed", info.mazeSeed},
+                    {"tickRate", info.tickRate},
+                    {"avgTickMs", info.tick.avgTickMs},
+                    {"maxTickMs", info.tick.maxTickMs},
+                    {"tickOverruns", info.tick.overruns}
+                });
+            }
+            return json{{"rooms", rooms}}.dump(2);
+        });
+        
+        // 各模块已有的统计在导出时读取
+        MetricsRegistry& metrics = MetricsRegistry::getInstance();
+        metrics.gaugeCallback("netlab_ws_connected_clients", "Connected WebSocket clients",
+            [&networkManager] { return static_cast<double>(networkManager.getConnectedClientsCount()); });
+        metrics.gaugeCallback("netlab_ws_send_queue_bytes", "Bytes waiting in all WebSocket send queues",
+            [&networkManager] { return static_cast<double>(networkManager.getSendQueueStats().totalBytes); });
+        metrics.gaugeCallback("netlab_ws_send_queue_max_bytes", "Largest single WebSocket send queue",
+            [&networkManager] { return static_cast<double>(networkManager.getSendQueueStats().maxBytes); });
+        metrics.gaugeCallback("netlab_ws_write_blocked_clients", "WebSocket clients waiting for socket writability",
+            [&networkManager] { return static_cast<double>(networkManager.getSendQueueStats().blockedConnections); });
+        metrics.gaugeCallback("netlab_ws_incoming_queue_messages", "Messages waiting for the simulation threads",
+            [&roomManager] { return static_cast<double>(roomManager.GetStats().queuedMessages); });
+        metrics.gaugeCallback("netlab_players_online", "Online players",
+            [&playerManager] { return static_cast<double>(playerManager->GetOnlinePlayerCount()); });
+        metrics.gaugeCallback("netlab_tick_rate_hz", "Configured simulation tick rate",
+            [&args] { return static_cast<double>(args.tickRate); });
+        metrics.counterCallback("netlab_tick_overruns_total", "Ticks that took longer than the tick interval",
+            [&roomManager] { return static_cast<uint64_t>(roomManager.GetStats().overruns); });
+        metrics.counterCallback("netlab_tick_skipped_total", "Ticks skipped after falling too far behind",
+            [&roomManager] { return static_cast<uint64_t>(roomManager.GetStats().skippedTicks); });
+        metrics.gaugeCallback("netlab_rooms", "Open game rooms",
+            [&roomManager] { return static_cast<double>(roomManager.GetRoomCount()); });
+        metrics.counterCallback("netlab_room_runs_total", "Times a room was run by a simulation thread",
+            [&roomManager] { return static_cast<uint64_t>(roomManager.GetStats().runs); });
+        metrics.counterCallback("netlab_room_steals_total", "Room runs taken from another simulation thread's queue",
+            [&roomManager] { return static_cast<uint64_t>(roomManager.GetStats().steals); });
+        metrics.gaugeCallback("netlab_log_queue_records", "Log records waiting for the writer thread",
+            [] { return static_cast<double>(Logger::getInstance().getQueueDepth()); });
+        metrics.counterCallback("netlab_log_dropped_records_total", "Log records dropped because the queue was full",
+            [] { return static_cast<uint64_t>(Logger::getInstance().getDroppedCount()); });
+        metrics.counterCallback("netlab_http_requests_total", "HTTP requests served",
+            [&webServer] { return static_cast<uint64_t>(webServer.getRequestsServed()); });
+        metrics.gaugeCallback("netlab_http_open_connections", "Open HTTP connections",
+            [&webServer] { return static_cast<double>(webServer.getOpenConnections()); });
+        
+        webServer.addRoute("/api/metrics", [&metrics](const std::string& request) -> std::string {
+            return metrics.renderPrometheus();
+        }, "text/plain; version=0.0.4; charset=utf-8");
+        
         logger.info(LogCategory::WEB, "Web服务器初始化完成");
         
         // 启动服务器
+        if (!roomManager.Start()) {
+            logger.error(LogCategory::GAME, "无法启动模拟线程");
+            return 1;
+        }
+        
         if (!networkManager.startServer()) {
             logger.error(LogCategory::NETWORK, "无法启动网络服务器");
             return 1;
@@ -572,6 +648,8 @@ int main(int argc, char* argv[]) {
         std::cout << "API接口可用:" << std::endl;
         std::cout << "  - http://localhost:" << args.port << "/api/config" << std::endl;
         std::cout << "  - http://localhost:" << args.port << "/api/status" << std::endl;
+        std::cout << "  - http://localhost:" << args.port << "/api/rooms" << std::endl;
+        std::cout << "  - http://localhost:" << args.port << "/api/metrics" << std::endl;
         std::cout << "输入 'quit' 或 'exit' 退出服务器" << std::endl;
         std::cout << "输入命令进行管理操作" << std::endl;
         std::cout << std::endl; // 添加空行分隔
@@ -580,21 +658,10 @@ int main(int argc, char* argv[]) {
         // 启动控制台命令线程
         std::thread consoleThread(consoleCommandThread, std::ref(*commandSystem));
         
-        // 主循环
-        auto lastUpdateTime = std::chrono::steady_clock::now();
-        const std::chrono::milliseconds updateInterval(100); // 10 FPS
-        
+        // 游戏逻辑在模拟线程池上运行，主线程等待关闭信号
+        logger.info(LogCategory::GAME, "游戏逻辑帧率: " + std::to_string(args.tickRate) + " Hz");
         while (!g_shutdownRequested) {
-            auto currentTime = std::chrono::steady_clock::now();
-            auto elapsedTime = currentTime - lastUpdateTime;
-            
-            if (elapsedTime >= updateInterval) {
-                // 更新游戏逻辑
-                gameLogic->Update();
-                lastUpdateTime = currentTime;
-            }
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
         }
         
         // 优雅关闭
@@ -604,6 +671,10 @@ int main(int argc, char* argv[]) {
         logger.info(LogCategory::SYSTEM, "正在关闭网络管理器...");
         networkManager.stopServer();
         
+        // 停止模拟线程（网络已停止，不会再有入站消息）
+        logger.info(LogCategory::SYSTEM, "正在停止模拟线程...");
+        roomManager.Stop();
+        
         // 停止Web服务器
         logger.info(LogCategory::SYSTEM, "正在关闭Web服务器...");
         webServer.stopServer();
@@ -641,6 +712,7 @@ int main(int argc, char* argv[]) {
         playerManager->SaveAllPlayerData();
         
         logger.logSystemEvent("服务器关闭", "服务器已完全关闭");
+        logger.flush();
         std::cout << "服务器已关闭" << std::endl;
         
     } catch (const std::exception& e) {
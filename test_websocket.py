@@ -1,6 +1,5 @@
 #!/usr/bin/env python3
 import websocket
-import thread
 import time
 import json
 
@@ -6,6 +6,7 @@ class GameController {
         this.mouse = { x: 0, y: 0 };
         this.movement = { x: 0, z: 0 };
         this.rotation = { x: 0, y: 0 };
+        this.lastSentRotationY = 0;
         
         this.moveSpeed = 0.1;
         this.rotationSpeed = 0.002;
@@ -125,41 +126,44 @@ class GameController {
         
         if (this.isChatFocused || this.isShopOpen) return;
         
-        // 处理移动输入
-        this.movement.x = 0;
-        this.movement.z = 0;
+        // 处理移动输入，方向与服务器 MoveDirection 对应
+        const directions = [];
+        if (this.keys['KeyW']) directions.push('forward');
+        if (this.keys['KeyS']) directions.push('backward');
+        if (this.keys['KeyA']) directions.push('left');
+        if (this.keys['KeyD']) directions.push('right');
         
-        if (this.keys['KeyW']) this.movement.z -= this.moveSpeed;
-        if (this.keys['KeyS']) this.movement.z += this.moveSpeed;
-        if (this.keys['KeyA']) this.movement.x -= this.moveSpeed;
-        if (this.keys['KeyD']) this.movement.x += this.moveSpeed;
+        // 没有移动且朝向未变化时不发送
+        if (directions.length === 0 && this.rotation.y === this.lastSentRotationY) return;
+        this.lastSentRotationY = this.rotation.y;
         
-        // 应用旋转到移动方向
-        if (this.movement.x !== 0 || this.movement.z !== 0) {
+        this.game.networkClient.sendPlayerMove(directions, this.rotation.y);
+        
+        // 本地预测：与服务器 GameLogic::MovePlayer 使用相同的公式，快照到达后再校正
+        if (this.game.gameState.position && directions.length > 0) {
             const sinY = Math.sin(this.rotation.y);
             const cosY = Math.cos(this.rotation.y);
+            let movedX = 0;
+            let movedZ = 0;
             
-            const movedX = this.movement.x * cosY - this.movement.z * sinY;
-            const movedZ = this.movement.x * sinY + this.movement.z * cosY;
+            directions.forEach(direction => {
+                switch (direction) {
+                    case 'forward':  movedX -= sinY; movedZ -= cosY; break;
+                    case 'backward': movedX += sinY; movedZ += cosY; break;
+                    case 'left':     movedX -= cosY; movedZ += sinY; break;
+                    case 'right':    movedX += cosY; movedZ -= sinY; break;
+                }
+            });
             
-            // 更新玩家位置
-            if (this.game.gameState.position) {
-                this.game.gameState.position.x += movedX;
-                this.game.gameState.position.z += movedZ;
-                
-                // 发送位置更新到服务器
-                this.game.networkClient.sendPlayerMove(
-                    this.game.gameState.position,
-                    this.rotation
-                );
-                
-                // 更新本地玩家渲染
-                this.game.renderer3D.updatePlayerPosition(
-                    this.game.gameState.playerId,
-                    this.game.gameState.position,
-                    this.rotation
-                );
-            }
+            this.game.gameState.position.x += movedX * this.moveSpeed;
+            this.game.gameState.position.z += movedZ * this.moveSpeed;
+            
+            // 更新本地玩家渲染
+            this.game.renderer3D.updatePlayerPosition(
+                this.game.gameState.playerId,
+                this.game.gameState.position,
+                this.rotation
+            );
         }
     }
     
@@ -1,4 +1,149 @@
 // NetworkClient.js - 完整的网络客户端实现
+
+// 二进制线格式编解码，与服务器 BinaryProtocol.h 对应
+// 消息头：[u8 版本][u8 操作码]，之后为固定布局的小端字段
+const BinaryProtocol = {
+    VERSION: 1,
+    
+    OP_INPUT: 0x01,
+    OP_PING: 0x02,
+    OP_SNAPSHOT_ACK: 0x03,
+    OP_PONG: 0x81,
+    OP_SNAPSHOT: 0x82,
+    OP_MAZE_CHUNK: 0x83,
+    
+    // 迷宫分块，与服务器 MazeChunks.h 对应
+    MAZE_CHUNK_MAGIC: 0x434D4C4E,
+    MAZE_CHUNK_VERSION: 1,
+    CELL_WALL: 0,
+    CELL_PATH: 1,
+    
+    // 方向位，与服务器 MoveDirection 的顺序一致
+    DIRECTION_BITS: { forward: 1, backward: 2, left: 4, right: 8, up: 16, down: 32 },
+    
+    // 玩家增量字段位
+    FIELD_X: 1, FIELD_Y: 2, FIELD_Z: 4, FIELD_ROT: 8, FIELD_ALIVE: 16, FIELD_COINS: 32,
+    
+    createMessage(opcode, bodySize) {
+        const buffer = new ArrayBuffer(2 + bodySize);
+        const view = new DataView(buffer);
+        view.setUint8(0, this.VERSION);
+        view.setUint8(1, opcode);
+        return { buffer, view };
+    },
+    
+    encodeInput(sequence, directions, rotation) {
+        const { buffer, view } = this.createMessage(this.OP_INPUT, 9);
+        let bits = 0;
+        directions.forEach(direction => { bits |= this.DIRECTION_BITS[direction] || 0; });
+        view.setUint32(2, sequence >>> 0, true);
+        view.setUint8(6, bits);
+        view.setFloat32(7, rotation, true);
+        return buffer;
+    },
+    
+    encodePing(timestamp) {
+        const { buffer, view } = this.createMessage(this.OP_PING, 8);
+        view.setFloat64(2, timestamp, true);
+        return buffer;
+    },
+    
+    encodeSnapshotAck(tick) {
+        const { buffer, view } = this.createMessage(this.OP_SNAPSHOT_ACK, 4);
+        view.setUint32(2, tick >>> 0, true);
+        return buffer;
+    },
+    
+    // 解码服务器消息，生成与JSON消息相同结构的对象；格式错误时返回null
+    decode(buffer) {
+        const view = new DataView(buffer);
+        if (view.byteLength < 2 || view.getUint8(0) !== this.VERSION) return null;
+        
+        try {
+            switch (view.getUint8(1)) {
+                case this.OP_PONG:
+                    return { type: 'pong', timestamp: view.getFloat64(2, true) };
+                case this.OP_SNAPSHOT:
+                    return this.decodeSnapshot(view);
+                case this.OP_MAZE_CHUNK:
+                    return this.decodeMazeChunk(view, 2);
+                default:
+                    return null;
+            }
+        } catch (error) {
+            // DataView越界
+            return null;
+        }
+    },
+    
+    decodeSnapshot(view) {
+        let offset = 2;
+        const u8 = () => { const v = view.getUint8(offset); offset += 1; return v; };
+        const u16 = () => { const v = view.getUint16(offset, true); offset += 2; return v; };
+        const i16 = () => { const v = view.getInt16(offset, true); offset += 2; return v; };
+        const u32 = () => { const v = view.getUint32(offset, true); offset += 4; return v; };
+        const i32 = () => { const v = view.getInt32(offset, true); offset += 4; return v; };
+        const list = (readItem) => { const items = []; for (let n = u16(); n > 0; n--) items.push(readItem()); return items; };
+        const wall = () => [i16(), i16(), i16()];
+        
+        const message = { type: 'snapshot', tick: u32(), baseline: u32() };
+        
+        message.players = list(() => {
+            const player = { id: i32() };
+            const fields = u8();
+            if (fields & this.FIELD_X) player.x = i32() / 1000;
+            if (fields & this.FIELD_Y) player.y = i32() / 1000;
+            if (fields & this.FIELD_Z) player.z = i32() / 1000;
+            if (fields & this.FIELD_ROT) player.r = i32() / 1000;
+            if (fields & this.FIELD_ALIVE) player.alive = u8() !== 0;
+            if (fields & this.FIELD_COINS) player.coins = i32();
+            return player;
+        });
+        message.removed = list(i32);
+        message.coinsCollected = list(u16);
+        message.coinsRestored = list(u16);
+        message.wallsBroken = list(wall);
+        message.wallsRepaired = list(wall);
+        return message;
+    },
+    
+    // 解码一层迷宫分块（WebSocket推送时offset为2，HTTP获取时为0）；cells[row * width + col] 为 CellType
+    decodeMazeChunk(view, offset = 0) {
+        if (view.getUint32(offset, true) !== this.MAZE_CHUNK_MAGIC ||
+            view.getUint16(offset + 4, true) !== this.MAZE_CHUNK_VERSION) {
+            return null;
+        }
+        const headerSize = view.getUint16(offset + 6, true);
+        const hex = value => value.toString(16).padStart(8, '0');
+        const chunk = {
+            type: 'maze_chunk',
+            hash: hex(view.getUint32(offset + 12, true)) + hex(view.getUint32(offset + 8, true)),
+            width: view.getUint16(offset + 16, true),
+            height: view.getUint16(offset + 18, true),
+            layers: view.getUint16(offset + 20, true),
+            layer: view.getUint16(offset + 22, true)
+        };
+        const specialCount = view.getUint32(offset + 24, true);
+        
+        const cellCount = chunk.width * chunk.height;
+        const bitmapOffset = offset + headerSize;
+        let specialOffset = bitmapOffset + Math.ceil(cellCount / 8);
+        if (specialOffset + specialCount * 5 > view.byteLength) return null;
+        
+        chunk.cells = new Uint8Array(cellCount);
+        for (let i = 0; i < cellCount; i++) {
+            const wall = (view.getUint8(bitmapOffset + (i >> 3)) >> (i & 7)) & 1;
+            chunk.cells[i] = wall ? this.CELL_WALL : this.CELL_PATH;
+        }
+        for (let n = 0; n < specialCount; n++, specialOffset += 5) {
+            const index = view.getUint32(specialOffset, true);
+            if (index >= cellCount) return null;
+            chunk.cells[index] = view.getUint8(specialOffset + 4);
+        }
+        return chunk;
+    }
+};
+
 class NetworkClient {
     constructor() {
         this.socket = null;
@@ -10,6 +155,12 @@ class NetworkClient {
         this.serverConfig = null;
         this.connectionState = 'disconnected'; // disconnected, connecting, connected, error
         this.connectionCheckInterval = null;
+        
+        // 认证时协商二进制协议；localStorage中 wireProtocol=json 可强制使用JSON便于调试
+        this.preferBinary = localStorage.getItem('wireProtocol') !== 'json';
+        this.useBinary = false;
+        this.inputSequence = 0;
+        this.serverAddress = null;
     }
 
     init(game) {
@@ -24,6 +175,7 @@ class NetworkClient {
         }
         
         this.connectionState = 'connecting';
+        this.serverAddress = serverAddress;
         this.game.uiManager.showConnectionModal('正在连接服务器...');
         this.game.log(`开始连接服务器: ${serverAddress}, 玩家: ${playerName}`, 'network');
         
@@ -104,6 +256,8 @@ class NetworkClient {
                 
                 // 创建简单的WebSocket连接，不添加额外选项
                 this.socket = new WebSocket(wsUrl);
+                this.socket.binaryType = 'arraybuffer';
+                this.useBinary = false;
                 
                 const connectionTimeout = setTimeout(() => {
                     if (this.socket.readyState !== WebSocket.OPEN) {
@@ -134,14 +288,24 @@ class NetworkClient {
                 };
                 
                 this.socket.onmessage = (event) => {
+                    // 二进制帧是高频消息，不经过JSON解析和日志
+                    if (event.data instanceof ArrayBuffer) {
+                        this.handleBinaryMessage(event.data);
+                        return;
+                    }
+                    
                     try {
                         const data = JSON.parse(event.data);
-                        console.log('Received message:', data);
+                        if (data.type !== 'snapshot') {
+                            console.log('Received message:', data);
+                        }
                         
                         // 检查是否是认证相关消息
                         if (data.type === 'auth_success') {
                             clearTimeout(authTimeout);
                             authSuccess = true;
+                            this.useBinary = data.protocol === 'binary';
+                            this.game.log(`消息协议: ${this.useBinary ? '二进制' : 'JSON'}`, 'network');
                             
                             // 保存token到本地存储
                             if (data.token) {
@@ -322,14 +486,66 @@ class NetworkClient {
         return this.send(message);
     }
 
-    // 发送玩家移动消息
-    sendPlayerMove(position, rotation) {
+    // 发送二进制消息
+    sendBinary(buffer) {
+        if (this.socket && this.socket.readyState === WebSocket.OPEN) {
+            this.socket.send(buffer);
+            return true;
+        }
+        return false;
+    }
+
+    // 处理服务器的二进制消息
+    handleBinaryMessage(buffer) {
+        const message = BinaryProtocol.decode(buffer);
+        if (!message) {
+            this.game.log('无法解析的二进制消息', 'warning');
+            return;
+        }
+        
+        if (message.type === 'snapshot') {
+            this.game.handleSnapshot(message);
+        } else if (message.type === 'pong') {
+            this.game.lastPongTime = Date.now();
+        } else if (message.type === 'maze_chunk') {
+            this.game.handleMazeChunk(message);
+        }
+    }
+    
+    // 通过HTTP获取迷宫分块（URL按内容哈希寻址，浏览器可长期缓存）
+    async fetchMazeChunk(path) {
+        const response = await fetch(this.buildHttpUrl(this.serverAddress, path));
+        if (!response.ok) {
+            throw new Error(`HTTP ${response.status}`);
+        }
+        const chunk = BinaryProtocol.decodeMazeChunk(new DataView(await response.arrayBuffer()));
+        if (!chunk) {
+            throw new Error('迷宫分块格式错误');
+        }
+        return chunk;
+    }
+
+    // 发送玩家移动输入：服务器根据方向权威计算位置
+    sendPlayerMove(directions, rotation) {
+        if (this.useBinary) {
+            return this.sendBinary(BinaryProtocol.encodeInput(++this.inputSequence, directions, rotation));
+        }
         return this.sendMessage('move', {
-            position: position,
+            directions: directions,
             rotation: rotation
         });
     }
 
+    // 确认已应用的快照，服务器以此作为后续增量的基线
+    sendSnapshotAck(tick) {
+        if (this.useBinary) {
+            return this.sendBinary(BinaryProtocol.encodeSnapshotAck(tick));
+        }
+        return this.sendMessage('snapshot_ack', {
+            tick: tick
+        });
+    }
+
     // 发送消息的方法，统一消息格式
     sendMessage(type, data = {}) {
         if (this.socket && this.socket.readyState === WebSocket.OPEN) {
@@ -404,7 +620,8 @@ class NetworkClient {
                 type: 'auth',
                 playerId: playerId,
                 playerName: playerName,
-                token: token
+                token: token,
+                binaryProtocol: this.preferBinary ? BinaryProtocol.VERSION : 0
             };
             
             try {
@@ -467,6 +684,7 @@ class NetworkClient {
             this.socket = null;
         }
         
+        this.useBinary = false;
         this.reconnectAttempts = 0;
     }
 
@@ -485,7 +703,11 @@ class NetworkClient {
     startHeartbeat() {
         this.heartbeatInterval = setInterval(() => {
             if (this.socket && this.socket.readyState === WebSocket.OPEN) {
-                this.sendMessage('ping');
+                if (this.useBinary) {
+                    this.sendBinary(BinaryProtocol.encodePing(Date.now()));
+                } else {
+                    this.sendMessage('ping');
+                }
             }
         }, 30000); // 每30秒发送一次ping
     }
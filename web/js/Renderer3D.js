@@ -7,6 +7,8 @@ class Renderer3D {
         this.game = null;
         
         this.maze = null;
+        this.mazeLayers = {};     // 按层加载的迷宫分块：layer -> THREE.Group
+        this.wallMeshes = {};     // "x,layer,z" -> 墙壁网格，用于显示被破坏的墙
         this.players = {};
         this.playerMesh = null;
         
@@ -166,7 +168,52 @@ class Renderer3D {
         this.createCoins(mazeData.coins || []);
     }
     
-    createWall(x, y, z) {
+    // 加载一层迷宫分块（服务器 CellType：0墙 1通路 2/3楼梯 6终点），替换该层已有的几何体
+    loadMazeLayer(layer, chunk) {
+        if (this.mazeLayers[layer]) {
+            this.scene.remove(this.mazeLayers[layer]);
+        }
+        Object.keys(this.wallMeshes).forEach(key => {
+            if (key.split(',')[1] === String(layer)) delete this.wallMeshes[key];
+        });
+        
+        this.mazeWidth = chunk.width;
+        this.mazeHeight = chunk.height;
+        this.mazeLevels = chunk.layers;
+        
+        const group = new THREE.Group();
+        this.mazeLayers[layer] = group;
+        this.scene.add(group);
+        
+        // 分块按 行(z) * width + 列(x) 排列
+        for (let z = 0; z < chunk.height; z++) {
+            for (let x = 0; x < chunk.width; x++) {
+                const cell = chunk.cells[z * chunk.width + x];
+                if (cell === 0) {
+                    this.wallMeshes[`${x},${layer},${z}`] = this.createWall(x, layer, z, group);
+                } else if (cell === 2 || cell === 3) {
+                    this.createStairs(x, layer, z, group);
+                } else if (cell === 6) {
+                    this.createEndPoint(x, layer, z, group);
+                }
+                
+                this.createFloor(x, layer, z, group);
+                if (layer === chunk.layers - 1) {
+                    this.createCeiling(x, layer, z, group);
+                }
+            }
+        }
+    }
+    
+    // 被锤子破坏（broken为true）或修复的墙壁
+    setWallBroken(x, layer, z, broken) {
+        const mesh = this.wallMeshes[`${x},${layer},${z}`];
+        if (mesh) {
+            mesh.visible = !broken;
+        }
+    }
+    
+    createWall(x, y, z, group = this.maze) {
         const geometry = new THREE.BoxGeometry(
             this.blockSize, 
             this.blockSize * 2, 
@@ -180,10 +227,11 @@ class Renderer3D {
         );
         mesh.castShadow = true;
         mesh.receiveShadow = true;
-        this.maze.add(mesh);
+        group.add(mesh);
+        return mesh;
     }
     
-    createFloor(x, y, z) {
+    createFloor(x, y, z, group = this.maze) {
         const geometry = new THREE.PlaneGeometry(this.blockSize, this.blockSize);
         const mesh = new THREE.Mesh(geometry, this.materials.floor);
         mesh.rotation.x = -Math.PI / 2;
@@ -193,10 +241,10 @@ class Renderer3D {
             z * this.blockSize - (this.mazeHeight * this.blockSize) / 2
         );
         mesh.receiveShadow = true;
-        this.maze.add(mesh);
+        group.add(mesh);
     }
     
-    createCeiling(x, y, z) {
+    createCeiling(x, y, z, group = this.maze) {
         const geometry = new THREE.PlaneGeometry(this.blockSize, this.blockSize);
         const mesh = new THREE.Mesh(geometry, this.materials.ceiling);
         mesh.rotation.x = Math.PI / 2;
@@ -206,10 +254,10 @@ class Renderer3D {
             z * this.blockSize - (this.mazeHeight * this.blockSize) / 2
         );
         mesh.receiveShadow = true;
-        this.maze.add(mesh);
+        group.add(mesh);
     }
     
-    createStairs(x, y, z) {
+    createStairs(x, y, z, group = this.maze) {
         const geometry = new THREE.BoxGeometry(
             this.blockSize, 
             this.blockSize * 0.5, 
@@ -224,10 +272,10 @@ class Renderer3D {
         );
         mesh.castShadow = true;
         mesh.receiveShadow = true;
-        this.maze.add(mesh);
+        group.add(mesh);
     }
     
-    createEndPoint(x, y, z) {
+    createEndPoint(x, y, z, group = this.maze) {
         const geometry = new THREE.BoxGeometry(
             this.blockSize, 
             this.blockSize * 0.2, 
@@ -241,7 +289,7 @@ class Renderer3D {
             z * this.blockSize - (this.mazeHeight * this.blockSize) / 2
         );
         mesh.receiveShadow = true;
-        this.maze.add(mesh);
+        group.add(mesh);
     }
     
     createCoins(coinPositions) {
@@ -22,6 +22,11 @@ class MazeGame {
             },
             activeItem: null,
             players: {},
+            entityId: null,        // 服务器快照中本玩家的实体编号
+            entities: {},          // 最新快照中的所有玩家实体
+            collectedCoins: new Set(),
+            brokenWalls: new Set(),
+            compassHint: null,     // 指南针：朝终点的下一步方向和剩余步数
             mazeData: null,
             gameStarted: false
         };
@@ -31,6 +36,16 @@ class MazeGame {
         this.debugLogs = [];
         this.maxDebugLogs = 100;
         
+        // 快照历史：tick -> 世界状态，用于应用服务器的增量
+        this.snapshotHistory = new Map();
+        this.latestSnapshotTick = 0;
+        
+        // 迷宫分块：清单随 auth_success 下发，按玩家所在层及相邻层加载
+        this.mazeManifest = null;
+        this.mazeChunks = new Map();       // layer -> 已解码的分块
+        this.mazeRequested = new Set();    // 已推送或正在获取的层
+        this.currentLayer = null;
+        
         this.init();
     }
     
@@ -217,6 +232,9 @@ class MazeGame {
         // 初始化3D渲染器
         this.renderer3D.init(this);
         
+        // 渲染器创建前已收到的迷宫分块
+        this.mazeChunks.forEach(chunk => this.renderMazeLayer(chunk));
+        
         // 开始游戏循环
         this.startGameLoop();
     }
@@ -304,6 +322,12 @@ class MazeGame {
             const messageType = data.type || data.eventType;
             const messageData = data.data || data; // 兼容两种格式
 
+            // 快照每帧到达，直接处理，不写调试日志
+            if (messageType === 'snapshot') {
+                this.handleSnapshot(data);
+                return;
+            }
+
             this.log(`收到服务器消息: ${messageType}`, 'network');
             
             switch (messageType) {
@@ -337,6 +361,9 @@ class MazeGame {
                 case 'game_event':
                     this.handleGameEvent(messageData);
                     break;
+                case 'compass':
+                    this.handleCompass(messageData);
+                    break;
                 case 'error':
                     this.handleErrorMessage(messageData);
                     break;
@@ -389,7 +416,16 @@ class MazeGame {
     handleAuthSuccess(data) {
         this.log('认证成功', 'network');
         this.gameState.playerId = data.playerId || data.id;
+        this.gameState.entityId = data.entityId !== undefined ? data.entityId : null;
         this.gameState.isConnected = true;
+        this.snapshotHistory.clear();
+        this.latestSnapshotTick = 0;
+        
+        // 服务器随后通过WebSocket推送 pushed 中的层，其余的层按需通过HTTP获取
+        this.mazeManifest = data.maze || null;
+        this.mazeChunks.clear();
+        this.mazeRequested = new Set(this.mazeManifest ? this.mazeManifest.pushed : []);
+        this.currentLayer = null;
         
         // 保存token到本地存储
         if (data.token) {
@@ -440,6 +476,7 @@ class MazeGame {
     handlePlayerJoined(data) {
         this.gameState.players[data.playerId] = {
             id: data.playerId,
+            entityId: data.entityId,
             name: data.playerName,
             position: data.position,
             coins: data.coins
@@ -453,6 +490,9 @@ class MazeGame {
         if (this.gameState.players[data.playerId]) {
             const playerName = this.gameState.players[data.playerId].name;
             delete this.gameState.players[data.playerId];
+            if (data.entityId !== undefined) {
+                this.renderer3D.removePlayer(`entity_${data.entityId}`);
+            }
             
             this.uiManager.addChatMessage('system', `${playerName} 离开了游戏`);
             this.uiManager.updatePlayerCount(Object.keys(this.gameState.players).length);
@@ -482,6 +522,152 @@ class MazeGame {
         
         this.uiManager.updatePlayerInfo(this.gameState.playerName, this.gameState.coins);
         this.uiManager.updateInventory(this.gameState.inventory);
+        this.updateMazeLayers(this.gameState.position.y);
+    }
+    
+    // 玩家所在层变化时加载该层及相邻层的迷宫分块（层号与世界坐标y一致）
+    updateMazeLayers(y) {
+        const layer = Math.round(y);
+        if (!this.mazeManifest || layer === this.currentLayer) return;
+        this.currentLayer = layer;
+        
+        for (let l = layer - 1; l <= layer + 1; l++) {
+            if (l < 0 || l >= this.mazeManifest.layers || this.mazeRequested.has(l)) continue;
+            this.mazeRequested.add(l);
+            this.networkClient.fetchMazeChunk(this.mazeManifest.chunks[l])
+                .then(chunk => this.handleMazeChunk(chunk))
+                .catch(error => {
+                    this.mazeRequested.delete(l);
+                    this.log(`迷宫分块 ${l} 加载失败: ${error.message}`, 'error');
+                });
+        }
+    }
+    
+    handleMazeChunk(chunk) {
+        // 忽略其他迷宫的分块（例如重连到了另一个房间）
+        if (!this.mazeManifest || chunk.hash !== this.mazeManifest.hash) return;
+        this.mazeChunks.set(chunk.layer, chunk);
+        this.renderMazeLayer(chunk);
+    }
+    
+    renderMazeLayer(chunk) {
+        if (!this.renderer3D.scene) return;
+        this.renderer3D.loadMazeLayer(chunk.layer, chunk);
+        
+        // 分块只包含初始墙壁，已被破坏的墙壁按快照状态移除
+        this.gameState.brokenWalls.forEach(key => {
+            const [x, layer, z] = key.split(',').map(Number);
+            if (layer === chunk.layer) {
+                this.renderer3D.setWallBroken(x, layer, z, true);
+            }
+        });
+        this.gameState.gameStarted = true;
+    }
+    
+    // 应用服务器快照：baseline为0表示完整快照，否则是相对已确认快照的增量
+    handleSnapshot(data) {
+        let base;
+        if (data.baseline === 0) {
+            base = { players: {}, coins: [], walls: [] };
+        } else {
+            base = this.snapshotHistory.get(data.baseline);
+            if (!base) {
+                // 基线已被丢弃，等待服务器基于我们确认过的快照重新发送
+                return;
+            }
+        }
+        
+        const state = {
+            players: {},
+            coins: new Set(base.coins),
+            walls: new Set(base.walls)
+        };
+        Object.keys(base.players).forEach(id => {
+            state.players[id] = Object.assign({}, base.players[id]);
+        });
+        
+        (data.players || []).forEach(player => {
+            state.players[player.id] = Object.assign(state.players[player.id] || {}, player);
+        });
+        (data.removed || []).forEach(id => delete state.players[id]);
+        (data.coinsCollected || []).forEach(id => state.coins.add(id));
+        (data.coinsRestored || []).forEach(id => state.coins.delete(id));
+        (data.wallsBroken || []).forEach(wall => state.walls.add(wall.join(',')));
+        (data.wallsRepaired || []).forEach(wall => state.walls.delete(wall.join(',')));
+        
+        const stored = { players: state.players, coins: [...state.coins], walls: [...state.walls] };
+        this.snapshotHistory.set(data.tick, stored);
+        
+        // 服务器之后只会引用不早于本次基线的快照
+        for (const tick of this.snapshotHistory.keys()) {
+            if (tick < data.baseline) {
+                this.snapshotHistory.delete(tick);
+            }
+        }
+        
+        this.networkClient.sendSnapshotAck(data.tick);
+        
+        // 乱序到达的旧快照只用作基线，不覆盖显示
+        if (data.tick > this.latestSnapshotTick) {
+            this.latestSnapshotTick = data.tick;
+            this.applyWorldState(state);
+        }
+    }
+    
+    applyWorldState(state) {
+        const previous = this.gameState.entities;
+        
+        Object.keys(state.players).forEach(id => {
+            const entity = state.players[id];
+            const position = { x: entity.x, y: entity.y, z: entity.z };
+            
+            if (String(this.gameState.entityId) === id) {
+                // 本地玩家：预测偏差过大时按服务器位置校正
+                const local = this.gameState.position;
+                const error = Math.abs(local.x - position.x) + Math.abs(local.y - position.y) + Math.abs(local.z - position.z);
+                if (error > 1.0) {
+                    this.gameState.position = position;
+                }
+                this.updateMazeLayers(position.y);
+                if (entity.coins !== this.gameState.coins) {
+                    this.gameState.coins = entity.coins;
+                    this.uiManager.updatePlayerInfo(this.gameState.playerName, this.gameState.coins);
+                }
+                return;
+            }
+            
+            // 场景尚未创建时只记录状态
+            if (!this.renderer3D.scene) return;
+            
+            const key = `entity_${id}`;
+            if (!this.renderer3D.players[key]) {
+                const player = Object.values(this.gameState.players).find(p => String(p.entityId) === id);
+                this.renderer3D.createPlayerMesh(key, player ? player.name : `玩家${id}`);
+            }
+            this.renderer3D.updatePlayerPosition(key, position, { y: entity.r });
+            this.renderer3D.players[key].visible = entity.alive !== false;
+        });
+        
+        Object.keys(previous).forEach(id => {
+            if (!state.players[id]) {
+                this.renderer3D.removePlayer(`entity_${id}`);
+            }
+        });
+        
+        this.gameState.entities = state.players;
+        this.gameState.collectedCoins = state.coins;
+        
+        // 墙壁变化：增量中的 wallsBroken / wallsRepaired 累积在快照状态里，这里按前后差异更新场景
+        if (this.renderer3D.scene) {
+            const previousWalls = this.gameState.brokenWalls;
+            const setWall = (key, broken) => {
+                const [x, layer, z] = key.split(',').map(Number);
+                this.renderer3D.setWallBroken(x, layer, z, broken);
+            };
+            state.walls.forEach(key => { if (!previousWalls.has(key)) setWall(key, true); });
+            previousWalls.forEach(key => { if (!state.walls.has(key)) setWall(key, false); });
+        }
+        this.gameState.brokenWalls = state.walls;
     }
     
     handleMazeData(data) {
@@ -503,6 +689,14 @@ class MazeGame {
         this.uiManager.updateInventory(this.gameState.inventory);
     }
     
+    handleCompass(data) {
+        const firstHint = !this.gameState.compassHint;
+        this.gameState.compassHint = { direction: data.direction, distance: data.distance };
+        if (firstHint) {
+            this.uiManager.showMessage(`指南针：距离终点 ${data.distance} 步`, 'info');
+        }
+    }
+    
     handleItemUsed(data) {
         if (data.playerId === this.gameState.playerId) {
             this.gameState.inventory = data.inventory;